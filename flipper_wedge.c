@@ -7,6 +7,50 @@ bool flipper_wedge_custom_event_callback(void* context, uint32_t event) {
     return scene_manager_handle_custom_event(app->scene_manager, event);
 }
 
+static FlipperWedgeHidWorkerMode flipper_wedge_get_worker_mode(FlipperWedgeOutput mode) {
+    switch(mode) {
+    case FlipperWedgeOutputBle:
+        return FlipperWedgeHidWorkerModeBle;
+    case FlipperWedgeOutputUsbBle:
+        return FlipperWedgeHidWorkerModeUsbBle;
+    case FlipperWedgeOutputUsbBulk:
+        return FlipperWedgeHidWorkerModeUsbBulk;
+    case FlipperWedgeOutputUsb:
+    default:
+        return FlipperWedgeHidWorkerModeUsb;
+    }
+}
+
+const char* flipper_wedge_output_name(FlipperWedgeOutput mode) {
+    switch(mode) {
+    case FlipperWedgeOutputBle:
+        return "BLE";
+    case FlipperWedgeOutputUsbBle:
+        return "USB+BLE";
+    case FlipperWedgeOutputUsbBulk:
+        return "USB Bulk";
+    case FlipperWedgeOutputUsb:
+    default:
+        return "USB";
+    }
+}
+
+bool flipper_wedge_output_uses_ble(FlipperWedgeOutput mode) {
+    return mode == FlipperWedgeOutputBle || mode == FlipperWedgeOutputUsbBle;
+}
+
+size_t flipper_wedge_ndef_max_chars(FlipperWedgeNdefMaxLen max_len) {
+    switch(max_len) {
+    case FlipperWedgeNdefMaxLen500:
+        return 500;
+    case FlipperWedgeNdefMaxLen1000:
+        return 1000;
+    case FlipperWedgeNdefMaxLen250:
+    default:
+        return 250;
+    }
+}
+
 void flipper_wedge_tick_event_callback(void* context) {
     furi_assert(context);
     FlipperWedge* app = context;
@@ -70,7 +114,11 @@ FlipperWedge* flipper_wedge_app_alloc() {
     app->append_enter = true;
     app->vibration_level = FlipperWedgeVibrationMedium;  // Default: Medium vibration
     app->ndef_max_len = FlipperWedgeNdefMaxLen250;  // Default: 250 char limit (fast typing)
+    app->ndef_select = FlipperWedgeNdefSelectText;  // Default: first text record
+    strlcpy(app->ndef_mime_type, "text/plain", sizeof(app->ndef_mime_type));
     app->log_to_sd = false;  // Default: Logging disabled for privacy/performance
+    app->output_template_text[0] = '\0';  // Default: built-in output arrangement
+    flipper_wedge_template_compile(&app->output_template, app->output_template_text);
     app->restart_pending = false;  // Deprecated field, no longer used
     app->output_switch_pending = false;
     app->output_switch_target = FlipperWedgeOutputUsb;
@@ -78,6 +126,8 @@ FlipperWedge* flipper_wedge_app_alloc() {
     // Clear scanned data
     app->nfc_uid_len = 0;
     app->rfid_uid_len = 0;
+    app->rfid_protocol[0] = '\0';
+    app->rfid_fields.valid = false;
     app->ndef_text[0] = '\0';
     app->output_buffer[0] = '\0';
 
@@ -87,6 +137,7 @@ FlipperWedge* flipper_wedge_app_alloc() {
 
     // Allocate keyboard layout (default to QWERTY)
     app->keyboard_layout = flipper_wedge_keyboard_layout_alloc();
+    app->layout_index = NULL;
 
     // Load configs BEFORE initializing HID (so we respect output_mode setting)
     // This also loads keyboard layout settings
@@ -97,13 +148,13 @@ FlipperWedge* flipper_wedge_app_alloc() {
 
     // Start HID worker with loaded output mode (like Bad USB pattern)
     flipper_wedge_debug_log("App", "Starting HID worker in %s mode",
-                        app->output_mode == FlipperWedgeOutputUsb ? "USB" : "BLE");
-    FlipperWedgeHidWorkerMode worker_mode = (app->output_mode == FlipperWedgeOutputUsb) ?
-        FlipperWedgeHidWorkerModeUsb : FlipperWedgeHidWorkerModeBle;
-    flipper_wedge_hid_worker_start(app->hid_worker, worker_mode);
+                        flipper_wedge_output_name(app->output_mode));
+    flipper_wedge_hid_worker_start(app->hid_worker, flipper_wedge_get_worker_mode(app->output_mode));
 
     // Allocate NFC module
     app->nfc = flipper_wedge_nfc_alloc();
+    flipper_wedge_nfc_set_ndef_select(app->nfc, app->ndef_select, app->ndef_mime_type);
+    flipper_wedge_nfc_set_ndef_max_chars(app->nfc, flipper_wedge_ndef_max_chars(app->ndef_max_len));
 
     // Allocate RFID module
     app->rfid = flipper_wedge_rfid_alloc();
@@ -169,7 +220,7 @@ void flipper_wedge_switch_output_mode(FlipperWedge* app, FlipperWedgeOutput new_
 
     // STEP 2: Stop HID worker (deinits HID in worker thread, waits for exit)
     flipper_wedge_debug_log(TAG, "Step 2: Stopping HID worker (old mode=%s)",
-                        app->output_mode == FlipperWedgeOutputUsb ? "USB" : "BLE");
+                        flipper_wedge_output_name(app->output_mode));
     flipper_wedge_hid_worker_stop(app->hid_worker);
     flipper_wedge_debug_log(TAG, "HID worker stopped");
 
@@ -183,10 +234,8 @@ void flipper_wedge_switch_output_mode(FlipperWedge* app, FlipperWedgeOutput new_
 
     // STEP 5: Start HID worker with new mode (inits HID in worker thread)
     flipper_wedge_debug_log(TAG, "Step 5: Starting HID worker (new mode=%s)",
-                        new_mode == FlipperWedgeOutputUsb ? "USB" : "BLE");
-    FlipperWedgeHidWorkerMode worker_mode = (new_mode == FlipperWedgeOutputUsb) ?
-        FlipperWedgeHidWorkerModeUsb : FlipperWedgeHidWorkerModeBle;
-    flipper_wedge_hid_worker_start(app->hid_worker, worker_mode);
+                        flipper_wedge_output_name(new_mode));
+    flipper_wedge_hid_worker_start(app->hid_worker, flipper_wedge_get_worker_mode(new_mode));
     flipper_wedge_debug_log(TAG, "HID worker started");
 
     // STEP 6: Restart NFC/RFID workers if they were running
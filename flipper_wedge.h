@@ -20,10 +20,12 @@
 #include "helpers/flipper_wedge_storage.h"
 #include "helpers/flipper_wedge_hid.h"
 #include "helpers/flipper_wedge_keyboard_layout.h"
+#include "helpers/flipper_wedge_keyboard_layout_index.h"
 #include "helpers/flipper_wedge_hid_worker.h"
 #include "helpers/flipper_wedge_nfc.h"
 #include "helpers/flipper_wedge_rfid.h"
 #include "helpers/flipper_wedge_format.h"
+#include "helpers/flipper_wedge_template.h"
 #include "helpers/flipper_wedge_log.h"
 #include "flipper_wedge_icons.h"
 
@@ -60,6 +62,8 @@ typedef enum {
 typedef enum {
     FlipperWedgeOutputUsb,      // USB HID only
     FlipperWedgeOutputBle,      // Bluetooth LE HID only
+    FlipperWedgeOutputUsbBle,   // USB and Bluetooth LE HID at the same time
+    FlipperWedgeOutputUsbBulk,  // USB raw HID reports for a host reader, no typing
     FlipperWedgeOutputCount,
 } FlipperWedgeOutput;
 
@@ -112,6 +116,7 @@ typedef struct {
 
     // Keyboard layout for HID output
     FlipperWedgeKeyboardLayout* keyboard_layout;
+    FlipperWedgeKeyboardLayoutIndex* layout_index; // Custom layout listing, only while in Settings
 
     // NFC module
     FlipperWedgeNfc* nfc;
@@ -131,13 +136,19 @@ typedef struct {
     FlipperWedgeNfcError nfc_error;
     uint8_t rfid_uid[FLIPPER_WEDGE_RFID_UID_MAX_LEN];
     uint8_t rfid_uid_len;
+    char rfid_protocol[32];
+    FlipperWedgeRfidFields rfid_fields; // Facility code and card number, when the protocol has them
 
     // Settings
     char delimiter[FLIPPER_WEDGE_DELIMITER_MAX_LEN];
     bool append_enter;
     FlipperWedgeVibration vibration_level;
     FlipperWedgeNdefMaxLen ndef_max_len;  // Maximum NDEF text length to type
+    FlipperWedgeNdefSelect ndef_select;  // Which NDEF records to type
+    char ndef_mime_type[FLIPPER_WEDGE_NDEF_MIME_TYPE_MAX_LEN]; // For MIME records, set in the settings file only
     bool log_to_sd;        // Log scanned UIDs to SD card
+    char output_template_text[FLIPPER_WEDGE_TEMPLATE_MAX_LEN]; // Set in the settings file only
+    FlipperWedgeTemplate output_template; // Compiled from output_template_text on load
     bool restart_pending;  // True if output mode changed and restart is required
 
     // Output mode switching (async to avoid UI thread blocking on bt_profile_start)
@@ -170,6 +181,15 @@ typedef enum {
  * @param new_mode New output mode to switch to
  */
 void flipper_wedge_switch_output_mode(FlipperWedge* app, FlipperWedgeOutput new_mode);
+const char* flipper_wedge_output_name(FlipperWedgeOutput mode);
+bool flipper_wedge_output_uses_ble(FlipperWedgeOutput mode);
+
+/** Get the character limit of an NDEF max length setting
+ *
+ * @param max_len NDEF max length setting
+ * @return Maximum characters of NDEF text to type
+ */
+size_t flipper_wedge_ndef_max_chars(FlipperWedgeNdefMaxLen max_len);
 
 /** Get HID instance from worker
  * Helper macro to access HID interface managed by worker thread
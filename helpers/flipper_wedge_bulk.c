@@ -0,0 +1,84 @@
+#include "flipper_wedge_bulk.h"
+
+#include <string.h>
+
+#define BULK_MAGIC_0 'F'
+#define BULK_MAGIC_1 'W'
+#define BULK_REQUEST 'R'
+#define BULK_FIRST_REPORT 0x80
+#define BULK_SEQUENCE_MASK 0x7F
+
+static void flipper_wedge_bulk_put_u16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+uint16_t flipper_wedge_bulk_crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t flipper_wedge_bulk_encode(
+    uint8_t type,
+    const FlipperWedgeBulkField* fields,
+    size_t count,
+    uint8_t* out,
+    size_t size) {
+    if(!out || size < FLIPPER_WEDGE_BULK_HEADER_SIZE) return 0;
+
+    size_t len = FLIPPER_WEDGE_BULK_HEADER_SIZE;
+    for(size_t i = 0; i < count; i++) {
+        if(!fields[i].data || fields[i].len == 0) continue;
+        if(len + FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE >= size) break;
+
+        size_t value_len = fields[i].len;
+        if(value_len > size - len - FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE) {
+            value_len = size - len - FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE;
+        }
+        if(value_len > UINT16_MAX) value_len = UINT16_MAX;
+
+        out[len] = fields[i].type;
+        flipper_wedge_bulk_put_u16(&out[len + 1], value_len);
+        memcpy(&out[len + FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE], fields[i].data, value_len);
+        len += FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE + value_len;
+    }
+
+    size_t body_len = len - FLIPPER_WEDGE_BULK_HEADER_SIZE;
+    out[0] = BULK_MAGIC_0;
+    out[1] = BULK_MAGIC_1;
+    out[2] = FLIPPER_WEDGE_BULK_VERSION;
+    out[3] = type;
+    flipper_wedge_bulk_put_u16(&out[4], body_len);
+    flipper_wedge_bulk_put_u16(
+        &out[6], flipper_wedge_bulk_crc16(&out[FLIPPER_WEDGE_BULK_HEADER_SIZE], body_len));
+
+    return len;
+}
+
+bool flipper_wedge_bulk_next_report(const uint8_t* message, size_t len, size_t* offset, uint8_t* report) {
+    if(!message || !offset || !report || *offset >= len) return false;
+
+    size_t chunk = len - *offset;
+    if(chunk > FLIPPER_WEDGE_BULK_REPORT_PAYLOAD) chunk = FLIPPER_WEDGE_BULK_REPORT_PAYLOAD;
+
+    // Sequence is derived from the offset, so the reader can spot lost reports
+    size_t index = *offset / FLIPPER_WEDGE_BULK_REPORT_PAYLOAD;
+    memset(report, 0, FLIPPER_WEDGE_BULK_REPORT_SIZE);
+    report[0] = (index & BULK_SEQUENCE_MASK) | (index == 0 ? BULK_FIRST_REPORT : 0);
+    report[1] = chunk;
+    memcpy(&report[2], &message[*offset], chunk);
+
+    *offset += chunk;
+    return true;
+}
+
+bool flipper_wedge_bulk_is_request(const uint8_t* report, size_t len) {
+    return report && len >= 4 && report[0] == BULK_MAGIC_0 && report[1] == BULK_MAGIC_1 &&
+           report[2] == BULK_REQUEST && report[3] == FLIPPER_WEDGE_BULK_VERSION;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/** Bulk scan message codec
+ *
+ * In USB Bulk output mode a scan is delivered as one binary message split
+ * over 64-byte HID reports instead of being typed. The host pulls: it sends
+ * a request report, the device answers with the next queued message (or an
+ * empty one), so the device only ever writes while a reader is listening.
+ *
+ * Report layout (64 bytes):
+ *   [0]     bit7 = first report of a message, bits0-6 = sequence number
+ *   [1]     payload bytes in this report (0..62)
+ *   [2..63] payload, zero padded
+ *
+ * Message = 8-byte header + fields:
+ *   'F' 'W' version type body_len(u16 LE) crc16(u16 LE, CCITT over body)
+ *   field: type(u8) len(u16 LE) value
+ *
+ * Request report: 'F' 'W' 'R' version, rest ignored.
+ *
+ * No furi dependencies so the codec builds and runs on a host as well,
+ * tools/flipper_wedge_bulk_reader.py is the reference reader.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLIPPER_WEDGE_BULK_REPORT_SIZE 64
+#define FLIPPER_WEDGE_BULK_REPORT_PAYLOAD (FLIPPER_WEDGE_BULK_REPORT_SIZE - 2)
+#define FLIPPER_WEDGE_BULK_HEADER_SIZE 8
+#define FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE 3
+#define FLIPPER_WEDGE_BULK_VERSION 1
+
+typedef enum {
+    FlipperWedgeBulkMessageEmpty = 0, // Reply to a request when nothing is queued
+    FlipperWedgeBulkMessageScan = 1,
+} FlipperWedgeBulkMessageType;
+
+typedef enum {
+    FlipperWedgeBulkFieldText = 1, // Formatted output, as it would be typed
+    FlipperWedgeBulkFieldNfcUid = 2, // Raw bytes
+    FlipperWedgeBulkFieldRfidUid = 3, // Raw bytes
+    FlipperWedgeBulkFieldRfidProtocol = 4, // Protocol name
+    FlipperWedgeBulkFieldNdefText = 5, // Sanitized NDEF text
+    FlipperWedgeBulkFieldTimestamp = 6, // u32 LE, seconds since epoch (RTC)
+} FlipperWedgeBulkFieldType;
+
+typedef struct {
+    uint8_t type;
+    const uint8_t* data;
+    size_t len;
+} FlipperWedgeBulkField;
+
+/** Encode a message into a linear buffer
+ * Fields with no data are left out, a field that doesn't fit is truncated
+ * (text fields stay valid, nothing is split mid-header).
+ *
+ * @param type FlipperWedgeBulkMessageType
+ * @param fields Fields to encode
+ * @param count Number of fields
+ * @param out Output buffer
+ * @param size Output buffer size, at least FLIPPER_WEDGE_BULK_HEADER_SIZE
+ * @return Encoded message length
+ */
+size_t flipper_wedge_bulk_encode(
+    uint8_t type,
+    const FlipperWedgeBulkField* fields,
+    size_t count,
+    uint8_t* out,
+    size_t size);
+
+/** Cut the next report from an encoded message
+ *
+ * @param message Encoded message
+ * @param len Message length
+ * @param offset Bytes already sent, advanced by this call (start at 0)
+ * @param report Output report, FLIPPER_WEDGE_BULK_REPORT_SIZE bytes
+ * @return true if a report was produced, false when the message is done
+ */
+bool flipper_wedge_bulk_next_report(const uint8_t* message, size_t len, size_t* offset, uint8_t* report);
+
+/** Check if a report received from the host is a bulk request
+ *
+ * @param report Received report
+ * @param len Received length
+ * @return true for a valid request
+ */
+bool flipper_wedge_bulk_is_request(const uint8_t* report, size_t len);
+
+/** CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ *
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @return CRC value
+ */
+uint16_t flipper_wedge_bulk_crc16(const uint8_t* data, size_t len);
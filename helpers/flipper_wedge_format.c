@@ -1,7 +1,40 @@
 #include "flipper_wedge_format.h"
-#include <stdio.h>
+#include "flipper_wedge_unicode.h"
 #include <string.h>
 
+static const char format_hex_digits[2][16] = {
+    "0123456789ABCDEF",
+    "0123456789abcdef",
+};
+
+// Write uid as hex at output, delimiter between bytes. The caller has
+// checked that format_uid_len() characters fit.
+static size_t format_uid_write(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    const char* delimiter,
+    size_t delim_len,
+    uint8_t flags,
+    char* output) {
+    const char* digits = format_hex_digits[(flags & FlipperWedgeFormatLowercase) ? 1 : 0];
+    const bool reverse = flags & FlipperWedgeFormatReverse;
+    char* out = output;
+    for(uint8_t i = 0; i < uid_len; i++) {
+        if(i > 0 && delim_len > 0) {
+            memcpy(out, delimiter, delim_len);
+            out += delim_len;
+        }
+        uint8_t byte = uid[reverse ? uid_len - 1 - i : i];
+        *out++ = digits[byte >> 4];
+        *out++ = digits[byte & 0x0F];
+    }
+    return out - output;
+}
+
+static size_t format_uid_len(uint8_t uid_len, size_t delim_len) {
+    return uid_len ? uid_len * 2 + (uid_len - 1) * delim_len : 0;
+}
+
 void flipper_wedge_format_uid(
     const uint8_t* uid,
     uint8_t uid_len,
@@ -16,24 +49,136 @@ void flipper_wedge_format_uid(
         return;
     }
 
-    size_t pos = 0;
     size_t delim_len = delimiter ? strlen(delimiter) : 0;
 
-    for(uint8_t i = 0; i < uid_len && pos < output_size - 3; i++) {
-        // Add delimiter before byte (except first)
-        if(i > 0 && delim_len > 0) {
-            if(pos + delim_len >= output_size - 3) break;
-            memcpy(output + pos, delimiter, delim_len);
-            pos += delim_len;
+    // Keep as many whole bytes as fit with the terminator
+    size_t space = output_size - 1;
+    uint8_t count = 0;
+    if(space >= 2) {
+        count = 1 + (space - 2) / (2 + delim_len);
+        if(count > uid_len) count = uid_len;
+    }
+
+    size_t pos = format_uid_write(uid, count, delimiter, delim_len, 0, output);
+    output[pos] = '\0';
+}
+
+size_t flipper_wedge_format_uid_hex(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    const char* delimiter,
+    uint8_t flags,
+    char* output,
+    size_t output_size) {
+    if(!uid || uid_len == 0 || !output) return 0;
+
+    size_t delim_len = delimiter ? strlen(delimiter) : 0;
+    if(format_uid_len(uid_len, delim_len) > output_size) return 0;
+    return format_uid_write(uid, uid_len, delimiter, delim_len, flags, output);
+}
+
+#define FORMAT_LIMB_BASE 1000000000UL // 10^9, nine decimal digits per limb
+#define FORMAT_LIMB_DIGITS 9
+#define FORMAT_DECIMAL_WORDS ((FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES + 3) / 4)
+#define FORMAT_DECIMAL_LIMBS 5 // 128 bits are at most 39 digits
+
+size_t flipper_wedge_format_uid_decimal(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    uint8_t flags,
+    char* output,
+    size_t output_size) {
+    if(!uid || uid_len == 0 || uid_len > FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES || !output) {
+        return 0;
+    }
+
+    // Pack into 32-bit words, most significant first. A leading partial
+    // word takes the extra high bytes.
+    uint32_t words[FORMAT_DECIMAL_WORDS] = {0};
+    const uint8_t word_count = (uid_len + 3) / 4;
+    const uint8_t skip = word_count * 4 - uid_len;
+    for(uint8_t i = 0; i < uid_len; i++) {
+        uint8_t byte = uid[(flags & FlipperWedgeFormatReverse) ? uid_len - 1 - i : i];
+        uint8_t at = skip + i;
+        words[at / 4] |= (uint32_t)byte << (8 * (3 - at % 4));
+    }
+
+    // Each pass divides the whole number by 10^9 and yields one limb, so an
+    // 80-bit UID takes three passes over three words instead of a division
+    // per byte for every digit
+    uint32_t limbs[FORMAT_DECIMAL_LIMBS];
+    uint8_t limb_count = 0;
+    uint8_t start = 0;
+    while(start < word_count && words[start] == 0) start++;
+    do {
+        uint64_t remainder = 0;
+        for(uint8_t i = start; i < word_count; i++) {
+            uint64_t value = (remainder << 32) | words[i];
+            words[i] = value / FORMAT_LIMB_BASE;
+            remainder = value % FORMAT_LIMB_BASE;
         }
+        limbs[limb_count++] = remainder;
+        while(start < word_count && words[start] == 0) start++;
+    } while(start < word_count);
+
+    // Top limb without leading zeros, the others always nine digits
+    char top[FORMAT_LIMB_DIGITS];
+    uint8_t top_len = 0;
+    uint32_t value = limbs[limb_count - 1];
+    do {
+        top[top_len++] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+
+    size_t len = top_len + (limb_count - 1) * FORMAT_LIMB_DIGITS;
+    if(len > output_size) return 0;
 
-        // Add hex byte (uppercase)
-        if(pos + 2 >= output_size) break;
-        snprintf(output + pos, output_size - pos, "%02X", uid[i]);
-        pos += 2;
+    char* out = output;
+    while(top_len) *out++ = top[--top_len];
+    for(int8_t i = limb_count - 2; i >= 0; i--) {
+        value = limbs[i];
+        for(int8_t digit = FORMAT_LIMB_DIGITS - 1; digit >= 0; digit--) {
+            out[digit] = '0' + value % 10;
+            value /= 10;
+        }
+        out += FORMAT_LIMB_DIGITS;
     }
+    return len;
+}
 
-    output[pos] = '\0';
+// Append a whole UID, or nothing if it doesn't fit
+static size_t format_append_uid(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    const char* delimiter,
+    size_t delim_len,
+    char* output,
+    size_t output_size,
+    size_t pos) {
+    if(!uid || uid_len == 0) return pos;
+
+    if(pos + format_uid_len(uid_len, delim_len) < output_size) {
+        pos += format_uid_write(uid, uid_len, delimiter, delim_len, 0, output + pos);
+    }
+    return pos;
+}
+
+// Append NDEF text directly after the NFC UID (no delimiter)
+static size_t format_append_ndef(
+    const uint8_t* nfc_uid,
+    uint8_t nfc_uid_len,
+    const char* ndef_text,
+    char* output,
+    size_t output_size,
+    size_t pos) {
+    if(!nfc_uid || nfc_uid_len == 0 || !ndef_text || ndef_text[0] == '\0') return pos;
+
+    size_t ndef_len = strlen(ndef_text);
+    if(pos + ndef_len < output_size) {
+        memcpy(output + pos, ndef_text, ndef_len);
+        pos += ndef_len;
+    }
+    return pos;
 }
 
 void flipper_wedge_format_output(
@@ -51,79 +196,40 @@ void flipper_wedge_format_output(
         return;
     }
 
-    output[0] = '\0';
+    // UIDs are encoded straight into output, no intermediate buffer
+    size_t delim_len = delimiter ? strlen(delimiter) : 0;
     size_t pos = 0;
 
-    char uid_buf[64];
-
     if(nfc_first) {
-        // NFC UID first
-        if(nfc_uid && nfc_uid_len > 0) {
-            flipper_wedge_format_uid(nfc_uid, nfc_uid_len, delimiter, uid_buf, sizeof(uid_buf));
-            size_t len = strlen(uid_buf);
-            if(pos + len < output_size) {
-                memcpy(output + pos, uid_buf, len);
-                pos += len;
-            }
-
-            // Append NDEF text directly after NFC UID (no delimiter)
-            if(ndef_text && ndef_text[0] != '\0') {
-                size_t ndef_len = strlen(ndef_text);
-                if(pos + ndef_len < output_size) {
-                    memcpy(output + pos, ndef_text, ndef_len);
-                    pos += ndef_len;
-                }
-            }
-        }
-
-        // Then RFID UID
-        if(rfid_uid && rfid_uid_len > 0) {
-            flipper_wedge_format_uid(rfid_uid, rfid_uid_len, delimiter, uid_buf, sizeof(uid_buf));
-            size_t len = strlen(uid_buf);
-            if(pos + len < output_size) {
-                memcpy(output + pos, uid_buf, len);
-                pos += len;
-            }
-        }
+        // NFC UID first, then RFID UID
+        pos = format_append_uid(nfc_uid, nfc_uid_len, delimiter, delim_len, output, output_size, pos);
+        pos = format_append_ndef(nfc_uid, nfc_uid_len, ndef_text, output, output_size, pos);
+        pos = format_append_uid(rfid_uid, rfid_uid_len, delimiter, delim_len, output, output_size, pos);
     } else {
-        // RFID UID first
-        if(rfid_uid && rfid_uid_len > 0) {
-            flipper_wedge_format_uid(rfid_uid, rfid_uid_len, delimiter, uid_buf, sizeof(uid_buf));
-            size_t len = strlen(uid_buf);
-            if(pos + len < output_size) {
-                memcpy(output + pos, uid_buf, len);
-                pos += len;
-            }
-        }
-
-        // Then NFC UID
-        if(nfc_uid && nfc_uid_len > 0) {
-            flipper_wedge_format_uid(nfc_uid, nfc_uid_len, delimiter, uid_buf, sizeof(uid_buf));
-            size_t len = strlen(uid_buf);
-            if(pos + len < output_size) {
-                memcpy(output + pos, uid_buf, len);
-                pos += len;
-            }
-
-            // Append NDEF text directly after NFC UID (no delimiter)
-            if(ndef_text && ndef_text[0] != '\0') {
-                size_t ndef_len = strlen(ndef_text);
-                if(pos + ndef_len < output_size) {
-                    memcpy(output + pos, ndef_text, ndef_len);
-                    pos += ndef_len;
-                }
-            }
-        }
+        // RFID UID first, then NFC UID
+        pos = format_append_uid(rfid_uid, rfid_uid_len, delimiter, delim_len, output, output_size, pos);
+        pos = format_append_uid(nfc_uid, nfc_uid_len, delimiter, delim_len, output, output_size, pos);
+        pos = format_append_ndef(nfc_uid, nfc_uid_len, ndef_text, output, output_size, pos);
     }
 
     output[pos] = '\0';
 }
 
+// Allow printable ASCII: space (0x20) through tilde (0x7E)
+// Also allow tab (0x09) and newline (0x0A) which HID can handle
+// Above ASCII skip the C1 controls, malformed bytes decode as 0
+static bool format_is_printable(uint32_t codepoint) {
+    return (codepoint >= 0x20 && codepoint <= 0x7E) || codepoint == '\t' || codepoint == '\n' ||
+           codepoint >= 0xA0;
+}
+
 size_t flipper_wedge_sanitize_text(
     const char* input,
     char* output,
     size_t output_size,
-    size_t max_len) {
+    size_t max_len,
+    bool* truncated) {
+    if(truncated) *truncated = false;
 
     if(!input || !output || output_size == 0) {
         if(output && output_size > 0) {
@@ -134,27 +240,35 @@ size_t flipper_wedge_sanitize_text(
 
     size_t out_pos = 0;
     size_t in_pos = 0;
+    size_t chars = 0;
+    size_t input_len = strlen(input);
     size_t effective_max = (max_len == 0) ? output_size - 1 : max_len;
 
-    // Ensure we don't exceed output buffer
-    if(effective_max >= output_size) {
-        effective_max = output_size - 1;
-    }
-
-    // Copy only printable ASCII characters (0x20-0x7E)
-    while(input[in_pos] != '\0' && out_pos < effective_max) {
-        char c = input[in_pos];
+    // Copy printable characters, UTF-8 sequences stay whole
+    while(in_pos < input_len && chars < effective_max) {
+        uint32_t codepoint;
+        size_t bytes = flipper_wedge_unicode_decode_utf8(input + in_pos, input_len - in_pos, &codepoint);
+        if(bytes == 0) break; // Cut off at the end
 
-        // Allow printable ASCII: space (0x20) through tilde (0x7E)
-        // Also allow tab (0x09) and newline (0x0A) which HID can handle
-        if((c >= 0x20 && c <= 0x7E) || c == '\t' || c == '\n') {
-            output[out_pos++] = c;
+        if(format_is_printable(codepoint)) {
+            if(out_pos + bytes >= output_size) break;
+            memcpy(output + out_pos, input + in_pos, bytes);
+            out_pos += bytes;
+            chars++;
         }
-        // Skip non-printable characters (including control chars and extended ASCII)
 
-        in_pos++;
+        in_pos += bytes;
+    }
+
+    // Stopped at a limit: anything printable left was cut
+    while(truncated && !*truncated && in_pos < input_len) {
+        uint32_t codepoint;
+        size_t bytes = flipper_wedge_unicode_decode_utf8(input + in_pos, input_len - in_pos, &codepoint);
+        if(bytes == 0) break;
+        *truncated = format_is_printable(codepoint);
+        in_pos += bytes;
     }
 
     output[out_pos] = '\0';
-    return out_pos;
+    return chars;
 }
@@ -3,6 +3,13 @@
 #include <furi.h>
 
 #define FLIPPER_WEDGE_FORMAT_MAX_LEN 128
+#define FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES 16 // Longest UID rendered as one number
+
+// Options for flipper_wedge_format_uid_hex() and _decimal()
+typedef enum {
+    FlipperWedgeFormatReverse = (1 << 0), // Last byte first
+    FlipperWedgeFormatLowercase = (1 << 1), // Hex digits a-f instead of A-F
+} FlipperWedgeFormatFlags;
 
 /** Format UID bytes to hex string with delimiter
  *
@@ -19,6 +26,43 @@ void flipper_wedge_format_uid(
     char* output,
     size_t output_size);
 
+/** Write UID bytes as hex, whole or not at all
+ * No terminator is written.
+ *
+ * @param uid UID bytes
+ * @param uid_len Length of UID
+ * @param delimiter Delimiter string between bytes (can be NULL or empty)
+ * @param flags FlipperWedgeFormatFlags
+ * @param output Output buffer
+ * @param output_size Space left in output
+ * @return Characters written, 0 if the UID doesn't fit
+ */
+size_t flipper_wedge_format_uid_hex(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    const char* delimiter,
+    uint8_t flags,
+    char* output,
+    size_t output_size);
+
+/** Write UID bytes as one unsigned decimal number, whole or not at all
+ * The first byte is the most significant unless FlipperWedgeFormatReverse
+ * is set. No terminator is written.
+ *
+ * @param uid UID bytes
+ * @param uid_len Length of UID, up to FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES
+ * @param flags FlipperWedgeFormatFlags
+ * @param output Output buffer
+ * @param output_size Space left in output
+ * @return Characters written, 0 if the number doesn't fit
+ */
+size_t flipper_wedge_format_uid_decimal(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    uint8_t flags,
+    char* output,
+    size_t output_size);
+
 /** Format complete output string for HID typing
  *
  * @param nfc_uid NFC UID bytes (can be NULL)
@@ -43,16 +87,20 @@ void flipper_wedge_format_output(
     size_t output_size);
 
 /** Sanitize text for HID keyboard typing
- * Removes non-printable characters and truncates to max length
+ * Removes non-printable characters and malformed UTF-8 and truncates to max
+ * length. Characters above ASCII are kept as UTF-8.
  *
  * @param input Input text (may contain binary data)
  * @param output Output buffer for sanitized text
  * @param output_size Size of output buffer
  * @param max_len Maximum characters to keep (0 = no limit)
- * @return Number of characters in sanitized output
+ * @param truncated Set to true if printable text was left out for max_len or
+ *                  output_size (may be NULL)
+ * @return Number of characters (not bytes) in sanitized output
  */
 size_t flipper_wedge_sanitize_text(
     const char* input,
     char* output,
     size_t output_size,
-    size_t max_len);
+    size_t max_len,
+    bool* truncated);
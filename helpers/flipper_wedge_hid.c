@@ -1,11 +1,22 @@
 #include "flipper_wedge_hid.h"
 #include "flipper_wedge_keyboard_layout.h"
+#include "flipper_wedge_hid_report.h"
+#include "flipper_wedge_keystream.h"
+#include "flipper_wedge_bulk.h"
+#include "flipper_wedge_hid_pacer.h"
+#include "flipper_wedge_hid_pacing.h"
 #include "flipper_wedge_debug.h"
 #include <storage/storage.h>
+#include <ble/ble.h>
+#include <furi_ble/event_dispatcher.h>
 
 #define TAG "FlipperWedgeHid"
 
-#define HID_TYPE_DELAY_MS 2
+// Reports a session needs before its pace is worth remembering
+#define HID_PACING_MIN_REPORTS 64
+
+// Longest wait for the bulk reader to take a report
+#define FLIPPER_WEDGE_HID_BULK_SEND_TIMEOUT_MS 100
 
 // MAC address XOR to make Flipper appear as different device in HID mode
 #define HID_BT_MAC_XOR 0xF1D0  // "FliD" in hex - unique identifier
@@ -14,12 +25,27 @@ struct FlipperWedgeHid {
     // USB HID
     FuriHalUsbInterface* usb_mode_prev;  // Save previous USB mode for restoration
     bool usb_initialized;
+    bool usb_bulk_initialized;  // Raw 64-byte report interface instead of keyboard
+    FlipperWedgeHidBulkRequestCallback bulk_request_callback;
+    void* bulk_request_context;
 
     // Bluetooth HID
     Bt* bt;
     FuriHalBleProfileBase* ble_hid_profile;
     bool bt_initialized;
     bool bt_connected;
+    GapSvcEventHandler* ble_event_handler;
+    // Peer of the current connection, written from the BLE event thread
+    uint8_t ble_peer_address[6];
+    uint8_t ble_peer_address_type;
+    volatile bool ble_peer_valid;
+
+    // Typing pace, learned per transport
+    FlipperWedgeHidPacer pacer[FlipperWedgeHidTransportCount];
+    // Host the pacer was restored for, kept until the connection changes
+    char pacing_host[FlipperWedgeHidTransportCount][FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    bool pacing_restored[FlipperWedgeHidTransportCount];
+    uint32_t pacing_saved_delay_us[FlipperWedgeHidTransportCount];
 
     // Callback
     FlipperWedgeHidConnectionCallback connection_callback;
@@ -33,6 +59,13 @@ static void flipper_wedge_hid_bt_status_callback(BtStatus status, void* context)
     bool connected = (status == BtStatusConnected);
     bool prev_connected = instance->bt_connected;
     instance->bt_connected = connected;
+    if(connected != prev_connected) {
+        // May be a different bonded host, look the profile up again
+        instance->pacing_restored[FlipperWedgeHidTransportBle] = false;
+    }
+    if(!connected) {
+        instance->ble_peer_valid = false;
+    }
 
     FURI_LOG_I(TAG, "BT status: %d (prev=%d, new=%d)", status, prev_connected, connected);
 
@@ -42,17 +75,85 @@ static void flipper_wedge_hid_bt_status_callback(BtStatus status, void* context)
     }
 }
 
+// Takes the peer address from the LE connection event, the BT service
+// doesn't pass it on
+static BleEventAckStatus flipper_wedge_hid_ble_event_callback(void* event, void* context) {
+    furi_assert(context);
+    FlipperWedgeHid* instance = context;
+
+    hci_event_pckt* event_pckt = (hci_event_pckt*)(((hci_uart_pckt*)event)->data);
+    if(event_pckt->evt != HCI_LE_META_EVT_CODE) return BleEventNotAck;
+
+    evt_le_meta_event* meta_event = (evt_le_meta_event*)event_pckt->data;
+    uint8_t status;
+    uint8_t address_type;
+    const uint8_t* address;
+    if(meta_event->subevent == HCI_LE_CONNECTION_COMPLETE_SUBEVT_CODE) {
+        hci_le_connection_complete_event_rp0* connection = (void*)meta_event->data;
+        status = connection->Status;
+        address_type = connection->Peer_Address_Type;
+        address = connection->Peer_Address;
+    } else if(meta_event->subevent == HCI_LE_ENHANCED_CONNECTION_COMPLETE_SUBEVT_CODE) {
+        hci_le_enhanced_connection_complete_event_rp0* connection = (void*)meta_event->data;
+        status = connection->Status;
+        address_type = connection->Peer_Address_Type;
+        address = connection->Peer_Address;
+    } else {
+        return BleEventNotAck;
+    }
+
+    if(status == BLE_STATUS_SUCCESS) {
+        instance->ble_peer_valid = false;
+        memcpy(instance->ble_peer_address, address, sizeof(instance->ble_peer_address));
+        instance->ble_peer_address_type = address_type;
+        instance->ble_peer_valid = true;
+    }
+
+    // Leave the event to the GAP
+    return BleEventNotAck;
+}
+
+// Pacing key of the connected BLE host: its identity address, resolved from
+// a private address through the bond database
+static bool flipper_wedge_hid_ble_host_id(FlipperWedgeHid* instance, char* host_id) {
+    if(!instance->ble_peer_valid) return false;
+
+    uint8_t address[sizeof(instance->ble_peer_address)];
+    memcpy(address, instance->ble_peer_address, sizeof(address));
+    if(flipper_wedge_hid_pacing_is_private_address(instance->ble_peer_address_type, address)) {
+        uint8_t identity[sizeof(address)];
+        // Fails until the host is bonded
+        if(aci_gap_resolve_private_addr(address, identity) != BLE_STATUS_SUCCESS) return false;
+        memcpy(address, identity, sizeof(address));
+    }
+
+    flipper_wedge_hid_pacing_ble_host_id(address, host_id);
+    return true;
+}
+
 FlipperWedgeHid* flipper_wedge_hid_alloc(void) {
     FlipperWedgeHid* instance = malloc(sizeof(FlipperWedgeHid));
 
     instance->usb_mode_prev = NULL;
     instance->usb_initialized = false;
+    instance->usb_bulk_initialized = false;
+    instance->bulk_request_callback = NULL;
+    instance->bulk_request_context = NULL;
     instance->bt = NULL;
     instance->ble_hid_profile = NULL;
     instance->bt_initialized = false;
     instance->bt_connected = false;
+    instance->ble_event_handler = NULL;
+    instance->ble_peer_valid = false;
     instance->connection_callback = NULL;
     instance->connection_callback_context = NULL;
+    memset(instance->pacing_host, 0, sizeof(instance->pacing_host));
+    memset(instance->pacing_restored, 0, sizeof(instance->pacing_restored));
+    memset(instance->pacing_saved_delay_us, 0, sizeof(instance->pacing_saved_delay_us));
+    flipper_wedge_hid_pacer_init(
+        &instance->pacer[FlipperWedgeHidTransportUsb], FlipperWedgeHidPacerProfileUsb);
+    flipper_wedge_hid_pacer_init(
+        &instance->pacer[FlipperWedgeHidTransportBle], FlipperWedgeHidPacerProfileBle);
 
     return instance;
 }
@@ -64,6 +165,9 @@ void flipper_wedge_hid_free(FlipperWedgeHid* instance) {
     if(instance->usb_initialized) {
         flipper_wedge_hid_deinit_usb(instance);
     }
+    if(instance->usb_bulk_initialized) {
+        flipper_wedge_hid_deinit_usb_bulk(instance);
+    }
     if(instance->bt_initialized) {
         flipper_wedge_hid_deinit_ble(instance);
     }
@@ -86,6 +190,9 @@ void flipper_wedge_hid_init_usb(FlipperWedgeHid* instance) {
     instance->usb_mode_prev = furi_hal_usb_get_config();
     furi_hal_usb_unlock();
     furi_check(furi_hal_usb_set_config(&usb_hid, NULL) == true);
+    flipper_wedge_hid_pacer_init(
+        &instance->pacer[FlipperWedgeHidTransportUsb], FlipperWedgeHidPacerProfileUsb);
+    instance->pacing_restored[FlipperWedgeHidTransportUsb] = false;
     instance->usb_initialized = true;
 
     FURI_LOG_I(TAG, "USB HID initialized");
@@ -108,6 +215,7 @@ void flipper_wedge_hid_deinit_usb(FlipperWedgeHid* instance) {
 
     FURI_LOG_I(TAG, "Deinitializing USB HID");
     flipper_wedge_debug_log(TAG, "Deinit USB HID");
+    flipper_wedge_hid_store_pacing(instance, FlipperWedgeHidTransportUsb);
 
     // Restore previous USB mode (like Bad USB)
     if(instance->usb_mode_prev) {
@@ -124,6 +232,108 @@ void flipper_wedge_hid_deinit_usb(FlipperWedgeHid* instance) {
     }
 }
 
+// Runs in USB interrupt context, only forward the request
+static void flipper_wedge_hid_usb_bulk_callback(void* context) {
+    FlipperWedgeHid* instance = context;
+    if(instance->bulk_request_callback) {
+        instance->bulk_request_callback(instance->bulk_request_context);
+    }
+}
+
+void flipper_wedge_hid_init_usb_bulk(FlipperWedgeHid* instance) {
+    furi_assert(instance);
+
+    if(instance->usb_bulk_initialized) {
+        FURI_LOG_W(TAG, "USB bulk already initialized");
+        return;
+    }
+
+    FURI_LOG_I(TAG, "Initializing USB bulk");
+    flipper_wedge_debug_log(TAG, "Init USB bulk");
+
+    // Keyboard plus a vendor-page interface for the reports, see flipper_wedge_usb_bulk.h
+    instance->usb_mode_prev = furi_hal_usb_get_config();
+    furi_hal_usb_unlock();
+    flipper_wedge_usb_bulk_set_request_callback(flipper_wedge_hid_usb_bulk_callback, instance);
+    furi_check(furi_hal_usb_set_config(&usb_flipper_wedge_bulk, NULL) == true);
+    instance->usb_bulk_initialized = true;
+
+    FURI_LOG_I(TAG, "USB bulk initialized");
+
+    // Notify connection callback
+    if(instance->connection_callback) {
+        bool usb_connected = flipper_wedge_hid_is_usb_connected(instance);
+        bool bt_connected = flipper_wedge_hid_is_bt_connected(instance);
+        instance->connection_callback(usb_connected, bt_connected, instance->connection_callback_context);
+    }
+}
+
+void flipper_wedge_hid_deinit_usb_bulk(FlipperWedgeHid* instance) {
+    furi_assert(instance);
+
+    if(!instance->usb_bulk_initialized) {
+        FURI_LOG_W(TAG, "USB bulk not initialized");
+        return;
+    }
+
+    FURI_LOG_I(TAG, "Deinitializing USB bulk");
+    flipper_wedge_debug_log(TAG, "Deinit USB bulk");
+
+    flipper_wedge_usb_bulk_set_request_callback(NULL, NULL);
+    if(instance->usb_mode_prev) {
+        // Only once the interface is deinitialized, a send may still hold it before
+        if(furi_hal_usb_set_config(instance->usb_mode_prev, NULL)) {
+            flipper_wedge_usb_bulk_free();
+        }
+    }
+    instance->usb_bulk_initialized = false;
+
+    FURI_LOG_I(TAG, "USB bulk deinitialized");
+
+    // Notify connection callback
+    if(instance->connection_callback) {
+        bool bt_connected = flipper_wedge_hid_is_bt_connected(instance);
+        instance->connection_callback(false, bt_connected, instance->connection_callback_context);
+    }
+}
+
+void flipper_wedge_hid_set_bulk_request_callback(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidBulkRequestCallback callback,
+    void* context) {
+    furi_assert(instance);
+    instance->bulk_request_callback = callback;
+    instance->bulk_request_context = context;
+}
+
+bool flipper_wedge_hid_read_bulk_request(FlipperWedgeHid* instance) {
+    furi_assert(instance);
+    if(!instance->usb_bulk_initialized) return false;
+
+    uint8_t request[FLIPPER_WEDGE_USB_BULK_PACKET_LEN];
+    size_t len = flipper_wedge_usb_bulk_get_request(request);
+    if(!flipper_wedge_bulk_is_request(request, len)) {
+        FURI_LOG_D(TAG, "Ignoring non-bulk request (%zu bytes)", len);
+        return false;
+    }
+    return true;
+}
+
+bool flipper_wedge_hid_send_bulk(FlipperWedgeHid* instance, const uint8_t* message, size_t len) {
+    furi_assert(instance);
+    furi_assert(message);
+
+    if(!flipper_wedge_hid_is_usb_connected(instance) || !instance->usb_bulk_initialized) return false;
+
+    uint8_t report[FLIPPER_WEDGE_BULK_REPORT_SIZE];
+    size_t offset = 0;
+    while(flipper_wedge_bulk_next_report(message, len, &offset, report)) {
+        // A reader that stops mid-message gets the whole message again on its next request
+        if(!flipper_wedge_usb_bulk_send(report, FLIPPER_WEDGE_HID_BULK_SEND_TIMEOUT_MS)) return false;
+    }
+    return true;
+}
+
 void flipper_wedge_hid_init_ble(FlipperWedgeHid* instance) {
     furi_assert(instance);
 
@@ -176,6 +386,11 @@ void flipper_wedge_hid_init_ble(FlipperWedgeHid* instance) {
         return;  // Fail gracefully instead of crashing
     }
 
+    // Before advertising, so the first connection event is seen
+    instance->ble_peer_valid = false;
+    instance->ble_event_handler =
+        ble_event_dispatcher_register_svc_handler(flipper_wedge_hid_ble_event_callback, instance);
+
     // Start advertising
     flipper_wedge_debug_log(TAG, "Starting BT advertising");
     furi_hal_bt_start_advertising();
@@ -184,6 +399,9 @@ void flipper_wedge_hid_init_ble(FlipperWedgeHid* instance) {
     flipper_wedge_debug_log(TAG, "Registering BT status callback");
     bt_set_status_changed_callback(instance->bt, flipper_wedge_hid_bt_status_callback, instance);
 
+    flipper_wedge_hid_pacer_init(
+        &instance->pacer[FlipperWedgeHidTransportBle], FlipperWedgeHidPacerProfileBle);
+    instance->pacing_restored[FlipperWedgeHidTransportBle] = false;
     instance->bt_initialized = true;
 
     FURI_LOG_I(TAG, "BLE HID initialized and advertising");
@@ -200,8 +418,12 @@ void flipper_wedge_hid_deinit_ble(FlipperWedgeHid* instance) {
 
     FURI_LOG_I(TAG, "Deinitializing BLE HID");
     flipper_wedge_debug_log(TAG, "Deinit BLE HID");
+    flipper_wedge_hid_store_pacing(instance, FlipperWedgeHidTransportBle);
 
     bt_set_status_changed_callback(instance->bt, NULL, NULL);
+    ble_event_dispatcher_unregister_svc_handler(instance->ble_event_handler);
+    instance->ble_event_handler = NULL;
+    instance->ble_peer_valid = false;
     bt_disconnect(instance->bt);
     furi_delay_ms(200);  // CRITICAL delay for NVM sync
     bt_keys_storage_set_default_path(instance->bt);
@@ -241,6 +463,7 @@ void flipper_wedge_hid_set_connection_callback(
 
 bool flipper_wedge_hid_is_usb_connected(FlipperWedgeHid* instance) {
     furi_assert(instance);
+    if(instance->usb_bulk_initialized) return flipper_wedge_usb_bulk_is_connected();
     if(!instance->usb_initialized) return false;
     return furi_hal_hid_is_connected();
 }
@@ -255,70 +478,375 @@ bool flipper_wedge_hid_is_connected(FlipperWedgeHid* instance) {
     return flipper_wedge_hid_is_usb_connected(instance) || flipper_wedge_hid_is_bt_connected(instance);
 }
 
-void flipper_wedge_hid_type_char(FlipperWedgeHid* instance, FlipperWedgeKeyboardLayout* layout, char c) {
+bool flipper_wedge_hid_is_transport_ready(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport) {
     furi_assert(instance);
+    if(transport == FlipperWedgeHidTransportUsb) {
+        return instance->usb_initialized && flipper_wedge_hid_is_usb_connected(instance);
+    }
+    return instance->bt_initialized && flipper_wedge_hid_is_bt_connected(instance) &&
+           instance->ble_hid_profile;
+}
 
-    uint16_t keycode;
-    if(layout) {
-        keycode = flipper_wedge_keyboard_layout_get_keycode(layout, c);
-    } else {
-        keycode = HID_ASCII_TO_KEY(c);
+static bool flipper_wedge_hid_transport_press(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    uint16_t keycode) {
+    if(transport == FlipperWedgeHidTransportUsb) {
+        return furi_hal_hid_kb_press(keycode);
+    }
+    return ble_profile_hid_kb_press(instance->ble_hid_profile, keycode);
+}
+
+static bool flipper_wedge_hid_transport_release(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    uint16_t keycode) {
+    if(transport == FlipperWedgeHidTransportUsb) {
+        return furi_hal_hid_kb_release(keycode);
     }
-    if(keycode == HID_KEYBOARD_NONE) return;
+    return ble_profile_hid_kb_release(instance->ble_hid_profile, keycode);
+}
 
-    // Send to USB HID if initialized
-    if(instance->usb_initialized && flipper_wedge_hid_is_usb_connected(instance)) {
-        furi_hal_hid_kb_press(keycode);
-        furi_hal_hid_kb_release(keycode);
+static bool flipper_wedge_hid_transport_release_all(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport) {
+    if(transport == FlipperWedgeHidTransportUsb) {
+        return furi_hal_hid_kb_release_all();
     }
+    return ble_profile_hid_kb_release_all(instance->ble_hid_profile);
+}
 
-    // Send to BT HID if initialized
-    if(instance->bt_initialized && flipper_wedge_hid_is_bt_connected(instance) && instance->ble_hid_profile) {
-        ble_profile_hid_kb_press(instance->ble_hid_profile, keycode);
-        ble_profile_hid_kb_release(instance->ble_hid_profile, keycode);
+// End of a report: everything up at once, or only the keys if the next
+// report continues an Alt code
+static bool flipper_wedge_hid_transport_release_report(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    const FlipperWedgeHidReport* report) {
+    if(!report->hold_modifiers) {
+        return flipper_wedge_hid_transport_release_all(instance, transport);
     }
 
-    furi_delay_ms(HID_TYPE_DELAY_MS);
+    bool released = true;
+    for(uint8_t i = 0; i < report->key_count; i++) {
+        released &= flipper_wedge_hid_transport_release(instance, transport, report->keys[i]);
+    }
+    return released;
 }
 
-void flipper_wedge_hid_type_string(FlipperWedgeHid* instance, FlipperWedgeKeyboardLayout* layout, const char* str) {
-    furi_assert(instance);
-    furi_assert(str);
+// Press packed keys one by one, then release them with a single report.
+// Every submission is fed back to the transport pacer, and how long the
+// first one waited for the host.
+static void flipper_wedge_hid_send_report_on(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    const FlipperWedgeHidReport* report) {
+    FlipperWedgeHidPacer* pacer = &instance->pacer[transport];
+    uint8_t max_retries = flipper_wedge_hid_pacer_get_max_retries(pacer);
+    flipper_wedge_hid_pacer_begin_burst(pacer);
+
+    for(uint8_t i = 0; i < report->key_count; i++) {
+        uint16_t keycode = flipper_wedge_hid_report_get_keycode(report, i);
+        uint32_t start = flipper_wedge_hid_pacer_timer_start();
+        bool accepted = flipper_wedge_hid_transport_press(instance, transport, keycode);
+        // Later presses of the report always wait for the one before, only
+        // the first tells if the delay kept up with the host
+        if(i == 0) {
+            flipper_wedge_hid_pacer_feedback_blocked(
+                pacer, flipper_wedge_hid_pacer_timer_elapsed_us(start));
+        }
+
+        // Reports are cumulative, so a refused press is carried by the next one.
+        // Only the last press of the run has no successor and must be resent.
+        bool last = (i == report->key_count - 1);
+        for(uint8_t retry = 0; !accepted && last && retry < max_retries; retry++) {
+            flipper_wedge_hid_pacer_feedback(pacer, false);
+            flipper_wedge_hid_pacer_delay(flipper_wedge_hid_pacer_get_delay_us(pacer));
+            flipper_wedge_hid_pacer_begin_burst(pacer);
+            // Drop the key (keeping modifiers) and press it again to resend the report
+            flipper_wedge_hid_transport_release(instance, transport, keycode & 0xFF);
+            accepted = flipper_wedge_hid_transport_press(instance, transport, keycode);
+        }
+        flipper_wedge_hid_pacer_feedback(pacer, accepted);
+    }
 
-    while(*str) {
-        flipper_wedge_hid_type_char(instance, layout, *str);
-        str++;
+    // A lost release leaves keys held on the host (auto-repeat), always retry it
+    bool released = flipper_wedge_hid_transport_release_report(instance, transport, report);
+    for(uint8_t retry = 0; !released && retry < max_retries; retry++) {
+        flipper_wedge_hid_pacer_feedback(pacer, false);
+        flipper_wedge_hid_pacer_delay(flipper_wedge_hid_pacer_get_delay_us(pacer));
+        flipper_wedge_hid_pacer_begin_burst(pacer);
+        released = flipper_wedge_hid_transport_release_report(instance, transport, report);
     }
+    flipper_wedge_hid_pacer_feedback(pacer, released);
 }
 
-void flipper_wedge_hid_press_enter(FlipperWedgeHid* instance) {
+void flipper_wedge_hid_cursor_init(FlipperWedgeHidCursor* cursor, const uint8_t* data, size_t len) {
+    furi_assert(cursor);
+    furi_assert(data || len == 0);
+
+    cursor->data = data;
+    cursor->len = len;
+    cursor->pos = 0;
+    cursor->modifiers = 0;
+    cursor->typed = 0;
+}
+
+bool flipper_wedge_hid_cursor_is_done(const FlipperWedgeHidCursor* cursor) {
+    furi_assert(cursor);
+    return cursor->pos >= cursor->len;
+}
+
+// Pack the next run from the cursor, returns false when the stream is exhausted
+static bool flipper_wedge_hid_cursor_pack(FlipperWedgeHidCursor* cursor, FlipperWedgeHidReport* report) {
+    flipper_wedge_hid_report_reset(report);
+    bool release_point = false;
+
+    while(cursor->pos < cursor->len) {
+        uint8_t byte = cursor->data[cursor->pos];
+        if(byte == FLIPPER_WEDGE_KEYSTREAM_RELEASE) {
+            cursor->pos++;
+            if(flipper_wedge_hid_report_is_empty(report)) continue;
+            release_point = true;
+            break;
+        }
+        if(flipper_wedge_keystream_is_modifier(byte)) {
+            // Modifier state carries over, safe to consume even if the next key starts a new run
+            cursor->modifiers = flipper_wedge_keystream_get_modifiers(byte);
+            cursor->pos++;
+            continue;
+        }
+
+        uint16_t keycode = ((uint16_t)cursor->modifiers << 8) | byte;
+        // Stop when the key can't join the current run (full, modifier change or repeat)
+        if(!flipper_wedge_hid_report_add(report, keycode)) break;
+        cursor->pos++;
+    }
+
+    // Left Alt alone is an Alt code being entered, the host only takes it
+    // once Alt goes up, so keep it down while the next report continues it
+    report->hold_modifiers = !release_point && report->modifiers == (KEY_MOD_LEFT_ALT >> 8) &&
+                             cursor->modifiers == report->modifiers && cursor->pos < cursor->len &&
+                             flipper_wedge_keystream_is_key(cursor->data[cursor->pos]);
+
+    return !flipper_wedge_hid_report_is_empty(report);
+}
+
+size_t flipper_wedge_hid_type_next_report(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    FlipperWedgeHidCursor* cursor) {
     furi_assert(instance);
+    furi_assert(transport < FlipperWedgeHidTransportCount);
+    furi_assert(cursor);
+
+    FlipperWedgeHidReport report;
+    if(!flipper_wedge_hid_cursor_pack(cursor, &report)) return 0;
+
+    flipper_wedge_hid_send_report_on(instance, transport, &report);
+    cursor->typed += report.key_count;
+    return report.key_count;
+}
+
+// Characters as the keystream compiles them, a malformed byte is one
+static size_t flipper_wedge_hid_text_count_chars(const char* str, size_t len) {
+    size_t chars = 0;
+    size_t pos = 0;
+    while(pos < len) {
+        uint32_t codepoint;
+        size_t bytes = ((uint8_t)str[pos] < 0x80) ?
+                           1 :
+                           flipper_wedge_unicode_decode_utf8(str + pos, len - pos, &codepoint);
+        if(bytes == 0) break; // Cut off by len, never typed
+        pos += bytes;
+        chars++;
+    }
+    return chars;
+}
+
+void flipper_wedge_hid_text_init(
+    FlipperWedgeHidText* text,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* str,
+    size_t len,
+    bool append_enter) {
+    furi_assert(text);
+    furi_assert(str || len == 0);
+
+    text->layout = layout;
+    text->text = str;
+    text->len = str ? strnlen(str, len) : 0;
+    text->compiled = 0;
+    text->enter = append_enter;
+    flipper_wedge_keystream_init(&text->stream, text->buffer, sizeof(text->buffer));
+    flipper_wedge_hid_cursor_init(&text->cursor, text->buffer, 0);
+    text->char_first = 0;
+    text->char_count = 0;
+    text->typed = 0;
+    text->total = flipper_wedge_hid_text_count_chars(str, text->len) + (append_enter ? 1 : 0);
+}
+
+bool flipper_wedge_hid_text_is_done(const FlipperWedgeHidText* text) {
+    furi_assert(text);
+    return text->compiled == text->len && !text->enter &&
+           flipper_wedge_hid_cursor_is_done(&text->cursor);
+}
+
+static void flipper_wedge_hid_text_push_char(FlipperWedgeHidText* text) {
+    uint8_t slot = (text->char_first + text->char_count) % FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE;
+    text->char_end[slot] = text->stream.len;
+    text->char_count++;
+}
+
+// Keep at least the lookahead compiled, unless the text runs out first
+static void flipper_wedge_hid_text_refill(FlipperWedgeHidText* text) {
+    FlipperWedgeHidCursor* cursor = &text->cursor;
+    if(cursor->len - cursor->pos >= FLIPPER_WEDGE_HID_TEXT_LOOKAHEAD) return;
+    if(text->compiled == text->len && !text->enter) return;
+
+    // Drop what was typed, the characters in it were already counted
+    size_t pos = cursor->pos;
+    memmove(text->buffer, text->buffer + pos, text->stream.len - pos);
+    text->stream.len -= pos;
+    for(uint8_t i = 0; i < text->char_count; i++) {
+        text->char_end[(text->char_first + i) % FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE] -= pos;
+    }
+    cursor->pos = 0;
+
+    while(text->compiled < text->len && text->char_count < FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE &&
+          text->stream.size - text->stream.len >= FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX) {
+        size_t bytes = flipper_wedge_keystream_append_char(
+            &text->stream, text->layout, text->text + text->compiled, text->len - text->compiled);
+        if(bytes == 0) {
+            // Last character is cut off by len
+            text->compiled = text->len;
+            break;
+        }
+        text->compiled += bytes;
+        flipper_wedge_hid_text_push_char(text);
+    }
+
+    if(text->compiled == text->len && text->enter &&
+       text->char_count < FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE &&
+       flipper_wedge_keystream_append_key(&text->stream, HID_KEYBOARD_RETURN)) {
+        text->enter = false;
+        flipper_wedge_hid_text_push_char(text);
+    }
+    cursor->len = text->stream.len;
+}
 
-    uint16_t keycode = HID_KEYBOARD_RETURN;
+// Pack the next report, false if none is ready (the text may not be done)
+static bool flipper_wedge_hid_text_pack(FlipperWedgeHidText* text, FlipperWedgeHidReport* report) {
+    flipper_wedge_hid_text_refill(text);
+    return flipper_wedge_hid_cursor_pack(&text->cursor, report);
+}
 
-    // Send to USB HID if initialized
-    if(instance->usb_initialized && flipper_wedge_hid_is_usb_connected(instance)) {
-        furi_hal_hid_kb_press(keycode);
-        furi_hal_hid_kb_release(keycode);
+// Count the characters the cursor is now past the last key of
+static void flipper_wedge_hid_text_count_typed(FlipperWedgeHidText* text) {
+    while(text->char_count > 0 && text->char_end[text->char_first] <= text->cursor.pos) {
+        text->char_first = (text->char_first + 1) % FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE;
+        text->char_count--;
+        text->typed++;
     }
+}
 
-    // Send to BT HID if initialized
-    if(instance->bt_initialized && flipper_wedge_hid_is_bt_connected(instance) && instance->ble_hid_profile) {
-        ble_profile_hid_kb_press(instance->ble_hid_profile, keycode);
-        ble_profile_hid_kb_release(instance->ble_hid_profile, keycode);
+size_t flipper_wedge_hid_type_next_text_report(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    FlipperWedgeHidText* text) {
+    furi_assert(instance);
+    furi_assert(transport < FlipperWedgeHidTransportCount);
+    furi_assert(text);
+
+    FlipperWedgeHidReport report;
+    size_t keys = 0;
+    if(flipper_wedge_hid_text_pack(text, &report)) {
+        flipper_wedge_hid_send_report_on(instance, transport, &report);
+        text->cursor.typed += report.key_count;
+        keys = report.key_count;
     }
+    flipper_wedge_hid_text_count_typed(text);
+    return keys;
+}
+
+uint32_t flipper_wedge_hid_get_delay_us(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport) {
+    furi_assert(instance);
+    furi_assert(transport < FlipperWedgeHidTransportCount);
+    return flipper_wedge_hid_pacer_get_delay_us(&instance->pacer[transport]);
 }
 
-void flipper_wedge_hid_release_all(FlipperWedgeHid* instance) {
+void flipper_wedge_hid_restore_pacing(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport) {
     furi_assert(instance);
+    furi_check(transport < FlipperWedgeHidTransportCount);
+    if(instance->pacing_restored[transport]) return;
+
+    char* host_id = instance->pacing_host[transport];
+    if(transport == FlipperWedgeHidTransportUsb) {
+        flipper_wedge_hid_pacing_usb_host_id(host_id);
+    } else if(!flipper_wedge_hid_ble_host_id(instance, host_id)) {
+        // Not connected or not bonded yet, try again on the next job
+        host_id[0] = '\0';
+        return;
+    }
+    instance->pacing_restored[transport] = true;
 
-    // Release all keys on USB HID if initialized
-    if(instance->usb_initialized && flipper_wedge_hid_is_usb_connected(instance)) {
-        furi_hal_hid_kb_release_all();
+    FlipperWedgeHidPacingProfile profile;
+    if(!flipper_wedge_hid_pacing_load(host_id, &profile)) {
+        FURI_LOG_I(TAG, "No pacing profile for %s, probing", host_id);
+        instance->pacing_saved_delay_us[transport] = UINT32_MAX;
+        return;
     }
 
-    // Release all keys on BT HID if initialized
-    if(instance->bt_initialized && flipper_wedge_hid_is_bt_connected(instance) && instance->ble_hid_profile) {
-        ble_profile_hid_kb_release_all(instance->ble_hid_profile);
+    flipper_wedge_hid_pacer_seed(
+        &instance->pacer[transport], profile.delay_us, profile.drop_per_mille);
+    instance->pacing_saved_delay_us[transport] = profile.delay_us;
+    FURI_LOG_I(
+        TAG,
+        "Pacing for %s: %lu us (%lu/1000 dropped over %lu reports)",
+        host_id,
+        profile.delay_us,
+        profile.drop_per_mille,
+        profile.reports);
+}
+
+void flipper_wedge_hid_store_pacing(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport) {
+    furi_assert(instance);
+    furi_assert(transport < FlipperWedgeHidTransportCount);
+    if(!instance->pacing_restored[transport]) return;
+
+    const FlipperWedgeHidPacer* pacer = &instance->pacer[transport];
+    if(pacer->reports_sent < HID_PACING_MIN_REPORTS) return;
+
+    FlipperWedgeHidPacingProfile profile = {
+        .delay_us = flipper_wedge_hid_pacer_get_stable_delay_us(pacer),
+        .drop_per_mille = (uint32_t)((uint64_t)pacer->reports_failed * 1000 / pacer->reports_sent),
+        .reports = pacer->reports_sent,
+    };
+
+    // Skip the SD write while the pace hasn't moved
+    if(profile.delay_us == instance->pacing_saved_delay_us[transport]) return;
+
+    if(flipper_wedge_hid_pacing_save(instance->pacing_host[transport], &profile)) {
+        instance->pacing_saved_delay_us[transport] = profile.delay_us;
+        FURI_LOG_I(
+            TAG, "Saved pacing for %s: %lu us", instance->pacing_host[transport], profile.delay_us);
     }
 }
+
+void flipper_wedge_hid_get_report_stats(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    uint32_t* sent,
+    uint32_t* failed) {
+    furi_assert(instance);
+    furi_assert(transport < FlipperWedgeHidTransportCount);
+    const FlipperWedgeHidPacer* pacer = &instance->pacer[transport];
+    if(sent) *sent = pacer->reports_sent;
+    if(failed) *failed = pacer->reports_failed;
+}
+
+void flipper_wedge_hid_release_all_on(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport) {
+    furi_assert(instance);
+    furi_assert(transport < FlipperWedgeHidTransportCount);
+    if(!flipper_wedge_hid_is_transport_ready(instance, transport)) return;
+    flipper_wedge_hid_transport_release_all(instance, transport);
+}
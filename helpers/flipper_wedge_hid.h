@@ -4,16 +4,80 @@
 #include <furi_hal.h>
 #include <furi_hal_usb.h>
 #include <furi_hal_usb_hid.h>
+#include "flipper_wedge_usb_bulk.h"
 #include <bt/bt_service/bt.h>
 #include <extra_profiles/hid_profile.h>
 #include "flipper_wedge_keyboard_layout.h"
+#include "flipper_wedge_keystream.h"
 
 #define FLIPPER_WEDGE_BT_KEYS_STORAGE_NAME ".flipper_wedge_bt.keys"
 
 typedef struct FlipperWedgeHid FlipperWedgeHid;
 
+typedef enum {
+    FlipperWedgeHidTransportUsb,
+    FlipperWedgeHidTransportBle,
+    FlipperWedgeHidTransportCount,
+} FlipperWedgeHidTransport;
+
+/** Playback position in a compiled keystream
+ * Lets a caller feed one transport report by report, see
+ * flipper_wedge_hid_type_next_report()
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    uint8_t modifiers; // Modifier state at pos
+    size_t typed;      // Keys delivered so far
+} FlipperWedgeHidCursor;
+
+// Compiled bytes a text session holds, at least this much is kept ahead
+// of the report being typed while text is left
+#define FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE 128
+#define FLIPPER_WEDGE_HID_TEXT_LOOKAHEAD 32
+
+/** Typing position in a text
+ * Compiles the text through the layout a few characters ahead of the
+ * report being typed, so text of any length types from a small buffer
+ * and progress is counted in characters. The text and layout must stay
+ * unchanged until the session is done or dropped.
+ * Text is typed straight from the caller's buffer, with no chunk copies
+ * and no pauses between chunks. Typing runs on the HID worker, so there
+ * is no progress callback: the UI polls flipper_wedge_hid_worker_get_progress()
+ * at its own rate.
+ * See flipper_wedge_hid_type_next_text_report()
+ */
+typedef struct {
+    FlipperWedgeKeyboardLayout* layout;
+    const char* text;
+    size_t len;
+    size_t compiled; // Bytes of text compiled so far
+    bool enter;      // Enter still to be compiled
+    FlipperWedgeKeystream stream;
+    FlipperWedgeHidCursor cursor;
+    uint8_t buffer[FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE];
+    // Stream offsets the compiled characters not yet typed end at
+    uint8_t char_end[FLIPPER_WEDGE_HID_TEXT_BUFFER_SIZE];
+    uint8_t char_first;
+    uint8_t char_count;
+    size_t typed; // Characters delivered so far, Enter counts as one
+    size_t total; // Characters in the text, plus one for Enter
+} FlipperWedgeHidText;
+
 typedef void (*FlipperWedgeHidConnectionCallback)(bool usb_connected, bool bt_connected, void* context);
 
+/** Bulk request callback
+ * Called from USB interrupt context when the host sent a report on the
+ * bulk interface, fetch it with flipper_wedge_hid_read_bulk_request()
+ *
+ * @param context Callback context
+ */
+typedef void (*FlipperWedgeHidBulkRequestCallback)(void* context);
+
+// How often the typing progress on screen is refreshed
+#define FLIPPER_WEDGE_HID_PROGRESS_INTERVAL_MS 100
+
 /** Allocate HID helper
  *
  * @return FlipperWedgeHid instance
@@ -40,6 +104,48 @@ void flipper_wedge_hid_init_usb(FlipperWedgeHid* instance);
  */
 void flipper_wedge_hid_deinit_usb(FlipperWedgeHid* instance);
 
+/** Initialize USB bulk interface
+ * Raw 64-byte report HID device used by the USB Bulk output mode, replaces
+ * the USB keyboard while active (see flipper_wedge_bulk.h)
+ *
+ * @param instance FlipperWedgeHid instance
+ */
+void flipper_wedge_hid_init_usb_bulk(FlipperWedgeHid* instance);
+
+/** Deinitialize USB bulk interface
+ *
+ * @param instance FlipperWedgeHid instance
+ */
+void flipper_wedge_hid_deinit_usb_bulk(FlipperWedgeHid* instance);
+
+/** Set bulk request callback
+ *
+ * @param instance FlipperWedgeHid instance
+ * @param callback Callback function (USB interrupt context)
+ * @param context Callback context
+ */
+void flipper_wedge_hid_set_bulk_request_callback(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidBulkRequestCallback callback,
+    void* context);
+
+/** Fetch the pending host report from the bulk interface
+ *
+ * @param instance FlipperWedgeHid instance
+ * @return true if it was a bulk request, false for anything else
+ */
+bool flipper_wedge_hid_read_bulk_request(FlipperWedgeHid* instance);
+
+/** Send an encoded bulk message as a series of 64-byte reports
+ * Only call in response to a request, the host is known to be reading then
+ *
+ * @param instance FlipperWedgeHid instance
+ * @param message Message from flipper_wedge_bulk_encode()
+ * @param len Message length
+ * @return true if sent, false if the bulk interface is not connected
+ */
+bool flipper_wedge_hid_send_bulk(FlipperWedgeHid* instance, const uint8_t* message, size_t len);
+
 /** Initialize BLE HID interface
  * Like Bad USB pattern - call at app start or when switching to BLE mode
  *
@@ -86,31 +192,122 @@ bool flipper_wedge_hid_is_bt_connected(FlipperWedgeHid* instance);
  */
 bool flipper_wedge_hid_is_connected(FlipperWedgeHid* instance);
 
-/** Type a string via HID keyboard
- * Sends to both USB and BT if connected
+/** Start a cursor at the beginning of a keystream
+ *
+ * @param cursor FlipperWedgeHidCursor instance
+ * @param data Stream bytes, see flipper_wedge_keystream.h
+ * @param len Number of stream bytes
+ */
+void flipper_wedge_hid_cursor_init(FlipperWedgeHidCursor* cursor, const uint8_t* data, size_t len);
+
+/** Check if a cursor reached the end of its keystream
+ *
+ * @param cursor FlipperWedgeHidCursor instance
+ * @return true if nothing is left to type
+ */
+bool flipper_wedge_hid_cursor_is_done(const FlipperWedgeHidCursor* cursor);
+
+/** Type the next packed report from a cursor on a single transport
+ * Feeds that transport's pacer but does not sleep, the caller schedules
+ * the next report using flipper_wedge_hid_get_delay_us()
  *
  * @param instance FlipperWedgeHid instance
+ * @param transport Transport to send on, must be ready
+ * @param cursor Cursor to advance
+ * @return Number of keys sent, 0 if the cursor was already done
+ */
+size_t flipper_wedge_hid_type_next_report(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    FlipperWedgeHidCursor* cursor);
+
+/** Start a text session
+ *
+ * @param text FlipperWedgeHidText instance
  * @param layout Keyboard layout for character mapping (NULL for firmware default)
- * @param str String to type
+ * @param str UTF-8 text, need not be NUL terminated (stops early at NUL)
+ * @param len Number of bytes in str
+ * @param append_enter Press Enter after the text
+ */
+void flipper_wedge_hid_text_init(
+    FlipperWedgeHidText* text,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* str,
+    size_t len,
+    bool append_enter);
+
+/** Check if a text session typed everything
+ *
+ * @param text FlipperWedgeHidText instance
+ * @return true if nothing is left to type
  */
-void flipper_wedge_hid_type_string(FlipperWedgeHid* instance, FlipperWedgeKeyboardLayout* layout, const char* str);
+bool flipper_wedge_hid_text_is_done(const FlipperWedgeHidText* text);
 
-/** Type a single character via HID keyboard
+/** Type the next packed report of a text session on a single transport
+ * Compiles more text first when little is left ahead, otherwise as
+ * flipper_wedge_hid_type_next_report()
  *
  * @param instance FlipperWedgeHid instance
- * @param layout Keyboard layout for character mapping (NULL for firmware default)
- * @param c Character to type
+ * @param transport Transport to send on, must be ready
+ * @param text Session to advance
+ * @return Number of keys sent, 0 if nothing was left to type
  */
-void flipper_wedge_hid_type_char(FlipperWedgeHid* instance, FlipperWedgeKeyboardLayout* layout, char c);
+size_t flipper_wedge_hid_type_next_text_report(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    FlipperWedgeHidText* text);
 
-/** Press and release Enter key
+/** Check if a transport is initialized and connected
  *
  * @param instance FlipperWedgeHid instance
+ * @param transport Transport to check
+ * @return true if reports can be sent on it
  */
-void flipper_wedge_hid_press_enter(FlipperWedgeHid* instance);
+bool flipper_wedge_hid_is_transport_ready(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport);
+
+/** Get the delay a transport currently needs between reports
+ *
+ * @param instance FlipperWedgeHid instance
+ * @param transport Transport to query
+ * @return Delay in microseconds, learned by the transport's pacer
+ */
+uint32_t flipper_wedge_hid_get_delay_us(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport);
+
+/** Start a transport's pacer from the pace learned for the connected host
+ * Loaded once per connection, later calls return immediately. Does file
+ * I/O, call from the worker thread before typing.
+ *
+ * @param instance FlipperWedgeHid instance
+ * @param transport Transport to restore
+ */
+void flipper_wedge_hid_restore_pacing(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport);
+
+/** Remember the pace learned for the connected host
+ * Writes only after enough reports and when the stable delay changed.
+ *
+ * @param instance FlipperWedgeHid instance
+ * @param transport Transport to store
+ */
+void flipper_wedge_hid_store_pacing(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport);
+
+/** Get report counters of a transport
+ * Counts every submission, retries included, since the transport was
+ * last initialized
+ *
+ * @param instance FlipperWedgeHid instance
+ * @param transport Transport to query
+ * @param sent Reports submitted (may be NULL)
+ * @param failed Reports the transport refused (may be NULL)
+ */
+void flipper_wedge_hid_get_report_stats(
+    FlipperWedgeHid* instance,
+    FlipperWedgeHidTransport transport,
+    uint32_t* sent,
+    uint32_t* failed);
 
-/** Release all keys
+/** Release all keys on a single transport
  *
  * @param instance FlipperWedgeHid instance
+ * @param transport Transport to release on (ignored if not ready)
  */
-void flipper_wedge_hid_release_all(FlipperWedgeHid* instance);
+void flipper_wedge_hid_release_all_on(FlipperWedgeHid* instance, FlipperWedgeHidTransport transport);
@@ -0,0 +1,153 @@
+#include "flipper_wedge_hid_pacer.h"
+#include <furi_hal.h>
+
+typedef struct {
+    uint32_t initial_delay_us;
+    uint32_t min_delay_us;
+    uint32_t max_delay_us;
+    uint32_t step_us;          // Smallest adjustment in either direction
+    uint16_t clean_run;        // Clean reports needed before speeding up
+    uint8_t max_retries;       // Resubmissions of a refused report
+    uint32_t blocked_us;       // Submission wait that counts as congestion, 0 to ignore
+} FlipperWedgeHidPacerConfig;
+
+// Drop rate of the learning session above which a learned delay is started
+// a step slower
+#define PACER_SEED_DROP_PER_MILLE 10
+
+// USB submission blocks until the previous report left the endpoint and
+// never fails, so the wait in the call is the only sign of the host's pace.
+// The pacer follows the poll interval, sleeping instead of blocking.
+// BLE notifications are queued by the radio core; centrals that poll slowly
+// drop keys when the queue overflows, so start with some headroom. A central
+// taking one notification per 30 ms connection event needs about 200 ms for
+// a full report.
+static const FlipperWedgeHidPacerConfig pacer_configs[FlipperWedgeHidPacerProfileCount] = {
+    [FlipperWedgeHidPacerProfileUsb] =
+        {
+            .initial_delay_us = 250,
+            .min_delay_us = 0,
+            .max_delay_us = 8000,
+            .step_us = 250,
+            .clean_run = 32,
+            .max_retries = 3,
+            .blocked_us = 250,
+        },
+    [FlipperWedgeHidPacerProfileBle] =
+        {
+            .initial_delay_us = 2000,
+            .min_delay_us = 500,
+            .max_delay_us = 250000,
+            .step_us = 500,
+            .clean_run = 16,
+            .max_retries = 5,
+            .blocked_us = 0,
+        },
+};
+
+void flipper_wedge_hid_pacer_init(FlipperWedgeHidPacer* pacer, FlipperWedgeHidPacerProfile profile) {
+    furi_assert(pacer);
+    furi_assert(profile < FlipperWedgeHidPacerProfileCount);
+
+    pacer->profile = profile;
+    pacer->delay_us = pacer_configs[profile].initial_delay_us;
+    pacer->stable_delay_us = pacer->delay_us;
+    pacer->clean_reports = 0;
+    pacer->backed_off = false;
+    pacer->reports_sent = 0;
+    pacer->reports_failed = 0;
+    pacer->reports_blocked = 0;
+}
+
+void flipper_wedge_hid_pacer_seed(FlipperWedgeHidPacer* pacer, uint32_t delay_us, uint32_t drop_per_mille) {
+    furi_assert(pacer);
+    const FlipperWedgeHidPacerConfig* config = &pacer_configs[pacer->profile];
+
+    // The delay held for a clean run, but the host refused enough reports
+    // on the way there to not start right at it
+    if(drop_per_mille > PACER_SEED_DROP_PER_MILLE && delay_us <= UINT32_MAX - config->step_us) {
+        delay_us += config->step_us;
+    }
+    pacer->delay_us = CLAMP(delay_us, config->max_delay_us, config->min_delay_us);
+    pacer->stable_delay_us = pacer->delay_us;
+    pacer->clean_reports = 0;
+}
+
+void flipper_wedge_hid_pacer_begin_burst(FlipperWedgeHidPacer* pacer) {
+    furi_assert(pacer);
+    pacer->backed_off = false;
+}
+
+void flipper_wedge_hid_pacer_feedback(FlipperWedgeHidPacer* pacer, bool accepted) {
+    furi_assert(pacer);
+    const FlipperWedgeHidPacerConfig* config = &pacer_configs[pacer->profile];
+
+    pacer->reports_sent++;
+
+    if(!accepted) {
+        // Back off hard: double the delay (at least one step)
+        pacer->reports_failed++;
+        pacer->clean_reports = 0;
+        if(pacer->backed_off) return;
+        pacer->backed_off = true;
+        uint32_t delay = MAX(pacer->delay_us * 2, pacer->delay_us + config->step_us);
+        pacer->delay_us = MIN(delay, config->max_delay_us);
+        return;
+    }
+
+    if(++pacer->clean_reports < config->clean_run) return;
+    pacer->clean_reports = 0;
+    pacer->stable_delay_us = pacer->delay_us;
+
+    // Speed up gently: shave 1/8 of the delay (at least one step)
+    uint32_t decrease = MAX(pacer->delay_us / 8, config->step_us);
+    if(pacer->delay_us > config->min_delay_us + decrease) {
+        pacer->delay_us -= decrease;
+    } else {
+        pacer->delay_us = config->min_delay_us;
+    }
+}
+
+void flipper_wedge_hid_pacer_feedback_blocked(FlipperWedgeHidPacer* pacer, uint32_t blocked_us) {
+    furi_assert(pacer);
+    const FlipperWedgeHidPacerConfig* config = &pacer_configs[pacer->profile];
+
+    if(config->blocked_us == 0 || blocked_us <= config->blocked_us) return;
+
+    // Nothing was lost, creep towards the host's pace by one step
+    pacer->reports_blocked++;
+    pacer->clean_reports = 0;
+    pacer->delay_us = MIN(pacer->delay_us + config->step_us, config->max_delay_us);
+}
+
+uint32_t flipper_wedge_hid_pacer_timer_start(void) {
+    return DWT->CYCCNT;
+}
+
+uint32_t flipper_wedge_hid_pacer_timer_elapsed_us(uint32_t start) {
+    return (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+}
+
+uint32_t flipper_wedge_hid_pacer_get_delay_us(const FlipperWedgeHidPacer* pacer) {
+    furi_assert(pacer);
+    return pacer->delay_us;
+}
+
+uint32_t flipper_wedge_hid_pacer_get_stable_delay_us(const FlipperWedgeHidPacer* pacer) {
+    furi_assert(pacer);
+    return pacer->stable_delay_us;
+}
+
+uint8_t flipper_wedge_hid_pacer_get_max_retries(const FlipperWedgeHidPacer* pacer) {
+    furi_assert(pacer);
+    return pacer_configs[pacer->profile].max_retries;
+}
+
+void flipper_wedge_hid_pacer_delay(uint32_t delay_us) {
+    if(delay_us >= 1000) {
+        furi_delay_ms(delay_us / 1000);
+    }
+    if(delay_us % 1000) {
+        furi_delay_us(delay_us % 1000);
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <furi.h>
+
+// Transport-specific pacing profiles
+typedef enum {
+    FlipperWedgeHidPacerProfileUsb,
+    FlipperWedgeHidPacerProfileBle,
+    FlipperWedgeHidPacerProfileCount,
+} FlipperWedgeHidPacerProfile;
+
+/** Adaptive typing pacer
+ * Closed-loop inter-report delay: starts fast, backs off multiplicatively
+ * when the host refuses a report (submission failure / full queue), a step
+ * at a time when a submission blocks waiting for the host, and speeds up
+ * again after a run of clean reports. Converges on the highest rate the
+ * current host sustains.
+ */
+typedef struct {
+    FlipperWedgeHidPacerProfile profile;
+    uint32_t delay_us;       // Current delay after each report
+    uint32_t stable_delay_us; // Last delay that held for a full clean run
+    uint16_t clean_reports;  // Accepted reports since last adjustment
+    bool backed_off;         // Refusal already handled in the current burst
+    uint32_t reports_sent;   // Statistics for the current session
+    uint32_t reports_failed;
+    uint32_t reports_blocked;
+} FlipperWedgeHidPacer;
+
+/** Reset pacer to the starting point of a profile
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @param profile Transport profile
+ */
+void flipper_wedge_hid_pacer_init(FlipperWedgeHidPacer* pacer, FlipperWedgeHidPacerProfile profile);
+
+/** Start from a previously learned delay instead of the profile default
+ * A host that refused many reports while the delay was learned starts a
+ * step above it, so the first burst doesn't drop keys again.
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @param delay_us Learned delay, clamped to the profile limits
+ * @param drop_per_mille Refused reports per 1000 in the session it was learned in
+ */
+void flipper_wedge_hid_pacer_seed(FlipperWedgeHidPacer* pacer, uint32_t delay_us, uint32_t drop_per_mille);
+
+/** Start a burst of submissions sent back to back
+ * The pacer backs off at most once per burst, later refusals in it are
+ * the same congestion. Call before a report and after every pacer delay.
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ */
+void flipper_wedge_hid_pacer_begin_burst(FlipperWedgeHidPacer* pacer);
+
+/** Feed back the outcome of one report submission
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @param accepted true if the transport accepted the report
+ */
+void flipper_wedge_hid_pacer_feedback(FlipperWedgeHidPacer* pacer, bool accepted);
+
+/** Feed back how long the first submission after the delay blocked
+ * USB submissions never fail, they wait until the host polled the previous
+ * report. A wait means the delay is shorter than the host's pace and the
+ * thread is stuck in the HAL instead of serving other lanes.
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @param blocked_us Time spent in the submit call
+ */
+void flipper_wedge_hid_pacer_feedback_blocked(FlipperWedgeHidPacer* pacer, uint32_t blocked_us);
+
+/** Start timing a submit call
+ *
+ * @return Timestamp for flipper_wedge_hid_pacer_timer_elapsed_us()
+ */
+uint32_t flipper_wedge_hid_pacer_timer_start(void);
+
+/** Get the time since flipper_wedge_hid_pacer_timer_start()
+ *
+ * @param start Timestamp
+ * @return Elapsed microseconds, valid for up to a minute
+ */
+uint32_t flipper_wedge_hid_pacer_timer_elapsed_us(uint32_t start);
+
+/** Get current inter-report delay
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @return Delay in microseconds
+ */
+uint32_t flipper_wedge_hid_pacer_get_delay_us(const FlipperWedgeHidPacer* pacer);
+
+/** Get the last delay the host sustained without refusals
+ * This is what is worth remembering for the next session, the current
+ * delay may be mid-probe below it.
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @return Delay in microseconds
+ */
+uint32_t flipper_wedge_hid_pacer_get_stable_delay_us(const FlipperWedgeHidPacer* pacer);
+
+/** Get retry budget for a refused report
+ *
+ * @param pacer FlipperWedgeHidPacer instance
+ * @return Number of resubmission attempts before giving up
+ */
+uint8_t flipper_wedge_hid_pacer_get_max_retries(const FlipperWedgeHidPacer* pacer);
+
+/** Sleep for the given delay
+ * Whole milliseconds yield to the scheduler, the remainder is busy-waited
+ *
+ * @param delay_us Delay in microseconds
+ */
+void flipper_wedge_hid_pacer_delay(uint32_t delay_us);
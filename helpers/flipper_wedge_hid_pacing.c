@@ -0,0 +1,164 @@
+#include "flipper_wedge_hid_pacing.h"
+#include <storage/storage.h>
+#include <flipper_format/flipper_format.h>
+
+#define TAG "FlipperWedgeHidPacing"
+
+#define PACING_FILE_HEADER "FlipperWedge Pacing"
+#define PACING_FILE_VERSION 2 // 1 keyed BLE hosts on the bond key file
+#define PACING_PROFILE_FIELDS (sizeof(FlipperWedgeHidPacingProfile) / sizeof(uint32_t))
+// Space separated BLE host ids, most recently saved first
+#define PACING_BLE_HOSTS_KEY "Ble hosts"
+#define PACING_BLE_HOST_PREFIX "Ble"
+
+#define BLE_ADDRESS_TYPE_RANDOM 0x01
+#define BLE_ADDRESS_LEN 6
+
+static bool flipper_wedge_hid_pacing_is_ble_host(const char* host_id) {
+    return strncmp(host_id, PACING_BLE_HOST_PREFIX, strlen(PACING_BLE_HOST_PREFIX)) == 0;
+}
+
+// Moves a BLE host to the front of the host list and deletes the profiles
+// that fall off its end
+static bool flipper_wedge_hid_pacing_touch_ble_host(FlipperFormat* file, const char* host_id) {
+    FuriString* hosts = furi_string_alloc();
+    FuriString* kept = furi_string_alloc_set_str(host_id);
+    size_t count = 1;
+
+    flipper_format_rewind(file);
+    if(flipper_format_read_string(file, PACING_BLE_HOSTS_KEY, hosts)) {
+        const char* next = furi_string_get_cstr(hosts);
+        char id[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+        while(*next) {
+            size_t len = strcspn(next, " ");
+            if(len > 0 && len < sizeof(id)) {
+                memcpy(id, next, len);
+                id[len] = '\0';
+                if(strcmp(id, host_id) == 0) {
+                    // Moved to the front
+                } else if(count < FLIPPER_WEDGE_HID_PACING_BLE_HOSTS_MAX) {
+                    furi_string_push_back(kept, ' ');
+                    furi_string_cat_str(kept, id);
+                    count++;
+                } else {
+                    FURI_LOG_I(TAG, "Evicting pacing for %s", id);
+                    flipper_format_rewind(file);
+                    flipper_format_delete_key(file, id);
+                }
+            }
+            next += len;
+            while(*next == ' ') next++;
+        }
+    }
+
+    flipper_format_rewind(file);
+    bool touched = flipper_format_insert_or_update_string_cstr(
+        file, PACING_BLE_HOSTS_KEY, furi_string_get_cstr(kept));
+
+    furi_string_free(kept);
+    furi_string_free(hosts);
+    return touched;
+}
+
+bool flipper_wedge_hid_pacing_load(const char* host_id, FlipperWedgeHidPacingProfile* profile) {
+    furi_assert(host_id);
+    furi_assert(profile);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    FuriString* header = furi_string_alloc();
+    bool loaded = false;
+
+    do {
+        uint32_t version = 0;
+        if(!flipper_format_file_open_existing(file, FLIPPER_WEDGE_HID_PACING_PATH)) break;
+        if(!flipper_format_read_header(file, header, &version)) break;
+        if(furi_string_cmp_str(header, PACING_FILE_HEADER) != 0 || version != PACING_FILE_VERSION) {
+            FURI_LOG_W(TAG, "Ignoring pacing file with unknown format");
+            break;
+        }
+        if(!flipper_format_read_uint32(file, host_id, (uint32_t*)profile, PACING_PROFILE_FIELDS)) break;
+        loaded = true;
+    } while(false);
+
+    furi_string_free(header);
+    flipper_format_file_close(file);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    return loaded;
+}
+
+bool flipper_wedge_hid_pacing_save(const char* host_id, const FlipperWedgeHidPacingProfile* profile) {
+    furi_assert(host_id);
+    furi_assert(profile);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    FuriString* header = furi_string_alloc();
+    bool saved = false;
+
+    do {
+        // Update in place so profiles of other hosts survive
+        uint32_t version = 0;
+        if(flipper_format_file_open_existing(file, FLIPPER_WEDGE_HID_PACING_PATH) &&
+           flipper_format_read_header(file, header, &version) &&
+           furi_string_cmp_str(header, PACING_FILE_HEADER) == 0 && version == PACING_FILE_VERSION) {
+            saved = flipper_format_insert_or_update_uint32(
+                file, host_id, (const uint32_t*)profile, PACING_PROFILE_FIELDS);
+            if(saved && flipper_wedge_hid_pacing_is_ble_host(host_id)) {
+                saved = flipper_wedge_hid_pacing_touch_ble_host(file, host_id);
+            }
+            break;
+        }
+
+        // Missing or unreadable, start over
+        flipper_format_file_close(file);
+        storage_common_mkdir(storage, APP_DATA_PATH(""));
+        if(!flipper_format_file_open_always(file, FLIPPER_WEDGE_HID_PACING_PATH)) break;
+        if(!flipper_format_write_header_cstr(file, PACING_FILE_HEADER, PACING_FILE_VERSION)) break;
+        saved = flipper_format_write_uint32(
+            file, host_id, (const uint32_t*)profile, PACING_PROFILE_FIELDS);
+        if(saved && flipper_wedge_hid_pacing_is_ble_host(host_id)) {
+            saved = flipper_format_write_string_cstr(file, PACING_BLE_HOSTS_KEY, host_id);
+        }
+    } while(false);
+
+    if(!saved) {
+        FURI_LOG_E(TAG, "Failed to save pacing for %s", host_id);
+    }
+
+    furi_string_free(header);
+    flipper_format_file_close(file);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    return saved;
+}
+
+void flipper_wedge_hid_pacing_usb_host_id(char* host_id) {
+    furi_assert(host_id);
+    strlcpy(host_id, "Usb", FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN);
+}
+
+bool flipper_wedge_hid_pacing_is_private_address(uint8_t address_type, const uint8_t* address) {
+    furi_assert(address);
+    // Random address with 0b01 in the two most significant bits
+    return address_type == BLE_ADDRESS_TYPE_RANDOM && (address[BLE_ADDRESS_LEN - 1] & 0xC0) == 0x40;
+}
+
+void flipper_wedge_hid_pacing_ble_host_id(const uint8_t* address, char* host_id) {
+    furi_assert(address);
+    furi_assert(host_id);
+
+    snprintf(
+        host_id,
+        FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN,
+        PACING_BLE_HOST_PREFIX "%02X%02X%02X%02X%02X%02X",
+        address[5],
+        address[4],
+        address[3],
+        address[2],
+        address[1],
+        address[0]);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <furi.h>
+
+// Learned typing pace per host, kept across sessions
+#define FLIPPER_WEDGE_HID_PACING_PATH APP_DATA_PATH("pacing.conf")
+#define FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN 16
+// BLE hosts kept in the file, the least recently used one is dropped
+#define FLIPPER_WEDGE_HID_PACING_BLE_HOSTS_MAX 8
+
+/** Pacing profile of one host
+ * Stored as a uint32 array under the host id key, in this order.
+ */
+typedef struct {
+    uint32_t delay_us;       // Last stable inter-report delay
+    uint32_t drop_per_mille; // Refused reports per 1000 in the saving session
+    uint32_t reports;        // Reports the profile was learned from
+} FlipperWedgeHidPacingProfile;
+
+/** Load the profile of a host
+ *
+ * @param host_id Host key, see flipper_wedge_hid_pacing_usb_host_id() / _ble_host_id()
+ * @param profile Filled in on success
+ * @return true if the host has a stored profile
+ */
+bool flipper_wedge_hid_pacing_load(const char* host_id, FlipperWedgeHidPacingProfile* profile);
+
+/** Store the profile of a host, other hosts in the file are kept
+ * BLE hosts beyond FLIPPER_WEDGE_HID_PACING_BLE_HOSTS_MAX are evicted, least
+ * recently saved first.
+ *
+ * @param host_id Host key
+ * @param profile Profile to store
+ * @return true on success
+ */
+bool flipper_wedge_hid_pacing_save(const char* host_id, const FlipperWedgeHidPacingProfile* profile);
+
+/** Host id for USB
+ * The device side never sees the host's identity, so all USB hosts
+ * share one profile.
+ *
+ * @param host_id Output buffer, FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN bytes
+ */
+void flipper_wedge_hid_pacing_usb_host_id(char* host_id);
+
+/** Check if a BLE address is a resolvable private address
+ * Such an address changes every few minutes, it has to be resolved to the
+ * bonded identity address before it can key a profile.
+ *
+ * @param address_type Peer address type from the connection event
+ * @param address Peer address, 6 bytes, least significant first
+ * @return true if the address is resolvable private
+ */
+bool flipper_wedge_hid_pacing_is_private_address(uint8_t address_type, const uint8_t* address);
+
+/** Host id for BLE, derived from the peer's identity address
+ *
+ * @param address Public or static identity address, 6 bytes, least significant first
+ * @param host_id Output buffer, FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN bytes
+ */
+void flipper_wedge_hid_pacing_ble_host_id(const uint8_t* address, char* host_id);
@@ -0,0 +1,41 @@
+#include "flipper_wedge_hid_report.h"
+
+void flipper_wedge_hid_report_reset(FlipperWedgeHidReport* report) {
+    furi_assert(report);
+    memset(report, 0, sizeof(FlipperWedgeHidReport));
+}
+
+bool flipper_wedge_hid_report_add(FlipperWedgeHidReport* report, uint16_t keycode) {
+    furi_assert(report);
+
+    uint8_t key = keycode & 0xFF;
+    uint8_t modifiers = (keycode >> 8) & 0xFF;
+
+    if(report->key_count == 0) {
+        report->modifiers = modifiers;
+        report->keys[report->key_count++] = key;
+        return true;
+    }
+
+    if(report->key_count >= FLIPPER_WEDGE_HID_REPORT_MAX_KEYS) return false;
+    if(report->modifiers != modifiers) return false;
+
+    // Same key can't be pressed twice without a release in between
+    for(uint8_t i = 0; i < report->key_count; i++) {
+        if(report->keys[i] == key) return false;
+    }
+
+    report->keys[report->key_count++] = key;
+    return true;
+}
+
+bool flipper_wedge_hid_report_is_empty(const FlipperWedgeHidReport* report) {
+    furi_assert(report);
+    return report->key_count == 0;
+}
+
+uint16_t flipper_wedge_hid_report_get_keycode(const FlipperWedgeHidReport* report, uint8_t index) {
+    furi_assert(report);
+    furi_assert(index < report->key_count);
+    return ((uint16_t)report->modifiers << 8) | report->keys[index];
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <furi.h>
+
+// Boot keyboard protocol carries at most 6 simultaneously pressed keys
+#define FLIPPER_WEDGE_HID_REPORT_MAX_KEYS 6
+
+/** Packed keyboard report
+ * A run of distinct keycodes sharing one modifier state.
+ * Keys are pressed one after another (each press adds a key to the report
+ * already held by the host) and released together, so a batch of N characters
+ * costs N+1 reports instead of 2N while the host still sees them in order.
+ */
+typedef struct {
+    uint8_t modifiers;
+    uint8_t keys[FLIPPER_WEDGE_HID_REPORT_MAX_KEYS];
+    uint8_t key_count;
+    bool hold_modifiers; // Release only the keys, the next report keeps the modifiers
+} FlipperWedgeHidReport;
+
+/** Clear report
+ *
+ * @param report FlipperWedgeHidReport instance
+ */
+void flipper_wedge_hid_report_reset(FlipperWedgeHidReport* report);
+
+/** Try to append keycode to report
+ * Fails if the report is full, the modifier state differs from the keys
+ * already packed, or the key is already held (a repeated character needs
+ * a release first).
+ *
+ * @param report FlipperWedgeHidReport instance
+ * @param keycode HID keycode (lower 8 bits) + modifiers (upper 8 bits)
+ * @return true if keycode was packed, false if report must be flushed first
+ */
+bool flipper_wedge_hid_report_add(FlipperWedgeHidReport* report, uint16_t keycode);
+
+/** Check if report holds any keys
+ *
+ * @param report FlipperWedgeHidReport instance
+ * @return true if report is empty
+ */
+bool flipper_wedge_hid_report_is_empty(const FlipperWedgeHidReport* report);
+
+/** Get packed key as full keycode (key + modifiers)
+ *
+ * @param report FlipperWedgeHidReport instance
+ * @param index Key index, less than key_count
+ * @return HID keycode with modifiers
+ */
+uint16_t flipper_wedge_hid_report_get_keycode(const FlipperWedgeHidReport* report, uint8_t index);
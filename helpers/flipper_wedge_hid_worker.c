@@ -1,54 +1,405 @@
 #include "flipper_wedge_hid_worker.h"
+#include "flipper_wedge_hid_pacer.h"
 #include "flipper_wedge_debug.h"
 
 #define TAG "FlipperWedgeHidWorker"
 
+// tests/bench_worker_stack.c measures 2.4KB for 1000 characters of ASCII and
+// Unicode on USB, BLE and both, on x86-64 and without log formatting or file
+// access (storage runs on its own thread on the Flipper). Log formatting
+// peaks around 1KB on top. High-water mark is logged after init and after
+// every job so this can be trimmed against real numbers.
+#define FLIPPER_WEDGE_HID_WORKER_STACK_SIZE (4 * 1024)
+
+// Longest a cancel waits for the worker, a BLE report can be held back by
+// its retries for about a second
+#define FLIPPER_WEDGE_HID_WORKER_CANCEL_TIMEOUT_MS 2000
+
 typedef enum {
     FlipperWedgeHidWorkerEventStop = (1 << 0),
+    FlipperWedgeHidWorkerEventJob = (1 << 1),
+    FlipperWedgeHidWorkerEventBulkRequest = (1 << 2),
 } FlipperWedgeHidWorkerEvent;
 
+#define FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_MAX \
+    MAX(FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_TYPING, FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_BULK)
+
+// Text is compiled by each lane as it types, a few characters ahead.
+// In USB Bulk mode the slot holds an encoded bulk message instead.
+typedef struct {
+    FlipperWedgeKeyboardLayout* layout;
+    bool append_enter;
+    size_t len;
+    uint8_t* data; // slot_size bytes of slot_data
+} FlipperWedgeHidWorkerJob;
+
+// Per-transport typing position. Each lane walks the job ring on its own and
+// is paced by its own transport, so a slow BLE central never holds back the
+// USB host (and vice versa).
+typedef struct {
+    bool active; // Transport brought up by this worker
+    uint32_t job; // Ring index the lane is typing
+    bool started; // Text session is set up for job
+    FlipperWedgeHidText text;
+    uint32_t text_job; // Job the text session was last set up for
+    uint32_t ready_tick; // Earliest tick for the next report
+    // Typing statistics of the current job
+    uint32_t start_tick;
+    uint32_t start_sent;
+    uint32_t start_failed;
+} FlipperWedgeHidWorkerLane;
+
 struct FlipperWedgeHidWorker {
     FlipperWedgeHid* hid;
     FuriThread* thread;
     FlipperWedgeHidWorkerMode mode;
+
+    // Single-producer (GUI thread) / single-consumer (worker thread) ring.
+    // Indices run freely, slot = index % size. Producer only writes head,
+    // consumer only writes tail, so no lock is needed. A slot is freed once
+    // every active lane has moved past it. Slot data is sized for the mode
+    // and only allocated while the worker runs.
+    FlipperWedgeHidWorkerJob jobs[FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_MAX];
+    uint8_t* slot_data;
+    uint32_t queue_size;
+    size_t slot_size;
+    uint32_t head;
+    uint32_t tail;
+    // Jobs queued before this index were cancelled (written by producer)
+    uint32_t cancel_before;
+
+    // Worker thread only
+    FlipperWedgeHidWorkerLane lanes[FlipperWedgeHidTransportCount];
+
+    // Progress of the oldest unfinished job, written by the worker thread only
+    size_t progress_typed;
+    size_t progress_total;
 };
 
+static const char* const lane_names[FlipperWedgeHidTransportCount] = {
+    [FlipperWedgeHidTransportUsb] = "USB",
+    [FlipperWedgeHidTransportBle] = "BLE",
+};
+
+static void flipper_wedge_hid_worker_log_stack(const char* stage) {
+    FURI_LOG_D(
+        TAG,
+        "Stack free after %s: %lu of %d bytes",
+        stage,
+        furi_thread_get_stack_space(furi_thread_get_current_id()),
+        FLIPPER_WEDGE_HID_WORKER_STACK_SIZE);
+}
+
+static bool flipper_wedge_hid_worker_is_cancelled(FlipperWedgeHidWorker* worker, uint32_t job) {
+    return (int32_t)(job - __atomic_load_n(&worker->cancel_before, __ATOMIC_ACQUIRE)) < 0;
+}
+
+// One line per finished job, fixed key order so the debug log can be parsed
+// (tools/flipper_wedge_typing_stats.py) and compared between builds
+static void flipper_wedge_hid_worker_log_job_stats(
+    FlipperWedgeHidWorker* worker,
+    FlipperWedgeHidTransport transport) {
+    FlipperWedgeHidWorkerLane* lane = &worker->lanes[transport];
+    uint32_t sent = 0;
+    uint32_t failed = 0;
+    flipper_wedge_hid_get_report_stats(worker->hid, transport, &sent, &failed);
+    sent -= lane->start_sent;
+    failed -= lane->start_failed;
+
+    uint32_t ms = (furi_get_tick() - lane->start_tick) * 1000 / furi_kernel_get_tick_frequency();
+    uint32_t keys = lane->text.cursor.typed;
+    uint32_t keys_per_s = ms ? keys * 1000 / ms : 0;
+    uint32_t reports_per_key_x100 = keys ? sent * 100 / keys : 0;
+
+    FURI_LOG_I(
+        TAG,
+        "%s: %lu keys in %lu ms (%lu keys/s, %lu reports)",
+        lane_names[transport],
+        keys,
+        ms,
+        keys_per_s,
+        sent);
+    flipper_wedge_debug_log(
+        TAG,
+        "STATS transport=%s keys=%lu chars=%zu reports=%lu failed=%lu ms=%lu "
+        "keys_per_s=%lu reports_per_key=%lu.%02lu delay_us=%lu",
+        lane_names[transport],
+        keys,
+        lane->text.total,
+        sent,
+        failed,
+        ms,
+        keys_per_s,
+        reports_per_key_x100 / 100,
+        reports_per_key_x100 % 100,
+        flipper_wedge_hid_get_delay_us(worker->hid, transport));
+}
+
+static void flipper_wedge_hid_worker_lane_next_job(FlipperWedgeHidWorkerLane* lane) {
+    lane->job++;
+    lane->started = false;
+}
+
+// Advance one lane by at most one report. Returns true if the lane made
+// progress, otherwise lowers *wait to the ticks until its pacer allows more.
+static bool flipper_wedge_hid_worker_lane_step(
+    FlipperWedgeHidWorker* worker,
+    FlipperWedgeHidTransport transport,
+    uint32_t head,
+    uint32_t now,
+    uint32_t* wait) {
+    FlipperWedgeHidWorkerLane* lane = &worker->lanes[transport];
+    if(!lane->active || lane->job == head) return false;
+
+    if(flipper_wedge_hid_worker_is_cancelled(worker, lane->job)) {
+        if(lane->started) {
+            flipper_wedge_hid_release_all_on(worker->hid, transport);
+            FURI_LOG_I(
+                TAG,
+                "%s: job %lu cancelled after %zu/%zu chars",
+                lane_names[transport],
+                lane->job,
+                lane->text.typed,
+                lane->text.total);
+        }
+        flipper_wedge_hid_worker_lane_next_job(lane);
+        return true;
+    }
+
+    if(!flipper_wedge_hid_is_transport_ready(worker->hid, transport)) {
+        FURI_LOG_W(TAG, "%s: not connected, dropping job %lu", lane_names[transport], lane->job);
+        flipper_wedge_hid_worker_lane_next_job(lane);
+        return true;
+    }
+
+    int32_t remaining = (int32_t)(lane->ready_tick - now);
+    if(remaining > 0) {
+        *wait = MIN(*wait, (uint32_t)remaining);
+        return false;
+    }
+
+    FlipperWedgeHidWorkerJob* job = &worker->jobs[lane->job % worker->queue_size];
+    if(!lane->started) {
+        FURI_LOG_D(TAG, "%s: typing job %lu (%zu bytes)", lane_names[transport], lane->job, job->len);
+        flipper_wedge_hid_restore_pacing(worker->hid, transport);
+        flipper_wedge_hid_text_init(
+            &lane->text, job->layout, (const char*)job->data, job->len, job->append_enter);
+        flipper_wedge_hid_get_report_stats(
+            worker->hid, transport, &lane->start_sent, &lane->start_failed);
+        lane->start_tick = furi_get_tick();
+        lane->started = true;
+        lane->text_job = lane->job;
+    }
+
+    flipper_wedge_hid_type_next_text_report(worker->hid, transport, &lane->text);
+
+    // Sub-millisecond gaps are cheaper to spin than to schedule
+    uint32_t delay_us = flipper_wedge_hid_get_delay_us(worker->hid, transport);
+    if(delay_us < 1000) {
+        flipper_wedge_hid_pacer_delay(delay_us);
+        lane->ready_tick = furi_get_tick();
+    } else {
+        lane->ready_tick = furi_get_tick() + furi_ms_to_ticks((delay_us + 999) / 1000);
+    }
+
+    if(flipper_wedge_hid_text_is_done(&lane->text)) {
+        flipper_wedge_hid_worker_log_job_stats(worker, transport);
+        flipper_wedge_hid_worker_lane_next_job(lane);
+        // Persist between bursts, not while more jobs are waiting
+        if(lane->job == head) {
+            flipper_wedge_hid_store_pacing(worker->hid, transport);
+        }
+    }
+    return true;
+}
+
+// Free ring slots all lanes are done with and publish progress of the oldest job
+static void flipper_wedge_hid_worker_update_tail(FlipperWedgeHidWorker* worker, uint32_t head) {
+    uint32_t tail = head;
+    for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount; transport++) {
+        FlipperWedgeHidWorkerLane* lane = &worker->lanes[transport];
+        if(lane->active && (int32_t)(lane->job - tail) < 0) tail = lane->job;
+    }
+
+    // Once the queue is empty the last job's final count stays up
+    if(tail != head || tail != worker->tail) {
+        uint32_t job = (tail != head) ? tail : head - 1;
+        // A lane that hasn't started the job (or dropped it) holds the others' count at 0
+        size_t typed = SIZE_MAX;
+        size_t total = 0;
+        for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount; transport++) {
+            FlipperWedgeHidWorkerLane* lane = &worker->lanes[transport];
+            if(!lane->active || (tail != head && lane->job != tail)) continue;
+            bool has_text = (lane->text_job == job) && (tail == head || lane->started);
+            typed = MIN(typed, has_text ? lane->text.typed : 0);
+            if(has_text) total = lane->text.total;
+        }
+        __atomic_store_n(&worker->progress_total, total, __ATOMIC_RELAXED);
+        __atomic_store_n(&worker->progress_typed, MIN(typed, total), __ATOMIC_RELAXED);
+    }
+
+    if(tail != worker->tail) {
+        __atomic_store_n(&worker->tail, tail, __ATOMIC_RELEASE);
+        flipper_wedge_hid_worker_log_stack("job");
+    }
+}
+
+// Run lanes round-robin until all are idle or waiting on their pacer.
+// Returns ticks until the next lane is due, FuriWaitForever when idle.
+static uint32_t flipper_wedge_hid_worker_service(FlipperWedgeHidWorker* worker) {
+    while(true) {
+        // Stop request wins over queued jobs
+        if(furi_thread_flags_get() & FlipperWedgeHidWorkerEventStop) return FuriWaitForever;
+
+        uint32_t head = __atomic_load_n(&worker->head, __ATOMIC_ACQUIRE);
+        uint32_t now = furi_get_tick();
+        uint32_t wait = FuriWaitForever;
+        bool progressed = false;
+
+        for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount;
+            transport++) {
+            progressed |= flipper_wedge_hid_worker_lane_step(worker, transport, head, now, &wait);
+        }
+        flipper_wedge_hid_worker_update_tail(worker, head);
+
+        if(!progressed) return wait;
+    }
+}
+
+// USB interrupt context
+static void flipper_wedge_hid_worker_bulk_request_callback(void* context) {
+    FlipperWedgeHidWorker* worker = context;
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), FlipperWedgeHidWorkerEventBulkRequest);
+}
+
+// Free the slots of cancelled bulk messages, returns the new tail
+static uint32_t flipper_wedge_hid_worker_drop_cancelled(FlipperWedgeHidWorker* worker, uint32_t head) {
+    uint32_t tail = worker->tail;
+    while(tail != head && flipper_wedge_hid_worker_is_cancelled(worker, tail)) {
+        tail++;
+    }
+    if(tail != worker->tail) {
+        __atomic_store_n(&worker->tail, tail, __ATOMIC_RELEASE);
+    }
+    return tail;
+}
+
+// Host asked for data: answer with the oldest queued message, or an empty one
+static void flipper_wedge_hid_worker_serve_bulk(FlipperWedgeHidWorker* worker) {
+    if(!flipper_wedge_hid_read_bulk_request(worker->hid)) return;
+
+    uint32_t head = __atomic_load_n(&worker->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = flipper_wedge_hid_worker_drop_cancelled(worker, head);
+
+    if(tail == head) {
+        uint8_t empty[FLIPPER_WEDGE_BULK_HEADER_SIZE];
+        size_t len = flipper_wedge_bulk_encode(FlipperWedgeBulkMessageEmpty, NULL, 0, empty, sizeof(empty));
+        flipper_wedge_hid_send_bulk(worker->hid, empty, len);
+    } else {
+        FlipperWedgeHidWorkerJob* job = &worker->jobs[tail % worker->queue_size];
+        FURI_LOG_D(TAG, "Bulk: sending job %lu (%zu bytes)", tail, job->len);
+        if(flipper_wedge_hid_send_bulk(worker->hid, job->data, job->len)) {
+            tail++;
+        }
+    }
+
+    if(tail != worker->tail) {
+        __atomic_store_n(&worker->tail, tail, __ATOMIC_RELEASE);
+        flipper_wedge_hid_worker_log_stack("job");
+    }
+}
+
 static int32_t flipper_wedge_hid_worker_thread(void* context) {
     FlipperWedgeHidWorker* worker = context;
 
     FURI_LOG_I(TAG, "Worker thread started, mode=%d", worker->mode);
     flipper_wedge_debug_log(TAG, "Worker thread starting HID init (mode=%d)", worker->mode);
 
-    // Initialize HID interface in worker thread context
-    if(worker->mode == FlipperWedgeHidWorkerModeUsb) {
+    bool use_usb = (worker->mode == FlipperWedgeHidWorkerModeUsb ||
+                    worker->mode == FlipperWedgeHidWorkerModeUsbBle);
+    bool use_ble = (worker->mode == FlipperWedgeHidWorkerModeBle ||
+                    worker->mode == FlipperWedgeHidWorkerModeUsbBle);
+    bool use_bulk = (worker->mode == FlipperWedgeHidWorkerModeUsbBulk);
+
+    // Initialize HID interface(s) in worker thread context
+    if(use_usb) {
         flipper_wedge_hid_init_usb(worker->hid);
-    } else {
+    }
+    if(use_bulk) {
+        flipper_wedge_hid_set_bulk_request_callback(
+            worker->hid, flipper_wedge_hid_worker_bulk_request_callback, worker);
+        flipper_wedge_hid_init_usb_bulk(worker->hid);
+    }
+    if(use_ble) {
         flipper_wedge_hid_init_ble(worker->hid);
     }
 
-    FURI_LOG_I(TAG, "Worker thread HID initialized, waiting for stop signal");
+    uint32_t now = furi_get_tick();
+    for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount; transport++) {
+        FlipperWedgeHidWorkerLane* lane = &worker->lanes[transport];
+        lane->active = (transport == FlipperWedgeHidTransportUsb) ? use_usb : use_ble;
+        lane->job = worker->tail;
+        lane->started = false;
+        lane->text_job = worker->tail - 1;
+        lane->ready_tick = now;
+    }
+
+    FURI_LOG_I(TAG, "Worker thread HID initialized, waiting for jobs");
     flipper_wedge_debug_log(TAG, "Worker thread HID init complete, entering wait loop");
+    flipper_wedge_hid_worker_log_stack("init");
 
-    // Wait for stop signal
+    // Type queued jobs until stop signal, waking early when a lane's pacer is due
+    uint32_t timeout = FuriWaitForever;
     while(true) {
         uint32_t events = furi_thread_flags_wait(
-            FlipperWedgeHidWorkerEventStop,
-            FuriFlagWaitAny,
-            FuriWaitForever);
+            FlipperWedgeHidWorkerEventStop | FlipperWedgeHidWorkerEventJob |
+                FlipperWedgeHidWorkerEventBulkRequest,
+            FuriFlagWaitAny | FuriFlagNoClear,
+            timeout);
+
+        if(!(events & FuriFlagError)) {
+            if(events & FlipperWedgeHidWorkerEventStop) {
+                FURI_LOG_I(TAG, "Worker thread received stop signal");
+                flipper_wedge_debug_log(TAG, "Worker thread stopping, deiniting HID");
+                break;
+            }
+            if(events & FlipperWedgeHidWorkerEventJob) {
+                furi_thread_flags_clear(FlipperWedgeHidWorkerEventJob);
+                // Also sent by a cancel, which waits for the slots to be freed
+                if(use_bulk) {
+                    flipper_wedge_hid_worker_drop_cancelled(
+                        worker, __atomic_load_n(&worker->head, __ATOMIC_ACQUIRE));
+                }
+            }
+            if(events & FlipperWedgeHidWorkerEventBulkRequest) {
+                furi_thread_flags_clear(FlipperWedgeHidWorkerEventBulkRequest);
+                flipper_wedge_hid_worker_serve_bulk(worker);
+            }
+        }
 
-        if(events & FlipperWedgeHidWorkerEventStop) {
-            FURI_LOG_I(TAG, "Worker thread received stop signal");
-            flipper_wedge_debug_log(TAG, "Worker thread stopping, deiniting HID");
-            break;
+        // Bulk jobs wait for the host to pull them, only keyboard lanes are driven here
+        timeout = use_bulk ? FuriWaitForever : flipper_wedge_hid_worker_service(worker);
+    }
+
+    // Leave nothing held on the hosts if we stopped mid-job
+    for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount; transport++) {
+        if(worker->lanes[transport].active && worker->lanes[transport].started) {
+            flipper_wedge_hid_release_all_on(worker->hid, transport);
         }
+        worker->lanes[transport].active = false;
     }
 
-    // Deinitialize HID interface in worker thread context
-    if(worker->mode == FlipperWedgeHidWorkerModeUsb) {
-        flipper_wedge_hid_deinit_usb(worker->hid);
-    } else {
+    // Deinitialize HID interface(s) in worker thread context
+    if(use_bulk) {
+        flipper_wedge_hid_deinit_usb_bulk(worker->hid);
+        flipper_wedge_hid_set_bulk_request_callback(worker->hid, NULL, NULL);
+    }
+    if(use_ble) {
         flipper_wedge_hid_deinit_ble(worker->hid);
     }
+    if(use_usb) {
+        flipper_wedge_hid_deinit_usb(worker->hid);
+    }
 
     FURI_LOG_I(TAG, "Worker thread exiting");
     flipper_wedge_debug_log(TAG, "Worker thread HID deinit complete, exiting");
@@ -62,6 +413,19 @@ FlipperWedgeHidWorker* flipper_wedge_hid_worker_alloc(void) {
     worker->hid = flipper_wedge_hid_alloc();
     worker->thread = NULL;
     worker->mode = FlipperWedgeHidWorkerModeUsb;
+    worker->slot_data = NULL;
+    worker->queue_size = 0;
+    worker->slot_size = 0;
+    worker->head = 0;
+    worker->tail = 0;
+    worker->cancel_before = 0;
+    worker->progress_typed = 0;
+    worker->progress_total = 0;
+    for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount; transport++) {
+        worker->lanes[transport].active = false;
+        worker->lanes[transport].job = 0;
+        worker->lanes[transport].started = false;
+    }
 
     return worker;
 }
@@ -86,9 +450,26 @@ void flipper_wedge_hid_worker_start(FlipperWedgeHidWorker* worker, FlipperWedgeH
     flipper_wedge_debug_log(TAG, "Starting worker thread (mode=%d)", mode);
 
     worker->mode = mode;
+    worker->head = 0;
+    worker->tail = 0;
+    worker->cancel_before = 0;
+
+    // Typing slots hold the text, bulk slots the encoded message
+    if(mode == FlipperWedgeHidWorkerModeUsbBulk) {
+        worker->queue_size = FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_BULK;
+        worker->slot_size = FLIPPER_WEDGE_HID_WORKER_BULK_MAX_LEN;
+    } else {
+        worker->queue_size = FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_TYPING;
+        worker->slot_size = FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN + 1;
+    }
+    worker->slot_data = malloc(worker->queue_size * worker->slot_size);
+    for(uint32_t i = 0; i < worker->queue_size; i++) {
+        worker->jobs[i].data = worker->slot_data + i * worker->slot_size;
+    }
+
     worker->thread = furi_thread_alloc_ex(
         "FlipperWedgeHidWorker",
-        2048,  // Stack size
+        FLIPPER_WEDGE_HID_WORKER_STACK_SIZE,
         flipper_wedge_hid_worker_thread,
         worker);
 
@@ -111,7 +492,7 @@ void flipper_wedge_hid_worker_stop(FlipperWedgeHidWorker* worker) {
     FURI_LOG_I(TAG, "Stopping worker thread");
     flipper_wedge_debug_log(TAG, "Signaling worker thread to stop");
 
-    // Signal thread to stop
+    // Signal thread to stop, it checks between reports so typing in progress is cut short
     furi_thread_flags_set(furi_thread_get_id(worker->thread), FlipperWedgeHidWorkerEventStop);
 
     // Wait for thread to exit
@@ -122,6 +503,15 @@ void flipper_wedge_hid_worker_stop(FlipperWedgeHidWorker* worker) {
     furi_thread_free(worker->thread);
     worker->thread = NULL;
 
+    // Drop jobs the worker didn't get to
+    if(worker->head != worker->tail) {
+        FURI_LOG_W(TAG, "Dropping %lu queued typing jobs", worker->head - worker->tail);
+    }
+    worker->tail = worker->head;
+
+    free(worker->slot_data);
+    worker->slot_data = NULL;
+
     FURI_LOG_I(TAG, "Worker thread stopped");
     flipper_wedge_debug_log(TAG, "Worker thread stopped and cleaned up");
 }
@@ -135,3 +525,107 @@ bool flipper_wedge_hid_worker_is_running(FlipperWedgeHidWorker* worker) {
     furi_assert(worker);
     return (worker->thread != NULL);
 }
+
+bool flipper_wedge_hid_worker_type(
+    FlipperWedgeHidWorker* worker,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    bool append_enter) {
+    furi_assert(worker);
+    furi_assert(text);
+
+    if(!worker->thread) {
+        FURI_LOG_W(TAG, "Worker not running, can't queue typing");
+        return false;
+    }
+
+    uint32_t head = worker->head;
+    if(head - __atomic_load_n(&worker->tail, __ATOMIC_ACQUIRE) >= worker->queue_size) {
+        FURI_LOG_W(TAG, "Typing queue full");
+        return false;
+    }
+
+    // Copy the text, the lanes compile it through the layout as they type
+    FlipperWedgeHidWorkerJob* job = &worker->jobs[head % worker->queue_size];
+    size_t len = strlen(text);
+    if(len > FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN) {
+        // Cut at a character boundary
+        len = FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN;
+        while(len > 0 && ((uint8_t)text[len] & 0xC0) == 0x80) {
+            len--;
+        }
+        FURI_LOG_W(TAG, "Text too long, typing the first %zu of %zu bytes", len, strlen(text));
+    }
+    memcpy(job->data, text, len);
+    job->data[len] = '\0';
+    job->len = len;
+    job->layout = layout;
+    job->append_enter = append_enter;
+
+    // Publish the slot, then wake the worker
+    __atomic_store_n(&worker->head, head + 1, __ATOMIC_RELEASE);
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), FlipperWedgeHidWorkerEventJob);
+
+    return true;
+}
+
+bool flipper_wedge_hid_worker_send_bulk(
+    FlipperWedgeHidWorker* worker,
+    const FlipperWedgeBulkField* fields,
+    size_t count) {
+    furi_assert(worker);
+
+    if(!worker->thread || worker->mode != FlipperWedgeHidWorkerModeUsbBulk) {
+        FURI_LOG_W(TAG, "Worker not in bulk mode, can't queue message");
+        return false;
+    }
+
+    uint32_t head = worker->head;
+    if(head - __atomic_load_n(&worker->tail, __ATOMIC_ACQUIRE) >= worker->queue_size) {
+        FURI_LOG_W(TAG, "Bulk queue full");
+        return false;
+    }
+
+    FlipperWedgeHidWorkerJob* job = &worker->jobs[head % worker->queue_size];
+    job->len = flipper_wedge_bulk_encode(
+        FlipperWedgeBulkMessageScan, fields, count, job->data, worker->slot_size);
+    job->layout = NULL;
+    job->append_enter = false;
+
+    // Publish the slot, the host picks it up with its next request
+    __atomic_store_n(&worker->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+bool flipper_wedge_hid_worker_is_busy(FlipperWedgeHidWorker* worker) {
+    furi_assert(worker);
+    return __atomic_load_n(&worker->tail, __ATOMIC_ACQUIRE) != worker->head;
+}
+
+void flipper_wedge_hid_worker_get_progress(FlipperWedgeHidWorker* worker, size_t* typed, size_t* total) {
+    furi_assert(worker);
+    if(typed) *typed = __atomic_load_n(&worker->progress_typed, __ATOMIC_RELAXED);
+    if(total) *total = __atomic_load_n(&worker->progress_total, __ATOMIC_RELAXED);
+}
+
+void flipper_wedge_hid_worker_cancel(FlipperWedgeHidWorker* worker) {
+    furi_assert(worker);
+
+    // Lanes check this before every report
+    uint32_t head = worker->head;
+    __atomic_store_n(&worker->cancel_before, head, __ATOMIC_RELEASE);
+    if(!worker->thread) return;
+
+    // Wake the worker and wait until it let go of the cancelled jobs, so their
+    // slots are free for the next job and nothing is typed after this returns
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), FlipperWedgeHidWorkerEventJob);
+    uint32_t start = furi_get_tick();
+    while((int32_t)(__atomic_load_n(&worker->tail, __ATOMIC_ACQUIRE) - head) < 0) {
+        if(furi_get_tick() - start > furi_ms_to_ticks(FLIPPER_WEDGE_HID_WORKER_CANCEL_TIMEOUT_MS)) {
+            FURI_LOG_W(TAG, "Cancel timed out, worker still on job %lu", worker->tail);
+            break;
+        }
+        furi_delay_ms(1);
+    }
+}
@@ -2,12 +2,28 @@
 
 #include <furi.h>
 #include "flipper_wedge_hid.h"
+#include "flipper_wedge_keystream.h"
+#include "flipper_wedge_bulk.h"
+
+// Jobs the scene can queue ahead of the worker (powers of two). A new scan
+// cancels what is still being typed before it queues, so one slot is typed
+// while the next job waits in the other. Bulk scans wait for the host to
+// read them and are kept, so a few more of them queue up.
+#define FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_TYPING 2
+#define FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_BULK 4
+// Longest text a single job can carry (matches FLIPPER_WEDGE_OUTPUT_MAX_LEN)
+#define FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN 1200
+// Longest encoded bulk message: header, output text, both UIDs, RFID
+// protocol name, NDEF text and timestamp at their buffer sizes (2301 bytes)
+#define FLIPPER_WEDGE_HID_WORKER_BULK_MAX_LEN 2304
 
 typedef struct FlipperWedgeHidWorker FlipperWedgeHidWorker;
 
 typedef enum {
     FlipperWedgeHidWorkerModeUsb,
     FlipperWedgeHidWorkerModeBle,
+    FlipperWedgeHidWorkerModeUsbBle, // Both at once, each paced independently
+    FlipperWedgeHidWorkerModeUsbBulk, // Scans as binary messages, no keyboard
 } FlipperWedgeHidWorkerMode;
 
 /** Allocate HID worker
@@ -28,13 +44,13 @@ void flipper_wedge_hid_worker_free(FlipperWedgeHidWorker* worker);
  * Creates worker thread that initializes HID interface
  *
  * @param worker FlipperWedgeHidWorker instance
- * @param mode USB or BLE mode
+ * @param mode USB, BLE, both, or USB bulk
  */
 void flipper_wedge_hid_worker_start(FlipperWedgeHidWorker* worker, FlipperWedgeHidWorkerMode mode);
 
 /** Stop HID worker
  * Signals worker thread to exit and deinit HID interface
- * Blocks until worker thread exits
+ * Blocks until worker thread exits, queued jobs are dropped
  *
  * @param worker FlipperWedgeHidWorker instance
  */
@@ -54,3 +70,64 @@ FlipperWedgeHid* flipper_wedge_hid_worker_get_hid(FlipperWedgeHidWorker* worker)
  * @return true if worker thread is active
  */
 bool flipper_wedge_hid_worker_is_running(FlipperWedgeHidWorker* worker);
+
+/** Queue text for typing
+ * Copies text into the job queue and returns immediately, the worker
+ * thread compiles it through the layout as it types. The layout must not
+ * change until the job is done or cancelled.
+ * Single producer: call from the GUI thread only.
+ *
+ * @param worker FlipperWedgeHidWorker instance
+ * @param layout Keyboard layout for character mapping (NULL for firmware default)
+ * @param text Text to type, cut to FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN bytes
+ *             at a character boundary
+ * @param append_enter Press Enter after the text
+ * @return true if queued, false if worker is not running or queue is full
+ */
+bool flipper_wedge_hid_worker_type(
+    FlipperWedgeHidWorker* worker,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    bool append_enter);
+
+/** Cancel queued and in-progress typing
+ * Queued jobs are dropped, the job being typed stops at the next report
+ * boundary with all keys released. Waits until the worker has let go of
+ * them, so their slots are free and the queue has room for the next job.
+ * Jobs queued afterwards are typed normally. Call from the GUI thread only.
+ *
+ * @param worker FlipperWedgeHidWorker instance
+ */
+void flipper_wedge_hid_worker_cancel(FlipperWedgeHidWorker* worker);
+
+/** Queue a scan as a bulk message (USB Bulk mode only)
+ * Encodes the fields into the job queue and returns immediately, the
+ * message is sent when the host reader next asks for data.
+ * Single producer: call from the GUI thread only.
+ *
+ * @param worker FlipperWedgeHidWorker instance
+ * @param fields Message fields, see flipper_wedge_bulk.h
+ * @param count Number of fields
+ * @return true if queued, false if not in bulk mode or queue is full
+ */
+bool flipper_wedge_hid_worker_send_bulk(
+    FlipperWedgeHidWorker* worker,
+    const FlipperWedgeBulkField* fields,
+    size_t count);
+
+/** Check if worker has queued or in-progress typing
+ *
+ * @param worker FlipperWedgeHidWorker instance
+ * @return true if typing is pending
+ */
+bool flipper_wedge_hid_worker_is_busy(FlipperWedgeHidWorker* worker);
+
+/** Get progress of the oldest job still being typed
+ * Updated after every report. With both outputs active it follows the
+ * slower transport. Holds the last finished job once the queue is empty.
+ *
+ * @param worker FlipperWedgeHidWorker instance
+ * @param typed Characters typed so far, Enter counts as one (may be NULL)
+ * @param total Characters in the job, 0 until typing started (may be NULL)
+ */
+void flipper_wedge_hid_worker_get_progress(FlipperWedgeHidWorker* worker, size_t* typed, size_t* total);
@@ -1,246 +1,492 @@
 #include "flipper_wedge_keyboard_layout.h"
+#include "flipper_wedge_keyboard_layout_tables.h"
 #include <flipper_format/flipper_format.h>
 #include <lib/toolbox/path.h>
 
 #define TAG "FlipperWedgeKeyboardLayout"
 
 #define LAYOUT_FILE_TYPE "Flipper Wedge Keyboard Layout"
-#define LAYOUT_FILE_VERSION 1
-
-// NumPad keycodes from hid_usage_keyboard.h
-// NOTE: Digits 0-9 (0x62, 0x59-0x61) are standard HID numpad keycodes.
-// Hex letters A-F (0xBC-0xC1) are NON-STANDARD extended keycodes.
-// Standard USB HID does not define numpad A-F keys, so these may not
-// work on all operating systems or applications. NumPad mode is primarily
-// useful for typing digits 0-9 on systems where the number row layout differs.
-#define HID_KEYPAD_NUMLOCK 0x53
-#define HID_KEYPAD_0       0x62
-#define HID_KEYPAD_1       0x59
-#define HID_KEYPAD_2       0x5A
-#define HID_KEYPAD_3       0x5B
-#define HID_KEYPAD_4       0x5C
-#define HID_KEYPAD_5       0x5D
-#define HID_KEYPAD_6       0x5E
-#define HID_KEYPAD_7       0x5F
-#define HID_KEYPAD_8       0x60
-#define HID_KEYPAD_9       0x61
-#define HID_KEYPAD_A       0xBC  // Non-standard
-#define HID_KEYPAD_B       0xBD  // Non-standard
-#define HID_KEYPAD_C       0xBE  // Non-standard
-#define HID_KEYPAD_D       0xBF  // Non-standard
-#define HID_KEYPAD_E       0xC0  // Non-standard
-#define HID_KEYPAD_F       0xC1  // Non-standard
+#define LAYOUT_FILE_VERSION 2 // 2 adds multi-stroke values and ALTGR/CTRL/ALT
+#define LAYOUT_READ_CHUNK 128
+#define LAYOUT_LINE_MAX 64
+
+#define LAYOUT_CACHE_DIRECTORY FLIPPER_WEDGE_LAYOUTS_DIRECTORY "/.cache"
+#define LAYOUT_CACHE_MAGIC 0x434C5746 // "FWLC"
+#define LAYOUT_CACHE_VERSION 2
 
 static const char* layout_type_names[] = {
     [FlipperWedgeLayoutDefault] = "Default (QWERTY)",
     [FlipperWedgeLayoutNumPad] = "NumPad",
     [FlipperWedgeLayoutCustom] = "Custom",
+    [FlipperWedgeLayoutAzerty] = "AZERTY (French)",
+    [FlipperWedgeLayoutQwertz] = "QWERTZ (German)",
+    [FlipperWedgeLayoutHungarian] = "Hungarian",
+    [FlipperWedgeLayoutDvorak] = "Dvorak (US)",
+};
+
+static const char* unicode_mode_names[] = {
+    [FlipperWedgeUnicodeOff] = "OFF",
+    [FlipperWedgeUnicodeLayout] = "Layout",
+    [FlipperWedgeUnicodeLinux] = "Linux",
+    [FlipperWedgeUnicodeWindows] = "Windows",
 };
 
+// Custom layout being parsed or read from cache
+typedef struct {
+    char name[FLIPPER_WEDGE_LAYOUT_NAME_MAX];
+    // FLIPPER_WEDGE_LAYOUT_TABLE_SIZE entries, then the sequence pool
+    uint16_t* keycodes;
+    size_t sequences_len; // Pool slots in use
+} LayoutParsed;
+
+#define LAYOUT_PARSED_SIZE (FLIPPER_WEDGE_LAYOUT_TABLE_SIZE + FLIPPER_WEDGE_LAYOUT_SEQUENCE_POOL)
+
 FlipperWedgeKeyboardLayout* flipper_wedge_keyboard_layout_alloc(void) {
     FlipperWedgeKeyboardLayout* layout = malloc(sizeof(FlipperWedgeKeyboardLayout));
+    layout->custom = NULL;
+    layout->unicode_mode = FlipperWedgeUnicodeOff;
     flipper_wedge_keyboard_layout_set_default(layout);
     return layout;
 }
 
 void flipper_wedge_keyboard_layout_free(FlipperWedgeKeyboardLayout* layout) {
     furi_assert(layout);
+    free(layout->custom);
     free(layout);
 }
 
-void flipper_wedge_keyboard_layout_set_default(FlipperWedgeKeyboardLayout* layout) {
-    furi_assert(layout);
+// Sequences depend on the table and the mode
+static void layout_unicode_cache_clear(FlipperWedgeKeyboardLayout* layout) {
+    memset(layout->unicode_cache, 0, sizeof(layout->unicode_cache));
+}
 
-    memset(layout, 0, sizeof(FlipperWedgeKeyboardLayout));
-    strncpy(layout->name, "Default (QWERTY)", FLIPPER_WEDGE_LAYOUT_NAME_MAX - 1);
-    layout->type = FlipperWedgeLayoutDefault;
-    // All mappings left as undefined - will use firmware default
+bool flipper_wedge_keyboard_layout_is_builtin(FlipperWedgeLayoutType type) {
+    return type < FlipperWedgeLayoutCount && type != FlipperWedgeLayoutCustom;
 }
 
-void flipper_wedge_keyboard_layout_set_numpad(FlipperWedgeKeyboardLayout* layout) {
+void flipper_wedge_keyboard_layout_set_builtin(FlipperWedgeKeyboardLayout* layout, FlipperWedgeLayoutType type) {
     furi_assert(layout);
-
-    memset(layout, 0, sizeof(FlipperWedgeKeyboardLayout));
-    strncpy(layout->name, "NumPad", FLIPPER_WEDGE_LAYOUT_NAME_MAX - 1);
-    layout->type = FlipperWedgeLayoutNumPad;
-
-    // Map digits 0-9 to numpad keycodes
-    layout->map['0'].keycode = HID_KEYPAD_0;
-    layout->map['0'].defined = true;
-    layout->map['1'].keycode = HID_KEYPAD_1;
-    layout->map['1'].defined = true;
-    layout->map['2'].keycode = HID_KEYPAD_2;
-    layout->map['2'].defined = true;
-    layout->map['3'].keycode = HID_KEYPAD_3;
-    layout->map['3'].defined = true;
-    layout->map['4'].keycode = HID_KEYPAD_4;
-    layout->map['4'].defined = true;
-    layout->map['5'].keycode = HID_KEYPAD_5;
-    layout->map['5'].defined = true;
-    layout->map['6'].keycode = HID_KEYPAD_6;
-    layout->map['6'].defined = true;
-    layout->map['7'].keycode = HID_KEYPAD_7;
-    layout->map['7'].defined = true;
-    layout->map['8'].keycode = HID_KEYPAD_8;
-    layout->map['8'].defined = true;
-    layout->map['9'].keycode = HID_KEYPAD_9;
-    layout->map['9'].defined = true;
-
-    // Map hex letters A-F (uppercase)
-    layout->map['A'].keycode = HID_KEYPAD_A;
-    layout->map['A'].defined = true;
-    layout->map['B'].keycode = HID_KEYPAD_B;
-    layout->map['B'].defined = true;
-    layout->map['C'].keycode = HID_KEYPAD_C;
-    layout->map['C'].defined = true;
-    layout->map['D'].keycode = HID_KEYPAD_D;
-    layout->map['D'].defined = true;
-    layout->map['E'].keycode = HID_KEYPAD_E;
-    layout->map['E'].defined = true;
-    layout->map['F'].keycode = HID_KEYPAD_F;
-    layout->map['F'].defined = true;
-
-    // Map hex letters a-f (lowercase) - same keycodes, no shift
-    layout->map['a'].keycode = HID_KEYPAD_A;
-    layout->map['a'].defined = true;
-    layout->map['b'].keycode = HID_KEYPAD_B;
-    layout->map['b'].defined = true;
-    layout->map['c'].keycode = HID_KEYPAD_C;
-    layout->map['c'].defined = true;
-    layout->map['d'].keycode = HID_KEYPAD_D;
-    layout->map['d'].defined = true;
-    layout->map['e'].keycode = HID_KEYPAD_E;
-    layout->map['e'].defined = true;
-    layout->map['f'].keycode = HID_KEYPAD_F;
-    layout->map['f'].defined = true;
+    furi_assert(flipper_wedge_keyboard_layout_is_builtin(type));
+
+    // Switching back to a custom layout reloads it, so drop its table
+    free(layout->custom);
+    layout->custom = NULL;
+    strlcpy(layout->name, layout_type_names[type], FLIPPER_WEDGE_LAYOUT_NAME_MAX);
+    layout->file_path[0] = '\0';
+    layout->type = type;
+    layout->table = flipper_wedge_keyboard_layout_table(type);
+    layout->sequences = flipper_wedge_keyboard_layout_sequences(type);
+    layout_unicode_cache_clear(layout);
 }
 
-bool flipper_wedge_keyboard_layout_load(FlipperWedgeKeyboardLayout* layout, const char* path) {
-    furi_assert(layout);
-    furi_assert(path);
+void flipper_wedge_keyboard_layout_set_default(FlipperWedgeKeyboardLayout* layout) {
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutDefault);
+}
 
-    FURI_LOG_I(TAG, "Loading layout from: %s", path);
+void flipper_wedge_keyboard_layout_set_numpad(FlipperWedgeKeyboardLayout* layout) {
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutNumPad);
+}
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    FlipperFormat* file = flipper_format_file_alloc(storage);
-    bool success = false;
+// Buffered line reader, the layout file is read front to back exactly once
+typedef struct {
+    File* file;
+    uint8_t buffer[LAYOUT_READ_CHUNK];
+    size_t len;
+    size_t pos;
+} LayoutReader;
+
+// Read one line without its terminator. Overlong lines are consumed whole
+// and flagged, so a bad line never shifts the ones after it.
+static bool layout_read_line(LayoutReader* reader, char* line, size_t size, bool* overlong) {
+    size_t len = 0;
+    bool got_any = false;
+    *overlong = false;
+
+    while(true) {
+        if(reader->pos == reader->len) {
+            reader->len = storage_file_read(reader->file, reader->buffer, sizeof(reader->buffer));
+            reader->pos = 0;
+            if(reader->len == 0) break;
+        }
 
-    do {
-        if(!flipper_format_file_open_existing(file, path)) {
-            FURI_LOG_E(TAG, "Failed to open file: %s", path);
-            break;
+        char c = reader->buffer[reader->pos++];
+        got_any = true;
+        if(c == '\n') break;
+        if(c == '\r') continue;
+        if(len < size - 1) {
+            line[len++] = c;
+        } else {
+            *overlong = true;
         }
+    }
 
-        // Check file type and version
-        FuriString* file_type = furi_string_alloc();
-        uint32_t version = 0;
+    // Trailing blanks carry no meaning and would confuse value parsing
+    while(len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t')) len--;
+    line[len] = '\0';
+    return got_any;
+}
 
-        if(!flipper_format_read_header(file, file_type, &version)) {
-            FURI_LOG_E(TAG, "Failed to read header");
-            furi_string_free(file_type);
-            break;
-        }
+// Keys that can't be written as the character itself: whitespace, and '#'
+// which starts a comment
+static const struct {
+    const char* name;
+    char c;
+} layout_named_keys[] = {
+    {"SPACE", ' '},
+    {"TAB", '\t'},
+    {"ENTER", '\n'},
+    {"HASH", '#'},
+};
 
-        if(furi_string_cmp_str(file_type, LAYOUT_FILE_TYPE) != 0) {
-            FURI_LOG_E(TAG, "Invalid file type: %s", furi_string_get_cstr(file_type));
-            furi_string_free(file_type);
-            break;
-        }
+static const struct {
+    const char* name;
+    uint16_t modifier;
+} layout_modifiers[] = {
+    {"SHIFT", KEY_MOD_LEFT_SHIFT},
+    {"ALTGR", KEY_MOD_RIGHT_ALT},
+    {"CTRL", KEY_MOD_LEFT_CTRL},
+    {"ALT", KEY_MOD_LEFT_ALT},
+};
 
-        if(version > LAYOUT_FILE_VERSION) {
-            FURI_LOG_E(TAG, "Unsupported version: %lu", version);
-            furi_string_free(file_type);
-            break;
+// Parse one stroke "<keycode> [MODIFIER...]", keycode decimal or 0x hex,
+// 1..255. Stops at the ',' before the next stroke or the end of value.
+static const char* layout_parse_stroke(const char* value, uint16_t* keycode) {
+    char* end = NULL;
+    unsigned long code;
+    if(value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+        code = strtoul(value + 2, &end, 16);
+        if(end == value + 2) return NULL;
+    } else {
+        code = strtoul(value, &end, 10);
+        if(end == value) return NULL;
+    }
+    if(code == 0 || code > 0xFF) return NULL;
+
+    uint16_t modifiers = 0;
+    while(true) {
+        while(*end == ' ' || *end == '\t') end++;
+        if(*end == '\0' || *end == ',') break;
+
+        size_t len = strcspn(end, " \t,");
+        size_t i = 0;
+        for(; i < COUNT_OF(layout_modifiers); i++) {
+            if(strlen(layout_modifiers[i].name) == len &&
+               strncasecmp(end, layout_modifiers[i].name, len) == 0) {
+                break;
+            }
         }
+        if(i == COUNT_OF(layout_modifiers)) return NULL;
+        modifiers |= layout_modifiers[i].modifier;
+        end += len;
+    }
 
-        furi_string_free(file_type);
+    *keycode = code | modifiers;
+    return end;
+}
 
-        // Clear layout and set type
-        memset(layout->map, 0, sizeof(layout->map));
-        layout->type = FlipperWedgeLayoutCustom;
-        strncpy(layout->file_path, path, FLIPPER_WEDGE_LAYOUT_PATH_MAX - 1);
+// Parse a value of comma separated strokes, returns the stroke count or 0
+static uint8_t layout_parse_value(const char* value, uint16_t* keys) {
+    uint8_t count = 0;
+    while(count < FLIPPER_WEDGE_LAYOUT_STROKES_MAX) {
+        while(*value == ' ' || *value == '\t') value++;
+        value = layout_parse_stroke(value, &keys[count]);
+        if(!value) return 0;
+        count++;
+        if(*value == '\0') return count;
+        value++; // ','
+    }
+    return 0; // More strokes than fit
+}
 
-        // Read layout name
-        FuriString* name = furi_string_alloc();
-        if(flipper_format_read_string(file, "Name", name)) {
-            strncpy(layout->name, furi_string_get_cstr(name), FLIPPER_WEDGE_LAYOUT_NAME_MAX - 1);
-        } else {
+// Parse a layout text file into parsed (already cleared by the caller)
+static bool layout_parse_text(Storage* storage, const char* path, LayoutParsed* parsed) {
+    LayoutReader* reader = malloc(sizeof(LayoutReader));
+    reader->file = storage_file_alloc(storage);
+    reader->len = 0;
+    reader->pos = 0;
+
+    char line[LAYOUT_LINE_MAX];
+    bool overlong;
+    uint32_t line_no = 0;
+    bool header_ok = false;
+    bool version_ok = false;
+    size_t mapped = 0;
+    size_t errors = 0;
+
+    if(!storage_file_open(reader->file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(TAG, "Failed to open file: %s", path);
+    } else {
+        while(layout_read_line(reader, line, sizeof(line), &overlong)) {
+            line_no++;
+            if(line[0] == '\0' || line[0] == '#') continue;
+
+            if(overlong) {
+                FURI_LOG_W(TAG, "Line %lu: too long, skipped", line_no);
+                errors++;
+                continue;
+            }
+
+            // Single character keys are taken literally, so "::" maps ':'
+            const char* key = line;
+            const char* sep = (line[1] == ':') ? &line[1] : strchr(line, ':');
+            if(!sep || (sep[1] != ' ' && sep[1] != '\0')) {
+                FURI_LOG_W(TAG, "Line %lu: expected '<key>: <value>'", line_no);
+                errors++;
+                continue;
+            }
+            size_t key_len = sep - key;
+            const char* value = sep + 1;
+            while(*value == ' ') value++;
+
+            // Header must come first
+            if(!header_ok) {
+                if(key_len != 8 || strncmp(key, "Filetype", 8) != 0 ||
+                   strcmp(value, LAYOUT_FILE_TYPE) != 0) {
+                    FURI_LOG_E(TAG, "Line %lu: not a keyboard layout file", line_no);
+                    break;
+                }
+                header_ok = true;
+                continue;
+            }
+            if(!version_ok) {
+                uint32_t version = strtoul(value, NULL, 10);
+                if(key_len != 7 || strncmp(key, "Version", 7) != 0 || version == 0 ||
+                   version > LAYOUT_FILE_VERSION) {
+                    FURI_LOG_E(TAG, "Line %lu: unsupported version", line_no);
+                    break;
+                }
+                version_ok = true;
+                continue;
+            }
+            if(key_len == 4 && strncmp(key, "Name", 4) == 0) {
+                strlcpy(parsed->name, value, FLIPPER_WEDGE_LAYOUT_NAME_MAX);
+                continue;
+            }
+
+            int c = -1;
+            if(key_len == 1) {
+                c = (uint8_t)key[0];
+            } else {
+                for(size_t i = 0; i < COUNT_OF(layout_named_keys); i++) {
+                    const char* name = layout_named_keys[i].name;
+                    if(strlen(name) == key_len && strncasecmp(key, name, key_len) == 0) {
+                        c = (uint8_t)layout_named_keys[i].c;
+                        break;
+                    }
+                }
+            }
+            if(c < ' ' && c != '\t' && c != '\n') c = -1;
+            if(c < 0 || c >= 127) {
+                FURI_LOG_W(TAG, "Line %lu: unknown key '%.*s'", line_no, (int)key_len, key);
+                errors++;
+                continue;
+            }
+
+            uint16_t keys[FLIPPER_WEDGE_LAYOUT_STROKES_MAX];
+            uint8_t count = layout_parse_value(value, keys);
+            if(count == 0) {
+                FURI_LOG_W(TAG, "Line %lu: bad keycode '%s'", line_no, value);
+                errors++;
+                continue;
+            }
+
+            uint16_t entry = keys[0];
+            if(count > 1) {
+                // Stored once in the pool, a redefinition leaves its old slots unused
+                if(parsed->sequences_len + 1 + count > FLIPPER_WEDGE_LAYOUT_SEQUENCE_POOL) {
+                    FURI_LOG_W(TAG, "Line %lu: too many multi-stroke keys", line_no);
+                    errors++;
+                    continue;
+                }
+                uint16_t* pool = parsed->keycodes + FLIPPER_WEDGE_LAYOUT_TABLE_SIZE;
+                entry = FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG | parsed->sequences_len;
+                pool[parsed->sequences_len++] = count;
+                memcpy(&pool[parsed->sequences_len], keys, count * sizeof(uint16_t));
+                parsed->sequences_len += count;
+            }
+
+            if(parsed->keycodes[c] == HID_KEYBOARD_NONE) mapped++;
+            parsed->keycodes[c] = entry;
+        }
+    }
+
+    bool success = header_ok && version_ok;
+    if(success) {
+        if(parsed->name[0] == '\0') {
             // Use filename as fallback name
             FuriString* filename = furi_string_alloc();
             path_extract_filename_no_ext(path, filename);
-            strncpy(layout->name, furi_string_get_cstr(filename), FLIPPER_WEDGE_LAYOUT_NAME_MAX - 1);
+            strlcpy(parsed->name, furi_string_get_cstr(filename), FLIPPER_WEDGE_LAYOUT_NAME_MAX);
             furi_string_free(filename);
-            // Rewind to continue reading mappings
-            flipper_format_rewind(file);
-            // Skip header again
-            uint32_t dummy_ver;
-            FuriString* dummy_type = furi_string_alloc();
-            flipper_format_read_header(file, dummy_type, &dummy_ver);
-            furi_string_free(dummy_type);
         }
-        furi_string_free(name);
-
-        // Read character mappings
-        // Format: single character key, value is "keycode" or "keycode SHIFT"
-        FuriString* value = furi_string_alloc();
-
-        // Only lookup characters we actually need for hex UIDs and delimiters
-        // (27 lookups instead of 95 - ~3.5x faster)
-        static const char* chars_to_lookup = "0123456789ABCDEFabcdef-:,.;";
-        for(size_t i = 0; chars_to_lookup[i] != '\0'; i++) {
-            char c = chars_to_lookup[i];
-            char key[2] = {c, '\0'};
-
-            if(flipper_format_read_string(file, key, value)) {
-                // Parse value: "keycode" or "keycode SHIFT"
-                const char* val_str = furi_string_get_cstr(value);
-                uint32_t keycode = 0;
-                bool has_shift = false;
-
-                // Check for SHIFT modifier
-                if(strstr(val_str, "SHIFT") != NULL || strstr(val_str, "shift") != NULL) {
-                    has_shift = true;
-                }
+        FURI_LOG_I(
+            TAG, "Parsed layout: %s (%zu keys, %zu bad lines)", parsed->name, mapped, errors);
+    } else if(header_ok) {
+        FURI_LOG_E(TAG, "Missing version line");
+    }
 
-                // Parse keycode (decimal or hex)
-                if(val_str[0] == '0' && (val_str[1] == 'x' || val_str[1] == 'X')) {
-                    keycode = strtoul(val_str, NULL, 16);
-                } else {
-                    keycode = strtoul(val_str, NULL, 10);
-                }
+    storage_file_close(reader->file);
+    storage_file_free(reader->file);
+    free(reader);
 
-                if(keycode > 0 && keycode < 256) {
-                    layout->map[(uint8_t)c].keycode = keycode;
-                    if(has_shift) {
-                        layout->map[(uint8_t)c].keycode |= KEY_MOD_LEFT_SHIFT;
-                    }
-                    layout->map[(uint8_t)c].defined = true;
-                    FURI_LOG_D(TAG, "Mapped '%c' -> 0x%04X", c, layout->map[(uint8_t)c].keycode);
-                }
-            }
+    return success;
+}
 
-            // Rewind after each read attempt to try next key
-            flipper_format_rewind(file);
-            // Skip header
-            uint32_t dummy_ver;
-            FuriString* dummy_type = furi_string_alloc();
-            flipper_format_read_header(file, dummy_type, &dummy_ver);
-            furi_string_free(dummy_type);
-            // Skip Name if present
-            FuriString* dummy_name = furi_string_alloc();
-            flipper_format_read_string(file, "Name", dummy_name);
-            furi_string_free(dummy_name);
+// Compiled layout, one per source file in LAYOUT_CACHE_DIRECTORY.
+// Valid while the source keeps the mtime and size it was compiled from.
+// Fields are naturally aligned, so the struct is written as is.
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t source_mtime;
+    uint32_t source_size;
+    uint32_t path_hash; // Tells apart same-named files from other directories
+    uint32_t checksum; // Over everything after this field
+    char name[FLIPPER_WEDGE_LAYOUT_NAME_MAX];
+    uint32_t sequences_len;
+    uint16_t keycodes[LAYOUT_PARSED_SIZE]; // 0 = fall back to firmware default, then the pool
+} LayoutCacheBlob;
+
+static uint32_t layout_hash(const void* data, size_t len, uint32_t hash) {
+    const uint8_t* bytes = data;
+    for(size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 16777619UL; // FNV-1a
+    }
+    return hash;
+}
+
+static uint32_t layout_cache_checksum(const LayoutCacheBlob* blob) {
+    const size_t offset = offsetof(LayoutCacheBlob, checksum) + sizeof(blob->checksum);
+    return layout_hash((const uint8_t*)blob + offset, sizeof(LayoutCacheBlob) - offset, 2166136261UL);
+}
+
+static void layout_cache_path(const char* path, FuriString* cache_path) {
+    FuriString* filename = furi_string_alloc();
+    path_extract_filename_no_ext(path, filename);
+    furi_string_printf(
+        cache_path, "%s/%s.bin", LAYOUT_CACHE_DIRECTORY, furi_string_get_cstr(filename));
+    furi_string_free(filename);
+}
+
+static bool layout_cache_read(
+    Storage* storage,
+    const char* cache_path,
+    const LayoutCacheBlob* expected,
+    LayoutParsed* parsed) {
+    LayoutCacheBlob* blob = malloc(sizeof(LayoutCacheBlob));
+    File* file = storage_file_alloc(storage);
+    bool valid = false;
+
+    if(storage_file_open(file, cache_path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_read(file, blob, sizeof(LayoutCacheBlob)) == sizeof(LayoutCacheBlob)) {
+        valid = blob->magic == LAYOUT_CACHE_MAGIC && blob->version == LAYOUT_CACHE_VERSION &&
+                blob->source_mtime == expected->source_mtime &&
+                blob->source_size == expected->source_size &&
+                blob->path_hash == expected->path_hash &&
+                blob->sequences_len <= FLIPPER_WEDGE_LAYOUT_SEQUENCE_POOL &&
+                blob->checksum == layout_cache_checksum(blob);
+    }
+
+    if(valid) {
+        strlcpy(parsed->name, blob->name, FLIPPER_WEDGE_LAYOUT_NAME_MAX);
+        memcpy(parsed->keycodes, blob->keycodes, sizeof(blob->keycodes));
+        parsed->sequences_len = blob->sequences_len;
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    free(blob);
+    return valid;
+}
+
+static void layout_cache_write(
+    Storage* storage,
+    const char* cache_path,
+    const LayoutCacheBlob* source,
+    const LayoutParsed* parsed) {
+    LayoutCacheBlob* blob = malloc(sizeof(LayoutCacheBlob));
+    memcpy(blob, source, sizeof(LayoutCacheBlob));
+    strncpy(blob->name, parsed->name, FLIPPER_WEDGE_LAYOUT_NAME_MAX);
+    blob->sequences_len = parsed->sequences_len;
+    memcpy(blob->keycodes, parsed->keycodes, sizeof(blob->keycodes));
+    blob->checksum = layout_cache_checksum(blob);
+
+    storage_common_mkdir(storage, LAYOUT_CACHE_DIRECTORY);
+    File* file = storage_file_alloc(storage);
+    if(!storage_file_open(file, cache_path, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       storage_file_write(file, blob, sizeof(LayoutCacheBlob)) != sizeof(LayoutCacheBlob)) {
+        // Only costs a reparse next time
+        FURI_LOG_W(TAG, "Failed to write layout cache: %s", cache_path);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    free(blob);
+}
+
+bool flipper_wedge_keyboard_layout_load(FlipperWedgeKeyboardLayout* layout, const char* path) {
+    furi_assert(layout);
+    furi_assert(path);
+
+    FURI_LOG_I(TAG, "Loading layout from: %s", path);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    // Fill a fresh table so a rejected file leaves the layout unchanged
+    LayoutParsed parsed = {
+        .keycodes = malloc(LAYOUT_PARSED_SIZE * sizeof(uint16_t)),
+    };
+    memset(parsed.keycodes, 0, LAYOUT_PARSED_SIZE * sizeof(uint16_t));
+
+    bool success = false;
+    FileInfo info;
+    if(storage_common_stat(storage, path, &info) != FSE_OK) {
+        FURI_LOG_E(TAG, "Failed to open file: %s", path);
+    } else {
+        LayoutCacheBlob source = {
+            .magic = LAYOUT_CACHE_MAGIC,
+            .version = LAYOUT_CACHE_VERSION,
+            .source_size = info.size,
+            .path_hash = layout_hash(path, strlen(path), 2166136261UL),
+        };
+        bool have_mtime =
+            storage_common_timestamp(storage, path, &source.source_mtime) == FSE_OK;
+
+        FuriString* cache_path = furi_string_alloc();
+        layout_cache_path(path, cache_path);
+
+        if(have_mtime && layout_cache_read(storage, furi_string_get_cstr(cache_path), &source, &parsed)) {
+            FURI_LOG_D(TAG, "Layout cache hit: %s", furi_string_get_cstr(cache_path));
+            success = true;
+        } else if(layout_parse_text(storage, path, &parsed)) {
+            // Without an mtime the cache could never be validated, don't write one
+            if(have_mtime) {
+                layout_cache_write(storage, furi_string_get_cstr(cache_path), &source, &parsed);
+            }
+            success = true;
         }
 
-        furi_string_free(value);
-        success = true;
+        furi_string_free(cache_path);
+    }
 
+    if(success) {
+        // Only keep the part of the pool that is in use
+        free(layout->custom);
+        layout->custom = realloc(
+            parsed.keycodes,
+            (FLIPPER_WEDGE_LAYOUT_TABLE_SIZE + parsed.sequences_len) * sizeof(uint16_t));
+        layout->table = layout->custom;
+        layout->sequences =
+            parsed.sequences_len ? layout->custom + FLIPPER_WEDGE_LAYOUT_TABLE_SIZE : NULL;
+        layout->type = FlipperWedgeLayoutCustom;
+        layout_unicode_cache_clear(layout);
+        strlcpy(layout->name, parsed.name, FLIPPER_WEDGE_LAYOUT_NAME_MAX);
+        strlcpy(layout->file_path, path, FLIPPER_WEDGE_LAYOUT_PATH_MAX);
         FURI_LOG_I(TAG, "Loaded layout: %s", layout->name);
+    } else {
+        free(parsed.keycodes);
+    }
 
-    } while(false);
-
-    flipper_format_file_close(file);
-    flipper_format_free(file);
     furi_record_close(RECORD_STORAGE);
 
     return success;
@@ -250,111 +496,111 @@ uint16_t flipper_wedge_keyboard_layout_get_keycode(FlipperWedgeKeyboardLayout* l
     furi_assert(layout);
 
     uint8_t index = (uint8_t)c;
-    if(index >= 128) {
+    if(index >= FLIPPER_WEDGE_LAYOUT_TABLE_SIZE) {
         return HID_KEYBOARD_NONE;
     }
 
     // If character is mapped in layout, use that
-    if(layout->map[index].defined) {
-        return layout->map[index].keycode;
+    if(layout->table && layout->table[index] != HID_KEYBOARD_NONE) {
+        uint16_t keycode = layout->table[index];
+        return (keycode & FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG) ? HID_KEYBOARD_NONE : keycode;
     }
 
     // Otherwise fall back to firmware default
     return HID_ASCII_TO_KEY(c);
 }
 
-const char* flipper_wedge_keyboard_layout_type_name(FlipperWedgeLayoutType type) {
-    if(type >= FlipperWedgeLayoutCount) {
-        return "Unknown";
-    }
-    return layout_type_names[type];
-}
-
-size_t flipper_wedge_keyboard_layout_list(
-    Storage* storage,
-    FuriString** names,
-    FuriString** paths,
-    size_t max_count) {
-    furi_assert(storage);
-    furi_assert(names);
-    furi_assert(paths);
-
-    size_t count = 0;
+uint8_t flipper_wedge_keyboard_layout_get_keys(FlipperWedgeKeyboardLayout* layout, char c, uint16_t* keys) {
+    furi_assert(layout);
+    furi_assert(keys);
 
-    // Ensure directory exists
-    if(!storage_dir_exists(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY)) {
-        FURI_LOG_I(TAG, "Creating layouts directory");
-        storage_simply_mkdir(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY);
-        return 0;
+    uint8_t index = (uint8_t)c;
+    if(index < FLIPPER_WEDGE_LAYOUT_TABLE_SIZE && layout->table && layout->sequences &&
+       (layout->table[index] & FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG)) {
+        const uint16_t* sequence =
+            &layout->sequences[layout->table[index] & ~FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG];
+        uint8_t count = sequence[0];
+        furi_assert(count <= FLIPPER_WEDGE_LAYOUT_STROKES_MAX);
+        memcpy(keys, &sequence[1], count * sizeof(uint16_t));
+        return count;
     }
 
-    File* dir = storage_file_alloc(storage);
-    if(!storage_dir_open(dir, FLIPPER_WEDGE_LAYOUTS_DIRECTORY)) {
-        FURI_LOG_E(TAG, "Failed to open layouts directory");
-        storage_file_free(dir);
-        return 0;
-    }
+    keys[0] = flipper_wedge_keyboard_layout_get_keycode(layout, c);
+    return keys[0] != HID_KEYBOARD_NONE;
+}
 
-    FileInfo file_info;
-    char filename[256];
+uint16_t flipper_wedge_keyboard_layout_get_unicode_keycode(FlipperWedgeKeyboardLayout* layout, uint32_t codepoint) {
+    furi_assert(layout);
 
-    while(count < max_count && storage_dir_read(dir, &file_info, filename, sizeof(filename))) {
-        // Skip directories
-        if(file_info.flags & FSF_DIRECTORY) {
-            continue;
-        }
+    if(codepoint < FLIPPER_WEDGE_LAYOUT_TABLE_SIZE) {
+        return flipper_wedge_keyboard_layout_get_keycode(layout, (char)codepoint);
+    }
 
-        // Only process .txt files
-        size_t len = strlen(filename);
-        if(len < 4 || strcmp(filename + len - 4, ".txt") != 0) {
-            continue;
+    size_t count;
+    const FlipperWedgeLayoutUnicodeKey* keys =
+        flipper_wedge_keyboard_layout_unicode_table(layout->type, &count);
+
+    // Binary search, tables are sorted by code point
+    size_t low = 0;
+    size_t high = count;
+    while(low < high) {
+        size_t mid = (low + high) / 2;
+        if(keys[mid].codepoint == codepoint) {
+            return keys[mid].keycode;
+        } else if(keys[mid].codepoint < codepoint) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
+    }
 
-        // Build full path
-        FuriString* full_path = furi_string_alloc();
-        furi_string_printf(full_path, "%s/%s", FLIPPER_WEDGE_LAYOUTS_DIRECTORY, filename);
-
-        // Try to read layout name from file
-        FlipperFormat* file = flipper_format_file_alloc(storage);
-        FuriString* layout_name = furi_string_alloc();
-        bool got_name = false;
+    return HID_KEYBOARD_NONE;
+}
 
-        if(flipper_format_file_open_existing(file, furi_string_get_cstr(full_path))) {
-            FuriString* file_type = furi_string_alloc();
-            uint32_t version = 0;
+void flipper_wedge_keyboard_layout_set_unicode_mode(FlipperWedgeKeyboardLayout* layout, FlipperWedgeUnicodeMode mode) {
+    furi_assert(layout);
+    furi_assert(mode < FlipperWedgeUnicodeCount);
 
-            if(flipper_format_read_header(file, file_type, &version)) {
-                if(furi_string_cmp_str(file_type, LAYOUT_FILE_TYPE) == 0) {
-                    if(flipper_format_read_string(file, "Name", layout_name)) {
-                        got_name = true;
-                    }
-                }
-            }
-            furi_string_free(file_type);
-        }
+    layout->unicode_mode = mode;
+    layout_unicode_cache_clear(layout);
+}
 
-        flipper_format_file_close(file);
-        flipper_format_free(file);
+const char* flipper_wedge_keyboard_layout_unicode_mode_name(FlipperWedgeUnicodeMode mode) {
+    if(mode >= FlipperWedgeUnicodeCount) {
+        return "Unknown";
+    }
+    return unicode_mode_names[mode];
+}
 
-        // Use filename without extension as fallback name
-        if(!got_name) {
-            furi_string_set_str(layout_name, filename);
-            furi_string_left(layout_name, len - 4);  // Remove .txt
-        }
+const char* flipper_wedge_keyboard_layout_type_name(FlipperWedgeLayoutType type) {
+    if(type >= FlipperWedgeLayoutCount) {
+        return "Unknown";
+    }
+    return layout_type_names[type];
+}
 
-        // Store name and path
-        names[count] = layout_name;
-        paths[count] = full_path;
-        count++;
+void flipper_wedge_keyboard_layout_read_name(Storage* storage, const char* path, FuriString* name) {
+    furi_assert(storage);
+    furi_assert(path);
+    furi_assert(name);
 
-        FURI_LOG_D(TAG, "Found layout: %s at %s",
-            furi_string_get_cstr(layout_name),
-            furi_string_get_cstr(full_path));
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    FuriString* file_type = furi_string_alloc();
+    uint32_t version = 0;
+    bool got_name = false;
+
+    if(flipper_format_file_open_existing(file, path) &&
+       flipper_format_read_header(file, file_type, &version) &&
+       furi_string_cmp_str(file_type, LAYOUT_FILE_TYPE) == 0) {
+        got_name = flipper_format_read_string(file, "Name", name);
     }
 
-    storage_dir_close(dir);
-    storage_file_free(dir);
+    furi_string_free(file_type);
+    flipper_format_file_close(file);
+    flipper_format_free(file);
 
-    FURI_LOG_I(TAG, "Found %zu custom layouts", count);
-    return count;
+    // Use filename without extension as fallback name
+    if(!got_name) {
+        path_extract_filename_no_ext(path, name);
+    }
 }
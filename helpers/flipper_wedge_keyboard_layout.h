@@ -7,27 +7,64 @@
 #define FLIPPER_WEDGE_LAYOUT_NAME_MAX 32
 #define FLIPPER_WEDGE_LAYOUT_PATH_MAX 128
 #define FLIPPER_WEDGE_LAYOUTS_DIRECTORY EXT_PATH("apps_data/flipper_wedge/layouts")
+#define FLIPPER_WEDGE_LAYOUT_TABLE_SIZE 128 // ASCII 0-127
+#define FLIPPER_WEDGE_LAYOUT_STROKES_MAX 4 // Keys typing one character, e.g. dead key + Space
+#define FLIPPER_WEDGE_LAYOUT_SEQUENCE_POOL 64 // Slots for multi-stroke entries of a custom layout
+// Table entry that indexes the layout's sequence pool instead of being a
+// keycode. Right GUI never takes part in typing a character, so its
+// modifier bit is free to mark these.
+#define FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG 0x8000
+#define FLIPPER_WEDGE_UNICODE_SEQUENCE_MAX 8 // Keys per non-ASCII character, worst case
+#define FLIPPER_WEDGE_UNICODE_CACHE_SIZE 16 // Cached sequences (power of two)
 
 // Built-in layout identifiers
 typedef enum {
     FlipperWedgeLayoutDefault,  // Use firmware HID_ASCII_TO_KEY
     FlipperWedgeLayoutNumPad,   // Use numpad keycodes for 0-9, A-F
     FlipperWedgeLayoutCustom,   // Load from file
+    // Built-in tables, appended so saved settings keep their meaning
+    FlipperWedgeLayoutAzerty,
+    FlipperWedgeLayoutQwertz,
+    FlipperWedgeLayoutHungarian,
+    FlipperWedgeLayoutDvorak,
     FlipperWedgeLayoutCount,
 } FlipperWedgeLayoutType;
 
-// Single character mapping
+// How characters outside ASCII are typed
+typedef enum {
+    FlipperWedgeUnicodeOff,     // Skipped
+    FlipperWedgeUnicodeLayout,  // Only characters the layout has a key for
+    FlipperWedgeUnicodeLinux,   // Layout key, else Ctrl+Shift+U <hex> Space (IBus/GTK)
+    FlipperWedgeUnicodeWindows, // Layout key, else Alt + KP+ <hex> (EnableHexNumpad)
+    FlipperWedgeUnicodeCount,
+} FlipperWedgeUnicodeMode;
+
+// Keys typing one code point, compiled once and reused
 typedef struct {
-    uint16_t keycode;  // HID keycode (lower 8 bits) + modifiers (upper 8 bits)
-    bool defined;      // true if explicitly defined in layout
-} FlipperWedgeKeyMapping;
+    uint32_t codepoint; // 0 = empty slot
+    uint8_t len; // 0 = can't be typed in this mode
+    uint16_t keys[FLIPPER_WEDGE_UNICODE_SEQUENCE_MAX];
+} FlipperWedgeUnicodeSequence;
 
 // Complete keyboard layout
+// Keycodes (usage in lower 8 bits, modifiers in upper 8) are looked up in
+// table by ASCII code, 0 falls back to the firmware's US QWERTY map.
+// Characters needing several strokes (dead key + Space) have a
+// FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG entry whose low bits are an offset
+// into sequences: a stroke count followed by that many keycodes.
+// Built-in tables are const and stay in flash, a custom layout owns a
+// heap table with its pool right behind it. Switching layouts only swaps
+// the table pointer.
 typedef struct {
     char name[FLIPPER_WEDGE_LAYOUT_NAME_MAX];
     char file_path[FLIPPER_WEDGE_LAYOUT_PATH_MAX];
     FlipperWedgeLayoutType type;
-    FlipperWedgeKeyMapping map[128];  // ASCII 0-127
+    const uint16_t* table;  // Active table, NULL for firmware default
+    const uint16_t* sequences; // Pool of the active table, NULL if it has no multi-stroke entries
+    uint16_t* custom;       // Custom layout table, allocated on first load
+    FlipperWedgeUnicodeMode unicode_mode;
+    // Direct mapped by code point, cleared whenever the table or mode changes
+    FlipperWedgeUnicodeSequence unicode_cache[FLIPPER_WEDGE_UNICODE_CACHE_SIZE];
 } FlipperWedgeKeyboardLayout;
 
 /** Allocate keyboard layout
@@ -42,6 +79,20 @@ FlipperWedgeKeyboardLayout* flipper_wedge_keyboard_layout_alloc(void);
  */
 void flipper_wedge_keyboard_layout_free(FlipperWedgeKeyboardLayout* layout);
 
+/** Check if a layout type is built in (anything but Custom)
+ *
+ * @param type Layout type
+ * @return true for built-in layouts
+ */
+bool flipper_wedge_keyboard_layout_is_builtin(FlipperWedgeLayoutType type);
+
+/** Switch to a built-in layout
+ *
+ * @param layout FlipperWedgeKeyboardLayout instance
+ * @param type Built-in layout type (not Custom)
+ */
+void flipper_wedge_keyboard_layout_set_builtin(FlipperWedgeKeyboardLayout* layout, FlipperWedgeLayoutType type);
+
 /** Set layout to Default (QWERTY) - uses firmware HID_ASCII_TO_KEY
  *
  * @param layout FlipperWedgeKeyboardLayout instance
@@ -55,6 +106,12 @@ void flipper_wedge_keyboard_layout_set_default(FlipperWedgeKeyboardLayout* layou
 void flipper_wedge_keyboard_layout_set_numpad(FlipperWedgeKeyboardLayout* layout);
 
 /** Load custom layout from file
+ * Reads the file once, line by line. Every printable ASCII character can be
+ * mapped, plus named keys SPACE, TAB, ENTER and HASH. A value is one or more
+ * comma separated strokes, each a keycode with optional SHIFT, ALTGR, CTRL
+ * and ALT. Malformed lines are logged with their line number and skipped.
+ * The result is cached in compiled form under layouts/.cache and reused
+ * while the source file's mtime and size are unchanged.
  *
  * @param layout FlipperWedgeKeyboardLayout instance
  * @param path Path to layout file
@@ -63,13 +120,50 @@ void flipper_wedge_keyboard_layout_set_numpad(FlipperWedgeKeyboardLayout* layout
 bool flipper_wedge_keyboard_layout_load(FlipperWedgeKeyboardLayout* layout, const char* path);
 
 /** Get HID keycode for character
+ * For characters typed with a single key, see
+ * flipper_wedge_keyboard_layout_get_keys() for the general case.
  *
  * @param layout FlipperWedgeKeyboardLayout instance
  * @param c ASCII character to map
  * @return HID keycode with modifiers, or HID_KEYBOARD_NONE if unmappable
+ *         or the layout types it with several strokes
  */
 uint16_t flipper_wedge_keyboard_layout_get_keycode(FlipperWedgeKeyboardLayout* layout, char c);
 
+/** Get the strokes typing a character
+ *
+ * @param layout FlipperWedgeKeyboardLayout instance
+ * @param c ASCII character to map
+ * @param keys Filled in with up to FLIPPER_WEDGE_LAYOUT_STROKES_MAX keycodes
+ * @return Number of keycodes, 0 if unmappable
+ */
+uint8_t flipper_wedge_keyboard_layout_get_keys(FlipperWedgeKeyboardLayout* layout, char c, uint16_t* keys);
+
+/** Get HID keycode for a code point with a key of its own on this layout
+ * ASCII goes through flipper_wedge_keyboard_layout_get_keycode(). Above ASCII
+ * only built-in layouts have keys (accented letters, currency signs).
+ *
+ * @param layout FlipperWedgeKeyboardLayout instance
+ * @param codepoint Unicode code point
+ * @return HID keycode with modifiers, or HID_KEYBOARD_NONE if the layout has no key
+ */
+uint16_t flipper_wedge_keyboard_layout_get_unicode_keycode(FlipperWedgeKeyboardLayout* layout, uint32_t codepoint);
+
+/** Set how characters outside ASCII are typed
+ * Drops cached input sequences.
+ *
+ * @param layout FlipperWedgeKeyboardLayout instance
+ * @param mode Unicode input mode
+ */
+void flipper_wedge_keyboard_layout_set_unicode_mode(FlipperWedgeKeyboardLayout* layout, FlipperWedgeUnicodeMode mode);
+
+/** Get Unicode input mode name for display
+ *
+ * @param mode Unicode input mode
+ * @return Static string name
+ */
+const char* flipper_wedge_keyboard_layout_unicode_mode_name(FlipperWedgeUnicodeMode mode);
+
 /** Get layout type name for display
  *
  * @param type Layout type enum
@@ -77,16 +171,12 @@ uint16_t flipper_wedge_keyboard_layout_get_keycode(FlipperWedgeKeyboardLayout* l
  */
 const char* flipper_wedge_keyboard_layout_type_name(FlipperWedgeLayoutType type);
 
-/** List available custom layout files on SD card
+/** Read the display name of a custom layout file
+ * Only the header is read. Falls back to the file name without extension
+ * when the file has no Name field or is not a layout file.
  *
  * @param storage Storage instance
- * @param names Array to fill with layout names (from file content)
- * @param paths Array to fill with file paths
- * @param max_count Maximum number of layouts to return
- * @return Number of layouts found
+ * @param path Path to layout file
+ * @param name Filled in with the name
  */
-size_t flipper_wedge_keyboard_layout_list(
-    Storage* storage,
-    FuriString** names,
-    FuriString** paths,
-    size_t max_count);
+void flipper_wedge_keyboard_layout_read_name(Storage* storage, const char* path, FuriString* name);
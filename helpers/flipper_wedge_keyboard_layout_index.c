@@ -0,0 +1,318 @@
+#include "flipper_wedge_keyboard_layout_index.h"
+
+#define TAG "FlipperWedgeLayoutIndex"
+
+#define INDEX_MAGIC 0x494C5746 // "FWLI"
+#define INDEX_VERSION 1
+#define INDEX_TMP_PATH FLIPPER_WEDGE_LAYOUTS_DIRECTORY "/.index.tmp"
+
+typedef FlipperWedgeKeyboardLayoutIndexEntry IndexEntry;
+
+// Index file: this header, then count IndexEntry records in directory order
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t count;
+} IndexHeader;
+
+// Enough of a record to recognise an unchanged file during refresh
+typedef struct {
+    uint32_t path_hash;
+    uint32_t mtime;
+    uint32_t size;
+} IndexKey;
+
+struct FlipperWedgeKeyboardLayoutIndex {
+    Storage* storage;
+    size_t count;
+
+    // Last page read, page_count == 0 when nothing is cached
+    IndexEntry* page;
+    size_t page_start;
+    size_t page_count;
+};
+
+static uint32_t index_hash(const char* path) {
+    uint32_t hash = 2166136261UL; // FNV-1a
+    for(; *path; path++) {
+        hash = (hash ^ (uint8_t)*path) * 16777619UL;
+    }
+    return hash;
+}
+
+static size_t index_offset(size_t position) {
+    return sizeof(IndexHeader) + position * sizeof(IndexEntry);
+}
+
+// Open the index file and check it is complete, returns the record count
+static bool index_open(File* file, size_t* count) {
+    IndexHeader header;
+    if(!storage_file_open(file, FLIPPER_WEDGE_LAYOUT_INDEX_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        return false;
+    }
+    if(storage_file_read(file, &header, sizeof(header)) != sizeof(header) ||
+       header.magic != INDEX_MAGIC || header.version != INDEX_VERSION ||
+       storage_file_size(file) != index_offset(header.count)) {
+        FURI_LOG_W(TAG, "Ignoring invalid layout index");
+        storage_file_close(file);
+        return false;
+    }
+    *count = header.count;
+    return true;
+}
+
+static bool index_read(File* file, size_t position, IndexEntry* entries, size_t count) {
+    const size_t bytes = count * sizeof(IndexEntry);
+    return storage_file_seek(file, index_offset(position), true) &&
+           storage_file_read(file, entries, bytes) == bytes;
+}
+
+// Start the new index file with the first copy_count records of the old one
+static bool index_begin_write(
+    FlipperWedgeKeyboardLayoutIndex* index,
+    File* out,
+    File* old,
+    size_t copy_count) {
+    const IndexHeader header = {.magic = INDEX_MAGIC, .version = INDEX_VERSION};
+    if(!storage_file_open(out, INDEX_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       storage_file_write(out, &header, sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+
+    for(size_t i = 0; i < copy_count; i += FLIPPER_WEDGE_LAYOUT_INDEX_PAGE) {
+        size_t chunk = MIN((size_t)FLIPPER_WEDGE_LAYOUT_INDEX_PAGE, copy_count - i);
+        const size_t bytes = chunk * sizeof(IndexEntry);
+        if(!index_read(old, i, index->page, chunk) ||
+           storage_file_write(out, index->page, bytes) != bytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FlipperWedgeKeyboardLayoutIndex* flipper_wedge_keyboard_layout_index_alloc(Storage* storage) {
+    furi_assert(storage);
+
+    FlipperWedgeKeyboardLayoutIndex* index = malloc(sizeof(FlipperWedgeKeyboardLayoutIndex));
+    index->storage = storage;
+    index->count = 0;
+    index->page = malloc(FLIPPER_WEDGE_LAYOUT_INDEX_PAGE * sizeof(IndexEntry));
+    index->page_start = 0;
+    index->page_count = 0;
+    return index;
+}
+
+void flipper_wedge_keyboard_layout_index_free(FlipperWedgeKeyboardLayoutIndex* index) {
+    furi_assert(index);
+    free(index->page);
+    free(index);
+}
+
+size_t flipper_wedge_keyboard_layout_index_refresh(FlipperWedgeKeyboardLayoutIndex* index) {
+    furi_assert(index);
+    Storage* storage = index->storage;
+
+    // The page buffer doubles as scratch space below
+    index->page_count = 0;
+    index->count = 0;
+
+    if(!storage_dir_exists(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY)) {
+        FURI_LOG_I(TAG, "Creating layouts directory");
+        storage_simply_mkdir(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY);
+        return 0;
+    }
+
+    // Keys of the current index, 12 bytes per layout instead of whole records
+    File* old = storage_file_alloc(storage);
+    size_t old_count = 0;
+    IndexKey* keys = NULL;
+    if(index_open(old, &old_count) && old_count > 0) {
+        keys = malloc(old_count * sizeof(IndexKey));
+        for(size_t i = 0; i < old_count; i += FLIPPER_WEDGE_LAYOUT_INDEX_PAGE) {
+            size_t chunk = MIN((size_t)FLIPPER_WEDGE_LAYOUT_INDEX_PAGE, old_count - i);
+            if(!index_read(old, i, index->page, chunk)) {
+                old_count = i;
+                break;
+            }
+            for(size_t j = 0; j < chunk; j++) {
+                keys[i + j].path_hash = index_hash(index->page[j].path);
+                keys[i + j].mtime = index->page[j].mtime;
+                keys[i + j].size = index->page[j].size;
+            }
+        }
+    }
+
+    File* dir = storage_file_alloc(storage);
+    File* out = storage_file_alloc(storage);
+    IndexEntry* entry = malloc(sizeof(IndexEntry));
+    IndexEntry* known = malloc(sizeof(IndexEntry));
+    FuriString* name = furi_string_alloc();
+    FileInfo file_info;
+    char filename[256];
+    size_t count = 0;
+    size_t reread = 0;
+    bool writing = false; // Set at the first difference, unchanged directories write nothing
+    bool failed = false;
+
+    if(!storage_dir_open(dir, FLIPPER_WEDGE_LAYOUTS_DIRECTORY)) {
+        FURI_LOG_E(TAG, "Failed to open layouts directory");
+        failed = true;
+    }
+
+    while(!failed && storage_dir_read(dir, &file_info, filename, sizeof(filename))) {
+        if(file_info.flags & FSF_DIRECTORY) {
+            continue;
+        }
+
+        size_t len = strlen(filename);
+        if(len < 4 || strcmp(filename + len - 4, ".txt") != 0) {
+            continue;
+        }
+
+        memset(entry, 0, sizeof(IndexEntry));
+        if(snprintf(entry->path, sizeof(entry->path), "%s/%s", FLIPPER_WEDGE_LAYOUTS_DIRECTORY, filename) >=
+           (int)sizeof(entry->path)) {
+            FURI_LOG_W(TAG, "Skipping layout, file name too long: %s", filename);
+            continue;
+        }
+        entry->size = file_info.size;
+        // Without timestamps a file is recognised by path and size alone
+        bool have_mtime = storage_common_timestamp(storage, entry->path, &entry->mtime) == FSE_OK;
+
+        // Unchanged directories list in the same order, so look at the same position first
+        bool found = false;
+        uint32_t hash = index_hash(entry->path);
+        for(size_t i = 0; i < old_count; i++) {
+            size_t position = (count + i) % old_count;
+            const IndexKey* key = &keys[position];
+            if(key->path_hash != hash || (have_mtime && key->mtime != entry->mtime) ||
+               key->size != entry->size) {
+                continue;
+            }
+            if(index_read(old, position, known, 1) && strcmp(known->path, entry->path) == 0) {
+                memcpy(entry->name, known->name, sizeof(entry->name));
+                entry->mtime = known->mtime;
+                found = true;
+                if(position != count && !writing) {
+                    writing = true;
+                    failed = !index_begin_write(index, out, old, count);
+                }
+            }
+            break;
+        }
+
+        if(!found) {
+            flipper_wedge_keyboard_layout_read_name(storage, entry->path, name);
+            strlcpy(entry->name, furi_string_get_cstr(name), sizeof(entry->name));
+            reread++;
+            if(!writing) {
+                writing = true;
+                failed = !index_begin_write(index, out, old, count);
+            }
+        }
+
+        if(writing && !failed) {
+            failed = storage_file_write(out, entry, sizeof(IndexEntry)) != sizeof(IndexEntry);
+        }
+        count++;
+    }
+
+    // Files removed from the end of the listing
+    if(!failed && !writing && count != old_count) {
+        writing = true;
+        failed = !index_begin_write(index, out, old, count);
+    }
+
+    if(writing && !failed) {
+        const IndexHeader header = {.magic = INDEX_MAGIC, .version = INDEX_VERSION, .count = count};
+        failed = !storage_file_seek(out, 0, true) ||
+                 storage_file_write(out, &header, sizeof(header)) != sizeof(header);
+    }
+
+    storage_dir_close(dir);
+    storage_file_close(old);
+    storage_file_close(out);
+
+    if(!writing) {
+        index->count = count;
+    } else if(!failed) {
+        storage_common_remove(storage, FLIPPER_WEDGE_LAYOUT_INDEX_PATH);
+        if(storage_common_rename(storage, INDEX_TMP_PATH, FLIPPER_WEDGE_LAYOUT_INDEX_PATH) == FSE_OK) {
+            index->count = count;
+        } else {
+            FURI_LOG_E(TAG, "Failed to replace layout index");
+        }
+    } else {
+        // Keep serving the previous index, it is only out of date
+        FURI_LOG_E(TAG, "Failed to update layout index");
+        storage_common_remove(storage, INDEX_TMP_PATH);
+        index->count = old_count;
+    }
+
+    FURI_LOG_I(TAG, "Indexed %zu layouts, %zu read", index->count, reread);
+
+    furi_string_free(name);
+    free(known);
+    free(entry);
+    free(keys);
+    storage_file_free(out);
+    storage_file_free(dir);
+    storage_file_free(old);
+
+    return index->count;
+}
+
+size_t flipper_wedge_keyboard_layout_index_count(FlipperWedgeKeyboardLayoutIndex* index) {
+    furi_assert(index);
+    return index->count;
+}
+
+const FlipperWedgeKeyboardLayoutIndexEntry*
+    flipper_wedge_keyboard_layout_index_get(FlipperWedgeKeyboardLayoutIndex* index, size_t position) {
+    furi_assert(index);
+    furi_assert(position < index->count);
+
+    if(index->page_count == 0 || position < index->page_start ||
+       position >= index->page_start + index->page_count) {
+        size_t start = position - position % FLIPPER_WEDGE_LAYOUT_INDEX_PAGE;
+        size_t chunk = MIN((size_t)FLIPPER_WEDGE_LAYOUT_INDEX_PAGE, index->count - start);
+        size_t file_count = 0;
+
+        File* file = storage_file_alloc(index->storage);
+        index->page_count = 0;
+        if(index_open(file, &file_count) && start + chunk <= file_count &&
+           index_read(file, start, index->page, chunk)) {
+            index->page_start = start;
+            index->page_count = chunk;
+        }
+        storage_file_close(file);
+        storage_file_free(file);
+
+        if(index->page_count == 0) {
+            FURI_LOG_E(TAG, "Failed to read layout index at %zu", position);
+            return NULL;
+        }
+    }
+
+    return &index->page[position - index->page_start];
+}
+
+bool flipper_wedge_keyboard_layout_index_find(
+    FlipperWedgeKeyboardLayoutIndex* index,
+    const char* path,
+    size_t* position) {
+    furi_assert(index);
+    furi_assert(path);
+    furi_assert(position);
+
+    for(size_t i = 0; i < index->count; i++) {
+        const IndexEntry* entry = flipper_wedge_keyboard_layout_index_get(index, i);
+        if(!entry) break;
+        if(strcmp(entry->path, path) == 0) {
+            *position = i;
+            return true;
+        }
+    }
+    return false;
+}
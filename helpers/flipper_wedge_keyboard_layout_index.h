@@ -0,0 +1,78 @@
+#pragma once
+
+#include <furi.h>
+#include <storage/storage.h>
+#include "flipper_wedge_keyboard_layout.h"
+
+// Persistent listing of the layouts directory, one fixed-size record per file
+#define FLIPPER_WEDGE_LAYOUT_INDEX_PATH FLIPPER_WEDGE_LAYOUTS_DIRECTORY "/.index"
+// Records read from SD at a time when paging
+#define FLIPPER_WEDGE_LAYOUT_INDEX_PAGE 8
+
+typedef struct FlipperWedgeKeyboardLayoutIndex FlipperWedgeKeyboardLayoutIndex;
+
+/** One custom layout file
+ * Stored as is in the index file, fields are naturally aligned.
+ */
+typedef struct {
+    char name[FLIPPER_WEDGE_LAYOUT_NAME_MAX]; // From the file's Name field, or file name
+    char path[FLIPPER_WEDGE_LAYOUT_PATH_MAX];
+    uint32_t mtime; // Source timestamp when the name was read
+    uint32_t size; // Source size when the name was read
+} FlipperWedgeKeyboardLayoutIndexEntry;
+
+/** Allocate layout index
+ * Nothing is read until flipper_wedge_keyboard_layout_index_refresh().
+ *
+ * @param storage Storage instance, must outlive the index
+ * @return FlipperWedgeKeyboardLayoutIndex instance
+ */
+FlipperWedgeKeyboardLayoutIndex* flipper_wedge_keyboard_layout_index_alloc(Storage* storage);
+
+/** Free layout index
+ *
+ * @param index FlipperWedgeKeyboardLayoutIndex instance
+ */
+void flipper_wedge_keyboard_layout_index_free(FlipperWedgeKeyboardLayoutIndex* index);
+
+/** Bring the index file in line with the layouts directory
+ * Lists the directory and stats each .txt file. Files whose path, mtime and
+ * size match their index record keep it; only new or changed files are
+ * opened to read their name. Where the SD card gives no timestamps, path
+ * and size are compared, so an edit that keeps the size goes unnoticed
+ * there. The index file is rewritten only when something changed.
+ *
+ * @param index FlipperWedgeKeyboardLayoutIndex instance
+ * @return Number of layouts in the index
+ */
+size_t flipper_wedge_keyboard_layout_index_refresh(FlipperWedgeKeyboardLayoutIndex* index);
+
+/** Get number of layouts in the index
+ *
+ * @param index FlipperWedgeKeyboardLayoutIndex instance
+ * @return Number of layouts
+ */
+size_t flipper_wedge_keyboard_layout_index_count(FlipperWedgeKeyboardLayoutIndex* index);
+
+/** Get one layout record
+ * Records are read a page at a time and the last page is kept, so stepping
+ * through neighbouring entries mostly avoids SD access.
+ *
+ * @param index FlipperWedgeKeyboardLayoutIndex instance
+ * @param position Record number, below flipper_wedge_keyboard_layout_index_count()
+ * @return Record, valid until the next call on this index, or NULL on read error
+ */
+const FlipperWedgeKeyboardLayoutIndexEntry*
+    flipper_wedge_keyboard_layout_index_get(FlipperWedgeKeyboardLayoutIndex* index, size_t position);
+
+/** Find the record of a layout file
+ *
+ * @param index FlipperWedgeKeyboardLayoutIndex instance
+ * @param path Layout file path
+ * @param position Filled in with the record number if found
+ * @return true if the path is in the index
+ */
+bool flipper_wedge_keyboard_layout_index_find(
+    FlipperWedgeKeyboardLayoutIndex* index,
+    const char* path,
+    size_t* position);
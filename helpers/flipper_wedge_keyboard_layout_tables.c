@@ -0,0 +1,639 @@
+#include "flipper_wedge_keyboard_layout_tables.h"
+
+// Built-in layouts as const tables, so they stay in flash and selecting one
+// only swaps a pointer. Entries are HID keycodes (usage + modifiers) indexed
+// by ASCII; 0 falls back to the firmware's US QWERTY map.
+//
+// Keys are named by the US legend of the physical key, so a table reads as
+// "which key produces this character on that layout". Characters behind a
+// dead key are typed as dead key + Space from the layout's sequence pool:
+// QWERTZ ^ and `, AZERTY AltGr ` and ~, Hungarian AltGr ~ ^ and `. The
+// AltGr ones are dead on Windows; on hosts where they are plain keys
+// (some X11 variants) the Space is typed after the character.
+
+#define POS_A 0x04
+#define POS_B 0x05
+#define POS_C 0x06
+#define POS_D 0x07
+#define POS_E 0x08
+#define POS_F 0x09
+#define POS_G 0x0A
+#define POS_H 0x0B
+#define POS_I 0x0C
+#define POS_J 0x0D
+#define POS_K 0x0E
+#define POS_L 0x0F
+#define POS_M 0x10
+#define POS_N 0x11
+#define POS_O 0x12
+#define POS_P 0x13
+#define POS_Q 0x14
+#define POS_R 0x15
+#define POS_S 0x16
+#define POS_T 0x17
+#define POS_U 0x18
+#define POS_V 0x19
+#define POS_W 0x1A
+#define POS_X 0x1B
+#define POS_Y 0x1C
+#define POS_Z 0x1D
+#define POS_1 0x1E
+#define POS_2 0x1F
+#define POS_3 0x20
+#define POS_4 0x21
+#define POS_5 0x22
+#define POS_6 0x23
+#define POS_7 0x24
+#define POS_8 0x25
+#define POS_9 0x26
+#define POS_0 0x27
+#define POS_SPACE 0x2C
+#define POS_MINUS 0x2D
+#define POS_EQUAL 0x2E
+#define POS_LBRACKET 0x2F
+#define POS_RBRACKET 0x30
+#define POS_BACKSLASH 0x31
+#define POS_SEMICOLON 0x33
+#define POS_APOSTROPHE 0x34
+#define POS_GRAVE 0x35
+#define POS_COMMA 0x36
+#define POS_DOT 0x37
+#define POS_SLASH 0x38
+#define POS_NONUS_BACKSLASH 0x64 // Extra key left of Z on ISO keyboards
+
+#define S(key) ((key) | KEY_MOD_LEFT_SHIFT)
+#define AG(key) ((key) | KEY_MOD_RIGHT_ALT)
+// Table entry for the sequence at offset of the layout's pool
+#define SEQ(offset) (FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG | (offset))
+
+// NumPad keycodes from hid_usage_keyboard.h
+// NOTE: Digits 0-9 (0x62, 0x59-0x61) are standard HID numpad keycodes.
+// Hex letters A-F (0xBC-0xC1) are NON-STANDARD extended keycodes.
+// Standard USB HID does not define numpad A-F keys, so these may not
+// work on all operating systems or applications. NumPad mode is primarily
+// useful for typing digits 0-9 on systems where the number row layout differs.
+#define HID_KEYPAD_0 0x62
+#define HID_KEYPAD_1 0x59
+#define HID_KEYPAD_2 0x5A
+#define HID_KEYPAD_3 0x5B
+#define HID_KEYPAD_4 0x5C
+#define HID_KEYPAD_5 0x5D
+#define HID_KEYPAD_6 0x5E
+#define HID_KEYPAD_7 0x5F
+#define HID_KEYPAD_8 0x60
+#define HID_KEYPAD_9 0x61
+#define HID_KEYPAD_A 0xBC // Non-standard
+#define HID_KEYPAD_B 0xBD // Non-standard
+#define HID_KEYPAD_C 0xBE // Non-standard
+#define HID_KEYPAD_D 0xBF // Non-standard
+#define HID_KEYPAD_E 0xC0 // Non-standard
+#define HID_KEYPAD_F 0xC1 // Non-standard
+
+// Hex digits only, lowercase uses the same keys (no shift)
+static const uint16_t layout_table_numpad[FLIPPER_WEDGE_LAYOUT_TABLE_SIZE] = {
+    ['0'] = HID_KEYPAD_0,
+    ['1'] = HID_KEYPAD_1,
+    ['2'] = HID_KEYPAD_2,
+    ['3'] = HID_KEYPAD_3,
+    ['4'] = HID_KEYPAD_4,
+    ['5'] = HID_KEYPAD_5,
+    ['6'] = HID_KEYPAD_6,
+    ['7'] = HID_KEYPAD_7,
+    ['8'] = HID_KEYPAD_8,
+    ['9'] = HID_KEYPAD_9,
+    ['A'] = HID_KEYPAD_A,
+    ['B'] = HID_KEYPAD_B,
+    ['C'] = HID_KEYPAD_C,
+    ['D'] = HID_KEYPAD_D,
+    ['E'] = HID_KEYPAD_E,
+    ['F'] = HID_KEYPAD_F,
+    ['a'] = HID_KEYPAD_A,
+    ['b'] = HID_KEYPAD_B,
+    ['c'] = HID_KEYPAD_C,
+    ['d'] = HID_KEYPAD_D,
+    ['e'] = HID_KEYPAD_E,
+    ['f'] = HID_KEYPAD_F,
+};
+
+// French AZERTY
+static const uint16_t layout_table_azerty[FLIPPER_WEDGE_LAYOUT_TABLE_SIZE] = {
+    [' '] = POS_SPACE,
+    ['!'] = POS_SLASH,
+    ['"'] = POS_3,
+    ['#'] = AG(POS_3),
+    ['$'] = POS_RBRACKET,
+    ['%'] = S(POS_APOSTROPHE),
+    ['&'] = POS_1,
+    ['\''] = POS_4,
+    ['('] = POS_5,
+    [')'] = POS_MINUS,
+    ['*'] = POS_BACKSLASH,
+    ['+'] = S(POS_EQUAL),
+    [','] = POS_M,
+    ['-'] = POS_6,
+    ['.'] = S(POS_COMMA),
+    ['/'] = S(POS_DOT),
+    ['0'] = S(POS_0),
+    ['1'] = S(POS_1),
+    ['2'] = S(POS_2),
+    ['3'] = S(POS_3),
+    ['4'] = S(POS_4),
+    ['5'] = S(POS_5),
+    ['6'] = S(POS_6),
+    ['7'] = S(POS_7),
+    ['8'] = S(POS_8),
+    ['9'] = S(POS_9),
+    [':'] = POS_DOT,
+    [';'] = POS_COMMA,
+    ['<'] = POS_NONUS_BACKSLASH,
+    ['='] = POS_EQUAL,
+    ['>'] = S(POS_NONUS_BACKSLASH),
+    ['?'] = S(POS_M),
+    ['@'] = AG(POS_0),
+    ['A'] = S(POS_Q),
+    ['B'] = S(POS_B),
+    ['C'] = S(POS_C),
+    ['D'] = S(POS_D),
+    ['E'] = S(POS_E),
+    ['F'] = S(POS_F),
+    ['G'] = S(POS_G),
+    ['H'] = S(POS_H),
+    ['I'] = S(POS_I),
+    ['J'] = S(POS_J),
+    ['K'] = S(POS_K),
+    ['L'] = S(POS_L),
+    ['M'] = S(POS_SEMICOLON),
+    ['N'] = S(POS_N),
+    ['O'] = S(POS_O),
+    ['P'] = S(POS_P),
+    ['Q'] = S(POS_A),
+    ['R'] = S(POS_R),
+    ['S'] = S(POS_S),
+    ['T'] = S(POS_T),
+    ['U'] = S(POS_U),
+    ['V'] = S(POS_V),
+    ['W'] = S(POS_Z),
+    ['X'] = S(POS_X),
+    ['Y'] = S(POS_Y),
+    ['Z'] = S(POS_W),
+    ['['] = AG(POS_5),
+    ['\\'] = AG(POS_8),
+    [']'] = AG(POS_MINUS),
+    ['^'] = AG(POS_9),
+    ['_'] = POS_8,
+    ['`'] = SEQ(0),
+    ['a'] = POS_Q,
+    ['b'] = POS_B,
+    ['c'] = POS_C,
+    ['d'] = POS_D,
+    ['e'] = POS_E,
+    ['f'] = POS_F,
+    ['g'] = POS_G,
+    ['h'] = POS_H,
+    ['i'] = POS_I,
+    ['j'] = POS_J,
+    ['k'] = POS_K,
+    ['l'] = POS_L,
+    ['m'] = POS_SEMICOLON,
+    ['n'] = POS_N,
+    ['o'] = POS_O,
+    ['p'] = POS_P,
+    ['q'] = POS_A,
+    ['r'] = POS_R,
+    ['s'] = POS_S,
+    ['t'] = POS_T,
+    ['u'] = POS_U,
+    ['v'] = POS_V,
+    ['w'] = POS_Z,
+    ['x'] = POS_X,
+    ['y'] = POS_Y,
+    ['z'] = POS_W,
+    ['{'] = AG(POS_4),
+    ['|'] = AG(POS_6),
+    ['}'] = AG(POS_EQUAL),
+    ['~'] = SEQ(3),
+};
+
+// German QWERTZ
+static const uint16_t layout_table_qwertz[FLIPPER_WEDGE_LAYOUT_TABLE_SIZE] = {
+    [' '] = POS_SPACE,
+    ['!'] = S(POS_1),
+    ['"'] = S(POS_2),
+    ['#'] = POS_BACKSLASH,
+    ['$'] = S(POS_4),
+    ['%'] = S(POS_5),
+    ['&'] = S(POS_6),
+    ['\''] = S(POS_BACKSLASH),
+    ['('] = S(POS_8),
+    [')'] = S(POS_9),
+    ['*'] = S(POS_RBRACKET),
+    ['+'] = POS_RBRACKET,
+    [','] = POS_COMMA,
+    ['-'] = POS_SLASH,
+    ['.'] = POS_DOT,
+    ['/'] = S(POS_7),
+    ['0'] = POS_0,
+    ['1'] = POS_1,
+    ['2'] = POS_2,
+    ['3'] = POS_3,
+    ['4'] = POS_4,
+    ['5'] = POS_5,
+    ['6'] = POS_6,
+    ['7'] = POS_7,
+    ['8'] = POS_8,
+    ['9'] = POS_9,
+    [':'] = S(POS_DOT),
+    [';'] = S(POS_COMMA),
+    ['<'] = POS_NONUS_BACKSLASH,
+    ['='] = S(POS_0),
+    ['>'] = S(POS_NONUS_BACKSLASH),
+    ['?'] = S(POS_MINUS),
+    ['@'] = AG(POS_Q),
+    ['A'] = S(POS_A),
+    ['B'] = S(POS_B),
+    ['C'] = S(POS_C),
+    ['D'] = S(POS_D),
+    ['E'] = S(POS_E),
+    ['F'] = S(POS_F),
+    ['G'] = S(POS_G),
+    ['H'] = S(POS_H),
+    ['I'] = S(POS_I),
+    ['J'] = S(POS_J),
+    ['K'] = S(POS_K),
+    ['L'] = S(POS_L),
+    ['M'] = S(POS_M),
+    ['N'] = S(POS_N),
+    ['O'] = S(POS_O),
+    ['P'] = S(POS_P),
+    ['Q'] = S(POS_Q),
+    ['R'] = S(POS_R),
+    ['S'] = S(POS_S),
+    ['T'] = S(POS_T),
+    ['U'] = S(POS_U),
+    ['V'] = S(POS_V),
+    ['W'] = S(POS_W),
+    ['X'] = S(POS_X),
+    ['Y'] = S(POS_Z),
+    ['Z'] = S(POS_Y),
+    ['['] = AG(POS_8),
+    ['\\'] = AG(POS_MINUS),
+    [']'] = AG(POS_9),
+    ['^'] = SEQ(0),
+    ['_'] = S(POS_SLASH),
+    ['`'] = SEQ(3),
+    ['a'] = POS_A,
+    ['b'] = POS_B,
+    ['c'] = POS_C,
+    ['d'] = POS_D,
+    ['e'] = POS_E,
+    ['f'] = POS_F,
+    ['g'] = POS_G,
+    ['h'] = POS_H,
+    ['i'] = POS_I,
+    ['j'] = POS_J,
+    ['k'] = POS_K,
+    ['l'] = POS_L,
+    ['m'] = POS_M,
+    ['n'] = POS_N,
+    ['o'] = POS_O,
+    ['p'] = POS_P,
+    ['q'] = POS_Q,
+    ['r'] = POS_R,
+    ['s'] = POS_S,
+    ['t'] = POS_T,
+    ['u'] = POS_U,
+    ['v'] = POS_V,
+    ['w'] = POS_W,
+    ['x'] = POS_X,
+    ['y'] = POS_Z,
+    ['z'] = POS_Y,
+    ['{'] = AG(POS_7),
+    ['|'] = AG(POS_NONUS_BACKSLASH),
+    ['}'] = AG(POS_0),
+    ['~'] = AG(POS_RBRACKET),
+};
+
+// Hungarian QWERTZ, 0 sits left of 1
+static const uint16_t layout_table_hungarian[FLIPPER_WEDGE_LAYOUT_TABLE_SIZE] = {
+    [' '] = POS_SPACE,
+    ['!'] = S(POS_4),
+    ['"'] = S(POS_2),
+    ['#'] = AG(POS_X),
+    ['$'] = AG(POS_SEMICOLON),
+    ['%'] = S(POS_5),
+    ['&'] = AG(POS_C),
+    ['\''] = S(POS_1),
+    ['('] = S(POS_8),
+    [')'] = S(POS_9),
+    ['*'] = AG(POS_SLASH),
+    ['+'] = S(POS_3),
+    [','] = POS_COMMA,
+    ['-'] = POS_SLASH,
+    ['.'] = POS_DOT,
+    ['/'] = S(POS_6),
+    ['0'] = POS_GRAVE,
+    ['1'] = POS_1,
+    ['2'] = POS_2,
+    ['3'] = POS_3,
+    ['4'] = POS_4,
+    ['5'] = POS_5,
+    ['6'] = POS_6,
+    ['7'] = POS_7,
+    ['8'] = POS_8,
+    ['9'] = POS_9,
+    [':'] = S(POS_DOT),
+    [';'] = AG(POS_COMMA),
+    ['<'] = AG(POS_NONUS_BACKSLASH),
+    ['='] = S(POS_7),
+    ['>'] = AG(POS_Z),
+    ['?'] = S(POS_COMMA),
+    ['@'] = AG(POS_V),
+    ['A'] = S(POS_A),
+    ['B'] = S(POS_B),
+    ['C'] = S(POS_C),
+    ['D'] = S(POS_D),
+    ['E'] = S(POS_E),
+    ['F'] = S(POS_F),
+    ['G'] = S(POS_G),
+    ['H'] = S(POS_H),
+    ['I'] = S(POS_I),
+    ['J'] = S(POS_J),
+    ['K'] = S(POS_K),
+    ['L'] = S(POS_L),
+    ['M'] = S(POS_M),
+    ['N'] = S(POS_N),
+    ['O'] = S(POS_O),
+    ['P'] = S(POS_P),
+    ['Q'] = S(POS_Q),
+    ['R'] = S(POS_R),
+    ['S'] = S(POS_S),
+    ['T'] = S(POS_T),
+    ['U'] = S(POS_U),
+    ['V'] = S(POS_V),
+    ['W'] = S(POS_W),
+    ['X'] = S(POS_X),
+    ['Y'] = S(POS_Z),
+    ['Z'] = S(POS_Y),
+    ['['] = AG(POS_F),
+    ['\\'] = AG(POS_Q),
+    [']'] = AG(POS_G),
+    ['^'] = SEQ(0),
+    ['_'] = S(POS_SLASH),
+    ['`'] = SEQ(3),
+    ['a'] = POS_A,
+    ['b'] = POS_B,
+    ['c'] = POS_C,
+    ['d'] = POS_D,
+    ['e'] = POS_E,
+    ['f'] = POS_F,
+    ['g'] = POS_G,
+    ['h'] = POS_H,
+    ['i'] = POS_I,
+    ['j'] = POS_J,
+    ['k'] = POS_K,
+    ['l'] = POS_L,
+    ['m'] = POS_M,
+    ['n'] = POS_N,
+    ['o'] = POS_O,
+    ['p'] = POS_P,
+    ['q'] = POS_Q,
+    ['r'] = POS_R,
+    ['s'] = POS_S,
+    ['t'] = POS_T,
+    ['u'] = POS_U,
+    ['v'] = POS_V,
+    ['w'] = POS_W,
+    ['x'] = POS_X,
+    ['y'] = POS_Z,
+    ['z'] = POS_Y,
+    ['{'] = AG(POS_B),
+    ['|'] = AG(POS_W),
+    ['}'] = AG(POS_N),
+    ['~'] = SEQ(6),
+};
+
+// US Dvorak
+static const uint16_t layout_table_dvorak[FLIPPER_WEDGE_LAYOUT_TABLE_SIZE] = {
+    [' '] = POS_SPACE,
+    ['!'] = S(POS_1),
+    ['"'] = S(POS_Q),
+    ['#'] = S(POS_3),
+    ['$'] = S(POS_4),
+    ['%'] = S(POS_5),
+    ['&'] = S(POS_7),
+    ['\''] = POS_Q,
+    ['('] = S(POS_9),
+    [')'] = S(POS_0),
+    ['*'] = S(POS_8),
+    ['+'] = S(POS_RBRACKET),
+    [','] = POS_W,
+    ['-'] = POS_APOSTROPHE,
+    ['.'] = POS_E,
+    ['/'] = POS_LBRACKET,
+    ['0'] = POS_0,
+    ['1'] = POS_1,
+    ['2'] = POS_2,
+    ['3'] = POS_3,
+    ['4'] = POS_4,
+    ['5'] = POS_5,
+    ['6'] = POS_6,
+    ['7'] = POS_7,
+    ['8'] = POS_8,
+    ['9'] = POS_9,
+    [':'] = S(POS_Z),
+    [';'] = POS_Z,
+    ['<'] = S(POS_W),
+    ['='] = POS_RBRACKET,
+    ['>'] = S(POS_E),
+    ['?'] = S(POS_LBRACKET),
+    ['@'] = S(POS_2),
+    ['A'] = S(POS_A),
+    ['B'] = S(POS_N),
+    ['C'] = S(POS_I),
+    ['D'] = S(POS_H),
+    ['E'] = S(POS_D),
+    ['F'] = S(POS_Y),
+    ['G'] = S(POS_U),
+    ['H'] = S(POS_J),
+    ['I'] = S(POS_G),
+    ['J'] = S(POS_C),
+    ['K'] = S(POS_V),
+    ['L'] = S(POS_P),
+    ['M'] = S(POS_M),
+    ['N'] = S(POS_L),
+    ['O'] = S(POS_S),
+    ['P'] = S(POS_R),
+    ['Q'] = S(POS_X),
+    ['R'] = S(POS_O),
+    ['S'] = S(POS_SEMICOLON),
+    ['T'] = S(POS_K),
+    ['U'] = S(POS_F),
+    ['V'] = S(POS_DOT),
+    ['W'] = S(POS_COMMA),
+    ['X'] = S(POS_B),
+    ['Y'] = S(POS_T),
+    ['Z'] = S(POS_SLASH),
+    ['['] = POS_MINUS,
+    ['\\'] = POS_BACKSLASH,
+    [']'] = POS_EQUAL,
+    ['^'] = S(POS_6),
+    ['_'] = S(POS_APOSTROPHE),
+    ['`'] = POS_GRAVE,
+    ['a'] = POS_A,
+    ['b'] = POS_N,
+    ['c'] = POS_I,
+    ['d'] = POS_H,
+    ['e'] = POS_D,
+    ['f'] = POS_Y,
+    ['g'] = POS_U,
+    ['h'] = POS_J,
+    ['i'] = POS_G,
+    ['j'] = POS_C,
+    ['k'] = POS_V,
+    ['l'] = POS_P,
+    ['m'] = POS_M,
+    ['n'] = POS_L,
+    ['o'] = POS_S,
+    ['p'] = POS_R,
+    ['q'] = POS_X,
+    ['r'] = POS_O,
+    ['s'] = POS_SEMICOLON,
+    ['t'] = POS_K,
+    ['u'] = POS_F,
+    ['v'] = POS_DOT,
+    ['w'] = POS_COMMA,
+    ['x'] = POS_B,
+    ['y'] = POS_T,
+    ['z'] = POS_SLASH,
+    ['{'] = S(POS_MINUS),
+    ['|'] = S(POS_BACKSLASH),
+    ['}'] = S(POS_EQUAL),
+    ['~'] = S(POS_GRAVE),
+};
+
+// Multi-stroke entries of the tables above, SEQ() gives the offset.
+// Entries are a stroke count followed by the strokes
+static const uint16_t layout_sequences_azerty[] = {
+    2, AG(POS_7), POS_SPACE, // ` (0)
+    2, AG(POS_2), POS_SPACE, // ~ (3)
+};
+
+static const uint16_t layout_sequences_qwertz[] = {
+    2, POS_GRAVE, POS_SPACE, // ^ (0)
+    2, S(POS_EQUAL), POS_SPACE, // ` (3)
+};
+
+static const uint16_t layout_sequences_hungarian[] = {
+    2, AG(POS_3), POS_SPACE, // ^ (0)
+    2, AG(POS_7), POS_SPACE, // ` (3)
+    2, AG(POS_1), POS_SPACE, // ~ (6)
+};
+
+// Characters above ASCII with a key of their own, sorted by code point.
+// Only non-dead keys, so each entry types exactly one character.
+static const FlipperWedgeLayoutUnicodeKey layout_unicode_azerty[] = {
+    {0x00A3, S(POS_RBRACKET)}, // £
+    {0x00A4, AG(POS_RBRACKET)}, // ¤
+    {0x00A7, S(POS_SLASH)}, // §
+    {0x00B0, S(POS_MINUS)}, // °
+    {0x00B2, POS_GRAVE}, // ²
+    {0x00B5, S(POS_BACKSLASH)}, // µ
+    {0x00E0, POS_0}, // à
+    {0x00E7, POS_9}, // ç
+    {0x00E8, POS_7}, // è
+    {0x00E9, POS_2}, // é
+    {0x00F9, POS_APOSTROPHE}, // ù
+    {0x20AC, AG(POS_E)}, // €
+};
+
+static const FlipperWedgeLayoutUnicodeKey layout_unicode_qwertz[] = {
+    {0x00A7, S(POS_3)}, // §
+    {0x00B0, S(POS_GRAVE)}, // °
+    {0x00B2, AG(POS_2)}, // ²
+    {0x00B3, AG(POS_3)}, // ³
+    {0x00B5, AG(POS_M)}, // µ
+    {0x00C4, S(POS_APOSTROPHE)}, // Ä
+    {0x00D6, S(POS_SEMICOLON)}, // Ö
+    {0x00DC, S(POS_LBRACKET)}, // Ü
+    {0x00DF, POS_MINUS}, // ß
+    {0x00E4, POS_APOSTROPHE}, // ä
+    {0x00F6, POS_SEMICOLON}, // ö
+    {0x00FC, POS_LBRACKET}, // ü
+    {0x20AC, AG(POS_E)}, // €
+};
+
+static const FlipperWedgeLayoutUnicodeKey layout_unicode_hungarian[] = {
+    {0x00A7, S(POS_GRAVE)}, // §
+    {0x00C1, S(POS_APOSTROPHE)}, // Á
+    {0x00C9, S(POS_SEMICOLON)}, // É
+    {0x00CD, S(POS_NONUS_BACKSLASH)}, // Í
+    {0x00D3, S(POS_EQUAL)}, // Ó
+    {0x00D6, S(POS_0)}, // Ö
+    {0x00DA, S(POS_RBRACKET)}, // Ú
+    {0x00DC, S(POS_MINUS)}, // Ü
+    {0x00E1, POS_APOSTROPHE}, // á
+    {0x00E9, POS_SEMICOLON}, // é
+    {0x00ED, POS_NONUS_BACKSLASH}, // í
+    {0x00F3, POS_EQUAL}, // ó
+    {0x00F6, POS_0}, // ö
+    {0x00FA, POS_RBRACKET}, // ú
+    {0x00FC, POS_MINUS}, // ü
+    {0x0150, S(POS_LBRACKET)}, // Ő
+    {0x0151, POS_LBRACKET}, // ő
+    {0x0170, S(POS_BACKSLASH)}, // Ű
+    {0x0171, POS_BACKSLASH}, // ű
+    {0x20AC, AG(POS_U)}, // €
+};
+
+const FlipperWedgeLayoutUnicodeKey*
+    flipper_wedge_keyboard_layout_unicode_table(FlipperWedgeLayoutType type, size_t* count) {
+    furi_assert(count);
+
+    switch(type) {
+    case FlipperWedgeLayoutAzerty:
+        *count = COUNT_OF(layout_unicode_azerty);
+        return layout_unicode_azerty;
+    case FlipperWedgeLayoutQwertz:
+        *count = COUNT_OF(layout_unicode_qwertz);
+        return layout_unicode_qwertz;
+    case FlipperWedgeLayoutHungarian:
+        *count = COUNT_OF(layout_unicode_hungarian);
+        return layout_unicode_hungarian;
+    default:
+        // US legends only
+        *count = 0;
+        return NULL;
+    }
+}
+
+const uint16_t* flipper_wedge_keyboard_layout_sequences(FlipperWedgeLayoutType type) {
+    switch(type) {
+    case FlipperWedgeLayoutAzerty:
+        return layout_sequences_azerty;
+    case FlipperWedgeLayoutQwertz:
+        return layout_sequences_qwertz;
+    case FlipperWedgeLayoutHungarian:
+        return layout_sequences_hungarian;
+    default:
+        return NULL;
+    }
+}
+
+const uint16_t* flipper_wedge_keyboard_layout_table(FlipperWedgeLayoutType type) {
+    switch(type) {
+    case FlipperWedgeLayoutNumPad:
+        return layout_table_numpad;
+    case FlipperWedgeLayoutAzerty:
+        return layout_table_azerty;
+    case FlipperWedgeLayoutQwertz:
+        return layout_table_qwertz;
+    case FlipperWedgeLayoutHungarian:
+        return layout_table_hungarian;
+    case FlipperWedgeLayoutDvorak:
+        return layout_table_dvorak;
+    case FlipperWedgeLayoutDefault:
+    default:
+        // Firmware map is used as is
+        return NULL;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "flipper_wedge_keyboard_layout.h"
+
+/** Get the const keycode table of a built-in layout
+ *
+ * @param type Built-in layout type
+ * @return Table of FLIPPER_WEDGE_LAYOUT_TABLE_SIZE keycodes in flash,
+ *         NULL for Default (firmware map) and Custom
+ */
+const uint16_t* flipper_wedge_keyboard_layout_table(FlipperWedgeLayoutType type);
+
+/** Get the sequence pool of a built-in layout
+ * Table entries with FLIPPER_WEDGE_LAYOUT_SEQUENCE_FLAG index into it.
+ *
+ * @param type Built-in layout type
+ * @return Pool in flash, NULL if the layout has no multi-stroke characters
+ */
+const uint16_t* flipper_wedge_keyboard_layout_sequences(FlipperWedgeLayoutType type);
+
+// Key for a character above ASCII on a built-in layout
+typedef struct {
+    uint16_t codepoint;
+    uint16_t keycode;
+} FlipperWedgeLayoutUnicodeKey;
+
+/** Get the keys a built-in layout has for characters above ASCII
+ *
+ * @param type Built-in layout type
+ * @param count Filled in with the number of entries
+ * @return Entries sorted by code point, NULL if the layout has none
+ */
+const FlipperWedgeLayoutUnicodeKey*
+    flipper_wedge_keyboard_layout_unicode_table(FlipperWedgeLayoutType type, size_t* count);
@@ -0,0 +1,146 @@
+#include "flipper_wedge_keystream.h"
+
+#define TAG "FlipperWedgeKeystream"
+
+// Marker nibble bit -> HID modifier byte
+static const uint8_t keystream_modifier_bits[] = {
+    KEY_MOD_LEFT_CTRL >> 8,
+    KEY_MOD_LEFT_SHIFT >> 8,
+    KEY_MOD_LEFT_ALT >> 8,
+    KEY_MOD_RIGHT_ALT >> 8,
+};
+
+// Encode HID modifier byte as marker, false if it uses a modifier with no marker bit
+static bool flipper_wedge_keystream_encode_modifiers(uint8_t modifiers, uint8_t* marker) {
+    uint8_t nibble = 0;
+    for(uint8_t bit = 0; bit < COUNT_OF(keystream_modifier_bits); bit++) {
+        if(modifiers & keystream_modifier_bits[bit]) {
+            nibble |= (1 << bit);
+            modifiers &= ~keystream_modifier_bits[bit];
+        }
+    }
+    if(modifiers) return false;
+
+    *marker = FLIPPER_WEDGE_KEYSTREAM_MODIFIER_MARKER | nibble;
+    return true;
+}
+
+void flipper_wedge_keystream_init(FlipperWedgeKeystream* stream, uint8_t* buffer, size_t size) {
+    furi_assert(stream);
+    furi_assert(buffer);
+
+    stream->data = buffer;
+    stream->size = size;
+    stream->len = 0;
+    stream->keys = 0;
+    stream->modifiers = 0;
+}
+
+bool flipper_wedge_keystream_append_key(FlipperWedgeKeystream* stream, uint16_t keycode) {
+    furi_assert(stream);
+
+    if(keycode == FLIPPER_WEDGE_KEYSTREAM_RELEASE) {
+        if(stream->len + 1 > stream->size) return false;
+        stream->data[stream->len++] = FLIPPER_WEDGE_KEYSTREAM_RELEASE;
+        return true;
+    }
+
+    uint8_t usage = keycode & 0xFF;
+    uint8_t modifiers = (keycode >> 8) & 0xFF;
+
+    if(usage == HID_KEYBOARD_NONE || !flipper_wedge_keystream_is_key(usage)) return false;
+
+    if(modifiers != stream->modifiers) {
+        uint8_t marker;
+        if(!flipper_wedge_keystream_encode_modifiers(modifiers, &marker)) return false;
+        if(stream->len + 2 > stream->size) return false;
+        stream->data[stream->len++] = marker;
+        stream->modifiers = modifiers;
+    } else if(stream->len + 1 > stream->size) {
+        return false;
+    }
+
+    stream->data[stream->len++] = usage;
+    stream->keys++;
+    return true;
+}
+
+size_t flipper_wedge_keystream_append_char(
+    FlipperWedgeKeystream* stream,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    size_t len) {
+    furi_assert(stream);
+    furi_assert(text || len == 0);
+
+    if(len == 0 || text[0] == '\0') return 0;
+
+    const uint16_t* keys = NULL;
+    uint16_t ascii_keys[FLIPPER_WEDGE_LAYOUT_STROKES_MAX];
+    uint32_t codepoint = (uint8_t)text[0];
+    size_t bytes = 1;
+    uint8_t count;
+
+    if(codepoint >= 0x80) {
+        bytes = flipper_wedge_unicode_decode_utf8(text, len, &codepoint);
+        if(bytes == 0) return 0; // Rest of the character is beyond len
+        count = (layout && codepoint) ? flipper_wedge_unicode_sequence(layout, codepoint, &keys) : 0;
+    } else if(layout) {
+        count = flipper_wedge_keyboard_layout_get_keys(layout, text[0], ascii_keys);
+        keys = ascii_keys;
+    } else {
+        ascii_keys[0] = HID_ASCII_TO_KEY(text[0]);
+        count = ascii_keys[0] != HID_KEYBOARD_NONE;
+        keys = ascii_keys;
+    }
+
+    // Roll back to here if any key doesn't go in
+    size_t len_before = stream->len;
+    size_t keys_before = stream->keys;
+    uint8_t modifiers_before = stream->modifiers;
+
+    for(uint8_t i = 0; i < count; i++) {
+        if(flipper_wedge_keystream_append_key(stream, keys[i])) continue;
+
+        stream->len = len_before;
+        stream->keys = keys_before;
+        stream->modifiers = modifiers_before;
+        if(stream->size - stream->len < FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX) {
+            // Out of room, the caller gets the character again with a fresh buffer
+            return 0;
+        }
+        FURI_LOG_W(TAG, "Can't encode keycode 0x%04X for U+%04lX, skipped", keys[i], codepoint);
+        break;
+    }
+    return bytes;
+}
+
+size_t flipper_wedge_keystream_append(
+    FlipperWedgeKeystream* stream,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    size_t len) {
+    furi_assert(stream);
+    furi_assert(text);
+
+    size_t consumed = 0;
+    while(consumed < len) {
+        size_t bytes = flipper_wedge_keystream_append_char(stream, layout, text + consumed, len - consumed);
+        if(bytes == 0) break;
+        consumed += bytes;
+    }
+
+    return consumed;
+}
+
+uint8_t flipper_wedge_keystream_get_modifiers(uint8_t byte) {
+    furi_assert(flipper_wedge_keystream_is_modifier(byte));
+
+    uint8_t modifiers = 0;
+    for(uint8_t bit = 0; bit < COUNT_OF(keystream_modifier_bits); bit++) {
+        if(byte & (1 << bit)) {
+            modifiers |= keystream_modifier_bits[bit];
+        }
+    }
+    return modifiers;
+}
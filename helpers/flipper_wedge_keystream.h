@@ -0,0 +1,124 @@
+#pragma once
+
+#include <furi.h>
+#include <furi_hal_usb_hid.h>
+#include "flipper_wedge_keyboard_layout.h"
+#include "flipper_wedge_unicode.h"
+
+/** Compiled keystroke stream
+ *
+ * Output text is translated through the keyboard layout once, up front, into
+ * a flat byte stream the typing loop can replay without any lookups:
+ *   0x00-0xEE  HID usage, typed with the current modifier state
+ *   0xEF       release point, the report ends here with everything released
+ *   0xF0-0xFF  modifier state change, low nibble holds the new state
+ *              (bit0 Left Ctrl, bit1 Left Shift, bit2 Left Alt, bit3 Right Alt/AltGr)
+ * A state byte is only emitted when the modifiers actually change, so a run
+ * like "ABCDEF" compiles to one Shift marker followed by six usages.
+ * Worst case is 2 bytes per key, with modifiers toggling on every key.
+ *
+ * Left Alt on its own stays held across reports until the state changes or
+ * a release point, so a Windows Alt code survives being split over reports.
+ * A character takes up to FLIPPER_WEDGE_LAYOUT_STROKES_MAX keys through the
+ * layout (dead keys) or FLIPPER_WEDGE_UNICODE_SEQUENCE_MAX keys as an input
+ * method sequence, see flipper_wedge_unicode.h.
+ */
+
+#define FLIPPER_WEDGE_KEYSTREAM_MODIFIER_MARKER 0xF0
+#define FLIPPER_WEDGE_KEYSTREAM_RELEASE 0xEF
+
+// Most bytes a single character can compile to
+#define FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX                                              \
+    (2 * (FLIPPER_WEDGE_UNICODE_SEQUENCE_MAX > FLIPPER_WEDGE_LAYOUT_STROKES_MAX ?     \
+              FLIPPER_WEDGE_UNICODE_SEQUENCE_MAX :                                    \
+              FLIPPER_WEDGE_LAYOUT_STROKES_MAX))
+
+// Buffer size guaranteed to hold the given number of characters plus Enter
+#define FLIPPER_WEDGE_KEYSTREAM_SIZE(chars) ((chars) * FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX + 2)
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t len;
+    size_t keys;       // Usages in the stream, one per key press
+    uint8_t modifiers; // HID modifier byte in effect at the end of the stream
+} FlipperWedgeKeystream;
+
+/** Start an empty stream on a caller-owned buffer
+ *
+ * @param stream FlipperWedgeKeystream instance
+ * @param buffer Storage for compiled bytes
+ * @param size Buffer size in bytes
+ */
+void flipper_wedge_keystream_init(FlipperWedgeKeystream* stream, uint8_t* buffer, size_t size);
+
+/** Compile one character into the stream
+ * Text is UTF-8. Characters above ASCII are typed as the layout's Unicode
+ * mode says, a NULL layout skips them. Unmappable characters and malformed
+ * bytes compile to nothing. A character goes in whole or not at all, half a
+ * dead key or input method entry would garble the characters after it.
+ * FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX bytes of room always fit a character.
+ *
+ * @param stream FlipperWedgeKeystream instance
+ * @param layout Keyboard layout for character mapping (NULL for firmware default)
+ * @param text Character to compile
+ * @param len Number of bytes in text
+ * @return Number of bytes consumed from text, 0 if the buffer is full, text
+ *         is empty or the character is cut off by len
+ */
+size_t flipper_wedge_keystream_append_char(
+    FlipperWedgeKeystream* stream,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    size_t len);
+
+/** Compile text into the stream
+ * Characters are compiled one by one as by flipper_wedge_keystream_append_char().
+ * Stops at a character boundary when the buffer is full, at a NUL, or when
+ * a multi-byte character is cut off by len.
+ *
+ * @param stream FlipperWedgeKeystream instance
+ * @param layout Keyboard layout for character mapping (NULL for firmware default)
+ * @param text Characters to compile
+ * @param len Number of bytes in text
+ * @return Number of bytes consumed from text
+ */
+size_t flipper_wedge_keystream_append(
+    FlipperWedgeKeystream* stream,
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    size_t len);
+
+/** Append a single keycode
+ *
+ * @param stream FlipperWedgeKeystream instance
+ * @param keycode HID keycode (lower 8 bits) + modifiers (upper 8 bits),
+ *                or FLIPPER_WEDGE_KEYSTREAM_RELEASE for a release point
+ * @return true if appended, false if the buffer is full or keycode can't be encoded
+ */
+bool flipper_wedge_keystream_append_key(FlipperWedgeKeystream* stream, uint16_t keycode);
+
+/** Check if a stream byte is a modifier state change
+ *
+ * @param byte Stream byte
+ * @return true for a modifier marker, false for a HID usage
+ */
+static inline bool flipper_wedge_keystream_is_modifier(uint8_t byte) {
+    return (byte & 0xF0) == FLIPPER_WEDGE_KEYSTREAM_MODIFIER_MARKER;
+}
+
+/** Check if a stream byte is a HID usage
+ *
+ * @param byte Stream byte
+ * @return true for a usage, false for a modifier marker or release point
+ */
+static inline bool flipper_wedge_keystream_is_key(uint8_t byte) {
+    return byte < FLIPPER_WEDGE_KEYSTREAM_RELEASE;
+}
+
+/** Decode a modifier marker into a HID modifier byte
+ *
+ * @param byte Stream byte, flipper_wedge_keystream_is_modifier() must be true
+ * @return HID modifier byte (upper 8 bits of a keycode)
+ */
+uint8_t flipper_wedge_keystream_get_modifiers(uint8_t byte);
@@ -0,0 +1,470 @@
+#include "flipper_wedge_ndef.h"
+
+#define TAG "FlipperWedgeNdef"
+
+// Record header flags
+#define NDEF_FLAG_MB 0x80 // Message begin
+#define NDEF_FLAG_ME 0x40 // Message end
+#define NDEF_FLAG_CF 0x20 // Chunk follows
+#define NDEF_FLAG_SR 0x10 // Short record, 1-byte payload length
+#define NDEF_FLAG_IL 0x08 // ID length present
+#define NDEF_TNF_MASK 0x07
+
+// TLV types in Type 2/5 tag memory
+#define NDEF_TLV_NULL 0x00
+#define NDEF_TLV_MESSAGE 0x03
+#define NDEF_TLV_TERMINATOR 0xFE
+
+// One record or chunk as laid out in the message
+typedef struct {
+    uint8_t header;
+    uint8_t type_len;
+    uint8_t id_len;
+    size_t type_offset;
+    size_t id_offset;
+    size_t payload_offset;
+    size_t payload_len;
+    size_t next; // Offset after the payload
+} NdefChunk;
+
+// Header, type and id of a record or chunk, the payload may be cut off
+static bool ndef_parse_header(const uint8_t* data, size_t len, size_t pos, NdefChunk* chunk) {
+    if(pos + 3 > len) return false;
+    chunk->header = data[pos++];
+    chunk->type_len = data[pos++];
+
+    if(chunk->header & NDEF_FLAG_SR) {
+        chunk->payload_len = data[pos++];
+    } else {
+        if(pos + 4 > len) return false;
+        chunk->payload_len = ((uint32_t)data[pos] << 24) | ((uint32_t)data[pos + 1] << 16) |
+                             ((uint32_t)data[pos + 2] << 8) | data[pos + 3];
+        pos += 4;
+    }
+
+    chunk->id_len = 0;
+    if(chunk->header & NDEF_FLAG_IL) {
+        if(pos >= len) return false;
+        chunk->id_len = data[pos++];
+    }
+
+    chunk->type_offset = pos;
+    chunk->id_offset = chunk->type_offset + chunk->type_len;
+    chunk->payload_offset = chunk->id_offset + chunk->id_len;
+    if(chunk->payload_offset > len) return false;
+    chunk->next = chunk->payload_offset + chunk->payload_len;
+    return true;
+}
+
+static bool ndef_parse_chunk(const uint8_t* data, size_t len, size_t pos, NdefChunk* chunk) {
+    return ndef_parse_header(data, len, pos, chunk) &&
+           chunk->payload_len <= len - chunk->payload_offset;
+}
+
+void flipper_wedge_ndef_iter_init(FlipperWedgeNdefIterator* it, const uint8_t* data, size_t data_len) {
+    furi_assert(it);
+    it->message = data;
+    it->message_len = data ? data_len : 0;
+    it->pos = 0;
+    it->done = it->message_len == 0;
+}
+
+bool flipper_wedge_ndef_iter_init_tlv(FlipperWedgeNdefIterator* it, const uint8_t* data, size_t data_len) {
+    furi_assert(it);
+    flipper_wedge_ndef_iter_init(it, NULL, 0);
+    if(!data) return false;
+
+    size_t pos = 0;
+    while(pos < data_len) {
+        uint8_t type = data[pos++];
+        if(type == NDEF_TLV_NULL) continue;
+        if(type == NDEF_TLV_TERMINATOR) break;
+
+        if(pos >= data_len) break;
+        size_t len = data[pos++];
+        if(len == 0xFF) {
+            if(pos + 2 > data_len) break;
+            len = (data[pos] << 8) | data[pos + 1];
+            pos += 2;
+        }
+
+        if(type == NDEF_TLV_MESSAGE) {
+            if(len > data_len - pos) {
+                FURI_LOG_D(TAG, "NDEF TLV cut off at %zu of %zu bytes", data_len - pos, len);
+                len = data_len - pos;
+            }
+            flipper_wedge_ndef_iter_init(it, &data[pos], len);
+            return len > 0;
+        }
+
+        // Lock and memory control TLVs, proprietary TLVs
+        if(len > data_len - pos) break;
+        pos += len;
+    }
+    return false;
+}
+
+bool flipper_wedge_ndef_iter_next(FlipperWedgeNdefIterator* it, FlipperWedgeNdefRecord* record) {
+    furi_assert(it);
+    furi_assert(record);
+    if(it->done) return false;
+
+    const uint8_t* data = it->message;
+    NdefChunk chunk;
+    bool truncated = false;
+    if(!ndef_parse_chunk(data, it->message_len, it->pos, &chunk)) {
+        // A record cut off by the end of data comes with the part that is there
+        if(!ndef_parse_header(data, it->message_len, it->pos, &chunk) ||
+           (chunk.header & NDEF_FLAG_CF)) {
+            FURI_LOG_W(TAG, "Malformed record at %zu", it->pos);
+            it->done = true;
+            return false;
+        }
+        chunk.payload_len = it->message_len - chunk.payload_offset;
+        chunk.next = it->message_len;
+        truncated = true;
+    }
+
+    record->tnf = chunk.header & NDEF_TNF_MASK;
+    record->message_begin = chunk.header & NDEF_FLAG_MB;
+    record->chunked = chunk.header & NDEF_FLAG_CF;
+    record->truncated = truncated;
+    record->type = &data[chunk.type_offset];
+    record->type_len = chunk.type_len;
+    record->id = chunk.id_len ? &data[chunk.id_offset] : NULL;
+    record->id_len = chunk.id_len;
+    record->payload = &data[chunk.payload_offset];
+    record->payload_chunk_len = chunk.payload_len;
+    record->payload_len = chunk.payload_len;
+    record->message = data;
+    record->message_len = it->message_len;
+    record->offset = it->pos;
+
+    // Middle and last chunks carry no type, only more payload
+    while(chunk.header & NDEF_FLAG_CF) {
+        size_t pos = chunk.next;
+        if(!ndef_parse_chunk(data, it->message_len, pos, &chunk) ||
+           (chunk.header & NDEF_TNF_MASK) != FLIPPER_WEDGE_NDEF_TNF_UNCHANGED || chunk.type_len != 0) {
+            FURI_LOG_W(TAG, "Malformed chunk at %zu", pos);
+            it->done = true;
+            return false;
+        }
+        record->payload_len += chunk.payload_len;
+    }
+
+    record->message_end = chunk.header & NDEF_FLAG_ME;
+    it->pos = chunk.next;
+    it->done = record->message_end || it->pos >= it->message_len;
+    return true;
+}
+
+size_t flipper_wedge_ndef_record_copy(
+    const FlipperWedgeNdefRecord* record,
+    size_t offset,
+    uint8_t* output,
+    size_t len) {
+    furi_assert(record);
+    furi_assert(output || len == 0);
+
+    // Unchunked records, the common case, are a single copy
+    if(!record->chunked) {
+        if(offset >= record->payload_len) return 0;
+        len = MIN(len, record->payload_len - offset);
+        memcpy(output, record->payload + offset, len);
+        return len;
+    }
+
+    // Chunks were validated when the record was returned
+    size_t copied = 0;
+    size_t pos = record->offset;
+    NdefChunk chunk;
+    do {
+        ndef_parse_chunk(record->message, record->message_len, pos, &chunk);
+        if(offset < chunk.payload_len) {
+            size_t part = MIN(len - copied, chunk.payload_len - offset);
+            memcpy(output + copied, &record->message[chunk.payload_offset + offset], part);
+            copied += part;
+            offset = 0;
+        } else {
+            offset -= chunk.payload_len;
+        }
+        pos = chunk.next;
+    } while((chunk.header & NDEF_FLAG_CF) && copied < len);
+
+    return copied;
+}
+
+bool flipper_wedge_ndef_record_is(const FlipperWedgeNdefRecord* record, uint8_t tnf, const char* type) {
+    furi_assert(record);
+    furi_assert(type);
+    size_t type_len = strlen(type);
+    return record->tnf == tnf && record->type_len == type_len &&
+           memcmp(record->type, type, type_len) == 0;
+}
+
+// URI identifier codes, NFC Forum URI RTD
+static const char* const ndef_uri_prefixes[] = {
+    "",
+    "http://www.",
+    "https://www.",
+    "http://",
+    "https://",
+    "tel:",
+    "mailto:",
+    "ftp://anonymous:anonymous@",
+    "ftp://ftp.",
+    "ftps://",
+    "sftp://",
+    "smb://",
+    "nfs://",
+    "ftp://",
+    "dav://",
+    "news:",
+    "telnet://",
+    "imap:",
+    "rtsp://",
+    "urn:",
+    "pop:",
+    "sip:",
+    "sips:",
+    "tftp:",
+    "btspp://",
+    "btl2cap://",
+    "btgoep://",
+    "tcpobex://",
+    "irdaobex://",
+    "file://",
+    "urn:epc:id:",
+    "urn:epc:tag:",
+    "urn:epc:pat:",
+    "urn:epc:raw:",
+    "urn:epc:",
+    "urn:nfc:",
+};
+
+static const char* ndef_select_names[] = {
+    [FlipperWedgeNdefSelectText] = "Text",
+    [FlipperWedgeNdefSelectUri] = "URI",
+    [FlipperWedgeNdefSelectMime] = "MIME",
+    [FlipperWedgeNdefSelectAll] = "All",
+};
+
+// Record kinds the selector outputs
+typedef enum {
+    NdefKindNone,
+    NdefKindText,
+    NdefKindUri,
+    NdefKindMime,
+} NdefKind;
+
+// Record kind each selection outputs
+static const NdefKind ndef_select_kinds[] = {
+    [FlipperWedgeNdefSelectText] = NdefKindText,
+    [FlipperWedgeNdefSelectUri] = NdefKindUri,
+    [FlipperWedgeNdefSelectMime] = NdefKindMime,
+    [FlipperWedgeNdefSelectAll] = NdefKindNone, // Any
+};
+
+// Output being written by the selector
+typedef struct {
+    char* output;
+    size_t space; // Without terminator
+    size_t pos;
+} NdefWriter;
+
+static void ndef_write(NdefWriter* writer, const char* text, size_t len) {
+    len = MIN(len, writer->space - writer->pos);
+    memcpy(writer->output + writer->pos, text, len);
+    writer->pos += len;
+}
+
+static void ndef_write_payload(NdefWriter* writer, const FlipperWedgeNdefRecord* record, size_t offset) {
+    writer->pos += flipper_wedge_ndef_record_copy(
+        record, offset, (uint8_t*)writer->output + writer->pos, writer->space - writer->pos);
+}
+
+// First payload byte, the first chunk can be empty
+static uint8_t ndef_payload_byte(const FlipperWedgeNdefRecord* record) {
+    uint8_t byte = 0;
+    flipper_wedge_ndef_record_copy(record, 0, &byte, 1);
+    return byte;
+}
+
+static bool ndef_record_is_mime(const FlipperWedgeNdefRecord* record, const char* mime_type) {
+    return mime_type && mime_type[0] != '\0' && record->tnf == FLIPPER_WEDGE_NDEF_TNF_MEDIA &&
+           record->type_len == strlen(mime_type) &&
+           strncasecmp((const char*)record->type, mime_type, record->type_len) == 0;
+}
+
+// Kind of a record, a Smart Poster is replaced by the URI record inside it
+static NdefKind ndef_classify(
+    const FlipperWedgeNdefRecord* record,
+    const char* mime_type,
+    FlipperWedgeNdefRecord* target) {
+    *target = *record;
+
+    if(flipper_wedge_ndef_record_is(record, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T")) {
+        // [status byte][language code][text]
+        if(record->payload_len == 0) return NdefKindNone;
+        size_t lang_len = ndef_payload_byte(record) & 0x3F;
+        return (1 + lang_len <= record->payload_len) ? NdefKindText : NdefKindNone;
+    }
+    if(flipper_wedge_ndef_record_is(record, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "U")) {
+        // [identifier code][rest of the URI]
+        return record->payload_len > 0 ? NdefKindUri : NdefKindNone;
+    }
+    if(flipper_wedge_ndef_record_is(record, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "Sp")) {
+        // Payload is a message of its own, only walked when it is in one piece
+        if(record->chunked) return NdefKindNone;
+        FlipperWedgeNdefIterator it;
+        flipper_wedge_ndef_iter_init(&it, record->payload, record->payload_len);
+        FlipperWedgeNdefRecord inner;
+        while(flipper_wedge_ndef_iter_next(&it, &inner)) {
+            if(flipper_wedge_ndef_record_is(&inner, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "U") &&
+               inner.payload_len > 0) {
+                *target = inner;
+                return NdefKindUri;
+            }
+        }
+        return NdefKindNone;
+    }
+    if(ndef_record_is_mime(record, mime_type)) {
+        return NdefKindMime;
+    }
+    return NdefKindNone;
+}
+
+static void ndef_write_record(NdefWriter* writer, NdefKind kind, const FlipperWedgeNdefRecord* record) {
+    switch(kind) {
+    case NdefKindText:
+        ndef_write_payload(writer, record, 1 + (ndef_payload_byte(record) & 0x3F));
+        break;
+    case NdefKindUri: {
+        const char* prefix = flipper_wedge_ndef_uri_prefix(ndef_payload_byte(record));
+        ndef_write(writer, prefix, strlen(prefix));
+        ndef_write_payload(writer, record, 1);
+        break;
+    }
+    case NdefKindMime:
+        ndef_write_payload(writer, record, 0);
+        break;
+    case NdefKindNone:
+        break;
+    }
+}
+
+const char* flipper_wedge_ndef_uri_prefix(uint8_t code) {
+    return code < COUNT_OF(ndef_uri_prefixes) ? ndef_uri_prefixes[code] : "";
+}
+
+size_t flipper_wedge_ndef_select(
+    FlipperWedgeNdefIterator* it,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type,
+    char* output,
+    size_t output_size) {
+    furi_assert(it);
+
+    if(!output || output_size == 0) return 0;
+
+    furi_check(select < FlipperWedgeNdefSelectCount);
+
+    NdefWriter writer = {.output = output, .space = output_size - 1, .pos = 0};
+    bool found = false;
+    FlipperWedgeNdefRecord record;
+    FlipperWedgeNdefRecord target;
+
+    while(writer.pos < writer.space && flipper_wedge_ndef_iter_next(it, &record)) {
+        NdefKind kind = ndef_classify(&record, mime_type, &target);
+        if(kind == NdefKindNone) continue;
+
+        if(select == FlipperWedgeNdefSelectAll) {
+            if(found) ndef_write(&writer, "\n", 1);
+            ndef_write_record(&writer, kind, &target);
+            found = true;
+        } else if(kind == ndef_select_kinds[select]) {
+            ndef_write_record(&writer, kind, &target);
+            break;
+        }
+    }
+
+    output[writer.pos] = '\0';
+    return writer.pos;
+}
+
+// Characters of text that survive flipper_wedge_sanitize_text(), multi-byte
+// sequences only count once all their bytes are there
+static size_t ndef_count_chars(const uint8_t* text, size_t len) {
+    size_t chars = 0;
+    size_t i = 0;
+    while(i < len) {
+        uint8_t c = text[i];
+        size_t bytes = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+        if(i + bytes > len) break;
+        if(bytes == 1) {
+            if((c >= 0x20 && c <= 0x7E) || c == '\t' || c == '\n') chars++;
+        } else if(c != 0xC2 || text[i + 1] >= 0xA0) {
+            // Everything above ASCII but the C1 controls
+            chars++;
+        }
+        i += bytes;
+    }
+    return chars;
+}
+
+// Characters a record adds to the output, as far as it was read
+static size_t ndef_record_chars(NdefKind kind, const FlipperWedgeNdefRecord* record) {
+    const uint8_t* payload = record->payload;
+    size_t len = record->payload_chunk_len;
+    switch(kind) {
+    case NdefKindText: {
+        size_t skip = 1 + (payload[0] & 0x3F);
+        return ndef_count_chars(payload + skip, len - skip);
+    }
+    case NdefKindUri:
+        return strlen(flipper_wedge_ndef_uri_prefix(payload[0])) +
+               ndef_count_chars(payload + 1, len - 1);
+    case NdefKindMime:
+        return ndef_count_chars(payload, len);
+    case NdefKindNone:
+        break;
+    }
+    return 0;
+}
+
+bool flipper_wedge_ndef_select_complete(
+    FlipperWedgeNdefIterator* it,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type,
+    size_t max_chars) {
+    furi_assert(it);
+    furi_check(select < FlipperWedgeNdefSelectCount);
+
+    size_t chars = 0;
+    bool found = false;
+    FlipperWedgeNdefRecord record;
+    FlipperWedgeNdefRecord target;
+
+    while(flipper_wedge_ndef_iter_next(it, &record)) {
+        // Chunked records are only returned whole, their payload is read in full
+        NdefKind kind = ndef_classify(&record, mime_type, &target);
+        if(kind != NdefKindNone &&
+           (select == FlipperWedgeNdefSelectAll || kind == ndef_select_kinds[select])) {
+            if(found) chars++; // Line break between records
+            found = true;
+            if(!target.chunked) chars += ndef_record_chars(kind, &target);
+            if(max_chars > 0 && chars >= max_chars) return true;
+            if(select != FlipperWedgeNdefSelectAll) return !record.truncated;
+        }
+        if(record.truncated) return false;
+        if(record.message_end) return true;
+    }
+    return false;
+}
+
+const char* flipper_wedge_ndef_select_name(FlipperWedgeNdefSelect select) {
+    if(select >= FlipperWedgeNdefSelectCount) {
+        return "Unknown";
+    }
+    return ndef_select_names[select];
+}
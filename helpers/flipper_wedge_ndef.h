@@ -0,0 +1,164 @@
+#pragma once
+
+#include <furi.h>
+
+// Type Name Format values
+#define FLIPPER_WEDGE_NDEF_TNF_EMPTY 0x00
+#define FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN 0x01
+#define FLIPPER_WEDGE_NDEF_TNF_MEDIA 0x02
+#define FLIPPER_WEDGE_NDEF_TNF_URI 0x03
+#define FLIPPER_WEDGE_NDEF_TNF_EXTERNAL 0x04
+#define FLIPPER_WEDGE_NDEF_TNF_UNKNOWN 0x05
+#define FLIPPER_WEDGE_NDEF_TNF_UNCHANGED 0x06 // Middle and last chunks
+
+/** One NDEF record, pointing into the buffer being iterated
+ * Nothing is copied. A chunked record is reported once, with the type and
+ * id of its first chunk and the payload length of all chunks together;
+ * payload only covers the first chunk, read the rest with
+ * flipper_wedge_ndef_record_copy(). A record cut off by the end of the
+ * data is truncated, its payload_len covers what is there.
+ */
+typedef struct {
+    uint8_t tnf;
+    bool message_begin;
+    bool message_end;
+    bool chunked;
+    bool truncated; // Payload cut off by the end of data
+    const uint8_t* type;
+    uint8_t type_len;
+    const uint8_t* id;
+    uint8_t id_len;
+    const uint8_t* payload; // First chunk
+    size_t payload_chunk_len;
+    size_t payload_len; // All chunks
+
+    // Where the record starts, for walking its chunks
+    const uint8_t* message;
+    size_t message_len;
+    size_t offset;
+} FlipperWedgeNdefRecord;
+
+// Record iterator over an NDEF message
+typedef struct {
+    const uint8_t* message;
+    size_t message_len;
+    size_t pos;
+    bool done;
+} FlipperWedgeNdefIterator;
+
+/** Iterate a bare NDEF message, as read from a Type 4 NDEF file
+ *
+ * @param it Iterator to set up
+ * @param data Message bytes, must outlive the iterator and its records
+ * @param data_len Length of data
+ */
+void flipper_wedge_ndef_iter_init(FlipperWedgeNdefIterator* it, const uint8_t* data, size_t data_len);
+
+/** Iterate the NDEF message TLV of Type 2/5 tag memory
+ * A message TLV cut off by the end of data is iterated as far as it goes.
+ *
+ * @param it Iterator to set up
+ * @param data Tag memory starting at the first TLV
+ * @param data_len Length of data
+ * @return true if an NDEF message TLV was found
+ */
+bool flipper_wedge_ndef_iter_init_tlv(FlipperWedgeNdefIterator* it, const uint8_t* data, size_t data_len);
+
+/** Get the next record
+ * Stops after the record flagged message end, at the first malformed
+ * record, or after a record cut off by the end of data. A chunked record
+ * is only returned whole.
+ *
+ * @param it Iterator
+ * @param record Filled in with the record view
+ * @return true if a record was returned
+ */
+bool flipper_wedge_ndef_iter_next(FlipperWedgeNdefIterator* it, FlipperWedgeNdefRecord* record);
+
+/** Copy part of a record's payload, across chunks
+ *
+ * @param record Record from flipper_wedge_ndef_iter_next()
+ * @param offset Payload offset to start at
+ * @param output Output buffer
+ * @param len Bytes to copy at most
+ * @return Bytes copied
+ */
+size_t flipper_wedge_ndef_record_copy(
+    const FlipperWedgeNdefRecord* record,
+    size_t offset,
+    uint8_t* output,
+    size_t len);
+
+/** Check a record's TNF and type
+ *
+ * @param record Record
+ * @param tnf Type Name Format
+ * @param type Type string
+ * @return true if both match
+ */
+bool flipper_wedge_ndef_record_is(const FlipperWedgeNdefRecord* record, uint8_t tnf, const char* type);
+
+// Longest MIME type the record selector matches, including terminator
+#define FLIPPER_WEDGE_NDEF_MIME_TYPE_MAX_LEN 48
+
+// Which records of a message are output
+typedef enum {
+    FlipperWedgeNdefSelectText, // First text record
+    FlipperWedgeNdefSelectUri, // First URI record, also inside a Smart Poster
+    FlipperWedgeNdefSelectMime, // First MIME record of the given type
+    FlipperWedgeNdefSelectAll, // Every record of the kinds above, one per line
+    FlipperWedgeNdefSelectCount,
+} FlipperWedgeNdefSelect;
+
+/** Get the prefix a URI record identifier code stands for
+ *
+ * @param code First payload byte of a URI record
+ * @return Prefix, empty for 0 and reserved codes
+ */
+const char* flipper_wedge_ndef_uri_prefix(uint8_t code);
+
+/** Write the selected records of a message as text
+ * Text records give their text without the language code, URI records
+ * their full URI with the prefix expanded, MIME records their payload.
+ * Each byte is copied once, straight from the message into output; what
+ * doesn't fit is cut off.
+ *
+ * @param it Iterator, consumed
+ * @param select Records to output
+ * @param mime_type MIME type for FlipperWedgeNdefSelectMime and
+ *                  FlipperWedgeNdefSelectAll, matched case-insensitively, NULL or
+ *                  empty matches no MIME record
+ * @param output Output buffer
+ * @param output_size Size of output buffer
+ * @return Length of output, 0 if no record matched
+ */
+size_t flipper_wedge_ndef_select(
+    FlipperWedgeNdefIterator* it,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type,
+    char* output,
+    size_t output_size);
+
+/** Check if the start of a message already holds all the output needed
+ * Lets a reader stop before the end of a large tag: true once the message
+ * end was read, the selected record was read whole, or the selected
+ * records give at least max_chars characters of typed text.
+ *
+ * @param it Iterator over the data read so far, consumed
+ * @param select Records to output
+ * @param mime_type As for flipper_wedge_ndef_select()
+ * @param max_chars Characters that will be typed, 0 for no limit
+ * @return true if reading more can't change the typed output
+ */
+bool flipper_wedge_ndef_select_complete(
+    FlipperWedgeNdefIterator* it,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type,
+    size_t max_chars);
+
+/** Get the display name of a record selection
+ *
+ * @param select Record selection
+ * @return Name
+ */
+const char* flipper_wedge_ndef_select_name(FlipperWedgeNdefSelect select);
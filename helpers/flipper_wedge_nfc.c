@@ -1,4 +1,7 @@
 #include "flipper_wedge_nfc.h"
+#include "flipper_wedge_ndef.h"
+#include "flipper_wedge_nfc_t2.h"
+#include "flipper_wedge_nfc_t4.h"
 #include <furi_hal.h>
 #include <nfc/protocols/iso14443_3a/iso14443_3a_poller.h>
 #include <nfc/protocols/iso14443_4a/iso14443_4a.h>
@@ -12,22 +15,8 @@
 
 #define TAG "FlipperWedgeNfc"
 
-// Type 4 NDEF constants
-#define NDEF_T4_AID_LEN 7
-static const uint8_t NDEF_T4_AID[NDEF_T4_AID_LEN] = {
-    0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01
-};
-
-#define NDEF_T4_FILE_ID_CC 0xE103      // Capability Container
-#define NDEF_T4_FILE_ID_NDEF 0xE104    // NDEF Message
-
-// APDU retry configuration
-#define NDEF_T4_MAX_RETRIES 3          // Maximum retry attempts for APDU commands
-#define NDEF_T4_RETRY_DELAY_MS 15      // Delay between retries in milliseconds
-
-// APDU status codes
-#define APDU_SW1_SUCCESS 0x90
-#define APDU_SW2_SUCCESS 0x00
+// Frame wait time for Type 2 commands, as the MfUltralight poller uses
+#define FLIPPER_WEDGE_NFC_T2_FWT_FC 60000
 
 typedef enum {
     FlipperWedgeNfcStateIdle,
@@ -45,6 +34,9 @@ struct FlipperWedgeNfc {
 
     FlipperWedgeNfcState state;
     bool parse_ndef;
+    FlipperWedgeNdefSelect ndef_select;
+    char ndef_mime_type[FLIPPER_WEDGE_NDEF_MIME_TYPE_MAX_LEN];
+    size_t ndef_max_chars; // Typed at most, reads stop once they have this much
     NfcProtocol detected_protocol;
 
     FlipperWedgeNfcCallback callback;
@@ -56,509 +48,222 @@ struct FlipperWedgeNfc {
     FuriThreadId owner_thread;
 };
 
-// Simple NDEF text record parser
-// Returns number of bytes written to output, 0 if no text records found
-// Parse raw NDEF records (for Type 4 tags - no TLV wrapping)
-static size_t flipper_wedge_nfc_parse_raw_ndef_text(const uint8_t* data, size_t data_len, char* output, size_t output_max) {
-    if(!data || !output || data_len < 4 || output_max == 0) {
-        return 0;
-    }
-
-    size_t output_pos = 0;
-    size_t pos = 0;
-
-    // Parse NDEF message records directly (no TLV wrapper)
-    while(pos < data_len) {
-        // Read record header
-        if(pos + 1 > data_len) break;
-        uint8_t flags_tnf = data[pos++];
-
-        uint8_t tnf = flags_tnf & 0x07;
-        bool short_record = (flags_tnf & 0x10) != 0;
-        bool id_length_present = (flags_tnf & 0x08) != 0;
-        bool message_end = (flags_tnf & 0x40) != 0;
-
-        // Read type length
-        if(pos >= data_len) break;
-        uint8_t type_len = data[pos++];
-
-        // Read payload length
-        if(pos >= data_len) break;
-        uint32_t payload_len;
-        if(short_record) {
-            payload_len = data[pos++];
-        } else {
-            if(pos + 4 > data_len) break;
-            payload_len = (data[pos] << 24) | (data[pos + 1] << 16) |
-                         (data[pos + 2] << 8) | data[pos + 3];
-            pos += 4;
-        }
-
-        // Read ID length if present
-        uint8_t id_len = 0;
-        if(id_length_present) {
-            if(pos >= data_len) break;
-            id_len = data[pos++];
-        }
-
-        // Read type
-        if(pos + type_len > data_len) break;
-        const uint8_t* type = &data[pos];
-        pos += type_len;
-
-        // Skip ID
-        if(pos + id_len > data_len) break;
-        pos += id_len;
-
-        // Read payload
-        if(pos + payload_len > data_len) break;
-        const uint8_t* payload = &data[pos];
-        pos += payload_len;
-
-        // Check if this is a text record (TNF=0x01, Type='T')
-        if(tnf == 0x01 && type_len == 1 && type[0] == 'T' && payload_len > 1) {
-            FURI_LOG_I(TAG, "Type 4 NDEF: Found text record in raw NDEF");
-
-            // Text record format: [status byte][language code][text]
-            uint8_t status = payload[0];
-            uint8_t lang_len = status & 0x3F;
-
-            FURI_LOG_I(TAG, "Type 4 NDEF: Status=0x%02X, lang_len=%d, payload_len=%lu",
-                       status, lang_len, payload_len);
-
-            if((uint32_t)(lang_len + 1) <= payload_len) {
-                // Skip language code, extract text
-                const uint8_t* text = &payload[1 + lang_len];
-                size_t text_len = payload_len - 1 - lang_len;
-
-                FURI_LOG_I(TAG, "Type 4 NDEF: Text length=%zu", text_len);
-
-                // Copy text to output
-                size_t copy_len = text_len;
-                if(output_pos + copy_len >= output_max) {
-                    copy_len = output_max - output_pos - 1;
-                }
-                if(copy_len > 0) {
-                    memcpy(&output[output_pos], text, copy_len);
-                    output_pos += copy_len;
-                }
-            }
-        }
-
-        // Stop if this was the last record
-        if(message_end) break;
-    }
-
-    // Null-terminate
-    if(output_pos < output_max) {
-        output[output_pos] = '\0';
-    } else if(output_max > 0) {
-        output[output_max - 1] = '\0';
-    }
-
-    FURI_LOG_I(TAG, "Type 4 NDEF: Parsed %zu bytes of text", output_pos);
-    return output_pos;
+// Write the NDEF records selected in the settings, straight from the tag
+// data. Returns number of bytes written to output.
+static size_t flipper_wedge_nfc_select_ndef(
+    const FlipperWedgeNfc* instance,
+    FlipperWedgeNdefIterator* it,
+    char* output) {
+    size_t len = flipper_wedge_ndef_select(
+        it, instance->ndef_select, instance->ndef_mime_type, output, FLIPPER_WEDGE_NDEF_MAX_LEN);
+    FURI_LOG_D(TAG, "NDEF: %s records gave %zu bytes", flipper_wedge_ndef_select_name(instance->ndef_select), len);
+    return len;
 }
 
-// Parse TLV-wrapped NDEF records (for Type 2/5 tags)
-static size_t flipper_wedge_nfc_parse_ndef_text(const uint8_t* data, size_t data_len, char* output, size_t output_max) {
-    if(!data || !output || data_len < 4 || output_max == 0) {
-        return 0;
-    }
-
-    size_t output_pos = 0;
-    size_t pos = 0;
-
-    // Look for NDEF Message TLV (Type=0x03)
-    while(pos < data_len - 1) {
-        uint8_t tlv_type = data[pos++];
-
-        // Skip padding
-        if(tlv_type == 0x00) continue;
-
-        // Terminator found
-        if(tlv_type == 0xFE) break;
-
-        // Get length
-        if(pos >= data_len) break;
-        uint32_t tlv_len = data[pos++];
-        if(tlv_len == 0xFF) {
-            // 3-byte length
-            if(pos + 2 > data_len) break;
-            tlv_len = (data[pos] << 8) | data[pos + 1];
-            pos += 2;
-        }
-
-        // Check if this is an NDEF message
-        if(tlv_type == 0x03 && tlv_len > 0 && pos + tlv_len <= data_len) {
-            // Parse NDEF message records
-            size_t msg_end = pos + tlv_len;
-
-            while(pos < msg_end && pos < data_len) {
-                // Read record header
-                if(pos + 1 > data_len) break;
-                uint8_t flags_tnf = data[pos++];
-
-                uint8_t tnf = flags_tnf & 0x07;
-                bool short_record = (flags_tnf & 0x10) != 0;
-                bool id_length_present = (flags_tnf & 0x08) != 0;
-
-                // Read type length
-                if(pos >= data_len) break;
-                uint8_t type_len = data[pos++];
-
-                // Read payload length
-                if(pos >= data_len) break;
-                uint32_t payload_len;
-                if(short_record) {
-                    payload_len = data[pos++];
-                } else {
-                    if(pos + 4 > data_len) break;
-                    payload_len = (data[pos] << 24) | (data[pos + 1] << 16) |
-                                 (data[pos + 2] << 8) | data[pos + 3];
-                    pos += 4;
-                }
-
-                // Read ID length if present
-                uint8_t id_len = 0;
-                if(id_length_present) {
-                    if(pos >= data_len) break;
-                    id_len = data[pos++];
-                }
-
-                // Read type
-                if(pos + type_len > data_len) break;
-                const uint8_t* type = &data[pos];
-                pos += type_len;
-
-                // Skip ID
-                if(pos + id_len > data_len) break;
-                pos += id_len;
-
-                // Read payload
-                if(pos + payload_len > data_len) break;
-                const uint8_t* payload = &data[pos];
-                pos += payload_len;
-
-                // Check if this is a text record (TNF=0x01, Type='T')
-                if(tnf == 0x01 && type_len == 1 && type[0] == 'T' && payload_len > 1) {
-                    // Text record format: [status byte][language code][text]
-                    uint8_t status = payload[0];
-                    uint8_t lang_len = status & 0x3F;
-
-                    if((uint32_t)(lang_len + 1) <= payload_len) {
-                        // Skip language code, extract text
-                        const uint8_t* text = &payload[1 + lang_len];
-                        size_t text_len = payload_len - 1 - lang_len;
-
-                        // Copy text to output
-                        size_t copy_len = text_len;
-                        if(output_pos + copy_len >= output_max) {
-                            copy_len = output_max - output_pos - 1;
-                        }
-                        if(copy_len > 0) {
-                            memcpy(&output[output_pos], text, copy_len);
-                            output_pos += copy_len;
-                        }
-                    }
-                }
-            }
-
-            // Found and processed NDEF message, stop searching
-            break;
-        } else {
-            // Skip this TLV
-            pos += tlv_len;
-        }
-    }
-
-    // Null-terminate
-    if(output_pos < output_max) {
-        output[output_pos] = '\0';
-    } else if(output_max > 0) {
-        output[output_max - 1] = '\0';
-    }
-
-    return output_pos;
+// Check if the start of an NDEF message already gives all the text that will be typed
+static bool flipper_wedge_nfc_ndef_complete(
+    const FlipperWedgeNfc* instance,
+    const uint8_t* message,
+    size_t len) {
+    FlipperWedgeNdefIterator it;
+    flipper_wedge_ndef_iter_init(&it, message, len);
+    return flipper_wedge_ndef_select_complete(
+        &it, instance->ndef_select, instance->ndef_mime_type, instance->ndef_max_chars);
 }
 
-// Type 4 NDEF APDU Helper Functions
-
-// Check if APDU response has success status (90 00)
-static bool flipper_wedge_nfc_t4_check_apdu_success(const BitBuffer* rx_buffer) {
-    size_t resp_len = bit_buffer_get_size_bytes(rx_buffer);
-    if(resp_len < 2) return false;
-
-    uint8_t sw1 = bit_buffer_get_byte(rx_buffer, resp_len - 2);
-    uint8_t sw2 = bit_buffer_get_byte(rx_buffer, resp_len - 1);
-
-    return (sw1 == APDU_SW1_SUCCESS && sw2 == APDU_SW2_SUCCESS);
-}
+// Type 4 NDEF APDU exchange through the ISO14443-4A poller
+typedef struct {
+    const FlipperWedgeNfc* instance;
+    Iso14443_4aPoller* poller;
+    BitBuffer* tx_buffer;
+    BitBuffer* rx_buffer;
+} FlipperWedgeNfcT4Poller;
+
+static bool flipper_wedge_nfc_t4_transceive(
+    const uint8_t* command,
+    size_t command_len,
+    uint8_t* response,
+    size_t response_size,
+    size_t* response_len,
+    void* context) {
+    FlipperWedgeNfcT4Poller* t4 = context;
 
-// Build SELECT by AID APDU command
-static void flipper_wedge_nfc_t4_build_select_app_apdu(BitBuffer* tx_buffer) {
-    bit_buffer_reset(tx_buffer);
-    bit_buffer_append_byte(tx_buffer, 0x00);  // CLA
-    bit_buffer_append_byte(tx_buffer, 0xA4);  // INS (SELECT)
-    bit_buffer_append_byte(tx_buffer, 0x04);  // P1 (select by name/AID)
-    bit_buffer_append_byte(tx_buffer, 0x00);  // P2
-    bit_buffer_append_byte(tx_buffer, NDEF_T4_AID_LEN);  // Lc (data length)
-    bit_buffer_append_bytes(tx_buffer, NDEF_T4_AID, NDEF_T4_AID_LEN);  // AID data
-    // Note: Some Type 4 tags don't require Le for SELECT, trying without it first
-}
+    bit_buffer_copy_bytes(t4->tx_buffer, command, command_len);
+    Iso14443_4aError error = iso14443_4a_poller_send_block(t4->poller, t4->tx_buffer, t4->rx_buffer);
+    if(error != Iso14443_4aErrorNone) {
+        FURI_LOG_W(TAG, "Type 4 NDEF: APDU exchange failed, error=%d", error);
+        return false;
+    }
 
-// Build SELECT by File ID APDU command
-static void flipper_wedge_nfc_t4_build_select_file_apdu(BitBuffer* tx_buffer, uint16_t file_id) {
-    bit_buffer_reset(tx_buffer);
-    bit_buffer_append_byte(tx_buffer, 0x00);  // CLA
-    bit_buffer_append_byte(tx_buffer, 0xA4);  // INS (SELECT)
-    bit_buffer_append_byte(tx_buffer, 0x00);  // P1 (select by file ID)
-    bit_buffer_append_byte(tx_buffer, 0x0C);  // P2 (first or only occurrence)
-    bit_buffer_append_byte(tx_buffer, 0x02);  // Lc (2 bytes for file ID)
-    bit_buffer_append_byte(tx_buffer, (file_id >> 8) & 0xFF);  // File ID MSB
-    bit_buffer_append_byte(tx_buffer, file_id & 0xFF);  // File ID LSB
-    // Note: No Le needed for SELECT file
+    *response_len = MIN(bit_buffer_get_size_bytes(t4->rx_buffer), response_size);
+    bit_buffer_write_bytes(t4->rx_buffer, response, *response_len);
+    return true;
 }
 
-// Build READ BINARY APDU command
-static void flipper_wedge_nfc_t4_build_read_binary_apdu(
-    BitBuffer* tx_buffer,
-    uint16_t offset,
-    uint8_t length) {
-    bit_buffer_reset(tx_buffer);
-    bit_buffer_append_byte(tx_buffer, 0x00);  // CLA
-    bit_buffer_append_byte(tx_buffer, 0xB0);  // INS (READ BINARY)
-    bit_buffer_append_byte(tx_buffer, (offset >> 8) & 0xFF);  // P1 (offset MSB)
-    bit_buffer_append_byte(tx_buffer, offset & 0xFF);  // P2 (offset LSB)
-    bit_buffer_append_byte(tx_buffer, length);  // Le (bytes to read)
+static bool flipper_wedge_nfc_t4_complete(const uint8_t* message, size_t len, void* context) {
+    FlipperWedgeNfcT4Poller* t4 = context;
+    return flipper_wedge_nfc_ndef_complete(t4->instance, message, len);
 }
 
 // Read Type 4 NDEF data from ISO14443-4A tag
 static bool flipper_wedge_nfc_read_type4_ndef(
+    const FlipperWedgeNfc* instance,
     Iso14443_4aPoller* poller,
     FlipperWedgeNfcData* data) {
 
-    BitBuffer* tx_buffer = bit_buffer_alloc(256);
-    BitBuffer* rx_buffer = bit_buffer_alloc(256);
+    FlipperWedgeNfcT4Poller t4 = {
+        .instance = instance,
+        .poller = poller,
+        .tx_buffer = bit_buffer_alloc(FLIPPER_WEDGE_NFC_T4_COMMAND_MAX),
+        .rx_buffer = bit_buffer_alloc(FLIPPER_WEDGE_NFC_T4_RESPONSE_MAX),
+    };
     bool success = false;
 
     FURI_LOG_I(TAG, "========== Type 4 NDEF: Starting NDEF read sequence ==========");
 
     do {
-        // Step 1: SELECT NDEF Application (with retry logic)
-        FURI_LOG_I(TAG, "Type 4 NDEF: Step 1 - SELECT NDEF Application (AID: D2760000850101)");
-
-        Iso14443_4aError error = Iso14443_4aErrorNone;
-        bool select_success = false;
-
-        for(uint8_t retry = 0; retry < NDEF_T4_MAX_RETRIES; retry++) {
-            if(retry > 0) {
-                FURI_LOG_I(TAG, "Type 4 NDEF: Retry attempt %d/%d after %dms delay",
-                           retry + 1, NDEF_T4_MAX_RETRIES, NDEF_T4_RETRY_DELAY_MS);
-                furi_delay_ms(NDEF_T4_RETRY_DELAY_MS);
-            }
-
-            flipper_wedge_nfc_t4_build_select_app_apdu(tx_buffer);
-            error = iso14443_4a_poller_send_block(poller, tx_buffer, rx_buffer);
-
-            if(error == Iso14443_4aErrorNone) {
-                // Log response for debugging
-                size_t resp_len = bit_buffer_get_size_bytes(rx_buffer);
-                FURI_LOG_I(TAG, "Type 4 NDEF: SELECT app response length: %zu bytes", resp_len);
-                if(resp_len >= 2) {
-                    uint8_t sw1 = bit_buffer_get_byte(rx_buffer, resp_len - 2);
-                    uint8_t sw2 = bit_buffer_get_byte(rx_buffer, resp_len - 1);
-                    FURI_LOG_I(TAG, "Type 4 NDEF: SELECT app status: SW1=%02X SW2=%02X", sw1, sw2);
-                } else {
-                    FURI_LOG_E(TAG, "Type 4 NDEF: Response too short!");
-                }
-
-                if(flipper_wedge_nfc_t4_check_apdu_success(rx_buffer)) {
-                    select_success = true;
-                    FURI_LOG_I(TAG, "Type 4 NDEF: NDEF application selected successfully");
-                    break;
-                } else {
-                    // Application not found (APDU status error) - don't retry
-                    FURI_LOG_W(TAG, "Type 4 NDEF: No NDEF application found (invalid APDU status)");
-                    break;
-                }
-            } else {
-                // Communication error - will retry if attempts remain
-                FURI_LOG_W(TAG, "Type 4 NDEF: SELECT app failed, error=%d", error);
-            }
-        }
-
-        if(!select_success) {
-            // Type 4 tag detected but no NDEF app found
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
-        }
-
-        // Step 2: SELECT Capability Container (CC) file
-        FURI_LOG_I(TAG, "Type 4 NDEF: Step 2 - SELECT CC file (0xE103)");
-        flipper_wedge_nfc_t4_build_select_file_apdu(tx_buffer, NDEF_T4_FILE_ID_CC);
-        error = iso14443_4a_poller_send_block(poller, tx_buffer, rx_buffer);
+        // Steps 1-6: SELECT application, CC and NDEF file, READ as the CC allows
+        // until the selected records give all the text that will be typed
+        uint8_t ndef_data[1024];
+        size_t bytes_read = flipper_wedge_nfc_t4_read_ndef(
+            flipper_wedge_nfc_t4_transceive,
+            flipper_wedge_nfc_t4_complete,
+            &t4,
+            ndef_data,
+            sizeof(ndef_data));
 
-        if(error != Iso14443_4aErrorNone || !flipper_wedge_nfc_t4_check_apdu_success(rx_buffer)) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: SELECT CC file failed");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
+        if(bytes_read == 0) {
+            FURI_LOG_W(TAG, "Type 4 NDEF: No NDEF data read");
+            data->error = FlipperWedgeNfcErrorNoRecord;
             break;
         }
 
-        FURI_LOG_I(TAG, "Type 4 NDEF: CC file selected successfully");
-
-        // Step 3: READ CC file (first 15 bytes to get structure)
-        FURI_LOG_I(TAG, "Type 4 NDEF: Step 3 - READ CC file");
-        flipper_wedge_nfc_t4_build_read_binary_apdu(tx_buffer, 0, 15);
-        error = iso14443_4a_poller_send_block(poller, tx_buffer, rx_buffer);
-
-        if(error != Iso14443_4aErrorNone || !flipper_wedge_nfc_t4_check_apdu_success(rx_buffer)) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: READ CC file failed");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
-        }
+        FURI_LOG_I(TAG, "Type 4 NDEF: Successfully read %zu bytes", bytes_read);
 
-        size_t cc_len = bit_buffer_get_size_bytes(rx_buffer) - 2; // Subtract SW1 SW2
-        if(cc_len < 15) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: CC too short (%zu bytes)", cc_len);
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
+        // Log the raw NDEF data for debugging
+        FURI_LOG_I(TAG, "Type 4 NDEF: Raw data (first %zu bytes):", bytes_read > 32 ? 32 : bytes_read);
+        for(size_t i = 0; i < bytes_read && i < 32; i++) {
+            FURI_LOG_I(TAG, "  [%02zu] = 0x%02X", i, ndef_data[i]);
         }
 
-        // Parse and validate CC file structure
-        // Type 4 CC format:
-        // Bytes 0-1: CCLEN (CC file length)
-        // Byte 2: Mapping Version
-        // Bytes 3-4: MLe (max R-APDU data size)
-        // Bytes 5-6: MLc (max C-APDU data size)
-        // Byte 7+: TLV blocks
-
-        uint16_t cc_file_len = (bit_buffer_get_byte(rx_buffer, 0) << 8) |
-                               bit_buffer_get_byte(rx_buffer, 1);
-        uint8_t mapping_version = bit_buffer_get_byte(rx_buffer, 2);
-
-        FURI_LOG_I(TAG, "Type 4 NDEF: CC length=%d, version=0x%02X", cc_file_len, mapping_version);
+        // Step 7: Parse NDEF message to extract the selected records
+        // Type 4 uses raw NDEF records (no TLV wrapping)
+        FlipperWedgeNdefIterator ndef_it;
+        flipper_wedge_ndef_iter_init(&ndef_it, ndef_data, bytes_read);
+        size_t text_len = flipper_wedge_nfc_select_ndef(instance, &ndef_it, data->ndef_text);
 
-        // Validate mapping version (should be 0x10, 0x20, or 0x30)
-        if(mapping_version < 0x10 || mapping_version > 0x30) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: Invalid mapping version 0x%02X", mapping_version);
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
+        if(text_len > 0) {
+            data->has_ndef = true;
+            data->error = FlipperWedgeNfcErrorNone;
+            success = true;
+            FURI_LOG_I(TAG, "Type 4 NDEF: Found record: %s", data->ndef_text);
+        } else {
+            data->error = FlipperWedgeNfcErrorNoRecord;
+            FURI_LOG_D(TAG, "Type 4 NDEF: No matching records in NDEF message");
         }
 
-        FURI_LOG_I(TAG, "Type 4 NDEF: Valid CC found");
-
-        // Step 4: SELECT NDEF Message file
-        flipper_wedge_nfc_t4_build_select_file_apdu(tx_buffer, NDEF_T4_FILE_ID_NDEF);
-        error = iso14443_4a_poller_send_block(poller, tx_buffer, rx_buffer);
-
-        if(error != Iso14443_4aErrorNone || !flipper_wedge_nfc_t4_check_apdu_success(rx_buffer)) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: SELECT NDEF file failed");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
-        }
+    } while(false);
 
-        FURI_LOG_D(TAG, "Type 4 NDEF: NDEF file selected");
+    bit_buffer_free(t4.tx_buffer);
+    bit_buffer_free(t4.rx_buffer);
 
-        // Step 5: READ NDEF length (first 2 bytes)
-        flipper_wedge_nfc_t4_build_read_binary_apdu(tx_buffer, 0, 2);
-        error = iso14443_4a_poller_send_block(poller, tx_buffer, rx_buffer);
+    return success;
+}
 
-        if(error != Iso14443_4aErrorNone || !flipper_wedge_nfc_t4_check_apdu_success(rx_buffer)) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: READ NDEF length failed");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
-        }
+// Type 2 NDEF command exchange through the ISO14443-3A poller
+typedef struct {
+    const FlipperWedgeNfc* instance;
+    Iso14443_3aPoller* poller;
+    BitBuffer* tx_buffer;
+    BitBuffer* rx_buffer;
+} FlipperWedgeNfcT2Poller;
+
+static bool flipper_wedge_nfc_t2_transceive(
+    const uint8_t* command,
+    size_t command_len,
+    uint8_t* response,
+    size_t response_size,
+    size_t* response_len,
+    void* context) {
+    FlipperWedgeNfcT2Poller* t2 = context;
+
+    bit_buffer_copy_bytes(t2->tx_buffer, command, command_len);
+    // Adds and checks CRC, a NAK fails the check
+    Iso14443_3aError error = iso14443_3a_poller_send_standard_frame(
+        t2->poller, t2->tx_buffer, t2->rx_buffer, FLIPPER_WEDGE_NFC_T2_FWT_FC);
+    if(error != Iso14443_3aErrorNone) {
+        FURI_LOG_D(TAG, "Type 2 NDEF: Command %02X failed, error=%d", command[0], error);
+        return false;
+    }
 
-        if(bit_buffer_get_size_bytes(rx_buffer) < 4) { // 2 length bytes + SW1 SW2
-            FURI_LOG_W(TAG, "Type 4 NDEF: NDEF length response too short");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
-        }
+    *response_len = MIN(bit_buffer_get_size_bytes(t2->rx_buffer), response_size);
+    bit_buffer_write_bytes(t2->rx_buffer, response, *response_len);
+    return true;
+}
 
-        uint16_t ndef_len = (bit_buffer_get_byte(rx_buffer, 0) << 8) |
-                            bit_buffer_get_byte(rx_buffer, 1);
+static bool flipper_wedge_nfc_t2_reactivate(void* context) {
+    FlipperWedgeNfcT2Poller* t2 = context;
+    Iso14443_3aData iso3a_data;
+    return iso14443_3a_poller_activate(t2->poller, &iso3a_data) == Iso14443_3aErrorNone;
+}
 
-        if(ndef_len == 0) {
-            FURI_LOG_I(TAG, "Type 4 NDEF: Empty NDEF message");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            break;
-        }
+static bool flipper_wedge_nfc_t2_complete(const uint8_t* message, size_t len, void* context) {
+    FlipperWedgeNfcT2Poller* t2 = context;
+    return flipper_wedge_nfc_ndef_complete(t2->instance, message, len);
+}
 
-        // Limit NDEF read to reasonable size (increased from 240 to support large text records)
-        if(ndef_len > 1024) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: NDEF too large (%d bytes), limiting to 1024", ndef_len);
-            ndef_len = 1024;
-        }
+// Read Type 2 NDEF data from an Ultralight/NTAG tag, only the pages the NDEF TLV covers
+static bool flipper_wedge_nfc_read_type2_ndef(
+    const FlipperWedgeNfc* instance,
+    Iso14443_3aPoller* poller,
+    FlipperWedgeNfcData* data) {
 
-        FURI_LOG_D(TAG, "Type 4 NDEF: NDEF length = %d bytes", ndef_len);
+    FlipperWedgeNfcT2Poller t2 = {
+        .instance = instance,
+        .poller = poller,
+        .tx_buffer = bit_buffer_alloc(FLIPPER_WEDGE_NFC_T2_COMMAND_MAX),
+        .rx_buffer = bit_buffer_alloc(FLIPPER_WEDGE_NFC_T2_RESPONSE_MAX + 2), // With CRC
+    };
+    bool success = false;
 
-        // Step 6: READ NDEF Message data (skip 2-byte length prefix)
-        // Read in chunks if needed (most tags support up to 128-250 bytes per read)
+    do {
+        // CC and NDEF TLV header first, then FAST_READ of the message pages
+        // until the selected records give all the text that will be typed
         uint8_t ndef_data[1024];
-        uint16_t bytes_read = 0;
-
-        while(bytes_read < ndef_len) {
-            uint8_t chunk_size = (ndef_len - bytes_read > 128) ? 128 : (ndef_len - bytes_read);
-
-            flipper_wedge_nfc_t4_build_read_binary_apdu(tx_buffer, 2 + bytes_read, chunk_size);
-            error = iso14443_4a_poller_send_block(poller, tx_buffer, rx_buffer);
-
-            if(error != Iso14443_4aErrorNone || !flipper_wedge_nfc_t4_check_apdu_success(rx_buffer)) {
-                FURI_LOG_W(TAG, "Type 4 NDEF: READ NDEF chunk failed at offset %d", bytes_read);
-                break;
-            }
-
-            size_t chunk_received = bit_buffer_get_size_bytes(rx_buffer) - 2; // Subtract SW1 SW2
-            if(chunk_received == 0) {
-                FURI_LOG_W(TAG, "Type 4 NDEF: No data in chunk");
-                break;
-            }
-
-            // Copy chunk to buffer
-            for(size_t i = 0; i < chunk_received && bytes_read < ndef_len; i++) {
-                ndef_data[bytes_read++] = bit_buffer_get_byte(rx_buffer, i);
-            }
-
-            FURI_LOG_D(TAG, "Type 4 NDEF: Read %zu bytes, total %d/%d", chunk_received, bytes_read, ndef_len);
-        }
+        size_t bytes_read = flipper_wedge_nfc_t2_read_ndef(
+            flipper_wedge_nfc_t2_transceive,
+            flipper_wedge_nfc_t2_reactivate,
+            flipper_wedge_nfc_t2_complete,
+            &t2,
+            ndef_data,
+            sizeof(ndef_data));
 
         if(bytes_read == 0) {
-            FURI_LOG_W(TAG, "Type 4 NDEF: No NDEF data read");
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
+            FURI_LOG_I(TAG, "Type 2 NDEF: No NDEF data read");
+            data->error = FlipperWedgeNfcErrorNoRecord;
             break;
         }
 
-        FURI_LOG_I(TAG, "Type 4 NDEF: Successfully read %d bytes", bytes_read);
-
-        // Log the raw NDEF data for debugging
-        FURI_LOG_I(TAG, "Type 4 NDEF: Raw data (first %d bytes):", bytes_read > 32 ? 32 : bytes_read);
-        for(uint16_t i = 0; i < bytes_read && i < 32; i++) {
-            FURI_LOG_I(TAG, "  [%02d] = 0x%02X", i, ndef_data[i]);
-        }
+        FURI_LOG_I(TAG, "Type 2 NDEF: Read %zu bytes", bytes_read);
 
-        // Step 7: Parse NDEF message to extract text records
-        // Type 4 uses raw NDEF records (no TLV wrapping)
-        size_t text_len = flipper_wedge_nfc_parse_raw_ndef_text(
-            ndef_data,
-            bytes_read,
-            data->ndef_text,
-            FLIPPER_WEDGE_NDEF_MAX_LEN);
+        // The TLV header is already stripped, the message is iterated bare
+        FlipperWedgeNdefIterator ndef_it;
+        flipper_wedge_ndef_iter_init(&ndef_it, ndef_data, bytes_read);
+        size_t text_len = flipper_wedge_nfc_select_ndef(instance, &ndef_it, data->ndef_text);
 
         if(text_len > 0) {
             data->has_ndef = true;
             data->error = FlipperWedgeNfcErrorNone;
             success = true;
-            FURI_LOG_I(TAG, "Type 4 NDEF: Found text record: %s", data->ndef_text);
+            FURI_LOG_I(TAG, "Type 2 NDEF: Found record: %s", data->ndef_text);
         } else {
-            data->error = FlipperWedgeNfcErrorNoTextRecord;
-            FURI_LOG_D(TAG, "Type 4 NDEF: No text records found in NDEF message");
+            data->error = FlipperWedgeNfcErrorNoRecord;
+            FURI_LOG_I(TAG, "Type 2 NDEF: No matching records in NDEF message");
         }
-
     } while(false);
 
-    bit_buffer_free(tx_buffer);
-    bit_buffer_free(rx_buffer);
+    bit_buffer_free(t2.tx_buffer);
+    bit_buffer_free(t2.rx_buffer);
 
     return success;
 }
@@ -626,6 +331,51 @@ static NfcCommand flipper_wedge_nfc_poller_callback_iso14443_3a(NfcGenericEvent
     return NfcCommandContinue;
 }
 
+// Ultralight/NTAG in NDEF mode: activated as plain ISO14443-3A, then only
+// the NDEF pages are read instead of the MfUltralight poller's full dump
+static NfcCommand flipper_wedge_nfc_poller_callback_type2(NfcGenericEvent event, void* context) {
+    furi_assert(context);
+    FlipperWedgeNfc* instance = context;
+
+    if(event.protocol == NfcProtocolIso14443_3a) {
+        const Iso14443_3aPollerEvent* iso3a_event = event.event_data;
+
+        if(iso3a_event->type == Iso14443_3aPollerEventTypeReady) {
+            FURI_LOG_I(TAG, "Type 2 poller event: READY - reading NDEF");
+            const Iso14443_3aData* iso3a_data = nfc_poller_get_data(instance->poller);
+
+            if(iso3a_data && iso3a_data->uid_len > 0) {
+                uint8_t uid_len = iso3a_data->uid_len;
+                if(uid_len > FLIPPER_WEDGE_NFC_UID_MAX_LEN) {
+                    FURI_LOG_W(TAG, "Type 2 UID length %d exceeds max, truncating", uid_len);
+                    uid_len = FLIPPER_WEDGE_NFC_UID_MAX_LEN;
+                }
+                instance->last_data.uid_len = uid_len;
+                memcpy(instance->last_data.uid, iso3a_data->uid, uid_len);
+                instance->last_data.has_ndef = false;
+                instance->last_data.ndef_text[0] = '\0';
+
+                FURI_LOG_I(TAG, "Got MF Ultralight UID, len: %d", instance->last_data.uid_len);
+
+                Iso14443_3aPoller* poller = event.instance;
+                flipper_wedge_nfc_read_type2_ndef(instance, poller, &instance->last_data);
+                instance->state = FlipperWedgeNfcStateSuccess;
+            } else {
+                FURI_LOG_E(TAG, "Type 2 poller returned no UID");
+                instance->state = FlipperWedgeNfcStateError;
+            }
+            return NfcCommandStop;
+        } else if(iso3a_event->type == Iso14443_3aPollerEventTypeError) {
+            FURI_LOG_E(TAG, "Type 2 poller event: ERROR - activation failed");
+            instance->state = FlipperWedgeNfcStateError;
+            return NfcCommandStop;
+        }
+    } else {
+        FURI_LOG_W(TAG, "Type 2 callback received unexpected protocol: %d", event.protocol);
+    }
+    return NfcCommandContinue;
+}
+
 static NfcCommand flipper_wedge_nfc_poller_callback_iso14443_4a(NfcGenericEvent event, void* context) {
     furi_assert(context);
     FlipperWedgeNfc* instance = context;
@@ -669,12 +419,12 @@ static NfcCommand flipper_wedge_nfc_poller_callback_iso14443_4a(NfcGenericEvent
 
                         // Attempt to read Type 4 NDEF data
                         Iso14443_4aPoller* iso4a_poller = event.instance;
-                        flipper_wedge_nfc_read_type4_ndef(iso4a_poller, &instance->last_data);
+                        flipper_wedge_nfc_read_type4_ndef(instance, iso4a_poller, &instance->last_data);
 
                         // flipper_wedge_nfc_read_type4_ndef sets error field:
                         // - FlipperWedgeNfcErrorNone if NDEF text found
                         // - FlipperWedgeNfcErrorUnsupportedType if no NDEF app
-                        // - FlipperWedgeNfcErrorNoTextRecord if NDEF exists but no text records
+                        // - FlipperWedgeNfcErrorNoRecord if NDEF exists but no records match the selection
 
                         // If we're NOT in NDEF-only mode, we still want to output UID even if NDEF fails
                         if(!instance->parse_ndef) {
@@ -749,45 +499,7 @@ static NfcCommand flipper_wedge_nfc_poller_callback_mf_ultralight(NfcGenericEven
 
                         FURI_LOG_I(TAG, "Got MF Ultralight UID, len: %d", instance->last_data.uid_len);
 
-                        // Parse NDEF if requested
-                        if(instance->parse_ndef && mfu_data->pages_read > 4) {
-                            // NDEF data typically starts at page 4 (byte offset 16)
-                            // Pages 0-3 are reserved for UID and lock bytes
-                            // Increased limit from 240 to 1024 to support large text records
-                            size_t ndef_data_len = (mfu_data->pages_read - 4) * 4;
-                            if(ndef_data_len > 1024) {
-                                FURI_LOG_W(TAG, "Type 2 NDEF: Data too large (%zu bytes), limiting to 1024", ndef_data_len);
-                                ndef_data_len = 1024;
-                            }
-
-                            const uint8_t* ndef_data = &mfu_data->page[4].data[0];
-
-                            FURI_LOG_I(TAG, "Attempting NDEF parse, data_len=%zu, pages_read=%d",
-                                      ndef_data_len, mfu_data->pages_read);
-
-                            size_t text_len = flipper_wedge_nfc_parse_ndef_text(
-                                ndef_data,
-                                ndef_data_len,
-                                instance->last_data.ndef_text,
-                                FLIPPER_WEDGE_NDEF_MAX_LEN);
-
-                            if(text_len > 0) {
-                                instance->last_data.has_ndef = true;
-                                instance->last_data.error = FlipperWedgeNfcErrorNone;
-                                FURI_LOG_I(TAG, "Found NDEF text: %s", instance->last_data.ndef_text);
-                            } else {
-                                // Type 2 tag but no NDEF text record found
-                                instance->last_data.error = FlipperWedgeNfcErrorNoTextRecord;
-                                FURI_LOG_I(TAG, "No NDEF text records found on Type 2 tag");
-                            }
-                        } else if(instance->parse_ndef) {
-                            // Not enough pages read for NDEF
-                            instance->last_data.error = FlipperWedgeNfcErrorNoTextRecord;
-                            FURI_LOG_I(TAG, "Not enough pages for NDEF (pages_read=%d)", mfu_data->pages_read);
-                        } else {
-                            FURI_LOG_I(TAG, "NDEF parsing not requested (parse_ndef=false)");
-                        }
-
+                        // NDEF is read by the Type 2 reader, this full dump only runs in UID mode
                         instance->state = FlipperWedgeNfcStateSuccess;
                     } else {
                         FURI_LOG_E(TAG, "MFU UID length is 0");
@@ -879,29 +591,28 @@ static NfcCommand flipper_wedge_nfc_poller_callback_iso15693(NfcGenericEvent eve
                                 ndef_data_len = 1024;
                             }
 
-                            size_t text_len = flipper_wedge_nfc_parse_ndef_text(
-                                &block_data[4], // Skip 4-byte CC
-                                ndef_data_len,
-                                instance->last_data.ndef_text,
-                                FLIPPER_WEDGE_NDEF_MAX_LEN);
+                            FlipperWedgeNdefIterator ndef_it;
+                            flipper_wedge_ndef_iter_init_tlv(&ndef_it, &block_data[4], ndef_data_len); // Skip 4-byte CC
+                            size_t text_len = flipper_wedge_nfc_select_ndef(
+                                instance, &ndef_it, instance->last_data.ndef_text);
 
                             if(text_len > 0) {
                                 instance->last_data.has_ndef = true;
                                 instance->last_data.error = FlipperWedgeNfcErrorNone;
                                 FURI_LOG_I(TAG, "Found Type 5 NDEF text: %s", instance->last_data.ndef_text);
                             } else {
-                                // Type 5 tag with valid CC but no NDEF text record
-                                instance->last_data.error = FlipperWedgeNfcErrorNoTextRecord;
-                                FURI_LOG_D(TAG, "No NDEF text records found on Type 5 tag");
+                                // Type 5 tag with valid CC but no matching NDEF record
+                                instance->last_data.error = FlipperWedgeNfcErrorNoRecord;
+                                FURI_LOG_D(TAG, "No matching NDEF records on Type 5 tag");
                             }
                         } else {
                             // No valid Capability Container
-                            instance->last_data.error = FlipperWedgeNfcErrorNoTextRecord;
+                            instance->last_data.error = FlipperWedgeNfcErrorNoRecord;
                             FURI_LOG_D(TAG, "Invalid CC magic: 0x%02X (expected 0xE1)", block_data[0]);
                         }
                     } else {
                         FURI_LOG_W(TAG, "No block data available or insufficient size");
-                        instance->last_data.error = FlipperWedgeNfcErrorNoTextRecord;
+                        instance->last_data.error = FlipperWedgeNfcErrorNoRecord;
                     }
                 }
 
@@ -1023,11 +734,16 @@ static void flipper_wedge_nfc_start_poller(FlipperWedgeNfc* instance) {
         instance->scanner = NULL;
     }
 
-    // Start poller for the detected protocol
-    instance->poller = nfc_poller_alloc(instance->nfc, instance->detected_protocol);
+    // Start poller for the detected protocol. For NDEF an Ultralight/NTAG is
+    // polled as ISO14443-3A, the Type 2 reader picks the pages itself.
+    bool type2_ndef = instance->detected_protocol == NfcProtocolMfUltralight && instance->parse_ndef;
+    instance->poller = nfc_poller_alloc(
+        instance->nfc, type2_ndef ? NfcProtocolIso14443_3a : instance->detected_protocol);
     if(instance->poller) {
         instance->state = FlipperWedgeNfcStatePolling;
-        if(instance->detected_protocol == NfcProtocolMfUltralight) {
+        if(type2_ndef) {
+            nfc_poller_start(instance->poller, flipper_wedge_nfc_poller_callback_type2, instance);
+        } else if(instance->detected_protocol == NfcProtocolMfUltralight) {
             nfc_poller_start(instance->poller, flipper_wedge_nfc_poller_callback_mf_ultralight, instance);
         } else if(instance->detected_protocol == NfcProtocolIso14443_3a) {
             nfc_poller_start(instance->poller, flipper_wedge_nfc_poller_callback_iso14443_3a, instance);
@@ -1051,6 +767,9 @@ FlipperWedgeNfc* flipper_wedge_nfc_alloc(void) {
     instance->poller = NULL;
     instance->state = FlipperWedgeNfcStateIdle;
     instance->parse_ndef = false;
+    instance->ndef_select = FlipperWedgeNdefSelectText;
+    instance->ndef_mime_type[0] = '\0';
+    instance->ndef_max_chars = 0;
     instance->detected_protocol = NfcProtocolInvalid;
     instance->callback = NULL;
     instance->callback_context = NULL;
@@ -1086,6 +805,21 @@ void flipper_wedge_nfc_set_callback(
     instance->callback_context = context;
 }
 
+void flipper_wedge_nfc_set_ndef_select(
+    FlipperWedgeNfc* instance,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type) {
+    furi_assert(instance);
+    furi_assert(select < FlipperWedgeNdefSelectCount);
+    instance->ndef_select = select;
+    strlcpy(instance->ndef_mime_type, mime_type ? mime_type : "", sizeof(instance->ndef_mime_type));
+}
+
+void flipper_wedge_nfc_set_ndef_max_chars(FlipperWedgeNfc* instance, size_t max_chars) {
+    furi_assert(instance);
+    instance->ndef_max_chars = max_chars;
+}
+
 void flipper_wedge_nfc_start(FlipperWedgeNfc* instance, bool parse_ndef) {
     furi_assert(instance);
 
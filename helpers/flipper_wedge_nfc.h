@@ -8,6 +8,7 @@
 #include <nfc/protocols/iso14443_3a/iso14443_3a_poller.h>
 #include <nfc/protocols/mf_ultralight/mf_ultralight.h>
 #include <nfc/protocols/mf_ultralight/mf_ultralight_poller.h>
+#include "flipper_wedge_ndef.h"
 
 #define FLIPPER_WEDGE_NFC_UID_MAX_LEN 10
 #define FLIPPER_WEDGE_NDEF_MAX_LEN 1024  // Buffer size (max user setting is 1000 chars, +24 for safety)
@@ -18,7 +19,7 @@ typedef enum {
     FlipperWedgeNfcErrorNone,            // Success
     FlipperWedgeNfcErrorNotForumCompliant, // Tag is not NFC Forum compliant (e.g., MIFARE Classic)
     FlipperWedgeNfcErrorUnsupportedType, // Tag detected but unsupported NFC Forum Type for NDEF
-    FlipperWedgeNfcErrorNoTextRecord,    // Supported type but no NDEF text record found
+    FlipperWedgeNfcErrorNoRecord,        // Supported type but no NDEF record matching the selection
 } FlipperWedgeNfcError;
 
 typedef struct {
@@ -54,6 +55,25 @@ void flipper_wedge_nfc_set_callback(
     FlipperWedgeNfcCallback callback,
     void* context);
 
+/** Set which NDEF records are output
+ *
+ * @param instance FlipperWedgeNfc instance
+ * @param select Records to output
+ * @param mime_type MIME type for FlipperWedgeNdefSelectMime and FlipperWedgeNdefSelectAll
+ */
+void flipper_wedge_nfc_set_ndef_select(
+    FlipperWedgeNfc* instance,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type);
+
+/** Set how many characters of NDEF text are typed at most
+ * NDEF reads stop once they have that much of the selected records.
+ *
+ * @param instance FlipperWedgeNfc instance
+ * @param max_chars Maximum characters, 0 to always read the whole message
+ */
+void flipper_wedge_nfc_set_ndef_max_chars(FlipperWedgeNfc* instance, size_t max_chars);
+
 /** Start NFC scanning
  *
  * @param instance FlipperWedgeNfc instance
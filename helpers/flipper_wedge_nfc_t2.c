@@ -0,0 +1,217 @@
+#include "flipper_wedge_nfc_t2.h"
+#include <string.h>
+
+#define TAG "FlipperWedgeNfcT2"
+
+#define T2_CMD_READ 0x30
+#define T2_CMD_FAST_READ 0x3A
+
+#define T2_PAGE_SIZE 4
+#define T2_READ_PAGES 4 // READ always returns 16 bytes
+#define T2_CC_PAGE 3
+#define T2_DATA_PAGE 4 // Data area starts right after the CC
+// Page numbers are 8 bits, sectors beyond the first aren't selected
+#define T2_PAGE_LAST 0xFF
+#define T2_DATA_MAX ((T2_PAGE_LAST + 1 - T2_DATA_PAGE) * T2_PAGE_SIZE)
+
+// Capability Container
+#define T2_CC_MAGIC 0xE1
+#define T2_CC_MAJOR_VERSION 1
+
+// TLV blocks of the data area
+#define T2_TLV_NULL 0x00
+#define T2_TLV_NDEF 0x03
+#define T2_TLV_TERMINATOR 0xFE
+#define T2_TLV_LEN_3BYTE 0xFF
+
+// Data bytes searched for the NDEF TLV header, room for lock and memory
+// control TLVs before it. The first READ gives 12, every further READ 16.
+#define T2_HEAD_MAX (3 * T2_PAGE_SIZE + 3 * T2_READ_PAGES * T2_PAGE_SIZE)
+
+typedef struct {
+    FlipperWedgeNfcT2Transceive transceive;
+    FlipperWedgeNfcT2Reactivate reactivate;
+    void* context;
+    bool fast_read; // Cleared once the tag refuses FAST_READ
+    uint8_t response[FLIPPER_WEDGE_NFC_T2_RESPONSE_MAX];
+    size_t response_len;
+} T2Exchange;
+
+typedef enum {
+    T2TlvFound,
+    T2TlvMore, // Header not within the data yet
+    T2TlvNone,
+} T2TlvResult;
+
+// Exchange a command, true if at least expected bytes came back
+static bool t2_exchange(T2Exchange* ex, const uint8_t* command, size_t command_len, size_t expected) {
+    size_t len = 0;
+    ex->response_len = 0;
+    if(!ex->transceive(command, command_len, ex->response, sizeof(ex->response), &len, ex->context)) {
+        FURI_LOG_W(TAG, "No response to %02X", command[0]);
+        return false;
+    }
+    if(len < expected || len > sizeof(ex->response)) {
+        FURI_LOG_W(TAG, "Bad response length %zu to %02X", len, command[0]);
+        return false;
+    }
+    ex->response_len = len;
+    return true;
+}
+
+static bool t2_read(T2Exchange* ex, uint8_t page) {
+    const uint8_t command[] = {T2_CMD_READ, page};
+    return t2_exchange(ex, command, sizeof(command), T2_READ_PAGES * T2_PAGE_SIZE);
+}
+
+static bool t2_fast_read(T2Exchange* ex, uint8_t start, uint8_t end) {
+    const uint8_t command[] = {T2_CMD_FAST_READ, start, end};
+    return t2_exchange(ex, command, sizeof(command), (end - start + 1) * T2_PAGE_SIZE);
+}
+
+// Read up to count pages from start into the response, returns the pages read, 0 on failure
+static uint8_t t2_read_pages(T2Exchange* ex, uint8_t start, size_t count) {
+    // A single READ is as quick for a few pages and works on every tag
+    if(ex->fast_read && count > T2_READ_PAGES) {
+        if(t2_fast_read(ex, start, start + count - 1)) return count;
+        FURI_LOG_I(TAG, "FAST_READ refused, using READ");
+        ex->fast_read = false;
+        if(!ex->reactivate || !ex->reactivate(ex->context)) {
+            FURI_LOG_W(TAG, "Reactivation failed");
+            return 0;
+        }
+    }
+    return t2_read(ex, start) ? T2_READ_PAGES : 0;
+}
+
+// Find the NDEF TLV among the data area bytes read so far
+static T2TlvResult
+    t2_find_ndef_tlv(const uint8_t* data, size_t len, size_t* value_offset, size_t* value_len) {
+    size_t pos = 0;
+    while(pos < len) {
+        uint8_t type = data[pos];
+        if(type == T2_TLV_NULL) {
+            pos++;
+            continue;
+        }
+        if(type == T2_TLV_TERMINATOR) return T2TlvNone;
+
+        if(pos + 1 >= len) return T2TlvMore;
+        size_t tlv_len = data[pos + 1];
+        size_t header = 2;
+        if(tlv_len == T2_TLV_LEN_3BYTE) {
+            if(pos + 3 >= len) return T2TlvMore;
+            tlv_len = (data[pos + 2] << 8) | data[pos + 3];
+            header = 4;
+        }
+
+        if(type == T2_TLV_NDEF) {
+            *value_offset = pos + header;
+            *value_len = tlv_len;
+            return T2TlvFound;
+        }
+        // Lock control, memory control or proprietary
+        pos += header + tlv_len;
+    }
+    return T2TlvMore;
+}
+
+size_t flipper_wedge_nfc_t2_read_ndef(
+    FlipperWedgeNfcT2Transceive transceive,
+    FlipperWedgeNfcT2Reactivate reactivate,
+    FlipperWedgeNfcT2Complete complete,
+    void* context,
+    uint8_t* message,
+    size_t message_size) {
+    furi_assert(transceive);
+    furi_assert(message);
+
+    T2Exchange exchange = {
+        .transceive = transceive,
+        .reactivate = reactivate,
+        .context = context,
+        .fast_read = true,
+    };
+    T2Exchange* ex = &exchange;
+    size_t message_len = 0;
+
+    do {
+        // Page 3 is the CC, pages 4-6 the start of the data area
+        if(!t2_read(ex, T2_CC_PAGE)) {
+            FURI_LOG_W(TAG, "READ CC failed");
+            break;
+        }
+        const uint8_t* cc = ex->response;
+        if(cc[0] != T2_CC_MAGIC || (cc[1] >> 4) != T2_CC_MAJOR_VERSION) {
+            FURI_LOG_W(TAG, "No NDEF CC (%02X %02X)", cc[0], cc[1]);
+            break;
+        }
+        if((cc[3] >> 4) != 0) {
+            FURI_LOG_W(TAG, "NDEF read access denied (%02X)", cc[3]);
+            break;
+        }
+        size_t data_size = MIN(cc[2] * 8, T2_DATA_MAX);
+        FURI_LOG_I(TAG, "CC version %02X, data area %zu bytes", cc[1], data_size);
+
+        uint8_t head[T2_HEAD_MAX];
+        size_t head_len = (T2_READ_PAGES - 1) * T2_PAGE_SIZE;
+        memcpy(head, &ex->response[T2_PAGE_SIZE], head_len);
+
+        // Usually the NDEF TLV is the first one, behind lock and memory control TLVs otherwise
+        size_t value_offset = 0;
+        size_t value_len = 0;
+        T2TlvResult found;
+        while((found = t2_find_ndef_tlv(head, MIN(head_len, data_size), &value_offset, &value_len)) ==
+                  T2TlvMore &&
+              head_len < MIN(data_size, sizeof(head))) {
+            if(!t2_read(ex, T2_DATA_PAGE + head_len / T2_PAGE_SIZE)) break;
+            memcpy(&head[head_len], ex->response, T2_READ_PAGES * T2_PAGE_SIZE);
+            head_len += T2_READ_PAGES * T2_PAGE_SIZE;
+        }
+        if(found != T2TlvFound) {
+            FURI_LOG_W(TAG, "No NDEF TLV in the first %zu bytes", head_len);
+            break;
+        }
+        if(value_len == 0) {
+            FURI_LOG_I(TAG, "Empty NDEF message");
+            break;
+        }
+
+        // Message end as a data area offset, within the data area, the buffer and page reach
+        size_t end = value_offset + MIN(value_len, message_size);
+        end = MIN(end, data_size);
+        if(end <= value_offset) {
+            FURI_LOG_W(TAG, "NDEF TLV outside the data area");
+            break;
+        }
+        if(value_len > message_size) {
+            FURI_LOG_W(TAG, "NDEF message of %zu bytes cut to %zu", value_len, message_size);
+        }
+
+        size_t offset = MIN(head_len, end);
+        memcpy(message, &head[value_offset], offset - value_offset);
+
+        // offset is page aligned from here on, only the last read can go past end
+        while(offset < end) {
+            if(complete && complete(message, offset - value_offset, context)) {
+                FURI_LOG_D(TAG, "Enough read at offset %zu of %zu", offset, end);
+                break;
+            }
+            size_t pages = (end - offset + T2_PAGE_SIZE - 1) / T2_PAGE_SIZE;
+            pages = MIN(pages, (size_t)FLIPPER_WEDGE_NFC_T2_FAST_READ_PAGES);
+            uint8_t read = t2_read_pages(ex, T2_DATA_PAGE + offset / T2_PAGE_SIZE, pages);
+            if(read == 0) {
+                FURI_LOG_W(TAG, "READ NDEF failed at offset %zu", offset);
+                break;
+            }
+            size_t received = MIN(read * T2_PAGE_SIZE, end - offset);
+            memcpy(&message[offset - value_offset], ex->response, received);
+            offset += received;
+        }
+
+        message_len = offset - value_offset;
+        FURI_LOG_D(TAG, "Read %zu of %zu bytes", message_len, value_len);
+    } while(false);
+
+    return message_len;
+}
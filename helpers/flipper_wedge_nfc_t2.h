@@ -0,0 +1,70 @@
+#pragma once
+
+#include <furi.h>
+
+// Longest command sent, FAST_READ with start and end page
+#define FLIPPER_WEDGE_NFC_T2_COMMAND_MAX 3
+// Pages per FAST_READ, keeps the response well inside the reader FIFO
+#define FLIPPER_WEDGE_NFC_T2_FAST_READ_PAGES 60
+// Longest response, without CRC
+#define FLIPPER_WEDGE_NFC_T2_RESPONSE_MAX (FLIPPER_WEDGE_NFC_T2_FAST_READ_PAGES * 4)
+
+/** Send one command frame and receive the response
+ * CRC is added and checked by the caller's transport, a NAK or a missing
+ * response is a failure.
+ *
+ * @param command Command, without CRC
+ * @param command_len Length of command
+ * @param response Buffer for the response, without CRC
+ * @param response_size Size of response, FLIPPER_WEDGE_NFC_T2_RESPONSE_MAX
+ * @param response_len Set to the response length
+ * @param context Context
+ * @return true if a response was received
+ */
+typedef bool (*FlipperWedgeNfcT2Transceive)(
+    const uint8_t* command,
+    size_t command_len,
+    uint8_t* response,
+    size_t response_size,
+    size_t* response_len,
+    void* context);
+
+/** Wake and select the tag again after a failed command
+ * A Type 2 tag drops back to IDLE after a NAK, so a command it doesn't
+ * support has to be followed by a new activation.
+ *
+ * @param context Context
+ * @return true if the tag is selected again
+ */
+typedef bool (*FlipperWedgeNfcT2Reactivate)(void* context);
+
+/** Check if the start of the NDEF message is all that's needed
+ *
+ * @param message Message read so far, without its TLV header
+ * @param len Length of message
+ * @param context Context
+ * @return true to stop reading
+ */
+typedef bool (*FlipperWedgeNfcT2Complete)(const uint8_t* message, size_t len, void* context);
+
+/** Read the NDEF message of a Type 2 tag
+ * One READ of page 3 gives the Capability Container and the first data
+ * pages, which normally hold the NDEF TLV header. Only the pages the TLV
+ * covers are read after that, with FAST_READ where the tag supports it and
+ * READ where it doesn't, until complete says the part read is enough.
+ *
+ * @param transceive Command exchange
+ * @param reactivate Called when FAST_READ is refused, can be NULL to give up
+ * @param complete Checked after every read, can be NULL to read it all
+ * @param context Context for the callbacks
+ * @param message Buffer for the message, without its TLV header
+ * @param message_size Size of message, longer messages are cut off
+ * @return Length of the message read, 0 on failure or an empty message
+ */
+size_t flipper_wedge_nfc_t2_read_ndef(
+    FlipperWedgeNfcT2Transceive transceive,
+    FlipperWedgeNfcT2Reactivate reactivate,
+    FlipperWedgeNfcT2Complete complete,
+    void* context,
+    uint8_t* message,
+    size_t message_size);
@@ -0,0 +1,241 @@
+#include "flipper_wedge_nfc_t4.h"
+#include <string.h>
+
+#define TAG "FlipperWedgeNfcT4"
+
+// NDEF Tag Application, version 2 and later
+#define T4_AID_LEN 7
+static const uint8_t t4_aid[T4_AID_LEN] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
+
+#define T4_FILE_ID_CC 0xE103
+
+// File IDs the Type 4 Tag specification reserves, never an NDEF file
+static const uint16_t t4_file_ids_rfu[] = {0x0000, 0xE102, 0xE103, 0x3F00, 0x3FFF, 0xFFFF};
+
+// Mandatory part of the CC and the NDEF File Control TLV after it
+#define T4_CC_LEN 15
+#define T4_CC_TLV_OFFSET 7
+#define T4_TLV_NDEF_FILE 0x04
+#define T4_TLV_ENDEF_FILE 0x06 // Mapping 3.0, 4-byte length field
+
+// Short Le, 0 would mean 256 and isn't understood by every tag
+#define T4_READ_MAX 255
+// Used when the CC has no usable MLe, the size reads had before MLe was honored
+#define T4_READ_DEFAULT 128
+// READ BINARY offsets are 15 bits
+#define T4_OFFSET_MAX 0x7FFF
+
+// APDU retry configuration
+#define T4_MAX_RETRIES 3 // Maximum attempts for SELECT application
+#define T4_RETRY_DELAY_MS 15 // Delay between retries in milliseconds
+
+typedef struct {
+    FlipperWedgeNfcT4Transceive transceive;
+    void* context;
+    uint8_t response[FLIPPER_WEDGE_NFC_T4_RESPONSE_MAX];
+    size_t response_len; // Without SW1 SW2 after a successful exchange
+    bool answered; // Last exchange got a response, successful or not
+} T4Exchange;
+
+// Exchange a C-APDU, true if the tag answered 90 00
+static bool t4_exchange(T4Exchange* ex, const uint8_t* command, size_t command_len) {
+    size_t len = 0;
+    ex->response_len = 0;
+    ex->answered = false;
+    if(!ex->transceive(command, command_len, ex->response, sizeof(ex->response), &len, ex->context)) {
+        FURI_LOG_W(TAG, "No response to INS %02X", command[1]);
+        return false;
+    }
+    if(len < 2 || len > sizeof(ex->response)) {
+        FURI_LOG_W(TAG, "Bad response length %zu to INS %02X", len, command[1]);
+        return false;
+    }
+    ex->answered = true;
+    uint8_t sw1 = ex->response[len - 2];
+    uint8_t sw2 = ex->response[len - 1];
+    if(sw1 != 0x90 || sw2 != 0x00) {
+        FURI_LOG_W(TAG, "INS %02X status %02X%02X", command[1], sw1, sw2);
+        return false;
+    }
+    ex->response_len = len - 2;
+    return true;
+}
+
+static bool t4_select_file(T4Exchange* ex, uint16_t file_id) {
+    const uint8_t command[] = {
+        0x00, // CLA
+        0xA4, // INS (SELECT)
+        0x00, // P1 (select by file ID)
+        0x0C, // P2 (first or only occurrence, no response data)
+        0x02, // Lc
+        file_id >> 8,
+        file_id & 0xFF,
+    };
+    return t4_exchange(ex, command, sizeof(command));
+}
+
+static bool t4_read_binary(T4Exchange* ex, uint16_t offset, uint8_t len) {
+    const uint8_t command[] = {
+        0x00, // CLA
+        0xB0, // INS (READ BINARY)
+        offset >> 8, // P1 (offset MSB)
+        offset & 0xFF, // P2 (offset LSB)
+        len, // Le
+    };
+    return t4_exchange(ex, command, sizeof(command));
+}
+
+// SELECT the NDEF application, retried on communication errors only
+static bool t4_select_application(T4Exchange* ex) {
+    uint8_t command[5 + T4_AID_LEN] = {
+        0x00, // CLA
+        0xA4, // INS (SELECT)
+        0x04, // P1 (select by name)
+        0x00, // P2
+        T4_AID_LEN, // Lc
+    };
+    memcpy(&command[5], t4_aid, T4_AID_LEN);
+    // No Le, some tags don't accept one for SELECT
+
+    for(uint8_t retry = 0; retry < T4_MAX_RETRIES; retry++) {
+        if(retry > 0) {
+            FURI_LOG_I(TAG, "SELECT application retry %d/%d", retry + 1, T4_MAX_RETRIES);
+            furi_delay_ms(T4_RETRY_DELAY_MS);
+        }
+        if(t4_exchange(ex, command, sizeof(command))) return true;
+        // An error status means there is no NDEF application
+        if(ex->answered) break;
+    }
+    return false;
+}
+
+bool flipper_wedge_nfc_t4_parse_cc(const uint8_t* data, size_t len, FlipperWedgeNfcT4Cc* cc) {
+    furi_assert(data);
+    furi_assert(cc);
+
+    // CCLEN(2) MappingVersion(1) MLe(2) MLc(2) then the NDEF File Control TLV
+    if(len < T4_CC_LEN) return false;
+    cc->mapping_version = data[2];
+    cc->mle = (data[3] << 8) | data[4];
+
+    // Major version 1 to 3
+    if(cc->mapping_version < 0x10 || cc->mapping_version > 0x3F) {
+        FURI_LOG_W(TAG, "Unsupported mapping version %02X", cc->mapping_version);
+        return false;
+    }
+
+    const uint8_t* tlv = &data[T4_CC_TLV_OFFSET];
+    if(tlv[0] == T4_TLV_NDEF_FILE && tlv[1] >= 6) {
+        cc->ndef_file_id = (tlv[2] << 8) | tlv[3];
+        cc->ndef_file_max = (tlv[4] << 8) | tlv[5];
+        cc->nlen_size = 2;
+    } else if(tlv[0] == T4_TLV_ENDEF_FILE && tlv[1] >= 8) {
+        cc->ndef_file_id = (tlv[2] << 8) | tlv[3];
+        cc->ndef_file_max = ((uint32_t)tlv[4] << 24) | ((uint32_t)tlv[5] << 16) | (tlv[6] << 8) |
+                            tlv[7];
+        cc->nlen_size = 4;
+    } else {
+        FURI_LOG_W(TAG, "No NDEF File Control TLV (T=%02X)", tlv[0]);
+        return false;
+    }
+
+    for(size_t i = 0; i < COUNT_OF(t4_file_ids_rfu); i++) {
+        if(cc->ndef_file_id == t4_file_ids_rfu[i]) {
+            FURI_LOG_W(TAG, "Reserved NDEF file ID %04X", cc->ndef_file_id);
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t flipper_wedge_nfc_t4_read_ndef(
+    FlipperWedgeNfcT4Transceive transceive,
+    FlipperWedgeNfcT4Complete complete,
+    void* context,
+    uint8_t* message,
+    size_t message_size) {
+    furi_assert(transceive);
+    furi_assert(message);
+
+    T4Exchange exchange = {.transceive = transceive, .context = context};
+    T4Exchange* ex = &exchange;
+    size_t message_len = 0;
+
+    do {
+        if(!t4_select_application(ex)) {
+            FURI_LOG_W(TAG, "No NDEF application");
+            break;
+        }
+
+        FlipperWedgeNfcT4Cc cc;
+        if(!t4_select_file(ex, T4_FILE_ID_CC) || !t4_read_binary(ex, 0, T4_CC_LEN) ||
+           !flipper_wedge_nfc_t4_parse_cc(ex->response, ex->response_len, &cc)) {
+            FURI_LOG_W(TAG, "No valid CC");
+            break;
+        }
+
+        // Every READ BINARY is as large as the tag allows
+        uint8_t read_max = MIN(cc.mle, T4_READ_MAX);
+        if(read_max < cc.nlen_size + 1) read_max = T4_READ_DEFAULT;
+        FURI_LOG_I(
+            TAG,
+            "CC version %02X, MLe %u, NDEF file %04X of %lu bytes",
+            cc.mapping_version,
+            cc.mle,
+            cc.ndef_file_id,
+            cc.ndef_file_max);
+
+        if(!t4_select_file(ex, cc.ndef_file_id)) {
+            FURI_LOG_W(TAG, "SELECT NDEF file failed");
+            break;
+        }
+
+        // The length field and the start of the message in one read, never
+        // past the end of a file smaller than MLe
+        size_t first = MIN(read_max, cc.nlen_size + message_size);
+        if(cc.ndef_file_max >= cc.nlen_size) first = MIN(first, cc.ndef_file_max);
+        if(!t4_read_binary(ex, 0, first) || ex->response_len < cc.nlen_size) {
+            FURI_LOG_W(TAG, "READ NDEF length failed");
+            break;
+        }
+        uint32_t nlen = 0;
+        for(uint8_t i = 0; i < cc.nlen_size; i++) {
+            nlen = (nlen << 8) | ex->response[i];
+        }
+        if(nlen == 0) {
+            FURI_LOG_I(TAG, "Empty NDEF message");
+            break;
+        }
+
+        // Message end as a file offset, within the file, the buffer and READ BINARY's reach
+        size_t end = cc.nlen_size + MIN(nlen, message_size);
+        if(cc.ndef_file_max >= cc.nlen_size) end = MIN(end, cc.ndef_file_max);
+        end = MIN(end, (size_t)T4_OFFSET_MAX + 1);
+        if(nlen > message_size) {
+            FURI_LOG_W(TAG, "NDEF message of %lu bytes cut to %zu", nlen, message_size);
+        }
+
+        size_t offset = MIN(ex->response_len, end);
+        memcpy(message, &ex->response[cc.nlen_size], offset - cc.nlen_size);
+
+        while(offset < end) {
+            if(complete && complete(message, offset - cc.nlen_size, context)) {
+                FURI_LOG_D(TAG, "Enough read at offset %zu of %zu", offset, end);
+                break;
+            }
+            uint8_t len = MIN(read_max, end - offset);
+            if(!t4_read_binary(ex, offset, len) || ex->response_len == 0) {
+                FURI_LOG_W(TAG, "READ NDEF failed at offset %zu", offset);
+                break;
+            }
+            size_t received = MIN(ex->response_len, end - offset);
+            memcpy(&message[offset - cc.nlen_size], ex->response, received);
+            offset += received;
+        }
+
+        message_len = offset - cc.nlen_size;
+        FURI_LOG_D(TAG, "Read %zu of %lu bytes", message_len, nlen);
+    } while(false);
+
+    return message_len;
+}
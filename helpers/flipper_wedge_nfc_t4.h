@@ -0,0 +1,74 @@
+#pragma once
+
+#include <furi.h>
+
+// Longest R-APDU read, 255 data bytes with short Le plus SW1 SW2
+#define FLIPPER_WEDGE_NFC_T4_RESPONSE_MAX (255 + 2)
+// Longest C-APDU sent, SELECT by AID
+#define FLIPPER_WEDGE_NFC_T4_COMMAND_MAX 16
+
+/** Send one C-APDU and receive the R-APDU
+ *
+ * @param command C-APDU
+ * @param command_len Length of command
+ * @param response Buffer for the R-APDU, including SW1 SW2
+ * @param response_size Size of response, FLIPPER_WEDGE_NFC_T4_RESPONSE_MAX
+ * @param response_len Set to the R-APDU length
+ * @param context Context
+ * @return true if a response was received, false on a communication error
+ */
+typedef bool (*FlipperWedgeNfcT4Transceive)(
+    const uint8_t* command,
+    size_t command_len,
+    uint8_t* response,
+    size_t response_size,
+    size_t* response_len,
+    void* context);
+
+/** Check if the start of the NDEF message is all that's needed
+ *
+ * @param message Message read so far, without its length field
+ * @param len Length of message
+ * @param context Context
+ * @return true to stop reading
+ */
+typedef bool (*FlipperWedgeNfcT4Complete)(const uint8_t* message, size_t len, void* context);
+
+// Capability Container fields the reader uses
+typedef struct {
+    uint8_t mapping_version;
+    uint16_t mle; // Max R-APDU data size
+    uint16_t ndef_file_id;
+    uint32_t ndef_file_max; // NDEF file size, length field included
+    uint8_t nlen_size; // 2, or 4 for an extended NDEF file (mapping 3.0)
+} FlipperWedgeNfcT4Cc;
+
+/** Parse a Capability Container file
+ *
+ * @param data CC file contents
+ * @param len Length of data
+ * @param cc Filled in on success
+ * @return true if the CC is valid and has an NDEF File Control TLV naming
+ *         a file ID that isn't reserved
+ */
+bool flipper_wedge_nfc_t4_parse_cc(const uint8_t* data, size_t len, FlipperWedgeNfcT4Cc* cc);
+
+/** Read the NDEF message of a Type 4 tag
+ * Selects the NDEF application and CC file, then the NDEF file named in
+ * the CC. The length field and the first part of the message come in one
+ * READ BINARY, the rest in reads as large as the CC's MLe allows, until
+ * complete says the part read is enough.
+ *
+ * @param transceive APDU exchange
+ * @param complete Checked after every read, can be NULL to read it all
+ * @param context Context for transceive and complete
+ * @param message Buffer for the message, without its length field
+ * @param message_size Size of message, longer messages are cut off
+ * @return Length of the message read, 0 on failure or an empty message
+ */
+size_t flipper_wedge_nfc_t4_read_ndef(
+    FlipperWedgeNfcT4Transceive transceive,
+    FlipperWedgeNfcT4Complete complete,
+    void* context,
+    uint8_t* message,
+    size_t message_size);
@@ -26,12 +26,14 @@ static void flipper_wedge_rfid_worker_callback(LFRFIDWorkerReadResult result, Pr
             data_size = FLIPPER_WEDGE_RFID_UID_MAX_LEN;
         }
 
-        uint8_t* data = malloc(protocol_dict_get_data_size(instance->dict, protocol));
-        protocol_dict_get_data(instance->dict, protocol, data, protocol_dict_get_data_size(instance->dict, protocol));
+        size_t full_size = protocol_dict_get_data_size(instance->dict, protocol);
+        uint8_t* data = malloc(full_size);
+        protocol_dict_get_data(instance->dict, protocol, data, full_size);
 
         // Copy to our data structure
         instance->last_data.uid_len = data_size;
         memcpy(instance->last_data.uid, data, data_size);
+        flipper_wedge_rfid_fields_decode(protocol, data, full_size, &instance->last_data.fields);
 
         // Get protocol name
         const char* name = protocol_dict_get_name(instance->dict, protocol);
@@ -44,6 +46,13 @@ static void flipper_wedge_rfid_worker_callback(LFRFIDWorkerReadResult result, Pr
         free(data);
 
         FURI_LOG_I(TAG, "RFID tag read: %s, len: %d", instance->last_data.protocol_name, instance->last_data.uid_len);
+        if(instance->last_data.fields.valid) {
+            FURI_LOG_D(
+                TAG,
+                "FC: %lu, Card: %lu",
+                instance->last_data.fields.facility_code,
+                instance->last_data.fields.card_number);
+        }
 
         // Notify callback
         if(instance->callback) {
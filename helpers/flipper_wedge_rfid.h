@@ -2,6 +2,7 @@
 
 #include <furi.h>
 #include <lfrfid/lfrfid_worker.h>
+#include "flipper_wedge_rfid_fields.h"
 
 #define FLIPPER_WEDGE_RFID_UID_MAX_LEN 8
 
@@ -11,6 +12,7 @@ typedef struct {
     uint8_t uid[FLIPPER_WEDGE_RFID_UID_MAX_LEN];
     uint8_t uid_len;
     char protocol_name[32];
+    FlipperWedgeRfidFields fields;
 } FlipperWedgeRfidData;
 
 typedef void (*FlipperWedgeRfidCallback)(FlipperWedgeRfidData* data, void* context);
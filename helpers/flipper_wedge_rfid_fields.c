@@ -0,0 +1,119 @@
+#include "flipper_wedge_rfid_fields.h"
+#include <lfrfid/protocols/lfrfid_protocols.h>
+
+// Bits of a field in protocol data, counted MSB first from the first byte
+typedef struct {
+    uint8_t start;
+    uint8_t len;
+} RfidBitField;
+
+// Where a protocol keeps facility code and card number. HID Prox data has
+// the card's Wiegand bits right-aligned (see below), so each length has
+// its own entry; bits is 0 for protocols with a single format.
+typedef struct {
+    ProtocolId protocol;
+    uint8_t bits;
+    RfidBitField facility_code;
+    RfidBitField card_number;
+} RfidFieldLayout;
+
+// The firmware's HID Prox protocol (lib/lfrfid/protocols/protocol_hid_generic.c)
+// keeps the 44 data bits of the frame after 4 zero bits, in 6 bytes. The
+// data starts with a header whose length gives the card format, the card's
+// Wiegand bits fill the rest.
+#define RFID_HID_DATA_BITS 48
+#define RFID_HID_PAYLOAD_START 4
+#define RFID_HID(bits) (RFID_HID_DATA_BITS - (bits)) // First Wiegand bit in HID Prox data
+#define RFID_HID_BITS_MIN 26
+
+static const RfidFieldLayout rfid_field_layouts[] = {
+    // EM4100: version byte, then read as 8-bit facility and 16-bit card
+    {LFRFIDProtocolEM4100, 0, {16, 8}, {24, 16}},
+    // H10301: decoded without parity bits
+    {LFRFIDProtocolH10301, 0, {0, 8}, {8, 16}},
+    // HID Prox H10301 26-bit: parity, 8-bit facility, 16-bit card, parity
+    {LFRFIDProtocolHidGeneric, 26, {RFID_HID(26) + 1, 8}, {RFID_HID(26) + 9, 16}},
+    // HID Prox Corporate 1000 35-bit: 2 parity, 12-bit facility, 20-bit card, parity
+    {LFRFIDProtocolHidGeneric, 35, {RFID_HID(35) + 2, 12}, {RFID_HID(35) + 14, 20}},
+    // HID Prox H10304 37-bit: parity, 16-bit facility, 19-bit card, parity
+    {LFRFIDProtocolHidGeneric, 37, {RFID_HID(37) + 1, 16}, {RFID_HID(37) + 17, 19}},
+};
+
+// Indala 26-bit scatters both fields over its 32 data bits
+static const uint8_t rfid_indala26_facility_bits[] = {24, 16, 11, 14, 15, 20, 6, 25};
+static const uint8_t rfid_indala26_card_bits[] =
+    {9, 12, 10, 7, 19, 3, 2, 18, 13, 0, 4, 21, 23, 26, 17, 8};
+
+static uint8_t rfid_get_bit(const uint8_t* data, size_t bit) {
+    return (data[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+static uint32_t rfid_get_field(const uint8_t* data, RfidBitField field) {
+    uint32_t value = 0;
+    for(uint8_t i = 0; i < field.len; i++) {
+        value = (value << 1) | rfid_get_bit(data, field.start + i);
+    }
+    return value;
+}
+
+static uint32_t rfid_get_scattered(const uint8_t* data, const uint8_t* bits, size_t count) {
+    uint32_t value = 0;
+    for(size_t i = 0; i < count; i++) {
+        value = (value << 1) | rfid_get_bit(data, bits[i]);
+    }
+    return value;
+}
+
+// Same rules as protocol_hid_generic_decode_protocol_size() in the firmware:
+// a 1 in the first 6 header bits starts a card of 38 to 43 bits, else a 0
+// in the 7th starts a 37-bit card, else the card starts after the next 1
+uint8_t flipper_wedge_rfid_fields_hid_format_bits(const uint8_t* data, size_t data_size) {
+    furi_assert(data);
+    if(data_size * 8 < RFID_HID_DATA_BITS) return 0;
+
+    for(size_t bit = RFID_HID_PAYLOAD_START; bit < RFID_HID_PAYLOAD_START + 6; bit++) {
+        if(rfid_get_bit(data, bit)) return RFID_HID_DATA_BITS - bit - 1;
+    }
+    if(!rfid_get_bit(data, RFID_HID_PAYLOAD_START + 6)) return 37;
+    for(size_t bit = RFID_HID_PAYLOAD_START + 7; bit < RFID_HID(RFID_HID_BITS_MIN); bit++) {
+        if(rfid_get_bit(data, bit)) return RFID_HID_DATA_BITS - bit - 1;
+    }
+    return 0;
+}
+
+void flipper_wedge_rfid_fields_decode(
+    ProtocolId protocol,
+    const uint8_t* data,
+    size_t data_size,
+    FlipperWedgeRfidFields* fields) {
+    furi_assert(data);
+    furi_assert(fields);
+    memset(fields, 0, sizeof(FlipperWedgeRfidFields));
+
+    if(protocol == LFRFIDProtocolIndala26) {
+        if(data_size * 8 < 32) return;
+        fields->facility_code = rfid_get_scattered(
+            data, rfid_indala26_facility_bits, COUNT_OF(rfid_indala26_facility_bits));
+        fields->card_number =
+            rfid_get_scattered(data, rfid_indala26_card_bits, COUNT_OF(rfid_indala26_card_bits));
+        fields->valid = true;
+        return;
+    }
+
+    uint8_t bits = 0;
+    if(protocol == LFRFIDProtocolHidGeneric) {
+        bits = flipper_wedge_rfid_fields_hid_format_bits(data, data_size);
+        if(!bits) return;
+    }
+
+    for(size_t i = 0; i < COUNT_OF(rfid_field_layouts); i++) {
+        const RfidFieldLayout* layout = &rfid_field_layouts[i];
+        if(layout->protocol != protocol || layout->bits != bits) continue;
+        if(data_size * 8 < (size_t)layout->card_number.start + layout->card_number.len) return;
+
+        fields->facility_code = rfid_get_field(data, layout->facility_code);
+        fields->card_number = rfid_get_field(data, layout->card_number);
+        fields->valid = true;
+        return;
+    }
+}
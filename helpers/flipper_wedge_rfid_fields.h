@@ -0,0 +1,33 @@
+#pragma once
+
+#include <furi.h>
+#include <lfrfid/lfrfid_worker.h>
+
+// Facility code and card number, decoded from the protocol's bit layout
+// once when the tag is read
+typedef struct {
+    bool valid; // false for protocols without these fields
+    uint32_t facility_code;
+    uint32_t card_number;
+} FlipperWedgeRfidFields;
+
+/** Get the card format length of HID Prox protocol data
+ *
+ * @param data Protocol data of LFRFIDProtocolHidGeneric
+ * @param data_size Size of data, 6 bytes
+ * @return Wiegand bits of the card, 0 if the header is invalid
+ */
+uint8_t flipper_wedge_rfid_fields_hid_format_bits(const uint8_t* data, size_t data_size);
+
+/** Decode facility code and card number from protocol data
+ *
+ * @param protocol Protocol the data was read with
+ * @param data Protocol data, as protocol_dict_get_data() returns it
+ * @param data_size Size of data
+ * @param fields Filled in, valid is false if the protocol or format has no such fields
+ */
+void flipper_wedge_rfid_fields_decode(
+    ProtocolId protocol,
+    const uint8_t* data,
+    size_t data_size,
+    FlipperWedgeRfidFields* fields);
@@ -110,6 +110,26 @@ void flipper_wedge_save_settings(void* context) {
                 save_success = false;
             }
         }
+        uint32_t unicode_mode = app->keyboard_layout->unicode_mode;
+        if(!flipper_format_write_uint32(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_UNICODE_MODE, &unicode_mode, 1)) {
+            FURI_LOG_E(TAG, "Failed to write unicode_mode");
+            save_success = false;
+        }
+    }
+
+    // Written back as loaded, even if it didn't compile, so it can be fixed in the file
+    if(!flipper_format_write_string_cstr(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_OUTPUT_TEMPLATE, app->output_template_text)) {
+        FURI_LOG_E(TAG, "Failed to write output_template");
+        save_success = false;
+    }
+    uint32_t ndef_select = app->ndef_select;
+    if(!flipper_format_write_uint32(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_NDEF_SELECT, &ndef_select, 1)) {
+        FURI_LOG_E(TAG, "Failed to write ndef_select");
+        save_success = false;
+    }
+    if(!flipper_format_write_string_cstr(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_NDEF_MIME_TYPE, app->ndef_mime_type)) {
+        FURI_LOG_E(TAG, "Failed to write ndef_mime_type");
+        save_success = false;
     }
 
     if(!flipper_format_rewind(fff_file)) {
@@ -270,12 +290,6 @@ void flipper_wedge_read_settings(void* context) {
         if(flipper_format_read_uint32(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_LAYOUT_TYPE, &layout_type, 1)) {
             if(layout_type < FlipperWedgeLayoutCount) {
                 switch(layout_type) {
-                    case FlipperWedgeLayoutDefault:
-                        flipper_wedge_keyboard_layout_set_default(app->keyboard_layout);
-                        break;
-                    case FlipperWedgeLayoutNumPad:
-                        flipper_wedge_keyboard_layout_set_numpad(app->keyboard_layout);
-                        break;
                     case FlipperWedgeLayoutCustom: {
                         FuriString* layout_path = furi_string_alloc();
                         if(flipper_format_read_string(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_LAYOUT_FILE, layout_path)) {
@@ -291,12 +305,44 @@ void flipper_wedge_read_settings(void* context) {
                         break;
                     }
                     default:
-                        flipper_wedge_keyboard_layout_set_default(app->keyboard_layout);
+                        // Default, NumPad and the other built-in tables
+                        flipper_wedge_keyboard_layout_set_builtin(app->keyboard_layout, layout_type);
                         break;
                 }
             }
         }
+
+        // Characters above ASCII (default OFF, as before the setting existed)
+        uint32_t unicode_mode = FlipperWedgeUnicodeOff;
+        if(flipper_format_read_uint32(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_UNICODE_MODE, &unicode_mode, 1) &&
+           unicode_mode < FlipperWedgeUnicodeCount) {
+            flipper_wedge_keyboard_layout_set_unicode_mode(app->keyboard_layout, unicode_mode);
+        }
+    }
+
+    // Output template (default none), compiled here once instead of per scan
+    FuriString* template_str = furi_string_alloc();
+    if(flipper_format_read_string(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_OUTPUT_TEMPLATE, template_str)) {
+        strlcpy(app->output_template_text, furi_string_get_cstr(template_str), FLIPPER_WEDGE_TEMPLATE_MAX_LEN);
+        if(!flipper_wedge_template_compile(&app->output_template, app->output_template_text)) {
+            // The compiled template is left empty so the built-in format is
+            // used, the text stays for the next save to write back
+            FURI_LOG_W(TAG, "Invalid output template, using built-in format");
+        }
+    }
+    furi_string_free(template_str);
+
+    // NDEF record selection (default first text record, as before the setting existed)
+    uint32_t ndef_select = FlipperWedgeNdefSelectText;
+    if(flipper_format_read_uint32(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_NDEF_SELECT, &ndef_select, 1) &&
+       ndef_select < FlipperWedgeNdefSelectCount) {
+        app->ndef_select = (FlipperWedgeNdefSelect)ndef_select;
+    }
+    FuriString* mime_type_str = furi_string_alloc();
+    if(flipper_format_read_string(fff_file, FLIPPER_WEDGE_SETTINGS_KEY_NDEF_MIME_TYPE, mime_type_str)) {
+        strlcpy(app->ndef_mime_type, furi_string_get_cstr(mime_type_str), sizeof(app->ndef_mime_type));
     }
+    furi_string_free(mime_type_str);
 
     flipper_format_rewind(fff_file);
 
@@ -22,6 +22,10 @@
 #define FLIPPER_WEDGE_SETTINGS_KEY_LOG_TO_SD "LogToSd"
 #define FLIPPER_WEDGE_SETTINGS_KEY_LAYOUT_TYPE "LayoutType"
 #define FLIPPER_WEDGE_SETTINGS_KEY_LAYOUT_FILE "LayoutFile"
+#define FLIPPER_WEDGE_SETTINGS_KEY_UNICODE_MODE "UnicodeInput"
+#define FLIPPER_WEDGE_SETTINGS_KEY_OUTPUT_TEMPLATE "OutputTemplate"
+#define FLIPPER_WEDGE_SETTINGS_KEY_NDEF_SELECT "NdefRecord"
+#define FLIPPER_WEDGE_SETTINGS_KEY_NDEF_MIME_TYPE "NdefMimeType"
 
 void flipper_wedge_save_settings(void* context);
 void flipper_wedge_read_settings(void* context);
\ No newline at end of file
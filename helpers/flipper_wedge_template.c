@@ -0,0 +1,322 @@
+#include "flipper_wedge_template.h"
+#include "flipper_wedge_format.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define TAG "FlipperWedgeTemplate"
+
+#define TEMPLATE_TOKEN_MAX 32
+#define TEMPLATE_WIDTH_MAX 64
+#define TEMPLATE_NO_TEXT 0xFF // No literal text op open
+
+// Program ops, each followed by its operands
+typedef enum {
+    TemplateOpText = 1, // len, len bytes of text
+    TemplateOpSep, // -
+    TemplateOpUid, // source, flags, width
+    TemplateOpNdef, // max characters (u16 little endian, 0 = all)
+    TemplateOpRfidField, // TemplateRfidField, width
+} TemplateOp;
+
+typedef enum {
+    TemplateUidNfc,
+    TemplateUidRfid,
+} TemplateUidSource;
+
+typedef enum {
+    TemplateRfidFacilityCode,
+    TemplateRfidCardNumber,
+} TemplateRfidField;
+
+// UID flags on top of FlipperWedgeFormatFlags
+#define TEMPLATE_UID_DECIMAL (1 << 6)
+#define TEMPLATE_UID_NOSEP (1 << 7)
+#define TEMPLATE_UID_FORMAT_FLAGS (FlipperWedgeFormatReverse | FlipperWedgeFormatLowercase)
+
+typedef struct {
+    FlipperWedgeTemplate* tpl;
+    uint8_t text_len_at; // Length operand of the open text op
+} TemplateCompiler;
+
+static bool template_emit(TemplateCompiler* compiler, const uint8_t* bytes, size_t len) {
+    FlipperWedgeTemplate* tpl = compiler->tpl;
+    if(tpl->len + len > FLIPPER_WEDGE_TEMPLATE_PROGRAM_MAX) return false;
+    memcpy(&tpl->program[tpl->len], bytes, len);
+    tpl->len += len;
+    compiler->text_len_at = TEMPLATE_NO_TEXT;
+    return true;
+}
+
+// Literal characters are merged into one text op
+static bool template_emit_char(TemplateCompiler* compiler, char c) {
+    FlipperWedgeTemplate* tpl = compiler->tpl;
+    if(compiler->text_len_at == TEMPLATE_NO_TEXT || tpl->program[compiler->text_len_at] == UINT8_MAX) {
+        const uint8_t op[] = {TemplateOpText, 0};
+        if(!template_emit(compiler, op, sizeof(op))) return false;
+        compiler->text_len_at = tpl->len - 1;
+    }
+    if(tpl->len == FLIPPER_WEDGE_TEMPLATE_PROGRAM_MAX) return false;
+    tpl->program[tpl->len++] = c;
+    tpl->program[compiler->text_len_at]++;
+    return true;
+}
+
+// Parse a number option, 1..max
+static bool template_parse_number(const char* option, unsigned long max, unsigned long* value) {
+    char* end = NULL;
+    *value = strtoul(option, &end, 10);
+    return end != option && *end == '\0' && *value > 0 && *value <= max;
+}
+
+// Compile the inside of one {...} field, token is modified
+static bool template_compile_field(TemplateCompiler* compiler, char* token) {
+    char* options = strchr(token, ':');
+    if(options) *options++ = '\0';
+
+    if(strcmp(token, "sep") == 0 && !options) {
+        const uint8_t op[] = {TemplateOpSep};
+        return template_emit(compiler, op, sizeof(op));
+    }
+    if(strcmp(token, "tab") == 0 && !options) {
+        return template_emit_char(compiler, '\t');
+    }
+
+    if(strcmp(token, "ndef") == 0) {
+        unsigned long max = 0;
+        if(options && !template_parse_number(options, UINT16_MAX, &max)) {
+            FURI_LOG_W(TAG, "Bad NDEF length '%s'", options);
+            return false;
+        }
+        const uint8_t op[] = {TemplateOpNdef, max & 0xFF, max >> 8};
+        return template_emit(compiler, op, sizeof(op));
+    }
+
+    if(strcmp(token, "fc") == 0 || strcmp(token, "card") == 0) {
+        unsigned long width = 0;
+        if(options && !template_parse_number(options, TEMPLATE_WIDTH_MAX, &width)) {
+            FURI_LOG_W(TAG, "Bad width '%s'", options);
+            return false;
+        }
+        const uint8_t op[] = {
+            TemplateOpRfidField,
+            token[0] == 'f' ? TemplateRfidFacilityCode : TemplateRfidCardNumber,
+            width,
+        };
+        return template_emit(compiler, op, sizeof(op));
+    }
+
+    TemplateUidSource source;
+    if(strcmp(token, "nfc") == 0) {
+        source = TemplateUidNfc;
+    } else if(strcmp(token, "rfid") == 0) {
+        source = TemplateUidRfid;
+    } else {
+        FURI_LOG_W(TAG, "Unknown field '%s'", token);
+        return false;
+    }
+
+    uint8_t flags = 0;
+    unsigned long width = 0;
+    while(options) {
+        char* option = options;
+        options = strchr(options, ':');
+        if(options) *options++ = '\0';
+
+        if(strcmp(option, "hex") == 0) {
+            flags &= ~TEMPLATE_UID_DECIMAL;
+        } else if(strcmp(option, "dec") == 0) {
+            flags |= TEMPLATE_UID_DECIMAL;
+        } else if(strcmp(option, "rev") == 0) {
+            flags |= FlipperWedgeFormatReverse;
+        } else if(strcmp(option, "lower") == 0) {
+            flags |= FlipperWedgeFormatLowercase;
+        } else if(strcmp(option, "nosep") == 0) {
+            flags |= TEMPLATE_UID_NOSEP;
+        } else if(!template_parse_number(option, TEMPLATE_WIDTH_MAX, &width)) {
+            FURI_LOG_W(TAG, "Unknown option '%s'", option);
+            return false;
+        }
+    }
+
+    const uint8_t op[] = {TemplateOpUid, source, flags, width};
+    return template_emit(compiler, op, sizeof(op));
+}
+
+bool flipper_wedge_template_compile(FlipperWedgeTemplate* tpl, const char* source) {
+    furi_assert(tpl);
+    furi_assert(source);
+
+    TemplateCompiler compiler = {.tpl = tpl, .text_len_at = TEMPLATE_NO_TEXT};
+    char token[TEMPLATE_TOKEN_MAX];
+    bool success = true;
+    tpl->len = 0;
+
+    const char* p = source;
+    while(success && *p) {
+        if(*p == '\\') {
+            char c = p[1];
+            if(c == 'n') {
+                c = '\n';
+            } else if(c == 't') {
+                c = '\t';
+            } else if(c != '\\' && c != '{' && c != '}') {
+                FURI_LOG_W(TAG, "Bad escape at %zu", (size_t)(p - source));
+                success = false;
+                break;
+            }
+            success = template_emit_char(&compiler, c);
+            p += 2;
+        } else if(*p == '{') {
+            const char* end = strchr(p, '}');
+            size_t len = end ? (size_t)(end - p - 1) : 0;
+            if(!end || len == 0 || len >= sizeof(token)) {
+                FURI_LOG_W(TAG, "Bad field at %zu", (size_t)(p - source));
+                success = false;
+                break;
+            }
+            memcpy(token, p + 1, len);
+            token[len] = '\0';
+            success = template_compile_field(&compiler, token);
+            p = end + 1;
+        } else if(*p == '}') {
+            FURI_LOG_W(TAG, "Unmatched '}' at %zu", (size_t)(p - source));
+            success = false;
+        } else {
+            success = template_emit_char(&compiler, *p++);
+        }
+    }
+
+    if(!success) {
+        FURI_LOG_E(TAG, "Template not compiled: %s", source);
+        tpl->len = 0;
+    } else if(tpl->len > 0) {
+        FURI_LOG_I(TAG, "Compiled template, %u bytes", tpl->len);
+    }
+    return success;
+}
+
+bool flipper_wedge_template_is_set(const FlipperWedgeTemplate* tpl) {
+    furi_assert(tpl);
+    return tpl->len > 0;
+}
+
+// Pad the field just written at output + pos to width with leading zeros,
+// returns its new length or 0 if the padded field doesn't fit
+static size_t template_pad(char* output, size_t pos, size_t space, size_t len, uint8_t width) {
+    if(len == 0 || len >= width) return len;
+    if(pos + width > space) return 0;
+    memmove(output + pos + width - len, output + pos, len);
+    memset(output + pos, '0', width - len);
+    return width;
+}
+
+// Bytes of text making up at most max characters, UTF-8 sequences stay whole
+static size_t template_utf8_prefix(const char* text, size_t max) {
+    size_t bytes = 0;
+    size_t chars = 0;
+    while(text[bytes] != '\0') {
+        if(((uint8_t)text[bytes] & 0xC0) != 0x80) {
+            if(chars == max) break;
+            chars++;
+        }
+        bytes++;
+    }
+    return bytes;
+}
+
+size_t flipper_wedge_template_render(
+    const FlipperWedgeTemplate* tpl,
+    const FlipperWedgeTemplateData* data,
+    char* output,
+    size_t output_size) {
+    furi_assert(tpl);
+    furi_assert(data);
+
+    if(!output || output_size == 0) return 0;
+
+    const uint8_t* program = tpl->program;
+    const size_t space = output_size - 1; // Terminator
+    size_t pos = 0;
+    size_t pc = 0;
+
+    while(pc < tpl->len) {
+        const TemplateOp op = program[pc++];
+        switch(op) {
+        case TemplateOpText: {
+            uint8_t len = program[pc++];
+            if(pos + len <= space) {
+                memcpy(output + pos, &program[pc], len);
+                pos += len;
+            }
+            pc += len;
+            break;
+        }
+        case TemplateOpSep: {
+            size_t len = data->delimiter ? strlen(data->delimiter) : 0;
+            if(len > 0 && pos + len <= space) {
+                memcpy(output + pos, data->delimiter, len);
+                pos += len;
+            }
+            break;
+        }
+        case TemplateOpUid: {
+            TemplateUidSource source = program[pc];
+            uint8_t flags = program[pc + 1];
+            uint8_t width = program[pc + 2];
+            pc += 3;
+
+            const uint8_t* uid = (source == TemplateUidNfc) ? data->nfc_uid : data->rfid_uid;
+            uint8_t uid_len = (source == TemplateUidNfc) ? data->nfc_uid_len : data->rfid_uid_len;
+            if(!uid || uid_len == 0) break;
+
+            size_t len;
+            if(flags & TEMPLATE_UID_DECIMAL) {
+                len = flipper_wedge_format_uid_decimal(
+                    uid, uid_len, flags & TEMPLATE_UID_FORMAT_FLAGS, output + pos, space - pos);
+            } else {
+                len = flipper_wedge_format_uid_hex(
+                    uid,
+                    uid_len,
+                    (flags & TEMPLATE_UID_NOSEP) ? NULL : data->delimiter,
+                    flags & TEMPLATE_UID_FORMAT_FLAGS,
+                    output + pos,
+                    space - pos);
+            }
+
+            pos += template_pad(output, pos, space, len, width);
+            break;
+        }
+        case TemplateOpRfidField: {
+            TemplateRfidField field = program[pc];
+            uint8_t width = program[pc + 1];
+            pc += 2;
+            if(!data->rfid_fields || !data->rfid_fields->valid) break;
+
+            uint32_t value = (field == TemplateRfidFacilityCode) ? data->rfid_fields->facility_code :
+                                                                   data->rfid_fields->card_number;
+            const uint8_t bytes[] = {value >> 24, value >> 16, value >> 8, value};
+            size_t len = flipper_wedge_format_uid_decimal(bytes, sizeof(bytes), 0, output + pos, space - pos);
+            pos += template_pad(output, pos, space, len, width);
+            break;
+        }
+        case TemplateOpNdef: {
+            size_t max = program[pc] | (program[pc + 1] << 8);
+            pc += 2;
+            if(!data->ndef_text) break;
+
+            size_t len = max ? template_utf8_prefix(data->ndef_text, max) : strlen(data->ndef_text);
+            if(pos + len <= space) {
+                memcpy(output + pos, data->ndef_text, len);
+                pos += len;
+            }
+            break;
+        }
+        default:
+            // Programs only come from flipper_wedge_template_compile()
+            furi_check(false);
+        }
+    }
+
+    output[pos] = '\0';
+    return pos;
+}
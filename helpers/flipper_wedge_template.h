@@ -0,0 +1,70 @@
+#pragma once
+
+#include <furi.h>
+#include "flipper_wedge_rfid.h"
+
+// Template source as stored in the settings file, including terminator
+#define FLIPPER_WEDGE_TEMPLATE_MAX_LEN 96
+// Compiled program, fields take 3-4 bytes and literal text 2 more than its length
+#define FLIPPER_WEDGE_TEMPLATE_PROGRAM_MAX 128
+
+/** Compiled output template
+ * A template such as "{nfc:hex:rev}{sep}{rfid:dec}{tab}{ndef:250}\n" is
+ * compiled once into a byte program and run for every scan. Empty means
+ * no template, the built-in arrangement of flipper_wedge_format_output()
+ * is used instead.
+ */
+typedef struct {
+    uint8_t program[FLIPPER_WEDGE_TEMPLATE_PROGRAM_MAX];
+    uint8_t len;
+} FlipperWedgeTemplate;
+
+// Scan data a template is rendered from, absent parts have length 0
+typedef struct {
+    const uint8_t* nfc_uid;
+    uint8_t nfc_uid_len;
+    const uint8_t* rfid_uid;
+    uint8_t rfid_uid_len;
+    const FlipperWedgeRfidFields* rfid_fields; // Can be NULL
+    const char* ndef_text; // Sanitized, can be NULL
+    const char* delimiter; // Between UID bytes and for {sep}, can be NULL
+} FlipperWedgeTemplateData;
+
+/** Compile template source
+ * Fields are {nfc}, {rfid} and {ndef}. UID fields take options after ':'
+ * in any order: hex (default) or dec, rev for reversed byte order, lower
+ * for lowercase hex, nosep to leave out the delimiter between bytes, and a
+ * number for the minimum width, padded with leading zeros. {ndef:N} keeps
+ * at most N characters. {fc} and {card} are the RFID facility code and
+ * card number in decimal, empty for protocols without them, and take a
+ * width as well. {sep} is the delimiter, {tab} a tab. Backslash
+ * escapes \n, \t, \\, \{ and \} are recognised in literal text.
+ *
+ * @param tpl Template to fill in, left empty on error
+ * @param source Template text, empty clears the template
+ * @return true if compiled or empty, false on syntax error
+ */
+bool flipper_wedge_template_compile(FlipperWedgeTemplate* tpl, const char* source);
+
+/** Check if a template is set
+ *
+ * @param tpl Compiled template
+ * @return true if the template has a program
+ */
+bool flipper_wedge_template_is_set(const FlipperWedgeTemplate* tpl);
+
+/** Render a compiled template
+ * Runs the program without allocating. Parts that don't fit in the rest
+ * of the buffer are left out whole, output is always terminated.
+ *
+ * @param tpl Compiled template
+ * @param data Scan data
+ * @param output Output buffer
+ * @param output_size Size of output buffer
+ * @return Length of output
+ */
+size_t flipper_wedge_template_render(
+    const FlipperWedgeTemplate* tpl,
+    const FlipperWedgeTemplateData* data,
+    char* output,
+    size_t output_size);
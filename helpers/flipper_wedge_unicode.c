@@ -0,0 +1,148 @@
+#include "flipper_wedge_unicode.h"
+#include "flipper_wedge_keystream.h"
+
+#define TAG "FlipperWedgeUnicode"
+
+#define UNICODE_KEYPAD_PLUS 0x57
+
+// Keypad usages for 0-9, Windows only reads Alt codes from the keypad
+static const uint8_t unicode_keypad_digits[] = {0x62, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, 0x60, 0x61};
+
+size_t flipper_wedge_unicode_decode_utf8(const char* text, size_t len, uint32_t* codepoint) {
+    furi_assert(text);
+    furi_assert(codepoint);
+
+    const uint8_t* bytes = (const uint8_t*)text;
+    *codepoint = 0;
+    if(len == 0) return 0;
+
+    size_t count;
+    uint32_t value;
+    uint32_t min;
+    if(bytes[0] < 0x80) {
+        *codepoint = bytes[0];
+        return 1;
+    } else if((bytes[0] & 0xE0) == 0xC0) {
+        count = 2;
+        value = bytes[0] & 0x1F;
+        min = 0x80;
+    } else if((bytes[0] & 0xF0) == 0xE0) {
+        count = 3;
+        value = bytes[0] & 0x0F;
+        min = 0x800;
+    } else if((bytes[0] & 0xF8) == 0xF0) {
+        count = 4;
+        value = bytes[0] & 0x07;
+        min = 0x10000;
+    } else {
+        return 1;
+    }
+
+    for(size_t i = 1; i < count; i++) {
+        if(i >= len) return 0;
+        if((bytes[i] & 0xC0) != 0x80) return 1;
+        value = (value << 6) | (bytes[i] & 0x3F);
+    }
+
+    if(value < min || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) return 1;
+
+    *codepoint = value;
+    return count;
+}
+
+// Lowercase hex without leading zeros, returns digit count
+static uint8_t unicode_hex(uint32_t codepoint, char* hex) {
+    char digits[8];
+    uint8_t count = 0;
+    do {
+        digits[count++] = "0123456789abcdef"[codepoint & 0xF];
+        codepoint >>= 4;
+    } while(codepoint);
+
+    for(uint8_t i = 0; i < count; i++) {
+        hex[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+static uint8_t unicode_compile_linux(FlipperWedgeKeyboardLayout* layout, const char* hex, uint8_t digits, uint16_t* keys) {
+    uint8_t len = 0;
+    uint16_t keycode = flipper_wedge_keyboard_layout_get_keycode(layout, 'u');
+    if(keycode == HID_KEYBOARD_NONE) return 0;
+    keys[len++] = keycode | KEY_MOD_LEFT_CTRL | KEY_MOD_LEFT_SHIFT;
+
+    for(uint8_t i = 0; i < digits; i++) {
+        keycode = flipper_wedge_keyboard_layout_get_keycode(layout, hex[i]);
+        if(keycode == HID_KEYBOARD_NONE) return 0;
+        keys[len++] = keycode;
+    }
+
+    keycode = flipper_wedge_keyboard_layout_get_keycode(layout, ' ');
+    if(keycode == HID_KEYBOARD_NONE) return 0;
+    keys[len++] = keycode;
+    return len;
+}
+
+static uint8_t unicode_compile_windows(FlipperWedgeKeyboardLayout* layout, const char* hex, uint8_t digits, uint16_t* keys) {
+    uint8_t len = 0;
+    keys[len++] = UNICODE_KEYPAD_PLUS | KEY_MOD_LEFT_ALT;
+
+    for(uint8_t i = 0; i < digits; i++) {
+        if(hex[i] <= '9') {
+            keys[len++] = unicode_keypad_digits[hex[i] - '0'] | KEY_MOD_LEFT_ALT;
+        } else {
+            // The keypad has no letters, a-f come from the main block
+            uint16_t keycode = flipper_wedge_keyboard_layout_get_keycode(layout, hex[i]);
+            if(keycode == HID_KEYBOARD_NONE) return 0;
+            keys[len++] = keycode | KEY_MOD_LEFT_ALT;
+        }
+    }
+
+    // Alt going up is what enters the character
+    keys[len++] = FLIPPER_WEDGE_KEYSTREAM_RELEASE;
+    return len;
+}
+
+static uint8_t unicode_compile(FlipperWedgeKeyboardLayout* layout, uint32_t codepoint, uint16_t* keys) {
+    if(layout->unicode_mode == FlipperWedgeUnicodeOff) return 0;
+
+    uint16_t keycode = flipper_wedge_keyboard_layout_get_unicode_keycode(layout, codepoint);
+    if(keycode != HID_KEYBOARD_NONE) {
+        keys[0] = keycode;
+        return 1;
+    }
+
+    char hex[6];
+    uint8_t digits = unicode_hex(codepoint, hex);
+
+    switch(layout->unicode_mode) {
+    case FlipperWedgeUnicodeLinux:
+        return unicode_compile_linux(layout, hex, digits, keys);
+    case FlipperWedgeUnicodeWindows:
+        return unicode_compile_windows(layout, hex, digits, keys);
+    default:
+        return 0;
+    }
+}
+
+uint8_t flipper_wedge_unicode_sequence(
+    FlipperWedgeKeyboardLayout* layout,
+    uint32_t codepoint,
+    const uint16_t** keys) {
+    furi_assert(layout);
+    furi_assert(codepoint);
+    furi_assert(keys);
+
+    FlipperWedgeUnicodeSequence* slot =
+        &layout->unicode_cache[codepoint & (FLIPPER_WEDGE_UNICODE_CACHE_SIZE - 1)];
+    if(slot->codepoint != codepoint) {
+        slot->codepoint = codepoint;
+        slot->len = unicode_compile(layout, codepoint, slot->keys);
+        if(slot->len == 0 && layout->unicode_mode != FlipperWedgeUnicodeOff) {
+            FURI_LOG_D(TAG, "U+%04lX can't be typed, skipped", codepoint);
+        }
+    }
+
+    *keys = slot->keys;
+    return slot->len;
+}
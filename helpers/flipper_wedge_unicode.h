@@ -0,0 +1,32 @@
+#pragma once
+
+#include <furi.h>
+#include "flipper_wedge_keyboard_layout.h"
+
+/** Decode one UTF-8 character
+ * Overlong forms, surrogates and stray continuation bytes are malformed.
+ *
+ * @param text UTF-8 text
+ * @param len Bytes available in text
+ * @param codepoint Filled in with the code point, 0 for a malformed byte
+ * @return Bytes used (1 for a malformed byte), 0 if the character is cut off by len
+ */
+size_t flipper_wedge_unicode_decode_utf8(const char* text, size_t len, uint32_t* codepoint);
+
+/** Get the keys typing a code point above ASCII
+ * Uses the layout's own key when it has one, otherwise the input method
+ * sequence of its Unicode mode:
+ *   Linux    Ctrl+Shift+U, lowercase hex digits, Space
+ *   Windows  Left Alt held over KP+ and hex digits, then a release point
+ * Sequences are kept in the layout's cache, so a character seen before costs
+ * one lookup.
+ *
+ * @param layout FlipperWedgeKeyboardLayout instance
+ * @param codepoint Unicode code point
+ * @param keys Set to the keycodes, valid until the layout changes
+ * @return Number of keycodes, 0 if the character can't be typed
+ */
+uint8_t flipper_wedge_unicode_sequence(
+    FlipperWedgeKeyboardLayout* layout,
+    uint32_t codepoint,
+    const uint16_t** keys);
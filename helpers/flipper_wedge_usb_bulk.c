@@ -0,0 +1,412 @@
+#include "flipper_wedge_usb_bulk.h"
+
+#include <usb_hid.h>
+#include <hid_usage_desktop.h>
+#include <hid_usage_keyboard.h>
+#include <hid_usage_led.h>
+
+#define TAG "FlipperWedgeUsbBulk"
+
+// Interfaces and endpoints
+#define USB_BULK_KB_INTERFACE 0
+#define USB_BULK_VENDOR_INTERFACE 1
+#define USB_BULK_KB_EP_IN 0x82
+#define USB_BULK_KB_REPORT_LEN 8
+#define USB_BULK_VENDOR_EP_IN 0x81
+#define USB_BULK_VENDOR_EP_OUT 0x01
+
+// String descriptor indices furi_hal_usb serves from the interface
+#define USB_BULK_STR_MANUF 1
+#define USB_BULK_STR_PRODUCT 2
+
+// Vendor usages on FLIPPER_WEDGE_USB_BULK_USAGE_PAGE
+#define USB_BULK_USAGE_DEVICE 0x01
+#define USB_BULK_USAGE_INPUT 0x20
+#define USB_BULK_USAGE_OUTPUT 0x21
+
+struct UsbBulkHidInterface {
+    struct usb_interface_descriptor interface;
+    struct usb_hid_descriptor hid;
+} __attribute__((packed));
+
+struct UsbBulkConfigDescriptor {
+    struct usb_config_descriptor config;
+    struct UsbBulkHidInterface kb;
+    struct usb_endpoint_descriptor kb_ep_in;
+    struct UsbBulkHidInterface vendor;
+    struct usb_endpoint_descriptor vendor_ep_in;
+    struct usb_endpoint_descriptor vendor_ep_out;
+} __attribute__((packed));
+
+// Boot keyboard: modifiers, reserved byte, 6 keys, LED output
+static const uint8_t usb_bulk_kb_report_desc[] = {
+    HID_USAGE_PAGE(HID_PAGE_DESKTOP),
+    HID_USAGE(HID_DESKTOP_KEYBOARD),
+    HID_COLLECTION(HID_APPLICATION_COLLECTION),
+    HID_USAGE_PAGE(HID_DESKTOP_KEYPAD),
+    HID_USAGE_MINIMUM(HID_KEYBOARD_L_CTRL),
+    HID_USAGE_MAXIMUM(HID_KEYBOARD_R_GUI),
+    HID_LOGICAL_MINIMUM(0),
+    HID_LOGICAL_MAXIMUM(1),
+    HID_REPORT_SIZE(1),
+    HID_REPORT_COUNT(8),
+    HID_INPUT(HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+    HID_REPORT_COUNT(1),
+    HID_REPORT_SIZE(8),
+    HID_INPUT(HID_IOF_CONSTANT),
+    HID_USAGE_PAGE(HID_PAGE_LED),
+    HID_REPORT_COUNT(5),
+    HID_REPORT_SIZE(1),
+    HID_USAGE_MINIMUM(1),
+    HID_USAGE_MAXIMUM(5),
+    HID_OUTPUT(HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+    HID_REPORT_COUNT(1),
+    HID_REPORT_SIZE(3),
+    HID_OUTPUT(HID_IOF_CONSTANT),
+    HID_USAGE_PAGE(HID_DESKTOP_KEYPAD),
+    HID_REPORT_COUNT(6),
+    HID_REPORT_SIZE(8),
+    HID_LOGICAL_MINIMUM(0),
+    HID_LOGICAL_MAXIMUM(101),
+    HID_USAGE_MINIMUM(0),
+    HID_USAGE_MAXIMUM(101),
+    HID_INPUT(HID_IOF_DATA | HID_IOF_ARRAY | HID_IOF_ABSOLUTE),
+    HID_END_COLLECTION,
+};
+
+// Vendor page: one 64-byte input and one 64-byte output report, no report IDs
+static const uint8_t usb_bulk_vendor_report_desc[] = {
+    HID_RI_USAGE_PAGE(16, FLIPPER_WEDGE_USB_BULK_USAGE_PAGE),
+    HID_USAGE(USB_BULK_USAGE_DEVICE),
+    HID_COLLECTION(HID_APPLICATION_COLLECTION),
+    HID_USAGE(USB_BULK_USAGE_INPUT),
+    HID_LOGICAL_MINIMUM(0),
+    HID_RI_LOGICAL_MAXIMUM(16, 0xFF),
+    HID_REPORT_SIZE(8),
+    HID_REPORT_COUNT(FLIPPER_WEDGE_USB_BULK_PACKET_LEN),
+    HID_INPUT(HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+    HID_USAGE(USB_BULK_USAGE_OUTPUT),
+    HID_LOGICAL_MINIMUM(0),
+    HID_RI_LOGICAL_MAXIMUM(16, 0xFF),
+    HID_REPORT_SIZE(8),
+    HID_REPORT_COUNT(FLIPPER_WEDGE_USB_BULK_PACKET_LEN),
+    HID_OUTPUT(HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+    HID_END_COLLECTION,
+};
+
+static const struct usb_string_descriptor usb_bulk_manuf_desc = USB_STRING_DESC("Flipper Devices Inc.");
+static const struct usb_string_descriptor usb_bulk_prod_desc = USB_STRING_DESC("Flipper Wedge");
+
+static const struct usb_device_descriptor usb_bulk_device_desc = {
+    .bLength = sizeof(struct usb_device_descriptor),
+    .bDescriptorType = USB_DTYPE_DEVICE,
+    .bcdUSB = VERSION_BCD(2, 0, 0),
+    .bDeviceClass = USB_CLASS_PER_INTERFACE,
+    .bDeviceSubClass = USB_SUBCLASS_NONE,
+    .bDeviceProtocol = USB_PROTO_NONE,
+    .bMaxPacketSize0 = USB_EP0_SIZE,
+    .idVendor = FLIPPER_WEDGE_USB_BULK_VID,
+    .idProduct = FLIPPER_WEDGE_USB_BULK_PID,
+    .bcdDevice = VERSION_BCD(1, 0, 0),
+    .iManufacturer = USB_BULK_STR_MANUF,
+    .iProduct = USB_BULK_STR_PRODUCT,
+    .iSerialNumber = NO_DESCRIPTOR,
+    .bNumConfigurations = 1,
+};
+
+static const struct UsbBulkConfigDescriptor usb_bulk_cfg_desc = {
+    .config =
+        {
+            .bLength = sizeof(struct usb_config_descriptor),
+            .bDescriptorType = USB_DTYPE_CONFIGURATION,
+            .wTotalLength = sizeof(struct UsbBulkConfigDescriptor),
+            .bNumInterfaces = 2,
+            .bConfigurationValue = 1,
+            .iConfiguration = NO_DESCRIPTOR,
+            .bmAttributes = USB_CFG_ATTR_RESERVED | USB_CFG_ATTR_SELFPOWERED,
+            .bMaxPower = USB_CFG_POWER_MA(100),
+        },
+    .kb =
+        {
+            .interface =
+                {
+                    .bLength = sizeof(struct usb_interface_descriptor),
+                    .bDescriptorType = USB_DTYPE_INTERFACE,
+                    .bInterfaceNumber = USB_BULK_KB_INTERFACE,
+                    .bAlternateSetting = 0,
+                    .bNumEndpoints = 1,
+                    .bInterfaceClass = USB_CLASS_HID,
+                    .bInterfaceSubClass = USB_HID_SUBCLASS_BOOT,
+                    .bInterfaceProtocol = USB_HID_PROTO_KEYBOARD,
+                    .iInterface = NO_DESCRIPTOR,
+                },
+            .hid =
+                {
+                    .bLength = sizeof(struct usb_hid_descriptor),
+                    .bDescriptorType = USB_DTYPE_HID,
+                    .bcdHID = VERSION_BCD(1, 0, 0),
+                    .bCountryCode = USB_HID_COUNTRY_NONE,
+                    .bNumDescriptors = 1,
+                    .bDescriptorType0 = USB_DTYPE_HID_REPORT,
+                    .wDescriptorLength0 = sizeof(usb_bulk_kb_report_desc),
+                },
+        },
+    .kb_ep_in =
+        {
+            .bLength = sizeof(struct usb_endpoint_descriptor),
+            .bDescriptorType = USB_DTYPE_ENDPOINT,
+            .bEndpointAddress = USB_BULK_KB_EP_IN,
+            .bmAttributes = USB_EPTYPE_INTERRUPT,
+            .wMaxPacketSize = USB_BULK_KB_REPORT_LEN,
+            .bInterval = 10,
+        },
+    .vendor =
+        {
+            .interface =
+                {
+                    .bLength = sizeof(struct usb_interface_descriptor),
+                    .bDescriptorType = USB_DTYPE_INTERFACE,
+                    .bInterfaceNumber = USB_BULK_VENDOR_INTERFACE,
+                    .bAlternateSetting = 0,
+                    .bNumEndpoints = 2,
+                    .bInterfaceClass = USB_CLASS_HID,
+                    .bInterfaceSubClass = USB_HID_SUBCLASS_NONBOOT,
+                    .bInterfaceProtocol = USB_HID_PROTO_NONBOOT,
+                    .iInterface = NO_DESCRIPTOR,
+                },
+            .hid =
+                {
+                    .bLength = sizeof(struct usb_hid_descriptor),
+                    .bDescriptorType = USB_DTYPE_HID,
+                    .bcdHID = VERSION_BCD(1, 0, 0),
+                    .bCountryCode = USB_HID_COUNTRY_NONE,
+                    .bNumDescriptors = 1,
+                    .bDescriptorType0 = USB_DTYPE_HID_REPORT,
+                    .wDescriptorLength0 = sizeof(usb_bulk_vendor_report_desc),
+                },
+        },
+    .vendor_ep_in =
+        {
+            .bLength = sizeof(struct usb_endpoint_descriptor),
+            .bDescriptorType = USB_DTYPE_ENDPOINT,
+            .bEndpointAddress = USB_BULK_VENDOR_EP_IN,
+            .bmAttributes = USB_EPTYPE_INTERRUPT,
+            .wMaxPacketSize = FLIPPER_WEDGE_USB_BULK_PACKET_LEN,
+            .bInterval = 1,
+        },
+    .vendor_ep_out =
+        {
+            .bLength = sizeof(struct usb_endpoint_descriptor),
+            .bDescriptorType = USB_DTYPE_ENDPOINT,
+            .bEndpointAddress = USB_BULK_VENDOR_EP_OUT,
+            .bmAttributes = USB_EPTYPE_INTERRUPT,
+            .wMaxPacketSize = FLIPPER_WEDGE_USB_BULK_PACKET_LEN,
+            .bInterval = 1,
+        },
+};
+
+static void usb_bulk_init(usbd_device* dev, FuriHalUsbInterface* intf, void* ctx);
+static void usb_bulk_deinit(usbd_device* dev);
+static void usb_bulk_on_wakeup(usbd_device* dev);
+static void usb_bulk_on_suspend(usbd_device* dev);
+
+FuriHalUsbInterface usb_flipper_wedge_bulk = {
+    .init = usb_bulk_init,
+    .deinit = usb_bulk_deinit,
+    .wakeup = usb_bulk_on_wakeup,
+    .suspend = usb_bulk_on_suspend,
+
+    .dev_descr = (struct usb_device_descriptor*)&usb_bulk_device_desc,
+
+    .str_manuf_descr = (void*)&usb_bulk_manuf_desc,
+    .str_prod_descr = (void*)&usb_bulk_prod_desc,
+    .str_serial_descr = NULL,
+
+    .cfg_descr = (void*)&usb_bulk_cfg_desc,
+};
+
+static usbd_device* usb_dev;
+// Taken by a report on the vendor IN endpoint, given back when the host read it
+static FuriSemaphore* usb_bulk_tx_semaphore;
+static bool usb_bulk_connected;
+static uint8_t usb_bulk_kb_idle;
+static uint8_t usb_bulk_kb_protocol = 1;  // Report protocol
+
+static FlipperWedgeUsbBulkCallback usb_bulk_callback;
+static void* usb_bulk_callback_context;
+
+void flipper_wedge_usb_bulk_set_request_callback(FlipperWedgeUsbBulkCallback callback, void* context) {
+    usb_bulk_callback = callback;
+    usb_bulk_callback_context = context;
+}
+
+bool flipper_wedge_usb_bulk_is_connected(void) {
+    return usb_bulk_connected;
+}
+
+size_t flipper_wedge_usb_bulk_get_request(uint8_t* data) {
+    furi_assert(data);
+    if(!usb_dev) return 0;
+    int32_t len = usbd_ep_read(usb_dev, USB_BULK_VENDOR_EP_OUT, data, FLIPPER_WEDGE_USB_BULK_PACKET_LEN);
+    return (len < 0) ? 0 : (size_t)len;
+}
+
+bool flipper_wedge_usb_bulk_send(const uint8_t* report, uint32_t timeout_ms) {
+    furi_assert(report);
+    if(!usb_bulk_tx_semaphore || !usb_bulk_connected) return false;
+
+    if(furi_semaphore_acquire(usb_bulk_tx_semaphore, furi_ms_to_ticks(timeout_ms)) != FuriStatusOk) {
+        FURI_LOG_W(TAG, "Host didn't read the last report");
+        return false;
+    }
+    if(!usb_bulk_connected) return false;
+    usbd_ep_write(usb_dev, USB_BULK_VENDOR_EP_IN, (void*)report, FLIPPER_WEDGE_USB_BULK_PACKET_LEN);
+    return true;
+}
+
+static void usb_bulk_vendor_ep_callback(usbd_device* dev, uint8_t event, uint8_t ep) {
+    UNUSED(dev);
+    UNUSED(ep);
+    if(event == usbd_evt_eptx) {
+        furi_semaphore_release(usb_bulk_tx_semaphore);
+    } else if(usb_bulk_callback) {
+        usb_bulk_callback(usb_bulk_callback_context);
+    }
+}
+
+// The keyboard never types in this mode, its endpoint only answers polls
+static void usb_bulk_kb_ep_callback(usbd_device* dev, uint8_t event, uint8_t ep) {
+    UNUSED(dev);
+    UNUSED(event);
+    UNUSED(ep);
+}
+
+static usbd_respond usb_bulk_ep_config(usbd_device* dev, uint8_t cfg) {
+    switch(cfg) {
+    case 0:
+        // Deconfiguring device
+        usbd_ep_deconfig(dev, USB_BULK_KB_EP_IN);
+        usbd_ep_deconfig(dev, USB_BULK_VENDOR_EP_IN);
+        usbd_ep_deconfig(dev, USB_BULK_VENDOR_EP_OUT);
+        usbd_reg_endpoint(dev, USB_BULK_KB_EP_IN, 0);
+        usbd_reg_endpoint(dev, USB_BULK_VENDOR_EP_IN, 0);
+        usbd_reg_endpoint(dev, USB_BULK_VENDOR_EP_OUT, 0);
+        return usbd_ack;
+    case 1:
+        // Configuring device
+        usbd_ep_config(dev, USB_BULK_KB_EP_IN, USB_EPTYPE_INTERRUPT, USB_BULK_KB_REPORT_LEN);
+        usbd_ep_config(dev, USB_BULK_VENDOR_EP_IN, USB_EPTYPE_INTERRUPT, FLIPPER_WEDGE_USB_BULK_PACKET_LEN);
+        usbd_ep_config(dev, USB_BULK_VENDOR_EP_OUT, USB_EPTYPE_INTERRUPT, FLIPPER_WEDGE_USB_BULK_PACKET_LEN);
+        usbd_reg_endpoint(dev, USB_BULK_KB_EP_IN, usb_bulk_kb_ep_callback);
+        usbd_reg_endpoint(dev, USB_BULK_VENDOR_EP_IN, usb_bulk_vendor_ep_callback);
+        usbd_reg_endpoint(dev, USB_BULK_VENDOR_EP_OUT, usb_bulk_vendor_ep_callback);
+        return usbd_ack;
+    default:
+        return usbd_fail;
+    }
+}
+
+static usbd_respond usb_bulk_control(usbd_device* dev, usbd_ctlreq* req, usbd_rqc_callback* callback) {
+    UNUSED(callback);
+    uint8_t interface = req->wIndex & 0xFF;
+    if(interface != USB_BULK_KB_INTERFACE && interface != USB_BULK_VENDOR_INTERFACE) {
+        return usbd_fail;
+    }
+
+    // HID class requests, only the keyboard keeps state
+    if(((USB_REQ_RECIPIENT | USB_REQ_TYPE) & req->bmRequestType) ==
+       (USB_REQ_INTERFACE | USB_REQ_CLASS)) {
+        switch(req->bRequest) {
+        case USB_HID_SETIDLE:
+            if(interface == USB_BULK_KB_INTERFACE) usb_bulk_kb_idle = req->wValue >> 8;
+            return usbd_ack;
+        case USB_HID_GETIDLE:
+            dev->status.data_ptr = &usb_bulk_kb_idle;
+            dev->status.data_count = sizeof(usb_bulk_kb_idle);
+            return usbd_ack;
+        case USB_HID_SETPROTOCOL:
+            if(interface == USB_BULK_KB_INTERFACE) usb_bulk_kb_protocol = req->wValue;
+            return usbd_ack;
+        case USB_HID_GETPROTOCOL:
+            dev->status.data_ptr = &usb_bulk_kb_protocol;
+            dev->status.data_count = sizeof(usb_bulk_kb_protocol);
+            return usbd_ack;
+        case USB_HID_SETREPORT:
+            // Keyboard LEDs, nothing to show them on
+            return usbd_ack;
+        default:
+            return usbd_fail;
+        }
+    }
+
+    // HID and report descriptors of each interface
+    if(((USB_REQ_RECIPIENT | USB_REQ_TYPE) & req->bmRequestType) ==
+           (USB_REQ_INTERFACE | USB_REQ_STANDARD) &&
+       req->bRequest == USB_STD_GET_DESCRIPTOR) {
+        bool kb = (interface == USB_BULK_KB_INTERFACE);
+        switch(req->wValue >> 8) {
+        case USB_DTYPE_HID:
+            dev->status.data_ptr = kb ? (uint8_t*)&usb_bulk_cfg_desc.kb.hid :
+                                        (uint8_t*)&usb_bulk_cfg_desc.vendor.hid;
+            dev->status.data_count = sizeof(struct usb_hid_descriptor);
+            return usbd_ack;
+        case USB_DTYPE_HID_REPORT:
+            dev->status.data_ptr = kb ? (uint8_t*)usb_bulk_kb_report_desc :
+                                        (uint8_t*)usb_bulk_vendor_report_desc;
+            dev->status.data_count = kb ? sizeof(usb_bulk_kb_report_desc) :
+                                          sizeof(usb_bulk_vendor_report_desc);
+            return usbd_ack;
+        default:
+            return usbd_fail;
+        }
+    }
+
+    return usbd_fail;
+}
+
+static void usb_bulk_init(usbd_device* dev, FuriHalUsbInterface* intf, void* ctx) {
+    UNUSED(intf);
+    UNUSED(ctx);
+    if(!usb_bulk_tx_semaphore) {
+        usb_bulk_tx_semaphore = furi_semaphore_alloc(1, 1);
+    } else {
+        // A report in flight when the device went away is never acknowledged
+        furi_semaphore_release(usb_bulk_tx_semaphore);
+    }
+    usb_dev = dev;
+
+    usbd_reg_config(dev, usb_bulk_ep_config);
+    usbd_reg_control(dev, usb_bulk_control);
+
+    usbd_connect(dev, true);
+}
+
+static void usb_bulk_deinit(usbd_device* dev) {
+    usbd_reg_config(dev, NULL);
+    usbd_reg_control(dev, NULL);
+    usb_bulk_connected = false;
+    usb_dev = NULL;
+}
+
+static void usb_bulk_on_wakeup(usbd_device* dev) {
+    UNUSED(dev);
+    usb_bulk_connected = true;
+}
+
+static void usb_bulk_on_suspend(usbd_device* dev) {
+    UNUSED(dev);
+    if(usb_bulk_connected) {
+        usb_bulk_connected = false;
+        // A report the host will never read must not block the next send
+        if(usb_bulk_tx_semaphore) furi_semaphore_release(usb_bulk_tx_semaphore);
+    }
+}
+
+void flipper_wedge_usb_bulk_free(void) {
+    // The interface is gone, nothing signals the semaphore any more
+    furi_assert(!usb_dev);
+    if(usb_bulk_tx_semaphore) {
+        furi_semaphore_free(usb_bulk_tx_semaphore);
+        usb_bulk_tx_semaphore = NULL;
+    }
+}
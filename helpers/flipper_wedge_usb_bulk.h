@@ -0,0 +1,67 @@
+#pragma once
+
+/** USB device of the USB Bulk output mode
+ *
+ * A composite device of two HID interfaces:
+ *   0  boot keyboard, so the host sees the same keyboard wedge as in the
+ *      typing modes (nothing is typed on it in this mode)
+ *   1  vendor defined (usage page 0xFF00), 64-byte input and output reports
+ *      carrying the bulk protocol, see flipper_wedge_bulk.h
+ *
+ * The firmware's U2F interface would do for the reports, but it makes the
+ * Flipper a FIDO security key: browsers and OS FIDO services open it and
+ * send it their own requests. Nothing claims a vendor usage page.
+ */
+
+#include <furi.h>
+#include <furi_hal_usb.h>
+
+#define FLIPPER_WEDGE_USB_BULK_VID 0x0483
+#define FLIPPER_WEDGE_USB_BULK_PID 0x5742
+#define FLIPPER_WEDGE_USB_BULK_USAGE_PAGE 0xFF00
+#define FLIPPER_WEDGE_USB_BULK_PACKET_LEN 64
+
+/** Request callback
+ * Called from USB interrupt context when the host sent a report on the
+ * vendor interface, fetch it with flipper_wedge_usb_bulk_get_request()
+ *
+ * @param context Callback context
+ */
+typedef void (*FlipperWedgeUsbBulkCallback)(void* context);
+
+/** Interface to pass to furi_hal_usb_set_config() */
+extern FuriHalUsbInterface usb_flipper_wedge_bulk;
+
+/** Set the request callback
+ *
+ * @param callback Callback, NULL to remove
+ * @param context Callback context
+ */
+void flipper_wedge_usb_bulk_set_request_callback(FlipperWedgeUsbBulkCallback callback, void* context);
+
+/** Check if the host configured the device
+ *
+ * @return true if reports can be exchanged
+ */
+bool flipper_wedge_usb_bulk_is_connected(void);
+
+/** Read the last report the host sent on the vendor interface
+ *
+ * @param data Output, FLIPPER_WEDGE_USB_BULK_PACKET_LEN bytes
+ * @return Number of bytes read, 0 if there was none
+ */
+size_t flipper_wedge_usb_bulk_get_request(uint8_t* data);
+
+/** Send one report on the vendor interface
+ * Waits until the host took the previous report.
+ *
+ * @param report FLIPPER_WEDGE_USB_BULK_PACKET_LEN bytes
+ * @param timeout_ms Longest wait for the host
+ * @return true if the report was queued, false if disconnected or timed out
+ */
+bool flipper_wedge_usb_bulk_send(const uint8_t* report, uint32_t timeout_ms);
+
+/** Free what the interface allocated on its first init
+ * Call once another interface replaced it, the next init allocates again.
+ */
+void flipper_wedge_usb_bulk_free(void);
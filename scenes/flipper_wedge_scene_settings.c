@@ -12,8 +12,10 @@ enum SettingsIndex {
     SettingsIndexModeStartup,
     SettingsIndexVibration,
     SettingsIndexNdefMaxLen,
+    SettingsIndexNdefSelect,
     SettingsIndexLogToSd,
     SettingsIndexKeyboardLayout,
+    SettingsIndexUnicode,
 };
 
 const char* const on_off_text[2] = {
@@ -47,9 +49,11 @@ const char* const mode_startup_text[6] = {
 };
 
 // Output mode options
-const char* const output_text[2] = {
+const char* const output_text[FlipperWedgeOutputCount] = {
     "USB",
     "BLE",
+    "USB+BLE",
+    "USB Bulk",
 };
 
 // Delimiter options - display names
@@ -79,17 +83,18 @@ const char* const delimiter_values[] = {
 #define DELIMITER_OPTIONS_COUNT 8
 
 // Keyboard layout storage (built-in + custom layouts from SD)
-#define LAYOUT_BUILTIN_COUNT 2  // Default, NumPad
-#define LAYOUT_MAX_CUSTOM 10    // Max custom layouts to show
-static FuriString* layout_custom_names[LAYOUT_MAX_CUSTOM];
-static FuriString* layout_custom_paths[LAYOUT_MAX_CUSTOM];
-static size_t layout_custom_count = 0;
-static size_t layout_total_count = LAYOUT_BUILTIN_COUNT;
-
-// Built-in layout names
-static const char* layout_builtin_names[LAYOUT_BUILTIN_COUNT] = {
-    "Default (QWERTY)",
-    "NumPad",
+#define LAYOUT_BUILTIN_COUNT 6  // Default, NumPad, AZERTY, QWERTZ, Hungarian, Dvorak
+// Variable item value index is a uint8_t
+#define LAYOUT_MAX_CUSTOM (UINT8_MAX - LAYOUT_BUILTIN_COUNT)
+
+// Built-in layouts in menu order
+static const FlipperWedgeLayoutType layout_builtin_types[LAYOUT_BUILTIN_COUNT] = {
+    FlipperWedgeLayoutDefault,
+    FlipperWedgeLayoutNumPad,
+    FlipperWedgeLayoutAzerty,
+    FlipperWedgeLayoutQwertz,
+    FlipperWedgeLayoutHungarian,
+    FlipperWedgeLayoutDvorak,
 };
 
 // Helper function to find delimiter index
@@ -148,10 +153,21 @@ static void flipper_wedge_scene_settings_set_ndef_max_len(VariableItem* item) {
     FURI_LOG_I("Settings", "NDEF callback: index=%d, old app value=%d", index, app->ndef_max_len);
     variable_item_set_current_value_text(item, ndef_max_len_text[index]);
     app->ndef_max_len = (FlipperWedgeNdefMaxLen)index;
+    flipper_wedge_nfc_set_ndef_max_chars(app->nfc, flipper_wedge_ndef_max_chars(app->ndef_max_len));
     FURI_LOG_I("Settings", "NDEF callback: new app value=%d, about to save", app->ndef_max_len);
     flipper_wedge_save_settings(app);  // Save immediately to persist across app restarts
 }
 
+static void flipper_wedge_scene_settings_set_ndef_select(VariableItem* item) {
+    FlipperWedge* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, flipper_wedge_ndef_select_name(index));
+    app->ndef_select = (FlipperWedgeNdefSelect)index;
+    flipper_wedge_nfc_set_ndef_select(app->nfc, app->ndef_select, app->ndef_mime_type);
+    flipper_wedge_save_settings(app);  // Save immediately to persist across app restarts
+}
+
 static void flipper_wedge_scene_settings_set_log_to_sd(VariableItem* item) {
     FlipperWedge* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
@@ -163,38 +179,44 @@ static void flipper_wedge_scene_settings_set_log_to_sd(VariableItem* item) {
     flipper_wedge_save_settings(app);  // Save immediately to persist across app restarts
 }
 
-static void flipper_wedge_scene_settings_set_keyboard_layout(VariableItem* item) {
+static void flipper_wedge_scene_settings_set_unicode(VariableItem* item) {
     FlipperWedge* app = variable_item_get_context(item);
     uint8_t index = variable_item_get_current_value_index(item);
 
-    FURI_LOG_I("Settings", "Layout callback: index=%d", index);
+    variable_item_set_current_value_text(item, flipper_wedge_keyboard_layout_unicode_mode_name(index));
+    flipper_wedge_keyboard_layout_set_unicode_mode(app->keyboard_layout, (FlipperWedgeUnicodeMode)index);
+    flipper_wedge_save_settings(app);  // Save immediately to persist across app restarts
+}
 
-    // Get the layout name for display
-    const char* layout_name;
-    if(index < LAYOUT_BUILTIN_COUNT) {
-        layout_name = layout_builtin_names[index];
-    } else {
-        size_t custom_index = index - LAYOUT_BUILTIN_COUNT;
-        if(custom_index < layout_custom_count && layout_custom_names[custom_index]) {
-            layout_name = furi_string_get_cstr(layout_custom_names[custom_index]);
-        } else {
-            layout_name = "???";
-        }
+// Custom layout record for a selector index, read from the index on demand
+static const FlipperWedgeKeyboardLayoutIndexEntry*
+    flipper_wedge_scene_settings_custom_layout(FlipperWedge* app, uint8_t index) {
+    size_t custom_index = index - LAYOUT_BUILTIN_COUNT;
+    if(!app->layout_index ||
+       custom_index >= flipper_wedge_keyboard_layout_index_count(app->layout_index)) {
+        return NULL;
     }
-    variable_item_set_current_value_text(item, layout_name);
+    return flipper_wedge_keyboard_layout_index_get(app->layout_index, custom_index);
+}
+
+static void flipper_wedge_scene_settings_set_keyboard_layout(VariableItem* item) {
+    FlipperWedge* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    FURI_LOG_I("Settings", "Layout callback: index=%d", index);
 
     // Apply the selected layout
-    if(index == 0) {
-        // Default (QWERTY)
-        flipper_wedge_keyboard_layout_set_default(app->keyboard_layout);
-    } else if(index == 1) {
-        // NumPad
-        flipper_wedge_keyboard_layout_set_numpad(app->keyboard_layout);
+    if(index < LAYOUT_BUILTIN_COUNT) {
+        variable_item_set_current_value_text(
+            item, flipper_wedge_keyboard_layout_type_name(layout_builtin_types[index]));
+        flipper_wedge_keyboard_layout_set_builtin(app->keyboard_layout, layout_builtin_types[index]);
     } else {
         // Custom layout from file
-        size_t custom_index = index - LAYOUT_BUILTIN_COUNT;
-        if(custom_index < layout_custom_count && layout_custom_paths[custom_index]) {
-            const char* path = furi_string_get_cstr(layout_custom_paths[custom_index]);
+        const FlipperWedgeKeyboardLayoutIndexEntry* entry =
+            flipper_wedge_scene_settings_custom_layout(app, index);
+        variable_item_set_current_value_text(item, entry ? entry->name : "???");
+        if(entry) {
+            const char* path = entry->path;
             if(!flipper_wedge_keyboard_layout_load(app->keyboard_layout, path)) {
                 FURI_LOG_E("Settings", "Failed to load layout: %s", path);
                 // Notify user of failure with error feedback
@@ -222,8 +244,8 @@ static void flipper_wedge_scene_settings_set_output(VariableItem* item) {
     // Handle output mode change with DEFERRED switching
     if(new_output_mode != app->output_mode) {
         FURI_LOG_I("Settings", "Requesting output mode switch: %s -> %s",
-                   app->output_mode == FlipperWedgeOutputUsb ? "USB" : "BLE",
-                   new_output_mode == FlipperWedgeOutputUsb ? "USB" : "BLE");
+                   flipper_wedge_output_name(app->output_mode),
+                   flipper_wedge_output_name(new_output_mode));
 
         // Set flag for tick callback to process (worker thread handles HID lifecycle)
         app->output_switch_pending = true;
@@ -284,9 +306,9 @@ void flipper_wedge_scene_settings_on_enter(void* context) {
 
     // Pair Bluetooth... action (show in BLE mode or when switching to BLE)
     // Hide immediately when switching from BLE to USB for cleaner UX
-    bool currently_ble = (app->output_mode == FlipperWedgeOutputBle);
-    bool switching_to_ble = (app->output_switch_pending && app->output_switch_target == FlipperWedgeOutputBle);
-    bool switching_from_ble = (app->output_switch_pending && app->output_mode == FlipperWedgeOutputBle);
+    bool currently_ble = flipper_wedge_output_uses_ble(app->output_mode);
+    bool switching_to_ble = (app->output_switch_pending && flipper_wedge_output_uses_ble(app->output_switch_target));
+    bool switching_from_ble = (app->output_switch_pending && flipper_wedge_output_uses_ble(app->output_mode));
 
     // Only show if in BLE mode or switching TO BLE (not FROM BLE)
     if((currently_ble || switching_to_ble) && !switching_from_ble) {
@@ -368,6 +390,16 @@ void flipper_wedge_scene_settings_on_enter(void* context) {
     variable_item_set_current_value_index(item, app->ndef_max_len);
     variable_item_set_current_value_text(item, ndef_max_len_text[app->ndef_max_len]);
 
+    // NDEF record selector
+    item = variable_item_list_add(
+        app->variable_item_list,
+        "NDEF Record:",
+        FlipperWedgeNdefSelectCount,
+        flipper_wedge_scene_settings_set_ndef_select,
+        app);
+    variable_item_set_current_value_index(item, app->ndef_select);
+    variable_item_set_current_value_text(item, flipper_wedge_ndef_select_name(app->ndef_select));
+
     // Log to SD toggle
     item = variable_item_list_add(
         app->variable_item_list,
@@ -379,59 +411,47 @@ void flipper_wedge_scene_settings_on_enter(void* context) {
     variable_item_set_current_value_text(item, on_off_text[app->log_to_sd ? 1 : 0]);
 
     // Keyboard Layout selector
-    // First, free any previously allocated custom layout strings
-    for(size_t i = 0; i < layout_custom_count; i++) {
-        if(layout_custom_names[i]) {
-            furi_string_free(layout_custom_names[i]);
-            layout_custom_names[i] = NULL;
-        }
-        if(layout_custom_paths[i]) {
-            furi_string_free(layout_custom_paths[i]);
-            layout_custom_paths[i] = NULL;
-        }
+    // Custom layouts come from the index, only changed files are re-read
+    if(!app->layout_index) {
+        app->layout_index =
+            flipper_wedge_keyboard_layout_index_alloc(furi_record_open(RECORD_STORAGE));
     }
-
-    // Scan for custom layouts on SD card
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    layout_custom_count = flipper_wedge_keyboard_layout_list(
-        storage,
-        layout_custom_names,
-        layout_custom_paths,
-        LAYOUT_MAX_CUSTOM);
-    furi_record_close(RECORD_STORAGE);
-
-    layout_total_count = LAYOUT_BUILTIN_COUNT + layout_custom_count;
+    size_t layout_custom_count = flipper_wedge_keyboard_layout_index_refresh(app->layout_index);
+    if(layout_custom_count > LAYOUT_MAX_CUSTOM) {
+        FURI_LOG_W("Settings", "Showing %d of %zu custom layouts", LAYOUT_MAX_CUSTOM, layout_custom_count);
+        layout_custom_count = LAYOUT_MAX_CUSTOM;
+    }
+    uint8_t layout_total_count = LAYOUT_BUILTIN_COUNT + layout_custom_count;
 
     // Determine current layout index
     uint8_t layout_index = 0;
     if(app->keyboard_layout) {
-        if(app->keyboard_layout->type == FlipperWedgeLayoutDefault) {
-            layout_index = 0;
-        } else if(app->keyboard_layout->type == FlipperWedgeLayoutNumPad) {
-            layout_index = 1;
-        } else if(app->keyboard_layout->type == FlipperWedgeLayoutCustom) {
-            // Find the matching custom layout by path
-            for(size_t i = 0; i < layout_custom_count; i++) {
-                if(layout_custom_paths[i] &&
-                   strcmp(app->keyboard_layout->file_path, furi_string_get_cstr(layout_custom_paths[i])) == 0) {
-                    layout_index = LAYOUT_BUILTIN_COUNT + i;
+        if(flipper_wedge_keyboard_layout_is_builtin(app->keyboard_layout->type)) {
+            for(uint8_t i = 0; i < LAYOUT_BUILTIN_COUNT; i++) {
+                if(layout_builtin_types[i] == app->keyboard_layout->type) {
+                    layout_index = i;
                     break;
                 }
             }
+        } else if(app->keyboard_layout->type == FlipperWedgeLayoutCustom) {
+            // Find the matching custom layout by path
+            size_t position;
+            if(flipper_wedge_keyboard_layout_index_find(
+                   app->layout_index, app->keyboard_layout->file_path, &position) &&
+               position < layout_custom_count) {
+                layout_index = LAYOUT_BUILTIN_COUNT + position;
+            }
         }
     }
 
     // Get current layout name for display
     const char* current_layout_name;
     if(layout_index < LAYOUT_BUILTIN_COUNT) {
-        current_layout_name = layout_builtin_names[layout_index];
+        current_layout_name = flipper_wedge_keyboard_layout_type_name(layout_builtin_types[layout_index]);
     } else {
-        size_t custom_idx = layout_index - LAYOUT_BUILTIN_COUNT;
-        if(custom_idx < layout_custom_count && layout_custom_names[custom_idx]) {
-            current_layout_name = furi_string_get_cstr(layout_custom_names[custom_idx]);
-        } else {
-            current_layout_name = "???";
-        }
+        const FlipperWedgeKeyboardLayoutIndexEntry* entry =
+            flipper_wedge_scene_settings_custom_layout(app, layout_index);
+        current_layout_name = entry ? entry->name : "???";
     }
 
     item = variable_item_list_add(
@@ -443,6 +463,17 @@ void flipper_wedge_scene_settings_on_enter(void* context) {
     variable_item_set_current_value_index(item, layout_index);
     variable_item_set_current_value_text(item, current_layout_name);
 
+    // Unicode input method for characters above ASCII (accented NDEF text)
+    item = variable_item_list_add(
+        app->variable_item_list,
+        "Unicode:",
+        FlipperWedgeUnicodeCount,
+        flipper_wedge_scene_settings_set_unicode,
+        app);
+    variable_item_set_current_value_index(item, app->keyboard_layout->unicode_mode);
+    variable_item_set_current_value_text(
+        item, flipper_wedge_keyboard_layout_unicode_mode_name(app->keyboard_layout->unicode_mode));
+
     // Set callback for when user clicks on an item
     variable_item_list_set_enter_callback(
         app->variable_item_list,
@@ -485,7 +516,7 @@ bool flipper_wedge_scene_settings_on_event(void* context, SceneManagerEvent even
         if(tick_counter >= check_interval) {
             tick_counter = 0;
 
-            bool currently_ble = (app->output_mode == FlipperWedgeOutputBle);
+            bool currently_ble = flipper_wedge_output_uses_ble(app->output_mode);
             bool switching = app->output_switch_pending;
 
             // Check if we need to rebuild the list
@@ -538,19 +569,12 @@ void flipper_wedge_scene_settings_on_exit(void* context) {
     variable_item_list_set_selected_item(app->variable_item_list, 0);
     variable_item_list_reset(app->variable_item_list);
 
-    // Free custom layout strings
-    for(size_t i = 0; i < layout_custom_count; i++) {
-        if(layout_custom_names[i]) {
-            furi_string_free(layout_custom_names[i]);
-            layout_custom_names[i] = NULL;
-        }
-        if(layout_custom_paths[i]) {
-            furi_string_free(layout_custom_paths[i]);
-            layout_custom_paths[i] = NULL;
-        }
+    // Drop the layout index page cache, the index file stays for next time
+    if(app->layout_index) {
+        flipper_wedge_keyboard_layout_index_free(app->layout_index);
+        app->layout_index = NULL;
+        furi_record_close(RECORD_STORAGE);
     }
-    layout_custom_count = 0;
-    layout_total_count = LAYOUT_BUILTIN_COUNT;
 
     // Return backlight to auto mode
     notification_message(app->notification, &sequence_display_backlight_enforce_auto);
@@ -14,6 +14,20 @@ typedef struct {
     char uid_text[64];
 } FlipperWedgeStartscreenModel;
 
+// Output is never cut by the typing queue, what fits the buffer fits a job
+_Static_assert(
+    FLIPPER_WEDGE_OUTPUT_MAX_LEN - 1 <= FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN,
+    "output buffer holds more text than a typing job");
+
+// Every bulk field at its buffer size still fits a bulk slot
+_Static_assert(
+    FLIPPER_WEDGE_BULK_HEADER_SIZE + 6 * FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE +
+            (FLIPPER_WEDGE_OUTPUT_MAX_LEN - 1) + FLIPPER_WEDGE_NFC_UID_MAX_LEN +
+            FLIPPER_WEDGE_RFID_UID_MAX_LEN + (sizeof(((FlipperWedge*)0)->rfid_protocol) - 1) +
+            (FLIPPER_WEDGE_NDEF_MAX_LEN - 1) + sizeof(uint32_t) <=
+        FLIPPER_WEDGE_HID_WORKER_BULK_MAX_LEN,
+    "bulk message can outgrow a bulk slot");
+
 // Forward declarations
 static void flipper_wedge_scene_startscreen_start_scanning(FlipperWedge* app);
 static void flipper_wedge_scene_startscreen_stop_scanning(FlipperWedge* app);
@@ -43,11 +57,35 @@ static void flipper_wedge_scene_startscreen_display_timer_callback(void* context
                 // Error messages don't need "Sent" confirmation
                 is_error = (strstr(model->status_text, "Not NFC Forum Compliant") != NULL) ||
                           (strstr(model->status_text, "Unsupported NFC Forum Type") != NULL) ||
-                          (strstr(model->status_text, "NDEF Not Found") != NULL);
+                          (strstr(model->status_text, "NDEF Not Found") != NULL) ||
+                          (strstr(model->status_text, "Output Queue Full") != NULL);
             },
             false);
 
-        if(is_error) {
+        // Bulk messages wait for the host reader, there is no typing to follow
+        if(!is_error && app->output_mode != FlipperWedgeOutputUsbBulk &&
+           flipper_wedge_hid_worker_is_busy(app->hid_worker)) {
+            // Still typing in the background, keep the result up and show progress
+            size_t typed = 0;
+            size_t total = 0;
+            flipper_wedge_hid_worker_get_progress(app->hid_worker, &typed, &total);
+            char progress_text[32];
+            if(total > 0) {
+                snprintf(progress_text, sizeof(progress_text), "Typing %zu/%zu...", typed, total);
+            } else {
+                snprintf(progress_text, sizeof(progress_text), "Typing...");
+            }
+            flipper_wedge_startscreen_set_status_text(app->flipper_wedge_startscreen, progress_text);
+
+            // Single-tag modes keep scanning while typing, a new tag pre-empts the
+            // rest of this output. Combo modes wait, their prompts use the display.
+            bool single_tag = (app->mode == FlipperWedgeModeNfc || app->mode == FlipperWedgeModeRfid ||
+                               app->mode == FlipperWedgeModeNdef);
+            if(single_tag && app->scan_state == FlipperWedgeScanStateCooldown) {
+                app->scan_state = FlipperWedgeScanStateIdle;
+            }
+            furi_timer_start(app->display_timer, furi_ms_to_ticks(FLIPPER_WEDGE_HID_PROGRESS_INTERVAL_MS));
+        } else if(is_error) {
             // For errors, skip "Sent" and go directly to cooldown
             flipper_wedge_led_reset(app);
             flipper_wedge_startscreen_set_display_state(app->flipper_wedge_startscreen, FlipperWedgeDisplayStateIdle);
@@ -71,7 +109,10 @@ static void flipper_wedge_scene_startscreen_display_timer_callback(void* context
         flipper_wedge_led_reset(app);
         flipper_wedge_startscreen_set_display_state(app->flipper_wedge_startscreen, FlipperWedgeDisplayStateIdle);
         flipper_wedge_startscreen_set_status_text(app->flipper_wedge_startscreen, "");
-        app->scan_state = FlipperWedgeScanStateIdle;
+        // Scanning may already be running again if it resumed during typing
+        if(app->scan_state == FlipperWedgeScanStateCooldown) {
+            app->scan_state = FlipperWedgeScanStateIdle;
+        }
         // Tick handler will restart scanning automatically
     }
 }
@@ -114,6 +155,8 @@ static void flipper_wedge_scene_startscreen_rfid_callback(FlipperWedgeRfidData*
     // Store the RFID data
     app->rfid_uid_len = data->uid_len;
     memcpy(app->rfid_uid, data->uid, data->uid_len);
+    strlcpy(app->rfid_protocol, data->protocol_name, sizeof(app->rfid_protocol));
+    app->rfid_fields = data->fields;
 
     // Send event to main thread
     view_dispatcher_send_custom_event(app->view_dispatcher, FlipperWedgeCustomEventRfidDetected);
@@ -130,46 +173,44 @@ static void flipper_wedge_scene_startscreen_output_and_reset(FlipperWedge* app)
     FURI_LOG_I("FlipperWedgeScene", "output_and_reset: nfc_uid_len=%d, rfid_uid_len=%d", app->nfc_uid_len, app->rfid_uid_len);
 
     // Determine max NDEF length from settings
-    size_t max_ndef_len = 0;
-    switch(app->ndef_max_len) {
-        case FlipperWedgeNdefMaxLen250:
-            max_ndef_len = 250;
-            break;
-        case FlipperWedgeNdefMaxLen500:
-            max_ndef_len = 500;
-            break;
-        case FlipperWedgeNdefMaxLen1000:
-            max_ndef_len = 1000;
-            break;
-        default:
-            max_ndef_len = 250;
-            break;
-    }
+    size_t max_ndef_len = flipper_wedge_ndef_max_chars(app->ndef_max_len);
 
     // Sanitize NDEF text if present (remove non-printable chars, apply length limit)
     char sanitized_ndef[FLIPPER_WEDGE_NDEF_MAX_LEN];
     if(app->ndef_text[0] != '\0') {
-        size_t original_len = strlen(app->ndef_text);
+        bool truncated;
         size_t sanitized_len = flipper_wedge_sanitize_text(
             app->ndef_text,
             sanitized_ndef,
             sizeof(sanitized_ndef),
-            max_ndef_len);
+            max_ndef_len,
+            &truncated);
 
-        FURI_LOG_I("FlipperWedgeScene", "NDEF text: original=%zu, sanitized=%zu, limit=%zu",
-                   original_len, sanitized_len, max_ndef_len);
+        FURI_LOG_I("FlipperWedgeScene", "NDEF text: original=%zu bytes, sanitized=%zu chars, limit=%zu",
+                   strlen(app->ndef_text), sanitized_len, max_ndef_len);
 
         // Warn if text was truncated
-        if(max_ndef_len > 0 && original_len > max_ndef_len) {
-            FURI_LOG_W("FlipperWedgeScene", "NDEF text truncated from %zu to %zu chars",
-                       original_len, sanitized_len);
+        if(truncated) {
+            FURI_LOG_W("FlipperWedgeScene", "NDEF text truncated to %zu chars", sanitized_len);
         }
     } else {
         sanitized_ndef[0] = '\0';
     }
 
-    // Format the output based on mode
-    if(app->mode == FlipperWedgeModeNdef) {
+    // Format the output based on mode, a template replaces the built-in arrangement
+    if(flipper_wedge_template_is_set(&app->output_template)) {
+        const FlipperWedgeTemplateData data = {
+            .nfc_uid = app->nfc_uid,
+            .nfc_uid_len = app->nfc_uid_len,
+            .rfid_uid = app->rfid_uid,
+            .rfid_uid_len = app->rfid_uid_len,
+            .rfid_fields = app->rfid_uid_len > 0 ? &app->rfid_fields : NULL,
+            .ndef_text = sanitized_ndef,
+            .delimiter = app->delimiter,
+        };
+        flipper_wedge_template_render(
+            &app->output_template, &data, app->output_buffer, sizeof(app->output_buffer));
+    } else if(app->mode == FlipperWedgeModeNdef) {
         // NDEF mode: output only NDEF text (no UID)
         snprintf(app->output_buffer, sizeof(app->output_buffer), "%s", sanitized_ndef);
     } else {
@@ -193,52 +234,63 @@ static void flipper_wedge_scene_startscreen_output_and_reset(FlipperWedge* app)
     flipper_wedge_startscreen_set_uid_text(app->flipper_wedge_startscreen, app->output_buffer);
     flipper_wedge_startscreen_set_display_state(app->flipper_wedge_startscreen, FlipperWedgeDisplayStateResult);
 
-    // Type the output via HID (with chunking for long text)
-    if(flipper_wedge_hid_is_connected(flipper_wedge_get_hid(app))) {
-        size_t text_len = strlen(app->output_buffer);
-
-        // If text is long (>100 chars), show progress and type in chunks
-        if(text_len > 100) {
-            const size_t chunk_size = 100;
-            size_t chunks = (text_len + chunk_size - 1) / chunk_size;
-
-            for(size_t i = 0; i < chunks; i++) {
-                // Update progress
-                char progress_text[32];
-                snprintf(progress_text, sizeof(progress_text), "Typing %zu/%zu...", i + 1, chunks);
-                flipper_wedge_startscreen_set_status_text(app->flipper_wedge_startscreen, progress_text);
-
-                // Type chunk
-                size_t chunk_start = i * chunk_size;
-                size_t chunk_len = (chunk_start + chunk_size > text_len) ?
-                                   (text_len - chunk_start) : chunk_size;
-
-                char chunk[101];  // 100 + null terminator
-                memcpy(chunk, app->output_buffer + chunk_start, chunk_len);
-                chunk[chunk_len] = '\0';
-
-                flipper_wedge_hid_type_string(flipper_wedge_get_hid(app), app->keyboard_layout, chunk);
-
-                // Small delay between chunks (let HID catch up)
-                furi_delay_ms(50);
+    // Queue the output for typing; the HID worker types it in the background
+    // so the GUI thread stays responsive for long NDEF payloads
+    bool queue_failed = false;
+    if(app->output_mode == FlipperWedgeOutputUsbBulk) {
+        // Bulk output is queued even with no reader attached, the host pulls
+        // it on its next request. Scans are kept, not pre-empted.
+        uint8_t timestamp[4];
+        uint32_t now = furi_hal_rtc_get_timestamp();
+        for(size_t i = 0; i < sizeof(timestamp); i++) {
+            timestamp[i] = (now >> (8 * i)) & 0xFF;
+        }
+        const FlipperWedgeBulkField fields[] = {
+            {FlipperWedgeBulkFieldText, (const uint8_t*)app->output_buffer, strlen(app->output_buffer)},
+            {FlipperWedgeBulkFieldNfcUid, app->nfc_uid, app->nfc_uid_len},
+            {FlipperWedgeBulkFieldRfidUid, app->rfid_uid, app->rfid_uid_len},
+            {FlipperWedgeBulkFieldRfidProtocol,
+             (const uint8_t*)app->rfid_protocol,
+             app->rfid_uid_len > 0 ? strlen(app->rfid_protocol) : 0},
+            {FlipperWedgeBulkFieldNdefText, (const uint8_t*)sanitized_ndef, strlen(sanitized_ndef)},
+            {FlipperWedgeBulkFieldTimestamp, timestamp, sizeof(timestamp)},
+        };
+
+        if(flipper_wedge_hid_worker_send_bulk(app->hid_worker, fields, COUNT_OF(fields))) {
+            if(app->log_to_sd) {
+                flipper_wedge_log_scan(app->output_buffer);
             }
         } else {
-            // Short text, type normally
-            flipper_wedge_hid_type_string(flipper_wedge_get_hid(app), app->keyboard_layout, app->output_buffer);
+            FURI_LOG_W("FlipperWedgeScene", "Bulk queue full, output dropped");
+            flipper_wedge_startscreen_set_status_text(app->flipper_wedge_startscreen, "Output Queue Full");
+            queue_failed = true;
         }
-
-        if(app->append_enter) {
-            flipper_wedge_hid_press_enter(flipper_wedge_get_hid(app));
+    } else if(flipper_wedge_hid_is_connected(flipper_wedge_get_hid(app))) {
+        // A new scan pre-empts whatever is still being typed
+        if(flipper_wedge_hid_worker_is_busy(app->hid_worker)) {
+            FURI_LOG_I("FlipperWedgeScene", "New output pre-empts typing in progress");
+            flipper_wedge_hid_worker_cancel(app->hid_worker);
         }
 
-        // Log to SD card if enabled
-        if(app->log_to_sd) {
-            flipper_wedge_log_scan(app->output_buffer);
+        if(flipper_wedge_hid_worker_type(
+               app->hid_worker, app->keyboard_layout, app->output_buffer, app->append_enter)) {
+            // Log to SD card if enabled
+            if(app->log_to_sd) {
+                flipper_wedge_log_scan(app->output_buffer);
+            }
+        } else {
+            FURI_LOG_W("FlipperWedgeScene", "Typing queue full, output dropped");
+            flipper_wedge_startscreen_set_status_text(app->flipper_wedge_startscreen, "Output Queue Full");
+            queue_failed = true;
         }
     }
 
     // LED feedback (haptic happens later when "Sent" is displayed)
-    flipper_wedge_led_set_rgb(app, 0, 255, 0);  // Green flash
+    if(queue_failed) {
+        flipper_wedge_led_set_rgb(app, 255, 0, 0);  // Red flash
+    } else {
+        flipper_wedge_led_set_rgb(app, 0, 255, 0);  // Green flash
+    }
 
     // Start display timer to show result, then "Sent", then cooldown (non-blocking)
     if(app->display_timer) {
@@ -253,6 +305,8 @@ static void flipper_wedge_scene_startscreen_output_and_reset(FlipperWedge* app)
     // Clear scanned data
     app->nfc_uid_len = 0;
     app->rfid_uid_len = 0;
+    app->rfid_protocol[0] = '\0';
+    app->rfid_fields.valid = false;
     app->ndef_text[0] = '\0';
 
     // Set state to cooldown to prevent immediate re-scan
@@ -349,8 +403,9 @@ bool flipper_wedge_scene_startscreen_on_event(void* context, SceneManagerEvent e
     if(event.type == SceneManagerEventTypeCustom) {
         switch(event.event) {
         case FlipperWedgeCustomEventModeChange:
-            // Stop current scanning and restart with new mode
+            // Stop current scanning and typing, restart with new mode
             flipper_wedge_scene_startscreen_stop_scanning(app);
+            flipper_wedge_hid_worker_cancel(app->hid_worker);
 
             // Get the new mode from the view (the view already updated it)
             app->mode = flipper_wedge_startscreen_get_mode(app->flipper_wedge_startscreen);
@@ -390,7 +445,7 @@ bool flipper_wedge_scene_startscreen_on_event(void* context, SceneManagerEvent e
                     } else if(app->nfc_error == FlipperWedgeNfcErrorUnsupportedType) {
                         error_msg = "Unsupported NFC Forum Type";
                         FURI_LOG_D("FlipperWedgeScene", "NDEF mode - Unsupported NFC Forum Type");
-                    } else if(app->nfc_error == FlipperWedgeNfcErrorNoTextRecord) {
+                    } else if(app->nfc_error == FlipperWedgeNfcErrorNoRecord) {
                         error_msg = "NDEF Not Found";
                         FURI_LOG_D("FlipperWedgeScene", "NDEF mode - NDEF not found");
                     } else {
@@ -479,6 +534,7 @@ bool flipper_wedge_scene_startscreen_on_event(void* context, SceneManagerEvent e
 
         case FlipperWedgeCustomEventStartscreenBack:
             flipper_wedge_scene_startscreen_stop_scanning(app);
+            flipper_wedge_hid_worker_cancel(app->hid_worker);
             notification_message(app->notification, &sequence_reset_red);
             notification_message(app->notification, &sequence_reset_green);
             notification_message(app->notification, &sequence_reset_blue);
@@ -523,6 +579,9 @@ void flipper_wedge_scene_startscreen_on_exit(void* context) {
     FlipperWedge* app = context;
     flipper_wedge_scene_startscreen_stop_scanning(app);
 
+    // Don't keep typing into the host behind the user's back
+    flipper_wedge_hid_worker_cancel(app->hid_worker);
+
     // Stop display timer if running
     if(app->display_timer) {
         furi_timer_stop(app->display_timer);
@@ -0,0 +1,254 @@
+// UID formatting speed. One JSON object per line.
+//
+// "hex" is flipper_wedge_format_output() with the ':' delimiter, writing
+// two characters per byte from a digit table straight into the output,
+// against the snprintf("%02X") per byte into a 64-byte buffer it
+// replaced, copied here as it was. Both must give the same output.
+//
+// "decimal" is flipper_wedge_format_uid_decimal(), which divides by 10^9
+// per pass, against the long division by 10 per digit it replaced, copied
+// here as it was. UIDs are 4 (EM4100/Mifare single size), 7 (NTAG), 10
+// (triple size) and 16 bytes with no zero bytes. Times are host CPU time
+// on x86-64, so compare the two columns rather than reading them as
+// Flipper numbers.
+
+#include "test.h"
+#include "flipper_wedge_format.h"
+#include <stdio.h>
+#include <time.h>
+
+#define RUN_NS 50000000ULL // Per case
+
+// flipper_wedge_format_uid() before the digit table
+static void hex_snprintf_uid(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    const char* delimiter,
+    char* output,
+    size_t output_size) {
+    size_t pos = 0;
+    size_t delim_len = delimiter ? strlen(delimiter) : 0;
+
+    for(uint8_t i = 0; i < uid_len && pos < output_size - 3; i++) {
+        // Add delimiter before byte (except first)
+        if(i > 0 && delim_len > 0) {
+            if(pos + delim_len >= output_size - 3) break;
+            memcpy(output + pos, delimiter, delim_len);
+            pos += delim_len;
+        }
+
+        // Add hex byte (uppercase)
+        if(pos + 2 >= output_size) break;
+        snprintf(output + pos, output_size - pos, "%02X", uid[i]);
+        pos += 2;
+    }
+
+    output[pos] = '\0';
+}
+
+// flipper_wedge_format_output() before the digit table, NFC first, no NDEF
+static void hex_snprintf_output(
+    const uint8_t* nfc_uid,
+    uint8_t nfc_uid_len,
+    const uint8_t* rfid_uid,
+    uint8_t rfid_uid_len,
+    const char* delimiter,
+    char* output,
+    size_t output_size) {
+    output[0] = '\0';
+    size_t pos = 0;
+
+    char uid_buf[64];
+
+    if(nfc_uid && nfc_uid_len > 0) {
+        hex_snprintf_uid(nfc_uid, nfc_uid_len, delimiter, uid_buf, sizeof(uid_buf));
+        size_t len = strlen(uid_buf);
+        if(pos + len < output_size) {
+            memcpy(output + pos, uid_buf, len);
+            pos += len;
+        }
+    }
+
+    if(rfid_uid && rfid_uid_len > 0) {
+        hex_snprintf_uid(rfid_uid, rfid_uid_len, delimiter, uid_buf, sizeof(uid_buf));
+        size_t len = strlen(uid_buf);
+        if(pos + len < output_size) {
+            memcpy(output + pos, uid_buf, len);
+            pos += len;
+        }
+    }
+
+    output[pos] = '\0';
+}
+
+static void hex_lookup_output(
+    const uint8_t* nfc_uid,
+    uint8_t nfc_uid_len,
+    const uint8_t* rfid_uid,
+    uint8_t rfid_uid_len,
+    const char* delimiter,
+    char* output,
+    size_t output_size) {
+    flipper_wedge_format_output(
+        nfc_uid, nfc_uid_len, rfid_uid, rfid_uid_len, NULL, delimiter, true, output, output_size);
+}
+
+typedef void (*HexFormatter)(const uint8_t*, uint8_t, const uint8_t*, uint8_t, const char*, char*, size_t);
+
+// flipper_wedge_format_uid_decimal() before base-10^9 limbs
+static size_t decimal_per_digit(
+    const uint8_t* uid,
+    uint8_t uid_len,
+    uint8_t flags,
+    char* output,
+    size_t output_size) {
+    if(!uid || uid_len == 0 || uid_len > FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES || !output) {
+        return 0;
+    }
+
+    // Most significant byte first
+    uint8_t number[FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES];
+    for(uint8_t i = 0; i < uid_len; i++) {
+        number[i] = uid[(flags & FlipperWedgeFormatReverse) ? uid_len - 1 - i : i];
+    }
+
+    // Divide by 10 until nothing is left, digits come out last first.
+    // 16 bytes are at most 39 digits.
+    char digits[40];
+    size_t count = 0;
+    uint8_t start = 0;
+    while(start < uid_len && number[start] == 0) start++;
+    do {
+        uint16_t remainder = 0;
+        for(uint8_t i = start; i < uid_len; i++) {
+            uint16_t value = (remainder << 8) | number[i];
+            number[i] = value / 10;
+            remainder = value % 10;
+        }
+        digits[count++] = '0' + remainder;
+        while(start < uid_len && number[start] == 0) start++;
+    } while(start < uid_len);
+
+    if(count > output_size) return 0;
+    for(size_t i = 0; i < count; i++) {
+        output[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+typedef size_t (*DecimalFormatter)(const uint8_t*, uint8_t, uint8_t, char*, size_t);
+
+static uint64_t cpu_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// Sum of the lengths, so the loop can't be optimized away
+static volatile size_t bench_sink;
+
+static double ns_per_uid(
+    DecimalFormatter format,
+    uint8_t (*uids)[FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES],
+    size_t count,
+    uint8_t len) {
+    char output[40];
+    uint64_t runs = 0;
+    uint64_t start = cpu_now_ns();
+    uint64_t elapsed;
+    do {
+        for(size_t i = 0; i < count; i++) {
+            bench_sink += format(uids[i], len, 0, output, sizeof(output));
+        }
+        runs += count;
+        elapsed = cpu_now_ns() - start;
+    } while(elapsed < RUN_NS);
+    return (double)elapsed / runs;
+}
+
+static double ns_per_scan(
+    HexFormatter format,
+    const uint8_t* nfc_uid,
+    uint8_t nfc_uid_len,
+    const uint8_t* rfid_uid,
+    uint8_t rfid_uid_len) {
+    static char output[1200]; // FLIPPER_WEDGE_OUTPUT_MAX_LEN
+    uint64_t runs = 0;
+    uint64_t start = cpu_now_ns();
+    uint64_t elapsed;
+    do {
+        for(size_t i = 0; i < 1000; i++) {
+            format(nfc_uid, nfc_uid_len, rfid_uid, rfid_uid_len, ":", output, sizeof(output));
+            bench_sink += output[0];
+        }
+        runs += 1000;
+        elapsed = cpu_now_ns() - start;
+    } while(elapsed < RUN_NS);
+    return (double)elapsed / runs;
+}
+
+static void bench_hex(const char* name, uint8_t nfc_uid_len, uint8_t rfid_uid_len) {
+    static const uint8_t nfc_uid[] = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6, 0x07, 0x18, 0x29};
+    static const uint8_t rfid_uid[] = {0x1A, 0x2B, 0x3C, 0x4D, 0x5E};
+    static char lookup[1200];
+    static char snprintf_output[1200];
+
+    hex_lookup_output(nfc_uid, nfc_uid_len, rfid_uid, rfid_uid_len, ":", lookup, sizeof(lookup));
+    hex_snprintf_output(
+        nfc_uid, nfc_uid_len, rfid_uid, rfid_uid_len, ":", snprintf_output, sizeof(snprintf_output));
+    furi_check(strcmp(lookup, snprintf_output) == 0);
+
+    double lookup_ns = ns_per_scan(hex_lookup_output, nfc_uid, nfc_uid_len, rfid_uid, rfid_uid_len);
+    double snprintf_ns = ns_per_scan(hex_snprintf_output, nfc_uid, nfc_uid_len, rfid_uid, rfid_uid_len);
+    printf(
+        "{\"bench\":\"format\",\"op\":\"hex\",\"uids\":\"%s\",\"chars\":%zu,"
+        "\"ns_per_scan\":%.1f,\"snprintf_ns_per_scan\":%.1f,\"speedup\":%.1f}\n",
+        name,
+        strlen(lookup),
+        lookup_ns,
+        snprintf_ns,
+        snprintf_ns / lookup_ns);
+}
+
+static void bench_decimal(uint8_t len) {
+    // Different UIDs each call, so branch history doesn't learn one number
+    static uint8_t uids[256][FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES];
+    uint32_t seed = 0xF0 + len;
+    for(size_t i = 0; i < COUNT_OF(uids); i++) {
+        for(uint8_t b = 0; b < len; b++) {
+            uids[i][b] = 1 + test_random(&seed) % 255;
+        }
+    }
+
+    // Same digits from both before timing anything
+    char limbs[40];
+    char digits[40];
+    for(size_t i = 0; i < COUNT_OF(uids); i++) {
+        size_t limbs_len = flipper_wedge_format_uid_decimal(uids[i], len, 0, limbs, sizeof(limbs));
+        furi_check(limbs_len == decimal_per_digit(uids[i], len, 0, digits, sizeof(digits)));
+        furi_check(memcmp(limbs, digits, limbs_len) == 0);
+    }
+
+    double limbs_ns = ns_per_uid(flipper_wedge_format_uid_decimal, uids, COUNT_OF(uids), len);
+    double per_digit_ns = ns_per_uid(decimal_per_digit, uids, COUNT_OF(uids), len);
+    printf(
+        "{\"bench\":\"format\",\"op\":\"decimal\",\"uid_bytes\":%u,\"digits\":%zu,"
+        "\"ns_per_uid\":%.1f,\"per_digit_ns_per_uid\":%.1f,\"speedup\":%.1f}\n",
+        len,
+        flipper_wedge_format_uid_decimal(uids[0], len, 0, limbs, sizeof(limbs)),
+        limbs_ns,
+        per_digit_ns,
+        per_digit_ns / limbs_ns);
+}
+
+int main(void) {
+    bench_hex("nfc_4", 4, 0);
+    bench_hex("nfc_7", 7, 0);
+    bench_hex("nfc_10", 10, 0);
+    bench_hex("nfc_7_rfid_5", 7, 5);
+    bench_decimal(4);
+    bench_decimal(7);
+    bench_decimal(10);
+    bench_decimal(16);
+    return 0;
+}
@@ -0,0 +1,230 @@
+// Load time of the shipped custom keyboard layouts: the single-pass parser,
+// the same load answered from the binary cache, and the FlipperFormat
+// loader it replaced, copied here as it was. One JSON object per line.
+//
+// "bytes_read" is what each load reads from the SD card: storage reads, and
+// for the old loader the lines every FlipperFormat lookup searched through
+// after its rewind, which the firmware streams from the file again. "cpu_us"
+// is host CPU time on x86-64, so compare the loaders rather than reading it
+// as a Flipper number. template.txt is left out, it maps no keys and is a
+// version 2 file the old loader refuses.
+
+#include "test.h"
+#include "stub.h"
+#include "flipper_wedge_keyboard_layout.h"
+#include <flipper_format/flipper_format.h>
+#include <toolbox/path.h>
+#include <inttypes.h>
+#include <time.h>
+
+#define RUN_NS 100000000ULL // Per case
+
+static const char* const layout_files[] = {"azerty_fr.txt", "hungarian.txt"};
+
+// Layout of the old loader: a keycode per ASCII character
+typedef struct {
+    uint16_t keycode;
+    bool defined;
+} OldKeyMapping;
+
+typedef struct {
+    char name[FLIPPER_WEDGE_LAYOUT_NAME_MAX];
+    OldKeyMapping map[128];
+} OldLayout;
+
+// flipper_wedge_keyboard_layout_load() before the single-pass parser, one
+// rewind and key lookup per character
+static bool old_layout_load(OldLayout* layout, const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* file = flipper_format_file_alloc(storage);
+    bool success = false;
+
+    do {
+        if(!flipper_format_file_open_existing(file, path)) break;
+
+        // Check file type and version
+        FuriString* file_type = furi_string_alloc();
+        uint32_t version = 0;
+        if(!flipper_format_read_header(file, file_type, &version) ||
+           furi_string_cmp_str(file_type, "Flipper Wedge Keyboard Layout") != 0 || version > 1) {
+            furi_string_free(file_type);
+            break;
+        }
+        furi_string_free(file_type);
+
+        memset(layout->map, 0, sizeof(layout->map));
+
+        // Read layout name
+        FuriString* name = furi_string_alloc();
+        if(flipper_format_read_string(file, "Name", name)) {
+            strlcpy(layout->name, furi_string_get_cstr(name), sizeof(layout->name));
+        } else {
+            // Use filename as fallback name
+            FuriString* filename = furi_string_alloc();
+            path_extract_filename_no_ext(path, filename);
+            strlcpy(layout->name, furi_string_get_cstr(filename), sizeof(layout->name));
+            furi_string_free(filename);
+            // Rewind to continue reading mappings
+            flipper_format_rewind(file);
+            uint32_t dummy_ver;
+            FuriString* dummy_type = furi_string_alloc();
+            flipper_format_read_header(file, dummy_type, &dummy_ver);
+            furi_string_free(dummy_type);
+        }
+        furi_string_free(name);
+
+        FuriString* value = furi_string_alloc();
+        static const char* chars_to_lookup = "0123456789ABCDEFabcdef-:,.;";
+        for(size_t i = 0; chars_to_lookup[i] != '\0'; i++) {
+            char c = chars_to_lookup[i];
+            char key[2] = {c, '\0'};
+
+            if(flipper_format_read_string(file, key, value)) {
+                // Parse value: "keycode" or "keycode SHIFT"
+                const char* val_str = furi_string_get_cstr(value);
+                uint32_t keycode = 0;
+                bool has_shift = strstr(val_str, "SHIFT") != NULL || strstr(val_str, "shift") != NULL;
+
+                if(val_str[0] == '0' && (val_str[1] == 'x' || val_str[1] == 'X')) {
+                    keycode = strtoul(val_str, NULL, 16);
+                } else {
+                    keycode = strtoul(val_str, NULL, 10);
+                }
+
+                if(keycode > 0 && keycode < 256) {
+                    layout->map[(uint8_t)c].keycode = keycode;
+                    if(has_shift) {
+                        layout->map[(uint8_t)c].keycode |= KEY_MOD_LEFT_SHIFT;
+                    }
+                    layout->map[(uint8_t)c].defined = true;
+                }
+            }
+
+            // Rewind after each read attempt to try next key
+            flipper_format_rewind(file);
+            uint32_t dummy_ver;
+            FuriString* dummy_type = furi_string_alloc();
+            flipper_format_read_header(file, dummy_type, &dummy_ver);
+            furi_string_free(dummy_type);
+            // Skip Name if present
+            FuriString* dummy_name = furi_string_alloc();
+            flipper_format_read_string(file, "Name", dummy_name);
+            furi_string_free(dummy_name);
+        }
+
+        furi_string_free(value);
+        success = true;
+    } while(false);
+
+    flipper_format_file_close(file);
+    flipper_format_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
+
+static bool install_layout(const char* file, FuriString* path) {
+    char source_path[64];
+    snprintf(source_path, sizeof(source_path), "../assets/layouts/%s", file);
+    FILE* source = fopen(source_path, "rb");
+    if(!source) return false;
+
+    furi_string_printf(path, "%s/%s", FLIPPER_WEDGE_LAYOUTS_DIRECTORY, file);
+    FILE* target = fopen(stub_storage_host_path(furi_string_get_cstr(path)), "wb");
+    if(!target) {
+        fclose(source);
+        return false;
+    }
+    char buffer[1024];
+    size_t read;
+    while((read = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+        fwrite(buffer, 1, read, target);
+    }
+    fclose(target);
+    fclose(source);
+    return true;
+}
+
+static uint64_t cpu_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+typedef bool (*LayoutLoader)(const char* path, void* layout);
+
+static bool load_old(const char* path, void* layout) {
+    return old_layout_load(layout, path);
+}
+
+static bool load_new(const char* path, void* layout) {
+    return flipper_wedge_keyboard_layout_load(layout, path);
+}
+
+static void bench_one(
+    const char* file,
+    const char* path,
+    const char* loader_name,
+    LayoutLoader loader,
+    void* layout) {
+    // Bytes of one load, then CPU time over many
+    uint64_t bytes_before = stub_storage_bytes_read();
+    furi_check(loader(path, layout));
+    uint64_t bytes_read = stub_storage_bytes_read() - bytes_before;
+
+    uint64_t runs = 0;
+    uint64_t start = cpu_now_ns();
+    uint64_t elapsed;
+    do {
+        for(size_t i = 0; i < 100; i++) furi_check(loader(path, layout));
+        runs += 100;
+        elapsed = cpu_now_ns() - start;
+    } while(elapsed < RUN_NS);
+
+    printf(
+        "{\"bench\":\"layout_load\",\"file\":\"%s\",\"loader\":\"%s\",\"bytes_read\":%" PRIu64
+        ",\"cpu_us\":%.1f}\n",
+        file,
+        loader_name,
+        bytes_read,
+        elapsed / 1000.0 / runs);
+}
+
+int main(void) {
+    char root[] = "/tmp/flipper_wedge_bench_XXXXXX";
+    furi_check(mkdtemp(root));
+    stub_storage_set_root(root);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY);
+    furi_record_close(RECORD_STORAGE);
+
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    static OldLayout old_layout;
+    FuriString* path = furi_string_alloc();
+
+    for(size_t i = 0; i < COUNT_OF(layout_files); i++) {
+        furi_check(install_layout(layout_files[i], path));
+        const char* layout_path = furi_string_get_cstr(path);
+
+        // Same keycodes for every character the old loader looked up
+        furi_check(old_layout_load(&old_layout, layout_path));
+        furi_check(flipper_wedge_keyboard_layout_load(layout, layout_path));
+        size_t mapped = 0;
+        for(size_t c = 0; c < COUNT_OF(old_layout.map); c++) {
+            if(!old_layout.map[c].defined) continue;
+            furi_check(flipper_wedge_keyboard_layout_get_keycode(layout, c) == old_layout.map[c].keycode);
+            mapped++;
+        }
+        furi_check(mapped > 0);
+
+        bench_one(layout_files[i], layout_path, "old", load_old, &old_layout);
+        // Without a timestamp the cache is neither read nor written
+        stub_storage_set_timestamp_fails(true);
+        bench_one(layout_files[i], layout_path, "parse", load_new, layout);
+        stub_storage_set_timestamp_fails(false);
+        bench_one(layout_files[i], layout_path, "cache", load_new, layout);
+    }
+
+    furi_string_free(path);
+    flipper_wedge_keyboard_layout_free(layout);
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Parse throughput of the NDEF record iterator and selector on messages as
+// tags hold them. One JSON object per line.
+//
+// Messages: one 1000-character text record in a Type 2 TLV, the same text
+// in 10 chunks, 32 short text and URI records, and a Smart Poster. "iterate"
+// walks every record view, "select" writes the selected text into a 1 KB
+// buffer the way the NFC reader does. Times are host CPU time on x86-64, so
+// compare runs rather than reading them as Flipper numbers.
+
+#include "test.h"
+#include "flipper_wedge_ndef.h"
+#include <time.h>
+
+#define MB 0x80
+#define ME 0x40
+#define CF 0x20
+#define SR 0x10
+
+#define RUN_NS 50000000ULL // Per case
+
+typedef struct {
+    const char* name;
+    bool tlv; // Type 2 tag memory instead of a bare message
+    FlipperWedgeNdefSelect select;
+    uint8_t data[4096];
+    size_t len;
+} BenchMessage;
+
+static void put(BenchMessage* message, const void* bytes, size_t len) {
+    furi_check(message->len + len <= sizeof(message->data));
+    memcpy(&message->data[message->len], bytes, len);
+    message->len += len;
+}
+
+static void put_byte(BenchMessage* message, uint8_t byte) {
+    put(message, &byte, 1);
+}
+
+static void put_record(
+    BenchMessage* message,
+    uint8_t flags,
+    const char* type,
+    const void* prefix,
+    size_t prefix_len,
+    const char* text) {
+    size_t payload_len = prefix_len + strlen(text);
+    bool short_record = payload_len <= 0xFF;
+    put_byte(message, flags | (short_record ? SR : 0));
+    put_byte(message, strlen(type));
+    if(short_record) {
+        put_byte(message, payload_len);
+    } else {
+        uint8_t len[4] = {0, 0, payload_len >> 8, payload_len};
+        put(message, len, sizeof(len));
+    }
+    put(message, type, strlen(type));
+    put(message, prefix, prefix_len);
+    put(message, text, strlen(text));
+}
+
+static void put_text(BenchMessage* message, uint8_t flags, const char* text) {
+    put_record(message, flags | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T", "\x02" "en", 3, text);
+}
+
+static void put_uri(BenchMessage* message, uint8_t flags, const char* rest) {
+    put_record(message, flags | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "U", "\x04", 1, rest);
+}
+
+static void wrap_tlv(BenchMessage* message) {
+    uint8_t memory[sizeof(message->data)];
+    size_t len = 0;
+    memory[len++] = 0x03;
+    memory[len++] = 0xFF;
+    memory[len++] = message->len >> 8;
+    memory[len++] = message->len & 0xFF;
+    furi_check(len + message->len + 1 <= sizeof(memory));
+    memcpy(&memory[len], message->data, message->len);
+    len += message->len;
+    memory[len++] = 0xFE;
+    memcpy(message->data, memory, len);
+    message->len = len;
+}
+
+static void fill_text(char* text, size_t len) {
+    uint32_t seed = 0x5EED;
+    for(size_t i = 0; i < len; i++) {
+        uint32_t r = test_random(&seed);
+        text[i] = (r % 7 == 0) ? ' ' : 'a' + (r >> 8) % 26;
+    }
+    text[len] = '\0';
+}
+
+static void build_messages(BenchMessage* messages) {
+    static char text[1001];
+    fill_text(text, 1000);
+
+    BenchMessage* message = &messages[0];
+    message->name = "text_1000_tlv";
+    message->tlv = true;
+    message->select = FlipperWedgeNdefSelectText;
+    put_text(message, MB | ME, text);
+    wrap_tlv(message);
+
+    message = &messages[1];
+    message->name = "text_1000_chunked_10";
+    message->select = FlipperWedgeNdefSelectText;
+    char piece[101];
+    for(size_t i = 0; i < 10; i++) {
+        memcpy(piece, &text[i * 100], 100);
+        piece[100] = '\0';
+        uint8_t flags = (i == 0) ? (MB | CF | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN) :
+                        (i < 9)  ? (CF | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED) :
+                                   (ME | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED);
+        if(i == 0) {
+            put_record(message, flags, "T", "\x02" "en", 3, piece);
+        } else {
+            put_record(message, flags, "", NULL, 0, piece);
+        }
+    }
+
+    message = &messages[2];
+    message->name = "records_32";
+    message->select = FlipperWedgeNdefSelectAll;
+    for(size_t i = 0; i < 32; i++) {
+        uint8_t flags = (i == 0) ? MB : (i == 31) ? ME : 0;
+        if(i % 2) {
+            put_uri(message, flags, "example.com/item");
+        } else {
+            put_text(message, flags, "short note");
+        }
+    }
+
+    message = &messages[3];
+    message->name = "smart_poster";
+    message->select = FlipperWedgeNdefSelectUri;
+    BenchMessage poster = {0};
+    put_text(&poster, MB, "Flipper Wedge");
+    put_record(&poster, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "act", "\x00", 1, "");
+    put_uri(&poster, ME, "flipperzero.one/wedge");
+    put_byte(message, MB | ME | SR | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN);
+    put_byte(message, 2);
+    put_byte(message, poster.len);
+    put(message, "Sp", 2);
+    put(message, poster.data, poster.len);
+}
+
+static uint64_t cpu_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void iter_init(const BenchMessage* message, FlipperWedgeNdefIterator* it) {
+    if(message->tlv) {
+        flipper_wedge_ndef_iter_init_tlv(it, message->data, message->len);
+    } else {
+        flipper_wedge_ndef_iter_init(it, message->data, message->len);
+    }
+}
+
+// Sum of the views, so the loop can't be optimized away
+static volatile size_t bench_sink;
+
+static size_t run_iterate(const BenchMessage* message) {
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    size_t records = 0;
+    iter_init(message, &it);
+    while(flipper_wedge_ndef_iter_next(&it, &record)) {
+        bench_sink += record.payload_len + record.type_len;
+        records++;
+    }
+    return records;
+}
+
+static size_t run_select(const BenchMessage* message) {
+    static char output[1024];
+    FlipperWedgeNdefIterator it;
+    iter_init(message, &it);
+    size_t len = flipper_wedge_ndef_select(&it, message->select, NULL, output, sizeof(output));
+    bench_sink += len;
+    return len;
+}
+
+static void bench_one(const BenchMessage* message, const char* op, size_t (*run)(const BenchMessage*)) {
+    size_t result = run(message);
+    uint64_t runs = 0;
+    uint64_t start = cpu_now_ns();
+    uint64_t elapsed;
+    do {
+        for(size_t i = 0; i < 1000; i++) run(message);
+        runs += 1000;
+        elapsed = cpu_now_ns() - start;
+    } while(elapsed < RUN_NS);
+
+    double ns = (double)elapsed / runs;
+    printf(
+        "{\"bench\":\"ndef_parse\",\"message\":\"%s\",\"op\":\"%s\",\"bytes\":%zu,"
+        "\"%s\":%zu,\"ns_per_message\":%.1f,\"mb_per_s\":%.0f}\n",
+        message->name,
+        op,
+        message->len,
+        run == run_iterate ? "records" : "chars",
+        result,
+        ns,
+        message->len / ns * 1e3);
+}
+
+int main(void) {
+    static BenchMessage messages[4];
+    build_messages(messages);
+
+    for(size_t i = 0; i < COUNT_OF(messages); i++) {
+        bench_one(&messages[i], "iterate", run_iterate);
+        bench_one(&messages[i], "select", run_select);
+    }
+    return 0;
+}
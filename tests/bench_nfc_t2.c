@@ -0,0 +1,106 @@
+// Tap-to-text latency of the Type 2 NDEF reader on simulated NTAG and
+// Ultralight tags, against the MfUltralight poller's full dump it replaced.
+// One JSON object per line.
+//
+// Latency model: 106 kbit/s air time (9 bits per byte with parity, CRC
+// included), 86 us frame delay and 500 us host overhead per exchange, 1 ms
+// per reactivation after a NAK. The full dump is GET_VERSION, READ_SIG and
+// READ_CNT on NTAG (one NAKed GET_VERSION on Ultralight), then one READ per
+// 4 pages of the whole tag. "cpu_us" is the host CPU time of the read and
+// the text selection, x86-64, not the Flipper.
+
+#include "nfc_t2_tag.h"
+#include <time.h>
+
+#define AIR_US_PER_BYTE (9 * 1e6 / 105938)
+#define FRAME_DELAY_US 86
+#define HOST_US_PER_EXCHANGE 500
+#define REACTIVATION_US 1000
+
+static double exchange_us(size_t exchanges, size_t tx_bytes, size_t rx_bytes, size_t reactivations) {
+    return (tx_bytes + rx_bytes) * AIR_US_PER_BYTE +
+           exchanges * (FRAME_DELAY_US + HOST_US_PER_EXCHANGE) + reactivations * REACTIVATION_US;
+}
+
+// MfUltralight poller in read mode: every page, plus version, signature and counter
+static double full_dump_us(const T2TagModel* model, size_t* exchanges) {
+    size_t reads = (model->pages + 3) / 4;
+    size_t tx = reads * 4;
+    size_t rx = reads * 18;
+    size_t extra = 0;
+    size_t reactivations = 0;
+    if(model->fast_read) {
+        extra = 3;
+        tx += 3 + 4 + 4;
+        rx += 10 + 34 + 5;
+    } else {
+        extra = 1;
+        tx += 3;
+        rx += 1;
+        reactivations = 1;
+    }
+    *exchanges = reads + extra;
+    return exchange_us(*exchanges, tx, rx, reactivations);
+}
+
+static uint64_t cpu_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void bench_one(const T2TagModel* model, size_t chars, size_t max_chars) {
+    static T2Tag tag;
+    static uint8_t message[1024];
+    static char text[1025];
+
+    t2_tag_init(&tag, model);
+    t2_tag_put_text(&tag, 0, chars, false);
+    tag.max_chars = max_chars;
+
+    // CPU time over many runs, counters from the last one
+    const size_t runs = 2000;
+    size_t text_len = 0;
+    uint64_t start = cpu_now_ns();
+    for(size_t i = 0; i < runs; i++) {
+        t2_tag_reset_counters(&tag);
+        size_t len = flipper_wedge_nfc_t2_read_ndef(
+            t2_tag_transceive, t2_tag_reactivate, t2_tag_complete, &tag, message, sizeof(message));
+        FlipperWedgeNdefIterator it;
+        flipper_wedge_ndef_iter_init(&it, message, len);
+        text_len = flipper_wedge_ndef_select(&it, FlipperWedgeNdefSelectText, NULL, text, sizeof(text));
+    }
+    double cpu_us = (cpu_now_ns() - start) / 1000.0 / runs;
+    furi_check(text_len >= (max_chars ? max_chars : chars));
+
+    size_t dump_exchanges;
+    double dump_us = full_dump_us(model, &dump_exchanges);
+    double us = exchange_us(tag.exchanges, tag.tx_bytes, tag.rx_bytes, tag.reactivations);
+    printf(
+        "{\"bench\":\"nfc_t2\",\"tag\":\"%s\",\"chars\":%zu,\"max_chars\":%zu,"
+        "\"exchanges\":%zu,\"naks\":%zu,\"rx_bytes\":%zu,\"ms\":%.1f,"
+        "\"full_dump_exchanges\":%zu,\"full_dump_ms\":%.1f,\"cpu_us\":%.2f}\n",
+        model->name,
+        chars,
+        max_chars,
+        tag.exchanges,
+        tag.naks,
+        tag.rx_bytes,
+        us / 1000,
+        dump_exchanges,
+        dump_us / 1000,
+        cpu_us);
+}
+
+int main(void) {
+    bench_one(&t2_tag_ntag213, 20, 0);
+    bench_one(&t2_tag_ntag213, 120, 0);
+    bench_one(&t2_tag_ntag215, 400, 0);
+    bench_one(&t2_tag_ntag216, 100, 0);
+    bench_one(&t2_tag_ntag216, 500, 0);
+    bench_one(&t2_tag_ntag216, 850, 0);
+    bench_one(&t2_tag_ntag216, 850, 250);
+    bench_one(&t2_tag_ultralight, 30, 0);
+    bench_one(&t2_tag_ultralight_c, 120, 0);
+    return 0;
+}
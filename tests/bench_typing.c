@@ -0,0 +1,202 @@
+// Typing throughput of the HID layer: text sessions typed report by report
+// the way a worker lane does, against timestamping USB and BLE host models
+// on the virtual clock. One JSON object per line.
+//
+// Layouts: the firmware map, NumPad and a custom layout file (the shipped
+// French AZERTY). Payloads: a 4-byte UID, a 10-byte UID with delimiters
+// and 250, 500 and 1000 characters of NDEF text, each followed by Enter.
+//
+// "ms" and "chars_per_s" are host time on the models (USB polled every
+// 1 ms, a BLE central draining a queue of 8 notifications at 4 per 7.5 ms
+// connection interval), set by report packing and the pacer. "cpu_us" is
+// the host CPU time spent compiling and packing, the helpers' own cost on
+// x86-64.
+
+#include "test.h"
+#include "flipper_wedge_hid.h"
+#include "flipper_wedge_hid_pacer.h"
+#include <storage/storage.h>
+#include <time.h>
+
+#define CUSTOM_LAYOUT_SOURCE "../assets/layouts/azerty_fr.txt"
+#define CUSTOM_LAYOUT_PATH FLIPPER_WEDGE_LAYOUTS_DIRECTORY "/azerty_fr.txt"
+
+#define USB_POLL_INTERVAL_US 1000
+#define BLE_CONNECTION_INTERVAL_US 7500
+#define BLE_NOTIFICATIONS_PER_INTERVAL 4
+#define BLE_QUEUE_DEPTH 8
+
+// Radio core queue the central drains a few notifications per connection
+// interval from, as in test_hid_pacer
+typedef struct {
+    uint32_t queued;
+    uint64_t drained_us;
+} CentralModel;
+
+static bool central_accept(StubHid sink, uint64_t now_us, void* context) {
+    UNUSED(sink);
+    CentralModel* central = context;
+    const uint32_t interval_us = BLE_CONNECTION_INTERVAL_US / BLE_NOTIFICATIONS_PER_INTERVAL;
+    uint64_t drained = (now_us - central->drained_us) / interval_us;
+    central->queued = (drained >= central->queued) ? 0 : central->queued - drained;
+    central->drained_us += drained * interval_us;
+    if(central->queued >= BLE_QUEUE_DEPTH) return false;
+    if(central->queued++ == 0) central->drained_us = now_us;
+    return true;
+}
+
+typedef struct {
+    const char* name;
+    char text[1001];
+} Payload;
+
+static Payload payloads[] = {
+    {"uid4", "04A1B2C3"},
+    {"uid10_delimited", "04:A1:B2:C3:D4:E5:F6:07:18:29"},
+    {"ndef_250", ""},
+    {"ndef_500", ""},
+    {"ndef_1000", ""},
+};
+
+static const size_t ndef_lengths[] = {250, 500, 1000};
+
+// Mixed case words, digits and punctuation, like a URL or a note in a tag
+static void fill_ndef(char* text, size_t len, uint32_t seed) {
+    static const char punctuation[] = ".,:/-?=&";
+    for(size_t i = 0; i < len; i++) {
+        uint32_t r = test_random(&seed);
+        if(r % 7 == 0) {
+            text[i] = ' ';
+        } else if(r % 11 == 0) {
+            text[i] = punctuation[(r >> 8) % (sizeof(punctuation) - 1)];
+        } else if(r % 13 == 0) {
+            text[i] = '0' + (r >> 8) % 10;
+        } else {
+            text[i] = ((r % 5 == 0) ? 'A' : 'a') + (r >> 8) % 26;
+        }
+    }
+    text[len] = '\0';
+}
+
+static bool install_custom_layout(void) {
+    FILE* source = fopen(CUSTOM_LAYOUT_SOURCE, "rb");
+    if(!source) return false;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_mkdir(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY);
+    furi_record_close(RECORD_STORAGE);
+    FILE* target = fopen(stub_storage_host_path(CUSTOM_LAYOUT_PATH), "wb");
+    if(!target) {
+        fclose(source);
+        return false;
+    }
+    char buffer[1024];
+    size_t read;
+    while((read = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+        fwrite(buffer, 1, read, target);
+    }
+    fclose(target);
+    fclose(source);
+    return true;
+}
+
+static uint64_t cpu_now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void bench_one(
+    FlipperWedgeHidTransport transport,
+    const char* layout_name,
+    FlipperWedgeKeyboardLayout* layout,
+    const Payload* payload) {
+    StubHid sink = (transport == FlipperWedgeHidTransportUsb) ? StubHidUsb : StubHidBle;
+    CentralModel central = {0};
+
+    stub_hid_reset();
+    stub_hid_set_poll_interval(StubHidUsb, USB_POLL_INTERVAL_US);
+    stub_hid_set_accept(StubHidBle, central_accept, &central);
+    FlipperWedgeHid* hid = flipper_wedge_hid_alloc();
+    if(transport == FlipperWedgeHidTransportUsb) {
+        flipper_wedge_hid_init_usb(hid);
+    } else {
+        flipper_wedge_hid_init_ble(hid);
+        stub_hid_set_connected(StubHidBle, true);
+    }
+
+    size_t chars = strlen(payload->text);
+    static FlipperWedgeHidText text;
+    uint64_t cpu_us = 0;
+    uint64_t start_us = stub_clock_now_us();
+    central.drained_us = start_us;
+    flipper_wedge_hid_text_init(&text, layout, payload->text, chars, true);
+    while(!flipper_wedge_hid_text_is_done(&text)) {
+        uint64_t cpu_start = cpu_now_us();
+        flipper_wedge_hid_type_next_text_report(hid, transport, &text);
+        cpu_us += cpu_now_us() - cpu_start;
+        flipper_wedge_hid_pacer_delay(flipper_wedge_hid_get_delay_us(hid, transport));
+    }
+    uint64_t elapsed_us = stub_clock_now_us() - start_us;
+
+    size_t reports;
+    stub_hid_get_reports(sink, &reports);
+    uint32_t refused = stub_hid_get_refused(sink);
+    // Text plus Enter, every key reached the host
+    static uint16_t keycodes[4096];
+    furi_check(stub_hid_decode(sink, keycodes, NULL, COUNT_OF(keycodes)) >= chars + 1);
+
+    printf(
+        "{\"bench\":\"typing\",\"transport\":\"%s\",\"layout\":\"%s\",\"payload\":\"%s\","
+        "\"chars\":%zu,\"reports\":%zu,\"refused\":%lu,\"reports_per_char\":%.2f,"
+        "\"chars_per_s\":%.0f,\"ms\":%.1f,\"cpu_us\":%llu}\n",
+        transport == FlipperWedgeHidTransportUsb ? "usb" : "ble",
+        layout_name,
+        payload->name,
+        chars,
+        reports,
+        (unsigned long)refused,
+        (double)reports / chars,
+        elapsed_us ? chars * 1e6 / elapsed_us : 0.0,
+        elapsed_us / 1000.0,
+        (unsigned long long)cpu_us);
+
+    if(transport == FlipperWedgeHidTransportUsb) {
+        flipper_wedge_hid_deinit_usb(hid);
+    } else {
+        flipper_wedge_hid_deinit_ble(hid);
+    }
+    flipper_wedge_hid_free(hid);
+}
+
+int main(void) {
+    stub_clock_set_virtual(true);
+    char root[] = "/tmp/flipper_wedge_bench_XXXXXX";
+    furi_check(mkdtemp(root));
+    stub_storage_set_root(root);
+
+    for(size_t i = 0; i < COUNT_OF(ndef_lengths); i++) {
+        fill_ndef(payloads[2 + i].text, ndef_lengths[i], 0x5EED + i);
+    }
+
+    FlipperWedgeKeyboardLayout* layouts[3];
+    const char* layout_names[3] = {"default", "numpad", "custom"};
+    for(size_t i = 0; i < COUNT_OF(layouts); i++) {
+        layouts[i] = flipper_wedge_keyboard_layout_alloc();
+    }
+    flipper_wedge_keyboard_layout_set_numpad(layouts[1]);
+    furi_check(install_custom_layout());
+    furi_check(flipper_wedge_keyboard_layout_load(layouts[2], CUSTOM_LAYOUT_PATH));
+
+    for(FlipperWedgeHidTransport transport = 0; transport < FlipperWedgeHidTransportCount; transport++) {
+        for(size_t l = 0; l < COUNT_OF(layouts); l++) {
+            for(size_t p = 0; p < COUNT_OF(payloads); p++) {
+                bench_one(transport, layout_names[l], layouts[l], &payloads[p]);
+            }
+        }
+    }
+
+    for(size_t i = 0; i < COUNT_OF(layouts); i++) {
+        flipper_wedge_keyboard_layout_free(layouts[i]);
+    }
+    return 0;
+}
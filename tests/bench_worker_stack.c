@@ -0,0 +1,173 @@
+// Stack high-water mark of the HID worker thread over real typing jobs:
+// 1000 characters of ASCII, Linux and Windows Unicode, on USB, BLE and
+// both, and a full USB Bulk message. One JSON object per line.
+//
+// The stub paints the worker's stack before it starts, "used" is what the
+// run left unpainted. An idle thread that returns at once gives the host's
+// fixed cost (C library and TLS setup), "delta" is the worker's own use.
+//
+// On the Flipper, file access runs on the storage service's thread. Here it
+// is host stdio on the caller's stack, so every case runs twice: with
+// "storage":"none" every file open fails at once, which leaves the worker's
+// own frames, and with "storage":"host" the pacing profile is really loaded
+// and saved, an upper bound. Host frames are x86-64, not Cortex-M4, and the
+// BLE profile start is a stub, so compare runs and keep a margin. The stub
+// log drops messages before formatting them (unless TEST_VERBOSE is set),
+// so log formatting isn't in the numbers either.
+//
+// A first pass over every case is thrown away: the dynamic linker resolves
+// each C library symbol on its first call, on whichever stack calls it.
+
+#include "test.h"
+#include "flipper_wedge_hid_worker.h"
+
+#define TEXT_CHARS 1000
+
+typedef struct {
+    const char* name;
+    FlipperWedgeUnicodeMode unicode_mode;
+    const char* piece; // Repeated TEXT_CHARS times
+} StackJob;
+
+static const StackJob jobs[] = {
+    {"ascii_1000", FlipperWedgeUnicodeOff, "a"},
+    {"linux_unicode_1000", FlipperWedgeUnicodeLinux, "\xE2\x82\xAC"},
+    {"windows_unicode_1000", FlipperWedgeUnicodeWindows, "\xF0\x9F\x98\x80"},
+};
+
+static const struct {
+    const char* name;
+    FlipperWedgeHidWorkerMode mode;
+} modes[] = {
+    {"usb", FlipperWedgeHidWorkerModeUsb},
+    {"ble", FlipperWedgeHidWorkerModeBle},
+    {"usb_ble", FlipperWedgeHidWorkerModeUsbBle},
+};
+
+static int32_t idle_thread(void* context) {
+    UNUSED(context);
+    return 0;
+}
+
+static size_t baseline_stack_used(void) {
+    FuriThread* thread = furi_thread_alloc_ex("Idle", 3 * 1024, idle_thread, NULL);
+    furi_thread_start(thread);
+    furi_thread_join(thread);
+    size_t used = stub_thread_get_stack_used(thread);
+    furi_thread_free(thread);
+    return used;
+}
+
+static bool wait_idle(FlipperWedgeHidWorker* worker) {
+    for(uint32_t ms = 0; ms < 120000; ms++) {
+        if(!flipper_wedge_hid_worker_is_busy(worker)) return true;
+        furi_delay_ms(1);
+    }
+    return false;
+}
+
+static const char* storage_name;
+static bool warm_up;
+
+static void print_result(const char* mode, const char* job, size_t used, size_t baseline, uint64_t us) {
+    if(warm_up) return;
+    printf(
+        "{\"bench\":\"worker_stack\",\"storage\":\"%s\",\"mode\":\"%s\",\"job\":\"%s\","
+        "\"stack_used\":%zu,\"baseline\":%zu,\"delta\":%zu,\"ms\":%llu}\n",
+        storage_name,
+        mode,
+        job,
+        used,
+        baseline,
+        used - baseline,
+        (unsigned long long)(us / 1000));
+}
+
+static void bench_typing(size_t baseline) {
+    static char text[TEXT_CHARS * 4 + 1];
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+
+    for(size_t m = 0; m < COUNT_OF(modes); m++) {
+        for(size_t j = 0; j < COUNT_OF(jobs); j++) {
+            size_t piece = strlen(jobs[j].piece);
+            for(size_t i = 0; i < TEXT_CHARS; i++) {
+                memcpy(text + i * piece, jobs[j].piece, piece);
+            }
+            text[TEXT_CHARS * piece] = '\0';
+            flipper_wedge_keyboard_layout_set_unicode_mode(layout, jobs[j].unicode_mode);
+
+            stub_hid_reset();
+            FlipperWedgeHidWorker* worker = flipper_wedge_hid_worker_alloc();
+            flipper_wedge_hid_worker_start(worker, modes[m].mode);
+            FuriThread* thread = stub_thread_get_last_started();
+            if(modes[m].mode != FlipperWedgeHidWorkerModeUsb) {
+                // The status callback is only set once the worker brought BLE up
+                FlipperWedgeHid* hid = flipper_wedge_hid_worker_get_hid(worker);
+                while(!flipper_wedge_hid_is_bt_connected(hid)) {
+                    furi_delay_ms(1);
+                    stub_hid_set_connected(StubHidBle, true);
+                }
+            }
+
+            uint64_t start = stub_clock_now_us();
+            furi_check(flipper_wedge_hid_worker_type(worker, layout, text, true));
+            furi_check(wait_idle(worker));
+            uint64_t elapsed = stub_clock_now_us() - start;
+            print_result(modes[m].name, jobs[j].name, stub_thread_get_stack_used(thread), baseline, elapsed);
+
+            flipper_wedge_hid_worker_free(worker);
+        }
+    }
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+static void bench_bulk(size_t baseline) {
+    static char text[FLIPPER_WEDGE_HID_WORKER_JOB_MAX_LEN];
+    static char ndef[1023];
+    static const uint8_t uid[10] = {0x04};
+    static const uint8_t request[] = {'F', 'W', 'R', FLIPPER_WEDGE_BULK_VERSION};
+    memset(text, 'a', sizeof(text));
+    memset(ndef, 'b', sizeof(ndef));
+    const FlipperWedgeBulkField fields[] = {
+        {FlipperWedgeBulkFieldText, (const uint8_t*)text, sizeof(text) - 1},
+        {FlipperWedgeBulkFieldNfcUid, uid, sizeof(uid)},
+        {FlipperWedgeBulkFieldNdefText, (const uint8_t*)ndef, sizeof(ndef)},
+    };
+
+    stub_hid_reset();
+    FlipperWedgeHidWorker* worker = flipper_wedge_hid_worker_alloc();
+    flipper_wedge_hid_worker_start(worker, FlipperWedgeHidWorkerModeUsbBulk);
+    FuriThread* thread = stub_thread_get_last_started();
+
+    uint64_t start = stub_clock_now_us();
+    furi_check(flipper_wedge_hid_worker_send_bulk(worker, fields, COUNT_OF(fields)));
+    stub_bulk_host_request(request, sizeof(request));
+    furi_check(wait_idle(worker));
+    uint64_t elapsed = stub_clock_now_us() - start;
+    print_result("usb_bulk", "scan_2300", stub_thread_get_stack_used(thread), baseline, elapsed);
+
+    flipper_wedge_hid_worker_free(worker);
+}
+
+int main(void) {
+    stub_clock_set_virtual(false);
+    size_t baseline = baseline_stack_used();
+    stub_storage_set_root("/nonexistent/flipper_wedge_bench");
+
+    warm_up = true;
+    bench_typing(baseline);
+    bench_bulk(baseline);
+    warm_up = false;
+
+    storage_name = "none";
+    bench_typing(baseline);
+    bench_bulk(baseline);
+
+    storage_name = "host";
+    char root[] = "/tmp/flipper_wedge_bench_XXXXXX";
+    furi_check(mkdtemp(root));
+    stub_storage_set_root(root);
+    bench_typing(baseline);
+
+    return 0;
+}
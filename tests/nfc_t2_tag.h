@@ -0,0 +1,165 @@
+#pragma once
+
+// Simulated Type 2 tag for test_nfc_t2 and bench_nfc_t2: answers READ and
+// FAST_READ from its page memory, NAKs anything else and stays silent after
+// a NAK until reactivated, like NTAG and Ultralight tags do.
+
+#include "test.h"
+#include "flipper_wedge_ndef.h"
+#include "flipper_wedge_nfc_t2.h"
+
+#define T2_TAG_PAGES_MAX 256
+
+typedef struct {
+    const char* name;
+    uint16_t pages; // Total pages, CC and lock pages included
+    uint16_t data_size; // Data area size in the CC
+    bool fast_read;
+} T2TagModel;
+
+static const T2TagModel t2_tag_ntag213 = {"ntag213", 45, 144, true};
+static const T2TagModel t2_tag_ntag215 = {"ntag215", 135, 496, true};
+static const T2TagModel t2_tag_ntag216 = {"ntag216", 231, 872, true};
+static const T2TagModel t2_tag_ultralight = {"ultralight", 16, 48, false};
+static const T2TagModel t2_tag_ultralight_c = {"ultralight_c", 48, 144, false};
+
+typedef struct {
+    uint8_t memory[T2_TAG_PAGES_MAX * 4];
+    uint16_t pages;
+    bool fast_read;
+    bool halted; // NAKed, silent until reactivated
+    size_t max_chars; // Reader's NDEF Max Length, for t2_tag_complete()
+
+    size_t exchanges;
+    size_t naks;
+    size_t reactivations;
+    size_t tx_bytes; // CRC included
+    size_t rx_bytes;
+    uint16_t page_last; // Highest page returned
+} T2Tag;
+
+static bool t2_tag_transceive(
+    const uint8_t* command,
+    size_t command_len,
+    uint8_t* response,
+    size_t response_size,
+    size_t* response_len,
+    void* context) {
+    T2Tag* tag = context;
+    tag->exchanges++;
+    tag->tx_bytes += command_len + 2;
+    *response_len = 0;
+    if(tag->halted) return false;
+    furi_check(command_len <= FLIPPER_WEDGE_NFC_T2_COMMAND_MAX);
+
+    if(command_len == 2 && command[0] == 0x30 && command[1] < tag->pages) {
+        // READ rolls over at the end of memory
+        for(size_t i = 0; i < 16; i++) {
+            response[i] = tag->memory[(command[1] * 4 + i) % (tag->pages * 4)];
+        }
+        *response_len = 16;
+        tag->page_last = MAX(tag->page_last, (command[1] + 3) % tag->pages);
+    } else if(
+        command_len == 3 && command[0] == 0x3A && tag->fast_read && command[1] <= command[2] &&
+        command[2] < tag->pages) {
+        size_t len = (command[2] - command[1] + 1) * 4;
+        furi_check(len <= response_size);
+        memcpy(response, &tag->memory[command[1] * 4], len);
+        *response_len = len;
+        tag->page_last = MAX(tag->page_last, command[2]);
+    } else {
+        tag->naks++;
+        tag->rx_bytes++; // 4-bit NAK
+        tag->halted = true;
+        return false;
+    }
+    tag->rx_bytes += *response_len + 2;
+    return true;
+}
+
+static bool t2_tag_reactivate(void* context) {
+    T2Tag* tag = context;
+    tag->reactivations++;
+    tag->halted = false;
+    return true;
+}
+
+// The reader's check for text records, one context for every callback
+static bool t2_tag_complete(const uint8_t* message, size_t len, void* context) {
+    T2Tag* tag = context;
+    FlipperWedgeNdefIterator it;
+    flipper_wedge_ndef_iter_init(&it, message, len);
+    return flipper_wedge_ndef_select_complete(&it, FlipperWedgeNdefSelectText, NULL, tag->max_chars);
+}
+
+// Blank formatted tag: UID pages, CC, empty data area
+static void t2_tag_init(T2Tag* tag, const T2TagModel* model) {
+    memset(tag, 0, sizeof(T2Tag));
+    furi_check(model->pages <= T2_TAG_PAGES_MAX);
+    tag->pages = model->pages;
+    tag->fast_read = model->fast_read;
+    const uint8_t cc[] = {0xE1, 0x10, model->data_size / 8, 0x00};
+    memcpy(&tag->memory[12], cc, sizeof(cc));
+    tag->memory[16] = 0x03;
+    tag->memory[17] = 0x00;
+    tag->memory[18] = 0xFE;
+}
+
+static void t2_tag_reset_counters(T2Tag* tag) {
+    tag->halted = false;
+    tag->exchanges = 0;
+    tag->naks = 0;
+    tag->reactivations = 0;
+    tag->tx_bytes = 0;
+    tag->rx_bytes = 0;
+    tag->page_last = 0;
+}
+
+static uint8_t* t2_tag_data(T2Tag* tag) {
+    return &tag->memory[16];
+}
+
+// Writes an NDEF TLV holding one text record of chars characters at data
+// offset at, after a lock control TLV if asked, then a terminator. Returns
+// the data bytes used.
+static size_t t2_tag_put_text(T2Tag* tag, size_t at, size_t chars, bool lock_control) {
+    uint8_t* data = t2_tag_data(tag) + at;
+    size_t n = 0;
+    if(lock_control) {
+        const uint8_t lock[] = {0x01, 0x03, 0xA0, 0x10, 0x44};
+        memcpy(&data[n], lock, sizeof(lock));
+        n += sizeof(lock);
+    }
+
+    size_t payload_len = chars + 3;
+    bool short_record = payload_len <= 0xFF;
+    size_t record_len = (short_record ? 4 : 7) + payload_len;
+    data[n++] = 0x03;
+    if(record_len < 0xFF) {
+        data[n++] = record_len;
+    } else {
+        data[n++] = 0xFF;
+        data[n++] = record_len >> 8;
+        data[n++] = record_len & 0xFF;
+    }
+    data[n++] = short_record ? 0xD1 : 0xC1;
+    data[n++] = 1;
+    if(short_record) {
+        data[n++] = payload_len;
+    } else {
+        data[n++] = 0;
+        data[n++] = 0;
+        data[n++] = payload_len >> 8;
+        data[n++] = payload_len & 0xFF;
+    }
+    data[n++] = 'T';
+    data[n++] = 0x02;
+    data[n++] = 'e';
+    data[n++] = 'n';
+    for(size_t i = 0; i < chars; i++) {
+        data[n++] = 'a' + i % 26;
+    }
+    data[n++] = 0xFE;
+    furi_check(16 + at + n <= (size_t)tag->pages * 4);
+    return n;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <furi.h>
+
+// The parts of the ST BLE stack interface the helpers use
+
+typedef uint8_t tBleStatus;
+#define BLE_STATUS_SUCCESS 0x00
+#define BLE_STATUS_FAILED 0x41
+
+#define HCI_LE_META_EVT_CODE 0x3E
+#define HCI_LE_CONNECTION_COMPLETE_SUBEVT_CODE 0x01
+#define HCI_LE_ENHANCED_CONNECTION_COMPLETE_SUBEVT_CODE 0x0A
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;
+    uint8_t data[1];
+} hci_uart_pckt;
+
+typedef struct __attribute__((packed)) {
+    uint8_t evt;
+    uint8_t plen;
+    uint8_t data[1];
+} hci_event_pckt;
+
+typedef struct __attribute__((packed)) {
+    uint8_t subevent;
+    uint8_t data[1];
+} evt_le_meta_event;
+
+typedef struct __attribute__((packed)) {
+    uint8_t Status;
+    uint16_t Connection_Handle;
+    uint8_t Role;
+    uint8_t Peer_Address_Type;
+    uint8_t Peer_Address[6];
+    uint16_t Conn_Interval;
+    uint16_t Conn_Latency;
+    uint16_t Supervision_Timeout;
+    uint8_t Master_Clock_Accuracy;
+} hci_le_connection_complete_event_rp0;
+
+typedef struct __attribute__((packed)) {
+    uint8_t Status;
+    uint16_t Connection_Handle;
+    uint8_t Role;
+    uint8_t Peer_Address_Type;
+    uint8_t Peer_Address[6];
+    uint8_t Local_Resolvable_Private_Address[6];
+    uint8_t Peer_Resolvable_Private_Address[6];
+    uint16_t Conn_Interval;
+    uint16_t Conn_Latency;
+    uint16_t Supervision_Timeout;
+    uint8_t Master_Clock_Accuracy;
+} hci_le_enhanced_connection_complete_event_rp0;
+
+tBleStatus aci_gap_resolve_private_addr(const uint8_t Address[6], uint8_t Actual_Address[6]);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <furi.h>
+
+#define RECORD_BT "bt"
+
+typedef struct Bt Bt;
+typedef struct FuriHalBleProfileBase FuriHalBleProfileBase;
+typedef struct FuriHalBleProfileTemplate FuriHalBleProfileTemplate;
+
+typedef enum {
+    BtStatusUnavailable,
+    BtStatusOff,
+    BtStatusAdvertising,
+    BtStatusConnected,
+} BtStatus;
+
+typedef void (*BtStatusChangedCallback)(BtStatus status, void* context);
+
+void bt_disconnect(Bt* bt);
+void bt_keys_storage_set_storage_path(Bt* bt, const char* keys_storage_path);
+void bt_keys_storage_set_default_path(Bt* bt);
+FuriHalBleProfileBase*
+    bt_profile_start(Bt* bt, const FuriHalBleProfileTemplate* profile_template, void* params);
+bool bt_profile_restore_default(Bt* bt);
+void bt_set_status_changed_callback(Bt* bt, BtStatusChangedCallback callback, void* context);
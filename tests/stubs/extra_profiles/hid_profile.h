@@ -0,0 +1,14 @@
+#pragma once
+
+#include <bt/bt_service/bt.h>
+
+typedef struct {
+    const char* device_name_prefix;
+    uint16_t mac_xor;
+} BleProfileHidParams;
+
+extern const FuriHalBleProfileTemplate* ble_profile_hid;
+
+bool ble_profile_hid_kb_press(FuriHalBleProfileBase* profile, uint16_t button);
+bool ble_profile_hid_kb_release(FuriHalBleProfileBase* profile, uint16_t button);
+bool ble_profile_hid_kb_release_all(FuriHalBleProfileBase* profile);
@@ -0,0 +1,3 @@
+#pragma once
+
+#include <flipper_format/flipper_format.h>
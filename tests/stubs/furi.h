@@ -0,0 +1,122 @@
+#pragma once
+
+// Host stand-in for the parts of furi.h the helpers use. Threads, flags and
+// mutexes run on pthreads, the tick is 1 ms and follows the stub clock
+// (see stub.h).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// Aborts, like furi_crash() the firmware's checks end in
+void stub_check_failed(const char* expression, const char* file, int line)
+    __attribute__((noreturn));
+void stub_log(char level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define furi_assert(x) ((x) ? (void)0 : stub_check_failed(#x, __FILE__, __LINE__))
+#define furi_check(x) ((x) ? (void)0 : stub_check_failed(#x, __FILE__, __LINE__))
+
+#define FURI_LOG_E(tag, ...) stub_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) stub_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) stub_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) stub_log('D', tag, __VA_ARGS__)
+#define FURI_LOG_T(tag, ...) stub_log('T', tag, __VA_ARGS__)
+
+#define UNUSED(x) (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#ifndef CLAMP
+#define CLAMP(x, upper, lower) (MIN(upper, MAX(x, lower)))
+#endif
+
+#define EXT_PATH(path) "/ext/" path
+#define APP_DATA_PATH(path) "/ext/apps_data/flipper_wedge/" path
+
+size_t strlcpy(char* dst, const char* src, size_t size);
+
+// Kernel
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriFlagWaitAny = 0,
+    FuriFlagWaitAll = 1,
+    FuriFlagNoClear = 2,
+    FuriFlagError = 0x80000000U,
+    FuriFlagErrorTimeout = 0xFFFFFFFEU,
+} FuriFlag;
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+} FuriStatus;
+
+uint32_t furi_get_tick(void);
+uint32_t furi_kernel_get_tick_frequency(void);
+uint32_t furi_ms_to_ticks(uint32_t ms);
+void furi_delay_tick(uint32_t ticks);
+void furi_delay_ms(uint32_t ms);
+void furi_delay_us(uint32_t us);
+
+// Threads
+typedef struct FuriThread FuriThread;
+typedef void* FuriThreadId;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadId furi_thread_get_id(FuriThread* thread);
+FuriThreadId furi_thread_get_current_id(void);
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id);
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_clear(uint32_t flags);
+uint32_t furi_thread_flags_get(void);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+// Mutex
+typedef struct FuriMutex FuriMutex;
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+// Records, all share one dummy instance
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+// Strings
+typedef struct FuriString FuriString;
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_set_str(const char* cstr);
+void furi_string_free(FuriString* string);
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_set_str(FuriString* string, const char* cstr);
+void furi_string_set(FuriString* string, FuriString* source);
+void furi_string_cat_str(FuriString* string, const char* cstr);
+void furi_string_push_back(FuriString* string, char c);
+int furi_string_cmp_str(const FuriString* string, const char* cstr);
+int furi_string_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
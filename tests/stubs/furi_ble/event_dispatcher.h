@@ -0,0 +1,16 @@
+#pragma once
+
+#include <furi.h>
+
+typedef enum {
+    BleEventNotAck,
+    BleEventAckFlowEnable,
+    BleEventAckFlowDisable,
+} BleEventAckStatus;
+
+typedef BleEventAckStatus (*BleSvcEventHandlerCb)(void* event, void* context);
+
+typedef struct GapSvcEventHandler GapSvcEventHandler;
+
+GapSvcEventHandler* ble_event_dispatcher_register_svc_handler(BleSvcEventHandlerCb handler, void* context);
+void ble_event_dispatcher_unregister_svc_handler(GapSvcEventHandler* handler);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <furi.h>
+
+void furi_hal_bt_start_advertising(void);
+
+// Cycle counter running at 64 MHz off the stub clock
+typedef struct {
+    volatile uint32_t CYCCNT;
+} StubDwt;
+
+StubDwt* stub_dwt(void);
+#define DWT (stub_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct FuriHalUsbInterface FuriHalUsbInterface;
+
+extern FuriHalUsbInterface usb_hid;
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void);
+bool furi_hal_usb_set_config(FuriHalUsbInterface* config, void* context);
+void furi_hal_usb_unlock(void);
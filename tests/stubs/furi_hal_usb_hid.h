@@ -0,0 +1,29 @@
+#pragma once
+
+#include <furi.h>
+
+#define HID_KEYBOARD_NONE 0x00
+#define HID_KEYBOARD_A 0x04
+#define HID_KEYBOARD_RETURN 0x28
+#define HID_KEYBOARD_ESCAPE 0x29
+#define HID_KEYBOARD_DELETE 0x2A
+#define HID_KEYBOARD_TAB 0x2B
+#define HID_KEYBOARD_SPACEBAR 0x2C
+
+#define KEY_MOD_LEFT_CTRL 0x0100
+#define KEY_MOD_LEFT_SHIFT 0x0200
+#define KEY_MOD_LEFT_ALT 0x0400
+#define KEY_MOD_LEFT_GUI 0x0800
+#define KEY_MOD_RIGHT_CTRL 0x1000
+#define KEY_MOD_RIGHT_SHIFT 0x2000
+#define KEY_MOD_RIGHT_ALT 0x4000
+#define KEY_MOD_RIGHT_GUI 0x8000
+
+// US QWERTY map of the firmware, ASCII to keycode with modifiers
+extern const uint16_t hid_asciimap[];
+#define HID_ASCII_TO_KEY(x) (((uint8_t)x < 128) ? (hid_asciimap[(uint8_t)x]) : HID_KEYBOARD_NONE)
+
+bool furi_hal_hid_is_connected(void);
+bool furi_hal_hid_kb_press(uint16_t button);
+bool furi_hal_hid_kb_release(uint16_t button);
+bool furi_hal_hid_kb_release_all(void);
@@ -0,0 +1,417 @@
+// Host implementation of the furi core: clock, threads, flags, mutexes,
+// strings and logging
+
+#include "stub.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include <errno.h>
+
+#define STUB_STACK_PAINT 0xA5
+// Host C library calls need far more stack than the Cortex-M4 ones
+#define STUB_STACK_MIN (256 * 1024)
+
+// Clock
+
+static bool clock_virtual = false;
+static uint64_t clock_virtual_us = 0;
+static uint64_t clock_real_start_us = 0;
+
+static uint64_t clock_real_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void stub_clock_set_virtual(bool enabled) {
+    clock_virtual = enabled;
+    clock_virtual_us = 0;
+    clock_real_start_us = clock_real_us();
+}
+
+uint64_t stub_clock_now_us(void) {
+    if(clock_virtual) return __atomic_load_n(&clock_virtual_us, __ATOMIC_RELAXED);
+    if(clock_real_start_us == 0) clock_real_start_us = clock_real_us();
+    return clock_real_us() - clock_real_start_us;
+}
+
+void stub_clock_advance_us(uint64_t us) {
+    if(clock_virtual) {
+        __atomic_add_fetch(&clock_virtual_us, us, __ATOMIC_RELAXED);
+        return;
+    }
+    struct timespec ts = {.tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000};
+    while(nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+uint32_t furi_get_tick(void) {
+    return (uint32_t)(stub_clock_now_us() / 1000);
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t ms) {
+    return ms;
+}
+
+void furi_delay_tick(uint32_t ticks) {
+    stub_clock_advance_us((uint64_t)ticks * 1000);
+}
+
+void furi_delay_ms(uint32_t ms) {
+    stub_clock_advance_us((uint64_t)ms * 1000);
+}
+
+void furi_delay_us(uint32_t us) {
+    stub_clock_advance_us(us);
+}
+
+// Checks and logs
+
+static int log_verbose = -1;
+
+void stub_check_failed(const char* expression, const char* file, int line) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    abort();
+}
+
+void stub_log_set_verbose(bool verbose) {
+    log_verbose = verbose;
+}
+
+void stub_log(char level, const char* tag, const char* format, ...) {
+    if(log_verbose < 0) log_verbose = getenv("TEST_VERBOSE") != NULL;
+    if(!log_verbose) return;
+
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%llu [%c][%s] ", (unsigned long long)stub_clock_now_us() / 1000, level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if(size) {
+        size_t copy = len < size ? len : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return len;
+}
+
+// Threads and flags
+
+struct FuriThread {
+    pthread_t pthread;
+    bool started;
+    uint32_t stack_size;
+    uint8_t* stack;
+    size_t stack_alloc;
+    FuriThreadCallback callback;
+    void* context;
+    int32_t result;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t flags;
+};
+
+static FuriThread main_thread = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+static __thread FuriThread* current_thread = NULL;
+static FuriThread* last_started = NULL;
+
+static FuriThread* thread_current(void) {
+    return current_thread ? current_thread : &main_thread;
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    thread->stack_size = stack_size;
+    thread->callback = callback;
+    thread->context = context;
+    pthread_mutex_init(&thread->lock, NULL);
+    pthread_cond_init(&thread->cond, NULL);
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    furi_check(thread);
+    furi_check(!thread->started);
+    if(last_started == thread) last_started = NULL;
+    pthread_mutex_destroy(&thread->lock);
+    pthread_cond_destroy(&thread->cond);
+    free(thread->stack);
+    free(thread);
+}
+
+static void* thread_body(void* arg) {
+    FuriThread* thread = arg;
+    current_thread = thread;
+    thread->result = thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_check(thread);
+    furi_check(!thread->started);
+
+    // Own stack, painted so the high-water mark can be read back
+    thread->stack_alloc = MAX((size_t)thread->stack_size, (size_t)STUB_STACK_MIN);
+    free(thread->stack);
+    thread->stack = aligned_alloc(4096, thread->stack_alloc);
+    memset(thread->stack, STUB_STACK_PAINT, thread->stack_alloc);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, thread->stack, thread->stack_alloc);
+    thread->flags = 0;
+    thread->started = true;
+    last_started = thread;
+    furi_check(pthread_create(&thread->pthread, &attr, thread_body, thread) == 0);
+    pthread_attr_destroy(&attr);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    furi_check(thread);
+    if(!thread->started) return true;
+    pthread_join(thread->pthread, NULL);
+    thread->started = false;
+    return true;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return thread;
+}
+
+FuriThreadId furi_thread_get_current_id(void) {
+    return thread_current();
+}
+
+FuriThread* stub_thread_get_last_started(void) {
+    return last_started;
+}
+
+size_t stub_thread_get_stack_used(FuriThread* thread) {
+    furi_check(thread && thread->stack);
+    // Stacks grow down, the paint survives from the low end up
+    size_t untouched = 0;
+    while(untouched < thread->stack_alloc && thread->stack[untouched] == STUB_STACK_PAINT) {
+        untouched++;
+    }
+    return thread->stack_alloc - untouched;
+}
+
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id) {
+    FuriThread* thread = thread_id;
+    if(!thread || !thread->stack) return 0;
+    size_t used = stub_thread_get_stack_used(thread);
+    return used < thread->stack_size ? thread->stack_size - used : 0;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    FuriThread* thread = thread_id;
+    pthread_mutex_lock(&thread->lock);
+    thread->flags |= flags;
+    uint32_t result = thread->flags;
+    pthread_cond_broadcast(&thread->cond);
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t furi_thread_flags_clear(uint32_t flags) {
+    FuriThread* thread = thread_current();
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result = thread->flags;
+    thread->flags &= ~flags;
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t furi_thread_flags_get(void) {
+    FuriThread* thread = thread_current();
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result = thread->flags;
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    FuriThread* thread = thread_current();
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    if(timeout != FuriWaitForever) {
+        uint64_t ns = deadline.tv_nsec + (uint64_t)timeout * 1000000;
+        deadline.tv_sec += ns / 1000000000;
+        deadline.tv_nsec = ns % 1000000000;
+    }
+
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result;
+    while(true) {
+        uint32_t pending = thread->flags & flags;
+        bool done = (options & FuriFlagWaitAll) ? pending == flags : pending != 0;
+        if(done) {
+            result = thread->flags;
+            if(!(options & FuriFlagNoClear)) thread->flags &= ~flags;
+            break;
+        }
+        if(timeout == 0) {
+            result = FuriFlagErrorTimeout;
+            break;
+        }
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&thread->cond, &thread->lock);
+        } else if(pthread_cond_timedwait(&thread->cond, &thread->lock, &deadline) == ETIMEDOUT) {
+            result = FuriFlagErrorTimeout;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+// Mutex
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if(type == FuriMutexTypeRecursive) {
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    }
+    pthread_mutex_init(&mutex->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    if(timeout == FuriWaitForever) {
+        return pthread_mutex_lock(&mutex->mutex) == 0 ? FuriStatusOk : FuriStatusError;
+    }
+    return pthread_mutex_trylock(&mutex->mutex) == 0 ? FuriStatusOk : FuriStatusErrorTimeout;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    return pthread_mutex_unlock(&mutex->mutex) == 0 ? FuriStatusOk : FuriStatusError;
+}
+
+// Records
+
+static int record_dummy;
+
+void* furi_record_open(const char* name) {
+    UNUSED(name);
+    return &record_dummy;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+// Strings
+
+struct FuriString {
+    char* data;
+    size_t len;
+    size_t capacity;
+};
+
+static void string_reserve(FuriString* string, size_t len) {
+    if(len + 1 <= string->capacity) return;
+    string->capacity = MAX(len + 1, string->capacity * 2);
+    string->data = realloc(string->data, string->capacity);
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = calloc(1, sizeof(FuriString));
+    string_reserve(string, 15);
+    string->data[0] = '\0';
+    return string;
+}
+
+FuriString* furi_string_alloc_set_str(const char* cstr) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set_str(string, cstr);
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->len;
+}
+
+void furi_string_reset(FuriString* string) {
+    string->len = 0;
+    string->data[0] = '\0';
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    furi_string_reset(string);
+    furi_string_cat_str(string, cstr);
+}
+
+void furi_string_set(FuriString* string, FuriString* source) {
+    furi_string_set_str(string, source->data);
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr) {
+    size_t len = strlen(cstr);
+    string_reserve(string, string->len + len);
+    memcpy(string->data + string->len, cstr, len + 1);
+    string->len += len;
+}
+
+void furi_string_push_back(FuriString* string, char c) {
+    string_reserve(string, string->len + 1);
+    string->data[string->len++] = c;
+    string->data[string->len] = '\0';
+}
+
+int furi_string_cmp_str(const FuriString* string, const char* cstr) {
+    return strcmp(string->data, cstr);
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if(len < 0) return len;
+
+    string_reserve(string, len);
+    va_start(args, format);
+    vsnprintf(string->data, len + 1, format, args);
+    va_end(args);
+    string->len = len;
+    return len;
+}
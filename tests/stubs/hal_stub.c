@@ -0,0 +1,434 @@
+// Host HID sinks standing in for the USB and BLE keyboards. Every submit call
+// updates the boot report like the firmware does and, if the sink takes it,
+// records the report the host receives with a timestamp.
+
+#include "stub.h"
+#include <furi_hal.h>
+#include <furi_hal_usb.h>
+#include <furi_hal_usb_hid.h>
+#include <flipper_wedge_usb_bulk.h>
+#include <bt/bt_service/bt.h>
+#include <extra_profiles/hid_profile.h>
+#include <ble/ble.h>
+#include <furi_ble/event_dispatcher.h>
+#include <pthread.h>
+
+const uint16_t hid_asciimap[128] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x002A, 0x002B, 0x0028, 0x0000, 0x0000, 0x0028, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0029, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x002C, 0x021E, 0x0234, 0x0220, 0x0221, 0x0222, 0x0224, 0x0034,
+    0x0226, 0x0227, 0x0225, 0x022E, 0x0036, 0x002D, 0x0037, 0x0038,
+    0x0027, 0x001E, 0x001F, 0x0020, 0x0021, 0x0022, 0x0023, 0x0024,
+    0x0025, 0x0026, 0x0233, 0x0033, 0x0236, 0x002E, 0x0237, 0x0238,
+    0x021F, 0x0204, 0x0205, 0x0206, 0x0207, 0x0208, 0x0209, 0x020A,
+    0x020B, 0x020C, 0x020D, 0x020E, 0x020F, 0x0210, 0x0211, 0x0212,
+    0x0213, 0x0214, 0x0215, 0x0216, 0x0217, 0x0218, 0x0219, 0x021A,
+    0x021B, 0x021C, 0x021D, 0x002F, 0x0031, 0x0030, 0x0223, 0x022D,
+    0x0035, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009, 0x000A,
+    0x000B, 0x000C, 0x000D, 0x000E, 0x000F, 0x0010, 0x0011, 0x0012,
+    0x0013, 0x0014, 0x0015, 0x0016, 0x0017, 0x0018, 0x0019, 0x001A,
+    0x001B, 0x001C, 0x001D, 0x022F, 0x0231, 0x0230, 0x0235, 0x0000,
+};
+
+typedef struct {
+    bool connected;
+    StubHidAcceptCallback accept;
+    void* accept_context;
+    uint32_t poll_interval_us;
+    uint32_t call_us;
+    uint64_t next_poll_us;
+
+    StubHidReport state;
+    StubHidReport* reports;
+    size_t count;
+    size_t capacity;
+    uint32_t refused;
+} StubHidSink;
+
+static StubHidSink sinks[StubHidCount] = {
+    [StubHidUsb] = {.connected = true},
+    [StubHidBle] = {.connected = true},
+};
+static pthread_mutex_t sinks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// USB bulk interface, reset along with the sinks
+static FlipperWedgeUsbBulkCallback bulk_callback;
+static void* bulk_context;
+static uint8_t bulk_request[FLIPPER_WEDGE_USB_BULK_PACKET_LEN];
+static size_t bulk_request_len;
+static uint8_t* bulk_sent;
+static size_t bulk_sent_len;
+static size_t bulk_send_limit = SIZE_MAX;
+
+// BLE bonds, reset along with the sinks
+#define STUB_BLE_BONDS_MAX 8
+static struct {
+    uint8_t private_address[6];
+    uint8_t identity[6];
+} ble_bonds[STUB_BLE_BONDS_MAX];
+static size_t ble_bonds_count;
+
+void stub_hid_reset(void) {
+    pthread_mutex_lock(&sinks_lock);
+    for(StubHid sink = 0; sink < StubHidCount; sink++) {
+        free(sinks[sink].reports);
+        memset(&sinks[sink], 0, sizeof(StubHidSink));
+        sinks[sink].connected = true;
+    }
+    free(bulk_sent);
+    bulk_sent = NULL;
+    bulk_sent_len = 0;
+    bulk_send_limit = SIZE_MAX;
+    ble_bonds_count = 0;
+    pthread_mutex_unlock(&sinks_lock);
+}
+
+void stub_hid_set_accept(StubHid sink, StubHidAcceptCallback callback, void* context) {
+    sinks[sink].accept = callback;
+    sinks[sink].accept_context = context;
+}
+
+void stub_hid_set_poll_interval(StubHid sink, uint32_t interval_us) {
+    sinks[sink].poll_interval_us = interval_us;
+    sinks[sink].next_poll_us = 0;
+}
+
+void stub_hid_set_call_us(StubHid sink, uint32_t us) {
+    sinks[sink].call_us = us;
+}
+
+const StubHidReport* stub_hid_get_reports(StubHid sink, size_t* count) {
+    *count = sinks[sink].count;
+    return sinks[sink].reports;
+}
+
+uint32_t stub_hid_get_refused(StubHid sink) {
+    return sinks[sink].refused;
+}
+
+static bool sink_submit(StubHid id) {
+    StubHidSink* sink = &sinks[id];
+    if(sink->call_us) stub_clock_advance_us(sink->call_us);
+
+    // The endpoint holds one report, the call waits for the host to take the last one
+    if(sink->poll_interval_us) {
+        uint64_t now = stub_clock_now_us();
+        if(now < sink->next_poll_us) {
+            stub_clock_advance_us(sink->next_poll_us - now);
+            now = sink->next_poll_us;
+        }
+        sink->next_poll_us = now + sink->poll_interval_us;
+    }
+
+    pthread_mutex_lock(&sinks_lock);
+    uint64_t now = stub_clock_now_us();
+    bool accepted = sink->connected &&
+                    (!sink->accept || sink->accept(id, now, sink->accept_context));
+    if(accepted) {
+        if(sink->count == sink->capacity) {
+            sink->capacity = sink->capacity ? sink->capacity * 2 : 256;
+            sink->reports = realloc(sink->reports, sink->capacity * sizeof(StubHidReport));
+        }
+        sink->state.time_us = now;
+        sink->reports[sink->count++] = sink->state;
+    } else {
+        sink->refused++;
+    }
+    pthread_mutex_unlock(&sinks_lock);
+    return accepted;
+}
+
+static bool sink_press(StubHid id, uint16_t button) {
+    StubHidReport* state = &sinks[id].state;
+    for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+        if(state->keys[i] == 0) {
+            state->keys[i] = button & 0xFF;
+            break;
+        }
+    }
+    state->modifiers |= button >> 8;
+    return sink_submit(id);
+}
+
+static bool sink_release(StubHid id, uint16_t button) {
+    StubHidReport* state = &sinks[id].state;
+    for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+        if(state->keys[i] == (button & 0xFF)) {
+            state->keys[i] = 0;
+            break;
+        }
+    }
+    state->modifiers &= ~(button >> 8);
+    return sink_submit(id);
+}
+
+static bool sink_release_all(StubHid id) {
+    memset(sinks[id].state.keys, 0, STUB_HID_KEYS);
+    sinks[id].state.modifiers = 0;
+    return sink_submit(id);
+}
+
+static bool report_has_key(const StubHidReport* report, uint8_t key) {
+    for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+        if(report->keys[i] == key) return true;
+    }
+    return false;
+}
+
+size_t stub_hid_decode(StubHid sink, uint16_t* keycodes, bool* released, size_t size) {
+    StubHidReport previous = {0};
+    bool all_up = true;
+    size_t count = 0;
+
+    // The worker thread may still be typing into the sink
+    pthread_mutex_lock(&sinks_lock);
+    for(size_t r = 0; r < sinks[sink].count; r++) {
+        const StubHidReport* report = &sinks[sink].reports[r];
+        bool empty = report->modifiers == 0;
+        for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+            empty &= report->keys[i] == 0;
+        }
+        if(empty) all_up = true;
+
+        for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+            uint8_t key = report->keys[i];
+            if(key == 0 || report_has_key(&previous, key)) continue;
+            if(count < size) {
+                keycodes[count] = key | (report->modifiers << 8);
+                if(released) released[count] = all_up;
+            }
+            count++;
+            all_up = false;
+        }
+        previous = *report;
+    }
+    pthread_mutex_unlock(&sinks_lock);
+    return MIN(count, size);
+}
+
+// USB
+
+struct FuriHalUsbInterface {
+    const char* name;
+};
+
+FuriHalUsbInterface usb_hid = {.name = "hid"};
+FuriHalUsbInterface usb_flipper_wedge_bulk = {.name = "flipper_wedge_bulk"};
+static FuriHalUsbInterface usb_cdc_single = {.name = "cdc"};
+static FuriHalUsbInterface* usb_config = &usb_cdc_single;
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void) {
+    return usb_config;
+}
+
+bool furi_hal_usb_set_config(FuriHalUsbInterface* config, void* context) {
+    UNUSED(context);
+    usb_config = config;
+    return true;
+}
+
+void furi_hal_usb_unlock(void) {
+}
+
+bool furi_hal_hid_is_connected(void) {
+    return usb_config == &usb_hid && sinks[StubHidUsb].connected;
+}
+
+bool furi_hal_hid_kb_press(uint16_t button) {
+    return sink_press(StubHidUsb, button);
+}
+
+bool furi_hal_hid_kb_release(uint16_t button) {
+    return sink_release(StubHidUsb, button);
+}
+
+bool furi_hal_hid_kb_release_all(void) {
+    return sink_release_all(StubHidUsb);
+}
+
+// USB bulk (vendor-page interface of the composite device)
+
+void flipper_wedge_usb_bulk_set_request_callback(FlipperWedgeUsbBulkCallback callback, void* context) {
+    bulk_callback = callback;
+    bulk_context = context;
+}
+
+bool flipper_wedge_usb_bulk_is_connected(void) {
+    return usb_config == &usb_flipper_wedge_bulk && sinks[StubHidUsb].connected;
+}
+
+size_t flipper_wedge_usb_bulk_get_request(uint8_t* data) {
+    memcpy(data, bulk_request, bulk_request_len);
+    size_t len = bulk_request_len;
+    bulk_request_len = 0;
+    return len;
+}
+
+void flipper_wedge_usb_bulk_free(void) {
+    // The firmware interface frees its semaphore, it must be gone by now
+    furi_check(usb_config != &usb_flipper_wedge_bulk);
+}
+
+bool flipper_wedge_usb_bulk_send(const uint8_t* report, uint32_t timeout_ms) {
+    UNUSED(timeout_ms);
+    if(!flipper_wedge_usb_bulk_is_connected()) return false;
+    // A reader that stopped reading, the send times out
+    if(bulk_send_limit == 0) return false;
+    bulk_send_limit--;
+
+    bulk_sent = realloc(bulk_sent, bulk_sent_len + FLIPPER_WEDGE_USB_BULK_PACKET_LEN);
+    memcpy(bulk_sent + bulk_sent_len, report, FLIPPER_WEDGE_USB_BULK_PACKET_LEN);
+    bulk_sent_len += FLIPPER_WEDGE_USB_BULK_PACKET_LEN;
+    return true;
+}
+
+void stub_bulk_host_request(const uint8_t* data, size_t len) {
+    bulk_request_len = MIN(len, sizeof(bulk_request));
+    memcpy(bulk_request, data, bulk_request_len);
+    if(bulk_callback) bulk_callback(bulk_context);
+}
+
+const uint8_t* stub_bulk_get_sent(size_t* len) {
+    *len = bulk_sent_len;
+    return bulk_sent;
+}
+
+void stub_bulk_set_send_limit(size_t reports) {
+    bulk_send_limit = reports;
+}
+
+// Bluetooth
+
+struct FuriHalBleProfileBase {
+    int dummy;
+};
+
+static FuriHalBleProfileBase ble_profile;
+const FuriHalBleProfileTemplate* ble_profile_hid = NULL;
+static BtStatusChangedCallback bt_status_callback;
+static void* bt_status_context;
+
+void furi_hal_bt_start_advertising(void) {
+}
+
+#define STUB_CYCLES_PER_US 64
+
+StubDwt* stub_dwt(void) {
+    static __thread StubDwt dwt;
+    dwt.CYCCNT = (uint32_t)(stub_clock_now_us() * STUB_CYCLES_PER_US);
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return STUB_CYCLES_PER_US;
+}
+
+void bt_disconnect(Bt* bt) {
+    UNUSED(bt);
+}
+
+void bt_keys_storage_set_storage_path(Bt* bt, const char* keys_storage_path) {
+    UNUSED(bt);
+    UNUSED(keys_storage_path);
+}
+
+void bt_keys_storage_set_default_path(Bt* bt) {
+    UNUSED(bt);
+}
+
+FuriHalBleProfileBase*
+    bt_profile_start(Bt* bt, const FuriHalBleProfileTemplate* profile_template, void* params) {
+    UNUSED(bt);
+    UNUSED(profile_template);
+    UNUSED(params);
+    return &ble_profile;
+}
+
+bool bt_profile_restore_default(Bt* bt) {
+    UNUSED(bt);
+    return true;
+}
+
+void bt_set_status_changed_callback(Bt* bt, BtStatusChangedCallback callback, void* context) {
+    UNUSED(bt);
+    bt_status_callback = callback;
+    bt_status_context = context;
+}
+
+struct GapSvcEventHandler {
+    BleSvcEventHandlerCb callback;
+    void* context;
+};
+
+static GapSvcEventHandler ble_event_handler;
+
+GapSvcEventHandler* ble_event_dispatcher_register_svc_handler(BleSvcEventHandlerCb handler, void* context) {
+    furi_check(!ble_event_handler.callback);
+    ble_event_handler.callback = handler;
+    ble_event_handler.context = context;
+    return &ble_event_handler;
+}
+
+void ble_event_dispatcher_unregister_svc_handler(GapSvcEventHandler* handler) {
+    furi_check(handler == &ble_event_handler);
+    ble_event_handler.callback = NULL;
+}
+
+void stub_ble_connect_event(uint8_t address_type, const uint8_t* address) {
+    // hci_uart_pckt > hci_event_pckt > evt_le_meta_event > connection complete
+    uint8_t packet[3 + 1 + sizeof(hci_le_connection_complete_event_rp0)] = {0};
+    hci_event_pckt* event_pckt = (hci_event_pckt*)(((hci_uart_pckt*)packet)->data);
+    event_pckt->evt = HCI_LE_META_EVT_CODE;
+    event_pckt->plen = 1 + sizeof(hci_le_connection_complete_event_rp0);
+    evt_le_meta_event* meta_event = (evt_le_meta_event*)event_pckt->data;
+    meta_event->subevent = HCI_LE_CONNECTION_COMPLETE_SUBEVT_CODE;
+    hci_le_connection_complete_event_rp0* connection = (void*)meta_event->data;
+    connection->Status = BLE_STATUS_SUCCESS;
+    connection->Peer_Address_Type = address_type;
+    memcpy(connection->Peer_Address, address, sizeof(connection->Peer_Address));
+
+    if(ble_event_handler.callback) {
+        ble_event_handler.callback(packet, ble_event_handler.context);
+    }
+}
+
+void stub_ble_add_bond(const uint8_t* private_address, const uint8_t* identity) {
+    furi_check(ble_bonds_count < STUB_BLE_BONDS_MAX);
+    memcpy(ble_bonds[ble_bonds_count].private_address, private_address, 6);
+    memcpy(ble_bonds[ble_bonds_count].identity, identity, 6);
+    ble_bonds_count++;
+}
+
+tBleStatus aci_gap_resolve_private_addr(const uint8_t Address[6], uint8_t Actual_Address[6]) {
+    for(size_t i = 0; i < ble_bonds_count; i++) {
+        if(memcmp(ble_bonds[i].private_address, Address, 6) == 0) {
+            memcpy(Actual_Address, ble_bonds[i].identity, 6);
+            return BLE_STATUS_SUCCESS;
+        }
+    }
+    return BLE_STATUS_FAILED;
+}
+
+void stub_hid_set_connected(StubHid sink, bool connected) {
+    sinks[sink].connected = connected;
+    if(sink == StubHidBle && bt_status_callback) {
+        bt_status_callback(connected ? BtStatusConnected : BtStatusAdvertising, bt_status_context);
+    }
+}
+
+bool ble_profile_hid_kb_press(FuriHalBleProfileBase* profile, uint16_t button) {
+    furi_check(profile == &ble_profile);
+    return sink_press(StubHidBle, button);
+}
+
+bool ble_profile_hid_kb_release(FuriHalBleProfileBase* profile, uint16_t button) {
+    furi_check(profile == &ble_profile);
+    return sink_release(StubHidBle, button);
+}
+
+bool ble_profile_hid_kb_release_all(FuriHalBleProfileBase* profile) {
+    furi_check(profile == &ble_profile);
+    return sink_release_all(StubHidBle);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <furi.h>
+
+// Declarations only, the RFID driver itself isn't built on the host
+
+typedef int32_t ProtocolId;
+typedef struct ProtocolDict ProtocolDict;
+typedef struct LFRFIDWorker LFRFIDWorker;
+
+typedef enum {
+    LFRFIDWorkerReadTypeAuto,
+    LFRFIDWorkerReadTypeASKOnly,
+    LFRFIDWorkerReadTypePSKOnly,
+} LFRFIDWorkerReadType;
+
+typedef enum {
+    LFRFIDWorkerReadSenseStart,
+    LFRFIDWorkerReadSenseEnd,
+    LFRFIDWorkerReadSenseCardStart,
+    LFRFIDWorkerReadSenseCardEnd,
+    LFRFIDWorkerReadStartASK,
+    LFRFIDWorkerReadStartPSK,
+    LFRFIDWorkerReadDone,
+} LFRFIDWorkerReadResult;
+
+typedef void (*LFRFIDWorkerReadCallback)(LFRFIDWorkerReadResult result, ProtocolId protocol, void* context);
+
+LFRFIDWorker* lfrfid_worker_alloc(ProtocolDict* dict);
+void lfrfid_worker_free(LFRFIDWorker* worker);
+void lfrfid_worker_start_thread(LFRFIDWorker* worker);
+void lfrfid_worker_stop_thread(LFRFIDWorker* worker);
+void lfrfid_worker_read_start(
+    LFRFIDWorker* worker,
+    LFRFIDWorkerReadType type,
+    LFRFIDWorkerReadCallback callback,
+    void* context);
+void lfrfid_worker_stop(LFRFIDWorker* worker);
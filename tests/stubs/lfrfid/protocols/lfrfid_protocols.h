@@ -0,0 +1,29 @@
+#pragma once
+
+#include <lfrfid/lfrfid_worker.h>
+
+typedef enum {
+    LFRFIDProtocolEM4100,
+    LFRFIDProtocolEM410032,
+    LFRFIDProtocolEM410016,
+    LFRFIDProtocolElectra,
+    LFRFIDProtocolH10301,
+    LFRFIDProtocolIdteck,
+    LFRFIDProtocolIndala26,
+    LFRFIDProtocolIOProxXSF,
+    LFRFIDProtocolAwid,
+    LFRFIDProtocolFDXA,
+    LFRFIDProtocolFDXB,
+    LFRFIDProtocolHidGeneric,
+    LFRFIDProtocolHidExGeneric,
+    LFRFIDProtocolMax,
+} LFRFIDProtocol;
+
+typedef struct ProtocolBase ProtocolBase;
+extern const ProtocolBase* lfrfid_protocols[];
+
+ProtocolDict* protocol_dict_alloc(const ProtocolBase** protocols, size_t protocol_count);
+void protocol_dict_free(ProtocolDict* dict);
+size_t protocol_dict_get_data_size(ProtocolDict* dict, size_t protocol_index);
+void protocol_dict_get_data(ProtocolDict* dict, size_t protocol_index, uint8_t* data, size_t data_size);
+const char* protocol_dict_get_name(ProtocolDict* dict, size_t protocol_index);
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct Nfc Nfc;
+
+Nfc* nfc_alloc(void);
+void nfc_free(Nfc* instance);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "nfc.h"
+#include "protocols/nfc_generic_event.h"
+
+typedef struct NfcPoller NfcPoller;
+typedef void NfcDeviceData;
+
+NfcPoller* nfc_poller_alloc(Nfc* nfc, NfcProtocol protocol);
+void nfc_poller_free(NfcPoller* instance);
+void nfc_poller_start(NfcPoller* instance, NfcGenericCallback callback, void* context);
+void nfc_poller_stop(NfcPoller* instance);
+const NfcDeviceData* nfc_poller_get_data(const NfcPoller* instance);
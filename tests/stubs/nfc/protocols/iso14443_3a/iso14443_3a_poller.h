@@ -0,0 +1,27 @@
+#pragma once
+
+#include "iso14443_3a.h"
+#include <toolbox/bit_buffer.h>
+
+typedef struct Iso14443_3aPoller Iso14443_3aPoller;
+
+typedef enum {
+    Iso14443_3aPollerEventTypeError,
+    Iso14443_3aPollerEventTypeReady,
+} Iso14443_3aPollerEventType;
+
+typedef union {
+    Iso14443_3aError error;
+} Iso14443_3aPollerEventData;
+
+typedef struct {
+    Iso14443_3aPollerEventType type;
+    Iso14443_3aPollerEventData* data;
+} Iso14443_3aPollerEvent;
+
+Iso14443_3aError iso14443_3a_poller_activate(Iso14443_3aPoller* instance, Iso14443_3aData* iso14443_3a_data);
+Iso14443_3aError iso14443_3a_poller_send_standard_frame(
+    Iso14443_3aPoller* instance,
+    const BitBuffer* tx_buffer,
+    BitBuffer* rx_buffer,
+    uint32_t fwt);
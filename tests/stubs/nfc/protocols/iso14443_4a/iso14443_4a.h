@@ -0,0 +1,14 @@
+#pragma once
+
+#include <nfc/protocols/iso14443_3a/iso14443_3a.h>
+
+typedef enum {
+    Iso14443_4aErrorNone,
+    Iso14443_4aErrorNotPresent,
+    Iso14443_4aErrorProtocol,
+    Iso14443_4aErrorTimeout,
+} Iso14443_4aError;
+
+typedef struct {
+    Iso14443_3aData* iso14443_3a_data;
+} Iso14443_4aData;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <furi.h>
+#include <toolbox/simple_array.h>
+
+#define ISO15693_3_UID_SIZE 8
+
+typedef struct {
+    uint16_t block_count;
+    uint8_t block_size;
+} Iso15693_3SystemInfo;
+
+typedef struct {
+    uint8_t uid[ISO15693_3_UID_SIZE];
+    Iso15693_3SystemInfo system_info;
+    SimpleArray* block_data;
+} Iso15693_3Data;
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "iso15693_3.h"
+
+typedef enum {
+    Iso15693_3PollerEventTypeError,
+    Iso15693_3PollerEventTypeReady,
+} Iso15693_3PollerEventType;
+
+typedef struct {
+    Iso15693_3PollerEventType type;
+    void* data;
+} Iso15693_3PollerEvent;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "nfc_protocol.h"
+
+typedef enum {
+    NfcCommandContinue,
+    NfcCommandReset,
+    NfcCommandSleep,
+    NfcCommandStop,
+} NfcCommand;
+
+typedef void NfcGenericInstance;
+typedef void NfcGenericEventData;
+
+typedef struct {
+    NfcProtocol protocol;
+    NfcGenericInstance* instance;
+    NfcGenericEventData* event_data;
+} NfcGenericEvent;
+
+typedef NfcCommand (*NfcGenericCallback)(NfcGenericEvent event, void* context);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <furi.h>
+
+typedef enum {
+    NfcProtocolIso14443_3a,
+    NfcProtocolIso14443_3b,
+    NfcProtocolIso14443_4a,
+    NfcProtocolIso14443_4b,
+    NfcProtocolIso15693_3,
+    NfcProtocolFelica,
+    NfcProtocolMfUltralight,
+    NfcProtocolMfClassic,
+    NfcProtocolMfDesfire,
+    NfcProtocolSlix,
+    NfcProtocolSt25tb,
+    NfcProtocolNum,
+    NfcProtocolInvalid,
+} NfcProtocol;
+
+NfcProtocol nfc_protocol_get_parent(NfcProtocol protocol);
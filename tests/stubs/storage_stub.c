@@ -0,0 +1,556 @@
+// Host storage, flipper_format and path helpers on real files
+
+#include "stub.h"
+#include <storage/storage.h>
+#include <flipper_format/flipper_format.h>
+#include <toolbox/path.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+static char storage_root[256];
+static char storage_path[2][512];
+static int storage_path_next;
+static bool storage_timestamp_fails;
+static uint64_t storage_bytes_read;
+
+void stub_storage_set_root(const char* root) {
+    strlcpy(storage_root, root, sizeof(storage_root));
+}
+
+const char* stub_storage_host_path(const char* path) {
+    if(storage_root[0] == '\0') {
+        strlcpy(storage_root, "/tmp/flipper_wedge_test_XXXXXX", sizeof(storage_root));
+        furi_check(mkdtemp(storage_root));
+    }
+
+    // Two rotating buffers, rename needs both paths at once
+    char* host = storage_path[storage_path_next];
+    storage_path_next ^= 1;
+    snprintf(host, sizeof(storage_path[0]), "%s%s", storage_root, path);
+    size_t len = strlen(host);
+    if(len > 1 && host[len - 1] == '/') host[len - 1] = '\0';
+    return host;
+}
+
+void stub_storage_set_timestamp_fails(bool fail) {
+    storage_timestamp_fails = fail;
+}
+
+uint64_t stub_storage_bytes_read(void) {
+    return storage_bytes_read;
+}
+
+struct File {
+    FILE* stream;
+    DIR* dir;
+};
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    storage_dir_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    const char* host = stub_storage_host_path(path);
+    bool exists = access(host, F_OK) == 0;
+    if(open_mode == FSOM_OPEN_EXISTING && !exists) return false;
+    if(open_mode == FSOM_CREATE_NEW && exists) return false;
+
+    const char* mode;
+    if(open_mode == FSOM_CREATE_ALWAYS || open_mode == FSOM_CREATE_NEW) {
+        mode = (access_mode & FSAM_READ) ? "w+b" : "wb";
+    } else if(open_mode == FSOM_OPEN_APPEND) {
+        mode = "a+b";
+    } else if(exists) {
+        mode = (access_mode & FSAM_WRITE) ? "r+b" : "rb";
+    } else {
+        mode = "w+b";
+    }
+    file->stream = fopen(host, mode);
+    return file->stream != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->stream) return false;
+    fclose(file->stream);
+    file->stream = NULL;
+    return true;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    size_t read = file->stream ? fread(buff, 1, bytes_to_read, file->stream) : 0;
+    storage_bytes_read += read;
+    return read;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    return file->stream ? fwrite(buff, 1, bytes_to_write, file->stream) : 0;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return file->stream && fseek(file->stream, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_tell(File* file) {
+    return file->stream ? (uint64_t)ftell(file->stream) : 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    if(!file->stream) return 0;
+    struct stat st;
+    fflush(file->stream);
+    return fstat(fileno(file->stream), &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+bool storage_file_sync(File* file) {
+    return file->stream && fflush(file->stream) == 0;
+}
+
+bool storage_file_eof(File* file) {
+    return !file->stream || feof(file->stream);
+}
+
+bool storage_dir_open(File* file, const char* path) {
+    file->dir = opendir(stub_storage_host_path(path));
+    return file->dir != NULL;
+}
+
+bool storage_dir_close(File* file) {
+    if(!file->dir) return false;
+    closedir(file->dir);
+    file->dir = NULL;
+    return true;
+}
+
+bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_length) {
+    if(!file->dir) return false;
+    struct dirent* entry;
+    do {
+        entry = readdir(file->dir);
+        if(!entry) return false;
+    } while(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0);
+
+    if(name) strlcpy(name, entry->d_name, name_length);
+    if(fileinfo) {
+        fileinfo->flags = entry->d_type == DT_DIR ? FSF_DIRECTORY : 0;
+        fileinfo->size = 0;
+        if(entry->d_type != DT_DIR) {
+            int fd = dirfd(file->dir);
+            struct stat st;
+            if(fstatat(fd, entry->d_name, &st, 0) == 0) fileinfo->size = st.st_size;
+        }
+    }
+    return true;
+}
+
+bool storage_dir_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    struct stat st;
+    return stat(stub_storage_host_path(path), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    struct stat st;
+    return stat(stub_storage_host_path(path), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    struct stat st;
+    if(stat(stub_storage_host_path(path), &st) != 0) return FSE_NOT_EXIST;
+    if(fileinfo) {
+        fileinfo->flags = S_ISDIR(st.st_mode) ? FSF_DIRECTORY : 0;
+        fileinfo->size = st.st_size;
+    }
+    return FSE_OK;
+}
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp) {
+    UNUSED(storage);
+    if(storage_timestamp_fails) return FSE_NOT_IMPLEMENTED;
+    struct stat st;
+    if(stat(stub_storage_host_path(path), &st) != 0) return FSE_NOT_EXIST;
+    *timestamp = (uint32_t)st.st_mtime;
+    return FSE_OK;
+}
+
+// Creates missing parents too, like the tests expect from a fresh SD card
+FS_Error storage_common_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host[512];
+    strlcpy(host, stub_storage_host_path(path), sizeof(host));
+    if(access(host, F_OK) == 0) return FSE_EXIST;
+    for(char* p = host + 1; *p; p++) {
+        if(*p != '/') continue;
+        *p = '\0';
+        mkdir(host, 0755);
+        *p = '/';
+    }
+    return mkdir(host, 0755) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    const char* host = stub_storage_host_path(path);
+    if(access(host, F_OK) != 0) return FSE_NOT_EXIST;
+    return remove(host) == 0 ? FSE_OK : FSE_DENIED;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    const char* old_host = stub_storage_host_path(old_path);
+    const char* new_host = stub_storage_host_path(new_path);
+    if(access(old_host, F_OK) != 0) return FSE_NOT_EXIST;
+    if(access(new_host, F_OK) == 0) return FSE_EXIST;
+    return rename(old_host, new_host) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_migrate(Storage* storage, const char* source, const char* dest) {
+    UNUSED(storage);
+    UNUSED(source);
+    UNUSED(dest);
+    return FSE_OK;
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    FS_Error error = storage_common_mkdir(storage, path);
+    return error == FSE_OK || error == FSE_EXIST;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    FS_Error error = storage_common_remove(storage, path);
+    return error == FSE_OK || error == FSE_NOT_EXIST;
+}
+
+// flipper_format: the file is kept in memory as text, writes go to the end
+// or replace a line and are saved on close
+
+struct FlipperFormat {
+    char path[256];
+    bool open;
+    bool dirty;
+    char* text;
+    size_t len;
+    size_t pos;
+};
+
+FlipperFormat* flipper_format_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(FlipperFormat));
+}
+
+void flipper_format_free(FlipperFormat* ff) {
+    flipper_format_file_close(ff);
+    free(ff);
+}
+
+static bool ff_load(FlipperFormat* ff, const char* path, bool create, bool truncate) {
+    flipper_format_file_close(ff);
+    strlcpy(ff->path, path, sizeof(ff->path));
+    ff->text = NULL;
+    ff->len = 0;
+    ff->pos = 0;
+
+    FILE* stream = fopen(stub_storage_host_path(path), "rb");
+    if(stream && !truncate) {
+        fseek(stream, 0, SEEK_END);
+        ff->len = ftell(stream);
+        fseek(stream, 0, SEEK_SET);
+        ff->text = malloc(ff->len + 1);
+        ff->len = fread(ff->text, 1, ff->len, stream);
+        ff->text[ff->len] = '\0';
+    }
+    if(stream) fclose(stream);
+    if(!stream && !create) return false;
+    if(!ff->text) ff->text = calloc(1, 1);
+
+    ff->open = true;
+    ff->dirty = !stream || truncate;
+    return true;
+}
+
+bool flipper_format_file_open_existing(FlipperFormat* ff, const char* path) {
+    return ff_load(ff, path, false, false);
+}
+
+bool flipper_format_file_open_always(FlipperFormat* ff, const char* path) {
+    return ff_load(ff, path, true, true);
+}
+
+bool flipper_format_file_open_new(FlipperFormat* ff, const char* path) {
+    if(access(stub_storage_host_path(path), F_OK) == 0) return false;
+    return ff_load(ff, path, true, true);
+}
+
+bool flipper_format_file_close(FlipperFormat* ff) {
+    if(!ff->open) return false;
+    bool saved = true;
+    if(ff->dirty) {
+        FILE* stream = fopen(stub_storage_host_path(ff->path), "wb");
+        saved = stream && fwrite(ff->text, 1, ff->len, stream) == ff->len;
+        if(stream) fclose(stream);
+    }
+    free(ff->text);
+    ff->text = NULL;
+    ff->open = false;
+    return saved;
+}
+
+bool flipper_format_rewind(FlipperFormat* ff) {
+    ff->pos = 0;
+    return ff->open;
+}
+
+// Find "key:" at a line start from pos on, sets the line bounds. The bytes
+// passed count as read, as the firmware streams them from the file.
+static bool ff_find(FlipperFormat* ff, const char* key, size_t* line, size_t* value, size_t* end) {
+    if(!ff->open) return false;
+    size_t key_len = strlen(key);
+    size_t pos = ff->pos;
+    while(pos < ff->len) {
+        size_t eol = pos;
+        while(eol < ff->len && ff->text[eol] != '\n') eol++;
+        if(ff->text[pos] != '#' && eol - pos > key_len && strncmp(ff->text + pos, key, key_len) == 0 &&
+           ff->text[pos + key_len] == ':') {
+            size_t start = pos + key_len + 1;
+            while(start < eol && ff->text[start] == ' ') start++;
+            *line = pos;
+            *value = start;
+            *end = eol;
+            storage_bytes_read += MIN(eol + 1, ff->len) - ff->pos;
+            return true;
+        }
+        pos = eol + 1;
+    }
+    storage_bytes_read += ff->len - ff->pos;
+    return false;
+}
+
+static bool ff_read_value(FlipperFormat* ff, const char* key, char* buffer, size_t size) {
+    size_t line, value, end;
+    if(!ff_find(ff, key, &line, &value, &end)) return false;
+    size_t len = MIN(end - value, size - 1);
+    memcpy(buffer, ff->text + value, len);
+    buffer[len] = '\0';
+    ff->pos = end < ff->len ? end + 1 : end;
+    return true;
+}
+
+static void ff_splice(FlipperFormat* ff, size_t start, size_t end, const char* insert) {
+    size_t insert_len = strlen(insert);
+    size_t new_len = ff->len - (end - start) + insert_len;
+    char* text = malloc(new_len + 1);
+    memcpy(text, ff->text, start);
+    memcpy(text + start, insert, insert_len);
+    memcpy(text + start + insert_len, ff->text + end, ff->len - end);
+    text[new_len] = '\0';
+    free(ff->text);
+    ff->text = text;
+    ff->len = new_len;
+    ff->pos = start + insert_len;
+    ff->dirty = true;
+}
+
+static bool ff_write_line(FlipperFormat* ff, const char* key, const char* value) {
+    if(!ff->open) return false;
+    char line[1024];
+    snprintf(line, sizeof(line), "%s: %s\n", key, value);
+    ff_splice(ff, ff->len, ff->len, line);
+    return true;
+}
+
+bool flipper_format_read_header(FlipperFormat* ff, FuriString* filetype, uint32_t* version) {
+    char value[256];
+    ff->pos = 0;
+    if(!ff_read_value(ff, "Filetype", value, sizeof(value))) return false;
+    furi_string_set_str(filetype, value);
+    if(!ff_read_value(ff, "Version", value, sizeof(value))) return false;
+    *version = strtoul(value, NULL, 10);
+    return true;
+}
+
+bool flipper_format_write_header_cstr(FlipperFormat* ff, const char* filetype, const uint32_t version) {
+    char value[16];
+    snprintf(value, sizeof(value), "%" PRIu32, version);
+    return ff_write_line(ff, "Filetype", filetype) && ff_write_line(ff, "Version", value);
+}
+
+bool flipper_format_key_exist(FlipperFormat* ff, const char* key) {
+    size_t line, value, end;
+    size_t pos = ff->pos;
+    ff->pos = 0;
+    bool found = ff_find(ff, key, &line, &value, &end);
+    ff->pos = pos;
+    return found;
+}
+
+bool flipper_format_get_value_count(FlipperFormat* ff, const char* key, uint32_t* count) {
+    size_t line, value, end;
+    if(!ff_find(ff, key, &line, &value, &end)) return false;
+    uint32_t values = 0;
+    for(size_t i = value; i < end;) {
+        while(i < end && ff->text[i] == ' ') i++;
+        if(i == end) break;
+        values++;
+        while(i < end && ff->text[i] != ' ') i++;
+    }
+    *count = values;
+    return true;
+}
+
+bool flipper_format_read_string(FlipperFormat* ff, const char* key, FuriString* data) {
+    char value[1024];
+    if(!ff_read_value(ff, key, value, sizeof(value))) return false;
+    furi_string_set_str(data, value);
+    return true;
+}
+
+bool flipper_format_write_string_cstr(FlipperFormat* ff, const char* key, const char* data) {
+    return ff_write_line(ff, key, data);
+}
+
+bool flipper_format_read_uint32(FlipperFormat* ff, const char* key, uint32_t* data, const uint16_t data_size) {
+    char value[1024];
+    if(!ff_read_value(ff, key, value, sizeof(value))) return false;
+    char* p = value;
+    for(uint16_t i = 0; i < data_size; i++) {
+        char* next;
+        unsigned long parsed = strtoul(p, &next, 10);
+        if(next == p) return false;
+        data[i] = parsed;
+        p = next;
+    }
+    return true;
+}
+
+static void ff_format_uint32(char* value, size_t size, const uint32_t* data, uint16_t data_size) {
+    size_t len = 0;
+    value[0] = '\0';
+    for(uint16_t i = 0; i < data_size && len < size; i++) {
+        len += snprintf(value + len, size - len, i ? " %" PRIu32 : "%" PRIu32, data[i]);
+    }
+}
+
+bool flipper_format_write_uint32(FlipperFormat* ff, const char* key, const uint32_t* data, const uint16_t data_size) {
+    char value[1024];
+    ff_format_uint32(value, sizeof(value), data, data_size);
+    return ff_write_line(ff, key, value);
+}
+
+bool flipper_format_insert_or_update_string_cstr(FlipperFormat* ff, const char* key, const char* data) {
+    char line_text[1100];
+    snprintf(line_text, sizeof(line_text), "%s: %s\n", key, data);
+
+    size_t line, start, end;
+    ff->pos = 0;
+    if(ff_find(ff, key, &line, &start, &end)) {
+        ff_splice(ff, line, end < ff->len ? end + 1 : end, line_text);
+    } else {
+        ff_splice(ff, ff->len, ff->len, line_text);
+    }
+    return true;
+}
+
+bool flipper_format_insert_or_update_uint32(
+    FlipperFormat* ff,
+    const char* key,
+    const uint32_t* data,
+    const uint16_t data_size) {
+    char value[1024];
+    char line_text[1100];
+    ff_format_uint32(value, sizeof(value), data, data_size);
+    snprintf(line_text, sizeof(line_text), "%s: %s\n", key, value);
+
+    size_t line, start, end;
+    ff->pos = 0;
+    if(ff_find(ff, key, &line, &start, &end)) {
+        ff_splice(ff, line, end < ff->len ? end + 1 : end, line_text);
+    } else {
+        ff_splice(ff, ff->len, ff->len, line_text);
+    }
+    return true;
+}
+
+bool flipper_format_delete_key(FlipperFormat* ff, const char* key) {
+    size_t line, start, end;
+    ff->pos = 0;
+    if(!ff_find(ff, key, &line, &start, &end)) return false;
+    ff_splice(ff, line, end < ff->len ? end + 1 : end, "");
+    return true;
+}
+
+bool flipper_format_read_bool(FlipperFormat* ff, const char* key, bool* data, const uint16_t data_size) {
+    char value[1024];
+    if(!ff_read_value(ff, key, value, sizeof(value))) return false;
+    char* p = value;
+    for(uint16_t i = 0; i < data_size; i++) {
+        while(*p == ' ') p++;
+        if(strncmp(p, "true", 4) == 0) {
+            data[i] = true;
+            p += 4;
+        } else if(strncmp(p, "false", 5) == 0) {
+            data[i] = false;
+            p += 5;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool flipper_format_write_bool(FlipperFormat* ff, const char* key, const bool* data, const uint16_t data_size) {
+    char value[1024] = "";
+    for(uint16_t i = 0; i < data_size; i++) {
+        strcat(value, i ? " " : "");
+        strcat(value, data[i] ? "true" : "false");
+    }
+    return ff_write_line(ff, key, value);
+}
+
+bool flipper_format_read_hex(FlipperFormat* ff, const char* key, uint8_t* data, const uint16_t data_size) {
+    char value[1024];
+    if(!ff_read_value(ff, key, value, sizeof(value))) return false;
+    char* p = value;
+    for(uint16_t i = 0; i < data_size; i++) {
+        while(*p == ' ') p++;
+        if(!isxdigit((unsigned char)p[0]) || !isxdigit((unsigned char)p[1])) return false;
+        char byte[3] = {p[0], p[1], '\0'};
+        data[i] = strtoul(byte, NULL, 16);
+        p += 2;
+    }
+    return true;
+}
+
+bool flipper_format_write_hex(FlipperFormat* ff, const char* key, const uint8_t* data, const uint16_t data_size) {
+    char value[1024] = "";
+    size_t len = 0;
+    for(uint16_t i = 0; i < data_size && len + 4 < sizeof(value); i++) {
+        len += snprintf(value + len, sizeof(value) - len, i ? " %02X" : "%02X", data[i]);
+    }
+    return ff_write_line(ff, key, value);
+}
+
+// Path
+
+void path_extract_filename_no_ext(const char* path, FuriString* filename) {
+    const char* start = strrchr(path, '/');
+    start = start ? start + 1 : path;
+    const char* dot = strrchr(start, '.');
+    size_t len = dot ? (size_t)(dot - start) : strlen(start);
+
+    char name[256];
+    len = MIN(len, sizeof(name) - 1);
+    memcpy(name, start, len);
+    name[len] = '\0';
+    furi_string_set_str(filename, name);
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+// Controls of the host stubs, used by tests and benchmarks only
+
+#include <furi.h>
+
+// Clock
+
+/** Switch between the real monotonic clock and a virtual one
+ * The virtual clock only moves when the code under test delays or a stub
+ * charges time for a call, so timings are exact and runs are instant.
+ * Threads need the real clock.
+ *
+ * @param enabled true for the virtual clock, starts at 0
+ */
+void stub_clock_set_virtual(bool enabled);
+
+/** Get the stub clock
+ *
+ * @return Microseconds since the clock was set
+ */
+uint64_t stub_clock_now_us(void);
+
+/** Let time pass, advances the virtual clock or sleeps
+ *
+ * @param us Microseconds
+ */
+void stub_clock_advance_us(uint64_t us);
+
+// HID sinks
+
+typedef enum {
+    StubHidUsb,
+    StubHidBle,
+    StubHidCount,
+} StubHid;
+
+#define STUB_HID_KEYS 6
+
+// Boot keyboard report as the host receives it
+typedef struct {
+    uint64_t time_us;
+    uint8_t modifiers;
+    uint8_t keys[STUB_HID_KEYS];
+} StubHidReport;
+
+/** Decide if the host takes a report
+ * A refused report is lost, but the sink state still changes, as on the
+ * firmware, so the next accepted report carries it.
+ *
+ * @param sink Sink the report is for
+ * @param now_us Stub clock
+ * @param context Context
+ * @return true if the report reaches the host
+ */
+typedef bool (*StubHidAcceptCallback)(StubHid sink, uint64_t now_us, void* context);
+
+/** Forget all reports and set both sinks to connected, accept everything
+ * and take no time. Also forgets what was sent on the bulk interface.
+ */
+void stub_hid_reset(void);
+
+/** Set the acceptance policy of a sink
+ *
+ * @param sink Sink
+ * @param callback Policy, NULL to accept everything
+ * @param context Context
+ */
+void stub_hid_set_accept(StubHid sink, StubHidAcceptCallback callback, void* context);
+
+/** Make a sink's submit calls block like the USB endpoint does
+ * A call waits until the host polled the previous report, at most one
+ * report per interval gets through.
+ *
+ * @param sink Sink
+ * @param interval_us Host poll interval, 0 for calls that return at once
+ */
+void stub_hid_set_poll_interval(StubHid sink, uint32_t interval_us);
+
+/** Charge a fixed time for every submit call
+ *
+ * @param sink Sink
+ * @param us Microseconds per call
+ */
+void stub_hid_set_call_us(StubHid sink, uint32_t us);
+
+/** Set the connection state of a sink
+ * BLE changes are reported through the Bt status callback.
+ *
+ * @param sink Sink
+ * @param connected Connection state
+ */
+void stub_hid_set_connected(StubHid sink, bool connected);
+
+/** Get the reports a sink delivered to the host
+ *
+ * @param sink Sink
+ * @param count Set to the number of reports
+ * @return Reports in order, valid until the next reset
+ */
+const StubHidReport* stub_hid_get_reports(StubHid sink, size_t* count);
+
+/** Get the number of submit calls a sink refused
+ *
+ * @param sink Sink
+ * @return Refused calls since the last reset
+ */
+uint32_t stub_hid_get_refused(StubHid sink);
+
+/** Decode what the host typed from the reports it received
+ * A key counts when it appears in a report, with that report's modifiers,
+ * and wasn't down in the report before.
+ *
+ * @param sink Sink
+ * @param keycodes Filled in with keycodes (usage | modifiers << 8)
+ * @param released Filled in per key, true if the host saw all keys and
+ *                 modifiers up since the previous key (may be NULL)
+ * @param size Capacity of keycodes and released
+ * @return Number of keys decoded
+ */
+size_t stub_hid_decode(StubHid sink, uint16_t* keycodes, bool* released, size_t size);
+
+// USB bulk interface
+
+/** Queue a host request on the bulk interface and signal it
+ *
+ * @param data Request report
+ * @param len Length of data
+ */
+void stub_bulk_host_request(const uint8_t* data, size_t len);
+
+/** Get the reports sent on the bulk interface since the last reset
+ *
+ * @param len Set to the number of bytes
+ * @return Concatenated reports
+ */
+const uint8_t* stub_bulk_get_sent(size_t* len);
+
+/** Make the reader stop reading after a number of reports, further sends
+ * time out. Cleared by stub_hid_reset().
+ *
+ * @param reports Reports the reader still takes
+ */
+void stub_bulk_set_send_limit(size_t reports);
+
+// BLE stack
+
+/** Deliver an LE connection complete event to the registered handler
+ *
+ * @param address_type Peer address type
+ * @param address Peer address, 6 bytes, least significant first
+ */
+void stub_ble_connect_event(uint8_t address_type, const uint8_t* address);
+
+/** Add a bond the stack resolves private addresses with
+ * Cleared by stub_hid_reset().
+ *
+ * @param private_address Resolvable private address, 6 bytes
+ * @param identity Identity address it resolves to, 6 bytes
+ */
+void stub_ble_add_bond(const uint8_t* private_address, const uint8_t* identity);
+
+// Storage
+
+/** Use a host directory as the SD card
+ * Defaults to a fresh temporary directory.
+ *
+ * @param root Directory /ext maps into
+ */
+void stub_storage_set_root(const char* root);
+
+/** Map a Flipper path to the host path behind it
+ *
+ * @param path Flipper path
+ * @return Host path, valid until the next call
+ */
+const char* stub_storage_host_path(const char* path);
+
+/** Make storage_common_timestamp() fail, like some SD card drivers do
+ *
+ * @param fail true to fail
+ */
+void stub_storage_set_timestamp_fails(bool fail);
+
+/** Get the bytes read from files so far
+ * Counts storage_file_read() and the lines flipper_format reads search
+ * through, rereading after a rewind included.
+ *
+ * @return Bytes read since start
+ */
+uint64_t stub_storage_bytes_read(void);
+
+// Threads
+
+/** Get the deepest stack use of a thread
+ * Stacks are painted when the thread starts. Host frames are not the
+ * same size as Cortex-M4 ones, compare runs rather than absolute values.
+ *
+ * @param thread Joined or running thread
+ * @return Bytes of stack that were ever used
+ */
+size_t stub_thread_get_stack_used(FuriThread* thread);
+
+/** Get the thread started last
+ * Reaches the thread of code that keeps it private, like the HID worker.
+ *
+ * @return Thread, NULL if none was started yet
+ */
+FuriThread* stub_thread_get_last_started(void);
+
+// Logs
+
+/** Print the log lines of the helpers, off unless TEST_VERBOSE is set
+ *
+ * @param verbose true to print them
+ */
+void stub_log_set_verbose(bool verbose);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct BitBuffer BitBuffer;
+
+BitBuffer* bit_buffer_alloc(size_t capacity_bytes);
+void bit_buffer_free(BitBuffer* buf);
+void bit_buffer_reset(BitBuffer* buf);
+void bit_buffer_write_bytes(BitBuffer* buf, void* data, size_t size_bytes);
+void bit_buffer_copy_bytes(BitBuffer* buf, const uint8_t* data, size_t size_bytes);
+size_t bit_buffer_get_size_bytes(const BitBuffer* buf);
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <furi.h>
+
+typedef struct SimpleArray SimpleArray;
+typedef void SimpleArrayData;
+
+uint32_t simple_array_get_count(const SimpleArray* instance);
+const SimpleArrayData* simple_array_cget_data(const SimpleArray* instance);
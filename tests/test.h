@@ -0,0 +1,79 @@
+#pragma once
+
+// Minimal assertions for the host tests, one executable per test file
+
+#include <stub.h>
+#include <inttypes.h>
+
+static int test_checks;
+static int test_failures;
+
+#define TEST_ASSERT(cond)                                                      \
+    do {                                                                       \
+        test_checks++;                                                         \
+        if(!(cond)) {                                                          \
+            test_failures++;                                                   \
+            fprintf(stderr, "%s:%d: %s: failed: %s\n", __FILE__, __LINE__, __func__, #cond); \
+        }                                                                      \
+    } while(0)
+
+#define TEST_ASSERT_EQ(actual, expected)                                       \
+    do {                                                                       \
+        long long test_a = (long long)(actual);                                \
+        long long test_e = (long long)(expected);                              \
+        test_checks++;                                                         \
+        if(test_a != test_e) {                                                 \
+            test_failures++;                                                   \
+            fprintf(                                                           \
+                stderr,                                                        \
+                "%s:%d: %s: %s is %lld, expected %lld\n",                      \
+                __FILE__,                                                      \
+                __LINE__,                                                      \
+                __func__,                                                      \
+                #actual,                                                       \
+                test_a,                                                        \
+                test_e);                                                       \
+        }                                                                      \
+    } while(0)
+
+#define TEST_ASSERT_STR(actual, expected)                                      \
+    do {                                                                       \
+        const char* test_a = (actual);                                         \
+        const char* test_e = (expected);                                       \
+        test_checks++;                                                         \
+        if(strcmp(test_a, test_e) != 0) {                                      \
+            test_failures++;                                                   \
+            fprintf(                                                           \
+                stderr,                                                        \
+                "%s:%d: %s: %s is \"%s\", expected \"%s\"\n",                  \
+                __FILE__,                                                      \
+                __LINE__,                                                      \
+                __func__,                                                      \
+                #actual,                                                       \
+                test_a,                                                        \
+                test_e);                                                       \
+        }                                                                      \
+    } while(0)
+
+#define TEST_RUN(test)                                                         \
+    do {                                                                       \
+        int test_before = test_failures;                                       \
+        test();                                                                \
+        printf("  %-48s %s\n", #test, test_failures == test_before ? "ok" : "FAILED"); \
+    } while(0)
+
+// Print the summary, the exit code of the test executable
+static inline int test_report(const char* name) {
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
+
+// Deterministic pseudo random numbers (xorshift32), seed must not be 0
+static inline uint32_t test_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
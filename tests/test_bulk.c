@@ -0,0 +1,284 @@
+// Bulk messages decode back to the fields they were encoded from: the codec
+// on its own, reports cut and reassembled the way
+// tools/flipper_wedge_bulk_reader.py reads them, and whole scans served by
+// the worker to a host polling the vendor interface.
+
+#include "test.h"
+#include "flipper_wedge_bulk.h"
+#include "flipper_wedge_hid_worker.h"
+
+#define MESSAGE_MAX 16384
+#define FIELDS_MAX 8
+
+typedef struct {
+    uint8_t type;
+    uint8_t message_type;
+    size_t count;
+    FlipperWedgeBulkField fields[FIELDS_MAX];
+} Decoded;
+
+static uint16_t get_u16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+// Header, CRC and field list as the reference reader checks them
+static bool decode_message(const uint8_t* message, size_t len, Decoded* decoded) {
+    if(len < FLIPPER_WEDGE_BULK_HEADER_SIZE) return false;
+    if(message[0] != 'F' || message[1] != 'W' || message[2] != FLIPPER_WEDGE_BULK_VERSION) return false;
+    size_t body_len = get_u16(&message[4]);
+    if(len != FLIPPER_WEDGE_BULK_HEADER_SIZE + body_len) return false;
+    const uint8_t* body = &message[FLIPPER_WEDGE_BULK_HEADER_SIZE];
+    if(flipper_wedge_bulk_crc16(body, body_len) != get_u16(&message[6])) return false;
+
+    decoded->message_type = message[3];
+    decoded->count = 0;
+    size_t pos = 0;
+    while(pos + FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE <= body_len) {
+        size_t value_len = get_u16(&body[pos + 1]);
+        if(pos + FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE + value_len > body_len) return false;
+        if(decoded->count == FIELDS_MAX) return false;
+        decoded->fields[decoded->count++] = (FlipperWedgeBulkField){
+            body[pos], &body[pos + FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE], value_len};
+        pos += FLIPPER_WEDGE_BULK_FIELD_HEADER_SIZE + value_len;
+    }
+    return pos == body_len;
+}
+
+// Reassemble one message from reports, false on a sequence or length error.
+// *used is set to the bytes of reports consumed.
+static bool reassemble(const uint8_t* reports, size_t len, uint8_t* message, size_t* message_len, size_t* used) {
+    size_t expected = SIZE_MAX;
+    size_t index = 0;
+    *message_len = 0;
+    *used = 0;
+
+    while(*message_len < expected) {
+        if(*used + FLIPPER_WEDGE_BULK_REPORT_SIZE > len) return false;
+        const uint8_t* report = &reports[*used];
+        *used += FLIPPER_WEDGE_BULK_REPORT_SIZE;
+
+        bool first = report[0] & 0x80;
+        uint8_t seq = report[0] & 0x7F;
+        uint8_t payload = report[1];
+        if(payload > FLIPPER_WEDGE_BULK_REPORT_PAYLOAD) return false;
+        if(first != (index == 0) || seq != (index & 0x7F)) return false;
+        // Padding after the payload is zero
+        for(size_t i = 2 + payload; i < FLIPPER_WEDGE_BULK_REPORT_SIZE; i++) {
+            if(report[i] != 0) return false;
+        }
+
+        memcpy(&message[*message_len], &report[2], payload);
+        *message_len += payload;
+        index++;
+
+        if(expected == SIZE_MAX && *message_len >= FLIPPER_WEDGE_BULK_HEADER_SIZE) {
+            expected = FLIPPER_WEDGE_BULK_HEADER_SIZE + get_u16(&message[4]);
+        }
+    }
+    return *message_len == expected;
+}
+
+static bool field_equals(const FlipperWedgeBulkField* a, const FlipperWedgeBulkField* b) {
+    return a->type == b->type && a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+static void check_round_trip(const FlipperWedgeBulkField* fields, size_t count) {
+    static uint8_t message[MESSAGE_MAX];
+    static uint8_t reports[MESSAGE_MAX * 2];
+    static uint8_t reassembled[MESSAGE_MAX];
+
+    size_t len = flipper_wedge_bulk_encode(FlipperWedgeBulkMessageScan, fields, count, message, sizeof(message));
+    size_t reports_len = 0;
+    size_t offset = 0;
+    while(flipper_wedge_bulk_next_report(message, len, &offset, &reports[reports_len])) {
+        reports_len += FLIPPER_WEDGE_BULK_REPORT_SIZE;
+    }
+    size_t payload = FLIPPER_WEDGE_BULK_REPORT_PAYLOAD;
+    TEST_ASSERT_EQ(reports_len / FLIPPER_WEDGE_BULK_REPORT_SIZE, (len + payload - 1) / payload);
+
+    size_t message_len, used;
+    TEST_ASSERT(reassemble(reports, reports_len, reassembled, &message_len, &used));
+    TEST_ASSERT_EQ(used, reports_len);
+    Decoded decoded;
+    TEST_ASSERT(decode_message(reassembled, message_len, &decoded));
+    TEST_ASSERT_EQ(decoded.message_type, FlipperWedgeBulkMessageScan);
+
+    // Empty fields are left out, the rest come back in order
+    size_t d = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(fields[i].len == 0) continue;
+        TEST_ASSERT(d < decoded.count && field_equals(&decoded.fields[d], &fields[i]));
+        d++;
+    }
+    TEST_ASSERT_EQ(decoded.count, d);
+}
+
+static void test_crc_vector(void) {
+    // CRC-16/CCITT-FALSE check value
+    TEST_ASSERT_EQ(flipper_wedge_bulk_crc16((const uint8_t*)"123456789", 9), 0x29B1);
+    TEST_ASSERT_EQ(flipper_wedge_bulk_crc16(NULL, 0), 0xFFFF);
+}
+
+static void test_round_trip(void) {
+    static const uint8_t uid[] = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6};
+    static const uint8_t rfid[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    static const uint8_t timestamp[] = {0x78, 0x56, 0x34, 0x12};
+    const char* text = "04:A1:B2:C3:D4:E5:F6";
+    const char* ndef = "h\xC3\xA9llo \xF0\x9F\x98\x80";
+
+    // Fits one report
+    FlipperWedgeBulkField small[] = {
+        {FlipperWedgeBulkFieldNfcUid, uid, 4},
+    };
+    check_round_trip(small, COUNT_OF(small));
+
+    // Every field, one of them empty
+    FlipperWedgeBulkField all[] = {
+        {FlipperWedgeBulkFieldText, (const uint8_t*)text, strlen(text)},
+        {FlipperWedgeBulkFieldNfcUid, uid, sizeof(uid)},
+        {FlipperWedgeBulkFieldRfidUid, rfid, 0},
+        {FlipperWedgeBulkFieldRfidProtocol, (const uint8_t*)"EM4100", 6},
+        {FlipperWedgeBulkFieldNdefText, (const uint8_t*)ndef, strlen(ndef)},
+        {FlipperWedgeBulkFieldTimestamp, timestamp, sizeof(timestamp)},
+    };
+    check_round_trip(all, COUNT_OF(all));
+
+    // Message sizes around the report boundaries, and one long enough for
+    // the sequence number to wrap
+    static uint8_t value[10000];
+    uint32_t seed = 0x5EED;
+    for(size_t i = 0; i < sizeof(value); i++) {
+        value[i] = test_random(&seed) & 0xFF;
+    }
+    static const size_t lengths[] = {1, 51, 52, 53, 113, 114, 115, 1023, 2290, 8000, 10000};
+    for(size_t i = 0; i < COUNT_OF(lengths); i++) {
+        FlipperWedgeBulkField field = {FlipperWedgeBulkFieldNdefText, value, lengths[i]};
+        check_round_trip(&field, 1);
+    }
+}
+
+// A field that doesn't fit is cut, the message stays valid
+static void test_truncation(void) {
+    static uint8_t value[200];
+    memset(value, 'x', sizeof(value));
+    FlipperWedgeBulkField fields[] = {
+        {FlipperWedgeBulkFieldText, value, 20},
+        {FlipperWedgeBulkFieldNdefText, value, sizeof(value)},
+        {FlipperWedgeBulkFieldTimestamp, value, 4},
+    };
+
+    for(size_t size = FLIPPER_WEDGE_BULK_HEADER_SIZE; size < 80; size++) {
+        uint8_t message[80];
+        size_t len = flipper_wedge_bulk_encode(FlipperWedgeBulkMessageScan, fields, COUNT_OF(fields), message, size);
+        TEST_ASSERT(len <= size);
+        Decoded decoded;
+        TEST_ASSERT(decode_message(message, len, &decoded));
+    }
+
+    uint8_t message[4];
+    TEST_ASSERT_EQ(flipper_wedge_bulk_encode(FlipperWedgeBulkMessageScan, fields, 1, message, sizeof(message)), 0);
+}
+
+static void test_request_filter(void) {
+    uint8_t report[FLIPPER_WEDGE_BULK_REPORT_SIZE] = {'F', 'W', 'R', FLIPPER_WEDGE_BULK_VERSION};
+    TEST_ASSERT(flipper_wedge_bulk_is_request(report, sizeof(report)));
+    TEST_ASSERT(!flipper_wedge_bulk_is_request(report, 3));
+    report[3] = FLIPPER_WEDGE_BULK_VERSION + 1;
+    TEST_ASSERT(!flipper_wedge_bulk_is_request(report, sizeof(report)));
+
+    // CTAPHID INIT on the broadcast channel, what a FIDO client sends first
+    uint8_t fido[FLIPPER_WEDGE_BULK_REPORT_SIZE] = {0xFF, 0xFF, 0xFF, 0xFF, 0x86, 0x00, 0x08};
+    TEST_ASSERT(!flipper_wedge_bulk_is_request(fido, sizeof(fido)));
+}
+
+static const uint8_t host_request[] = {'F', 'W', 'R', FLIPPER_WEDGE_BULK_VERSION};
+
+// Ask for a message like the reader does, decode what came back
+static bool host_poll(size_t* sent_before, uint8_t* message, Decoded* decoded) {
+    stub_bulk_host_request(host_request, sizeof(host_request));
+    size_t sent_len = 0;
+    const uint8_t* sent = NULL;
+    for(uint32_t ms = 0; ms < 1000; ms++) {
+        sent = stub_bulk_get_sent(&sent_len);
+        if(sent_len > *sent_before) break;
+        furi_delay_ms(1);
+    }
+    // Let the worker finish the message
+    furi_delay_ms(10);
+    sent = stub_bulk_get_sent(&sent_len);
+
+    size_t message_len, used;
+    if(!reassemble(sent + *sent_before, sent_len - *sent_before, message, &message_len, &used)) return false;
+    *sent_before += used;
+    return decode_message(message, message_len, decoded);
+}
+
+// Scans queued on the worker reach the host in order, one per request
+static void test_worker_serves_host(void) {
+    static uint8_t message[MESSAGE_MAX];
+    static const uint8_t uid_a[] = {0x04, 0x11, 0x22, 0x33};
+    static const uint8_t uid_b[] = {0x04, 0x44, 0x55, 0x66};
+    static char ndef[1023];
+    memset(ndef, 'n', sizeof(ndef));
+
+    stub_hid_reset();
+    FlipperWedgeHidWorker* worker = flipper_wedge_hid_worker_alloc();
+    flipper_wedge_hid_worker_start(worker, FlipperWedgeHidWorkerModeUsbBulk);
+
+    FlipperWedgeBulkField a[] = {{FlipperWedgeBulkFieldNfcUid, uid_a, sizeof(uid_a)}};
+    FlipperWedgeBulkField b[] = {
+        {FlipperWedgeBulkFieldNfcUid, uid_b, sizeof(uid_b)},
+        {FlipperWedgeBulkFieldNdefText, (const uint8_t*)ndef, sizeof(ndef)},
+    };
+    TEST_ASSERT(flipper_wedge_hid_worker_send_bulk(worker, a, COUNT_OF(a)));
+    TEST_ASSERT(flipper_wedge_hid_worker_send_bulk(worker, b, COUNT_OF(b)));
+
+    // Nothing goes out until the host asks, anything but a request is ignored
+    furi_delay_ms(20);
+    size_t sent = 0;
+    stub_bulk_get_sent(&sent);
+    TEST_ASSERT_EQ(sent, 0);
+    stub_bulk_host_request((const uint8_t*)"\xFF\xFF\xFF\xFF\x86", 5);
+    furi_delay_ms(20);
+    stub_bulk_get_sent(&sent);
+    TEST_ASSERT_EQ(sent, 0);
+
+    Decoded decoded;
+    TEST_ASSERT(host_poll(&sent, message, &decoded));
+    TEST_ASSERT(decoded.count == 1 && field_equals(&decoded.fields[0], &a[0]));
+
+    // The reader stops halfway through the long message: it stays queued
+    // and comes again whole on the next request
+    size_t stall_start = sent;
+    stub_bulk_set_send_limit(5);
+    stub_bulk_host_request(host_request, sizeof(host_request));
+    furi_delay_ms(20);
+    stub_bulk_get_sent(&sent);
+    TEST_ASSERT_EQ(sent - stall_start, 5 * FLIPPER_WEDGE_BULK_REPORT_SIZE);
+    TEST_ASSERT(flipper_wedge_hid_worker_is_busy(worker));
+    stub_bulk_set_send_limit(SIZE_MAX);
+
+    TEST_ASSERT(host_poll(&sent, message, &decoded));
+    TEST_ASSERT(decoded.count == 2 && field_equals(&decoded.fields[0], &b[0]) &&
+                field_equals(&decoded.fields[1], &b[1]));
+    TEST_ASSERT(!flipper_wedge_hid_worker_is_busy(worker));
+
+    // Empty queue: an empty message
+    TEST_ASSERT(host_poll(&sent, message, &decoded));
+    TEST_ASSERT_EQ(decoded.message_type, FlipperWedgeBulkMessageEmpty);
+    TEST_ASSERT_EQ(decoded.count, 0);
+
+    flipper_wedge_hid_worker_free(worker);
+}
+
+int main(void) {
+    stub_clock_set_virtual(false);
+
+    TEST_RUN(test_crc_vector);
+    TEST_RUN(test_round_trip);
+    TEST_RUN(test_truncation);
+    TEST_RUN(test_request_filter);
+    TEST_RUN(test_worker_serves_host);
+
+    return test_report("test_bulk");
+}
@@ -0,0 +1,172 @@
+// Decimal UIDs: every result parses back to the UID's bytes through a
+// multiply-add reference bignum and has no leading zeros. Every 1, 2 and
+// 3-byte value, the numbers around each power of ten and each limb
+// boundary for every length, and random UIDs up to 16 bytes biased
+// towards 00 and FF bytes, in both byte orders.
+
+#include "test.h"
+#include "flipper_wedge_format.h"
+
+#define UID_MAX FLIPPER_WEDGE_FORMAT_DECIMAL_MAX_BYTES
+#define DIGITS_MAX 39 // 2^128 - 1
+
+// Parse decimal digits into a big-endian number of len bytes, false if it
+// doesn't fit or a character isn't a digit
+static bool reference_parse(const char* digits, size_t count, uint8_t* number, size_t len) {
+    memset(number, 0, len);
+    for(size_t d = 0; d < count; d++) {
+        if(digits[d] < '0' || digits[d] > '9') return false;
+        uint32_t carry = digits[d] - '0';
+        for(size_t i = len; i-- > 0;) {
+            uint32_t value = number[i] * 10 + carry;
+            number[i] = value & 0xFF;
+            carry = value >> 8;
+        }
+        if(carry) return false;
+    }
+    return true;
+}
+
+// Format uid both ways round and check each result against the reference,
+// stops the test at the first mismatch so a bug doesn't print millions of lines
+static bool check_uid(const uint8_t* uid, uint8_t len) {
+    for(uint8_t flags = 0; flags <= FlipperWedgeFormatReverse; flags += FlipperWedgeFormatReverse) {
+        uint8_t expected[UID_MAX];
+        for(uint8_t i = 0; i < len; i++) {
+            expected[i] = uid[(flags & FlipperWedgeFormatReverse) ? len - 1 - i : i];
+        }
+
+        char digits[DIGITS_MAX + 1];
+        size_t count = flipper_wedge_format_uid_decimal(uid, len, flags, digits, sizeof(digits));
+        uint8_t parsed[UID_MAX];
+        bool ok = count > 0 && count <= DIGITS_MAX && (digits[0] != '0' || count == 1) &&
+                  reference_parse(digits, count, parsed, len) && memcmp(parsed, expected, len) == 0;
+        if(!ok) {
+            digits[MIN(count, DIGITS_MAX)] = '\0';
+            printf("  %u-byte UID, flags %u: \"%s\"\n", len, flags, digits);
+            TEST_ASSERT(ok);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_short_uids_exhaustive(void) {
+    uint8_t uid[3];
+    for(uint32_t value = 0; value < 0x100; value++) {
+        uid[0] = value;
+        if(!check_uid(uid, 1)) return;
+    }
+    for(uint32_t value = 0; value < 0x10000; value++) {
+        uid[0] = value >> 8;
+        uid[1] = value;
+        if(!check_uid(uid, 2)) return;
+    }
+    for(uint32_t value = 0; value < 0x1000000; value++) {
+        uid[0] = value >> 16;
+        uid[1] = value >> 8;
+        uid[2] = value;
+        if(!check_uid(uid, 3)) return;
+    }
+    TEST_ASSERT(true);
+}
+
+// uid = 10^k + delta in len big-endian bytes, false if it doesn't fit
+static bool power_of_ten(uint8_t* uid, uint8_t len, size_t k, int delta) {
+    char digits[DIGITS_MAX + 2];
+    digits[0] = '1';
+    memset(&digits[1], '0', k);
+    if(!reference_parse(digits, k + 1, uid, len)) return false;
+    // Add or subtract 1 with carry
+    for(int step = 0; step < (delta < 0 ? -delta : delta); step++) {
+        for(size_t i = len; i-- > 0;) {
+            uid[i] += (delta > 0) ? 1 : -1;
+            if(uid[i] != ((delta > 0) ? 0x00 : 0xFF)) break;
+        }
+    }
+    return true;
+}
+
+static void test_boundaries(void) {
+    uint8_t uid[UID_MAX];
+    for(uint8_t len = 1; len <= UID_MAX; len++) {
+        // 10^k - 2 ... 10^k + 2, crossing into another digit and, every
+        // nine digits, another limb
+        for(size_t k = 0; k <= DIGITS_MAX; k++) {
+            for(int delta = -2; delta <= 2; delta++) {
+                if(k == 0 && delta < -1) continue;
+                if(!power_of_ten(uid, len, k, delta)) break;
+                if(!check_uid(uid, len)) return;
+            }
+        }
+
+        // Zero, all ones, and one bit set at each position: word boundaries
+        memset(uid, 0, len);
+        if(!check_uid(uid, len)) return;
+        memset(uid, 0xFF, len);
+        if(!check_uid(uid, len)) return;
+        for(size_t bit = 0; bit < len * 8u; bit++) {
+            memset(uid, 0, len);
+            uid[bit / 8] = 0x80 >> (bit % 8);
+            if(!check_uid(uid, len)) return;
+            memset(uid, 0xFF, len);
+            uid[bit / 8] &= ~(0x80 >> (bit % 8));
+            if(!check_uid(uid, len)) return;
+        }
+    }
+
+    // Largest number: 2^128 - 1 has all 39 digits
+    char digits[DIGITS_MAX];
+    memset(uid, 0xFF, UID_MAX);
+    TEST_ASSERT_EQ(flipper_wedge_format_uid_decimal(uid, UID_MAX, 0, digits, sizeof(digits)), DIGITS_MAX);
+    TEST_ASSERT(memcmp(digits, "340282366920938463463374607431768211455", DIGITS_MAX) == 0);
+}
+
+static void test_random_uids(void) {
+    uint32_t seed = 0xDEC1;
+    uint8_t uid[UID_MAX];
+    for(uint8_t len = 4; len <= UID_MAX; len++) {
+        for(size_t round = 0; round < 200000; round++) {
+            for(uint8_t i = 0; i < len; i++) {
+                uint32_t r = test_random(&seed);
+                uid[i] = (r & 0x300) == 0 ? 0x00 : (r & 0x300) == 0x100 ? 0xFF : r & 0xFF;
+            }
+            if(!check_uid(uid, len)) return;
+        }
+    }
+    TEST_ASSERT(true);
+}
+
+static void test_output_size(void) {
+    static const uint8_t uid[] = {0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6};
+    char output[32];
+
+    // 1303689068602870: whole or not at all, nothing written past the size
+    for(size_t size = 0; size < 20; size++) {
+        memset(output, '#', sizeof(output));
+        size_t len = flipper_wedge_format_uid_decimal(uid, sizeof(uid), 0, output, size);
+        if(size < 16) {
+            TEST_ASSERT_EQ(len, 0);
+            TEST_ASSERT(output[0] == '#');
+        } else {
+            TEST_ASSERT_EQ(len, 16);
+            TEST_ASSERT(memcmp(output, "1303689068602870", 16) == 0);
+        }
+        TEST_ASSERT(output[MAX(size, len)] == '#');
+    }
+
+    // Nothing to format
+    TEST_ASSERT_EQ(flipper_wedge_format_uid_decimal(NULL, 4, 0, output, sizeof(output)), 0);
+    TEST_ASSERT_EQ(flipper_wedge_format_uid_decimal(uid, 0, 0, output, sizeof(output)), 0);
+    uint8_t long_uid[UID_MAX + 1] = {0};
+    TEST_ASSERT_EQ(flipper_wedge_format_uid_decimal(long_uid, sizeof(long_uid), 0, output, sizeof(output)), 0);
+}
+
+int main(void) {
+    TEST_RUN(test_short_uids_exhaustive);
+    TEST_RUN(test_boundaries);
+    TEST_RUN(test_random_uids);
+    TEST_RUN(test_output_size);
+
+    return test_report("test_format_decimal");
+}
@@ -0,0 +1,258 @@
+// The pacer against mock hosts with a limited acceptance rate: a BLE
+// central that drops notifications once its queue is full and a USB host
+// whose endpoint blocks until the next poll.
+
+#include "test.h"
+#include "flipper_wedge_hid.h"
+#include "flipper_wedge_hid_pacer.h"
+#include "flipper_wedge_keystream.h"
+
+#define STREAM_MAX 4096
+
+// Central taking one notification per connection interval, with a few buffered
+typedef struct {
+    uint32_t interval_us;
+    uint32_t depth;
+    uint32_t queued;
+    uint64_t drained_us;
+} CentralModel;
+
+static bool central_accept(StubHid sink, uint64_t now_us, void* context) {
+    UNUSED(sink);
+    CentralModel* central = context;
+    uint64_t drained = (now_us - central->drained_us) / central->interval_us;
+    central->queued = (drained >= central->queued) ? 0 : central->queued - drained;
+    central->drained_us += drained * central->interval_us;
+    if(central->queued >= central->depth) return false;
+    if(central->queued++ == 0) central->drained_us = now_us;
+    return true;
+}
+
+static FlipperWedgeHid* hid_alloc_connected(void) {
+    stub_hid_reset();
+    FlipperWedgeHid* hid = flipper_wedge_hid_alloc();
+    flipper_wedge_hid_init_usb(hid);
+    flipper_wedge_hid_init_ble(hid);
+    stub_hid_set_connected(StubHidBle, true);
+    return hid;
+}
+
+static void hid_free(FlipperWedgeHid* hid) {
+    flipper_wedge_hid_deinit_ble(hid);
+    flipper_wedge_hid_deinit_usb(hid);
+    flipper_wedge_hid_free(hid);
+}
+
+static size_t random_text(uint32_t* seed, uint8_t* data, size_t chars) {
+    static char text[STREAM_MAX];
+    for(size_t i = 0; i < chars; i++) {
+        uint32_t r = test_random(seed);
+        text[i] = (r % 9 == 0) ? ' ' : (char)('a' + (r >> 8) % 26);
+    }
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, STREAM_MAX);
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, NULL, text, chars), chars);
+    return stream.len;
+}
+
+// Type like the worker lane does, calls back halfway through
+typedef struct {
+    uint32_t refused;
+    uint32_t sent;
+    uint32_t failed;
+    uint64_t time_us;
+} Half;
+
+static void type_paced(
+    FlipperWedgeHid* hid,
+    FlipperWedgeHidTransport transport,
+    const uint8_t* data,
+    size_t len,
+    Half* first,
+    Half* second) {
+    StubHid sink = (transport == FlipperWedgeHidTransportUsb) ? StubHidUsb : StubHidBle;
+    FlipperWedgeHidCursor cursor;
+    flipper_wedge_hid_cursor_init(&cursor, data, len);
+    Half* half = first;
+    Half start = {0};
+
+    while(!flipper_wedge_hid_cursor_is_done(&cursor)) {
+        flipper_wedge_hid_type_next_report(hid, transport, &cursor);
+        flipper_wedge_hid_pacer_delay(flipper_wedge_hid_get_delay_us(hid, transport));
+
+        bool done = flipper_wedge_hid_cursor_is_done(&cursor);
+        if((half == first && cursor.pos >= len / 2) || done) {
+            Half now = {.refused = stub_hid_get_refused(sink), .time_us = stub_clock_now_us()};
+            flipper_wedge_hid_get_report_stats(hid, transport, &now.sent, &now.failed);
+            half->refused = now.refused - start.refused;
+            half->sent = now.sent - start.sent;
+            half->failed = now.failed - start.failed;
+            half->time_us = now.time_us - start.time_us;
+            start = now;
+            half = second;
+        }
+    }
+}
+
+static size_t decoded_keys(StubHid sink) {
+    static uint16_t keycodes[STREAM_MAX];
+    return stub_hid_decode(sink, keycodes, NULL, STREAM_MAX);
+}
+
+static void test_backoff_and_recovery(void) {
+    FlipperWedgeHidPacer pacer;
+    flipper_wedge_hid_pacer_init(&pacer, FlipperWedgeHidPacerProfileBle);
+    uint32_t initial = flipper_wedge_hid_pacer_get_delay_us(&pacer);
+
+    // A refusal doubles the delay, the stable delay stays where it held
+    flipper_wedge_hid_pacer_feedback(&pacer, false);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), initial * 2);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_stable_delay_us(&pacer), initial);
+
+    // A clean run shaves an eighth and marks the delay stable
+    for(int i = 0; i < 16; i++) {
+        flipper_wedge_hid_pacer_feedback(&pacer, true);
+    }
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_stable_delay_us(&pacer), initial * 2);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), initial * 2 - initial / 4);
+
+    // More refusals in the same burst are the same congestion
+    flipper_wedge_hid_pacer_begin_burst(&pacer);
+    uint32_t before = flipper_wedge_hid_pacer_get_delay_us(&pacer);
+    flipper_wedge_hid_pacer_feedback(&pacer, false);
+    flipper_wedge_hid_pacer_feedback(&pacer, false);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), before * 2);
+
+    // Refusals in every burst stop at the profile maximum
+    for(int i = 0; i < 32; i++) {
+        flipper_wedge_hid_pacer_begin_burst(&pacer);
+        flipper_wedge_hid_pacer_feedback(&pacer, false);
+    }
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), 250000);
+
+    // Seeds are clamped to the profile limits
+    flipper_wedge_hid_pacer_seed(&pacer, 0, 0);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), 500);
+    flipper_wedge_hid_pacer_seed(&pacer, UINT32_MAX, 1000);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), 250000);
+
+    // A delay learned with many refusals starts a step slower
+    flipper_wedge_hid_pacer_seed(&pacer, 7000, 10);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), 7000);
+    flipper_wedge_hid_pacer_seed(&pacer, 7000, 11);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), 7500);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_stable_delay_us(&pacer), 7500);
+}
+
+static void test_blocked_submissions(void) {
+    FlipperWedgeHidPacer pacer;
+
+    // BLE refuses instead of blocking, waits are not its signal
+    flipper_wedge_hid_pacer_init(&pacer, FlipperWedgeHidPacerProfileBle);
+    uint32_t initial = flipper_wedge_hid_pacer_get_delay_us(&pacer);
+    flipper_wedge_hid_pacer_feedback_blocked(&pacer, 5000);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), initial);
+
+    // USB creeps up a step per blocked report, short calls don't count
+    flipper_wedge_hid_pacer_init(&pacer, FlipperWedgeHidPacerProfileUsb);
+    initial = flipper_wedge_hid_pacer_get_delay_us(&pacer);
+    flipper_wedge_hid_pacer_feedback_blocked(&pacer, 100);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), initial);
+    flipper_wedge_hid_pacer_feedback_blocked(&pacer, 900);
+    flipper_wedge_hid_pacer_feedback_blocked(&pacer, 900);
+    TEST_ASSERT_EQ(flipper_wedge_hid_pacer_get_delay_us(&pacer), initial + 500);
+    TEST_ASSERT_EQ(pacer.reports_blocked, 2);
+    TEST_ASSERT_EQ(pacer.reports_failed, 0);
+}
+
+// The radio core buffers 8 notifications, the central takes one per
+// connection interval: the pacer has to find the central's rate from
+// refusals and then stay under it
+static void check_ble_central(uint32_t interval_us, uint32_t seed) {
+    static uint8_t data[STREAM_MAX];
+    CentralModel central = {.interval_us = interval_us, .depth = 8};
+
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    stub_hid_set_accept(StubHidBle, central_accept, &central);
+    size_t len = random_text(&seed, data, 1000);
+    Half first, second;
+    type_paced(hid, FlipperWedgeHidTransportBle, data, len, &first, &second);
+
+    TEST_ASSERT_EQ(decoded_keys(StubHidBle), 1000);
+    TEST_ASSERT(first.refused > 0);
+    // Converged: under 5% refused and over 60% of the central's rate
+    uint32_t accepted = second.sent - second.refused;
+    uint64_t capacity = second.time_us / interval_us;
+    TEST_ASSERT(second.refused * 20 < second.sent);
+    TEST_ASSERT(accepted > capacity * 6 / 10);
+    printf(
+        "    %lu us interval: refused %lu then %lu of %lu, %lu of %llu notifications, delay %lu us\n",
+        (unsigned long)interval_us,
+        (unsigned long)first.refused,
+        (unsigned long)second.refused,
+        (unsigned long)second.sent,
+        (unsigned long)accepted,
+        (unsigned long long)capacity,
+        (unsigned long)flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportBle));
+    hid_free(hid);
+}
+
+static void test_ble_limited_acceptance(void) {
+    check_ble_central(7500, 0x1234567);
+    check_ble_central(30000, 0x2345678);
+}
+
+// Endpoint polled every 2 ms: nothing is refused, the wait in the call is
+// the only signal, the delay must grow to the poll interval
+static void test_usb_poll_interval(void) {
+    static uint8_t data[STREAM_MAX];
+    uint32_t seed = 0x7654321;
+
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    stub_hid_set_poll_interval(StubHidUsb, 2000);
+    size_t len = random_text(&seed, data, 1000);
+    Half first, second;
+    type_paced(hid, FlipperWedgeHidTransportUsb, data, len, &first, &second);
+
+    TEST_ASSERT_EQ(decoded_keys(StubHidUsb), 1000);
+    TEST_ASSERT_EQ(first.refused + second.refused, 0);
+    uint32_t delay_us = flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportUsb);
+    TEST_ASSERT(delay_us >= 1500 && delay_us <= 3000);
+    // Typing speed is still the host's: one submission per poll
+    TEST_ASSERT(second.sent * 2000ULL <= second.time_us * 11 / 10);
+    TEST_ASSERT(second.sent * 2000ULL >= second.time_us * 7 / 10);
+    printf(
+        "    delay %lu us, %lu submissions in %llu ms\n",
+        (unsigned long)delay_us,
+        (unsigned long)second.sent,
+        (unsigned long long)second.time_us / 1000);
+    hid_free(hid);
+}
+
+// A host that takes reports as fast as they come needs no delay at all
+static void test_usb_fast_host(void) {
+    static uint8_t data[STREAM_MAX];
+    uint32_t seed = 0xABCDEF;
+
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    stub_hid_set_call_us(StubHidUsb, 20);
+    size_t len = random_text(&seed, data, 1000);
+    Half first, second;
+    type_paced(hid, FlipperWedgeHidTransportUsb, data, len, &first, &second);
+
+    TEST_ASSERT_EQ(decoded_keys(StubHidUsb), 1000);
+    TEST_ASSERT_EQ(flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportUsb), 0);
+    hid_free(hid);
+}
+
+int main(void) {
+    stub_clock_set_virtual(true);
+
+    TEST_RUN(test_backoff_and_recovery);
+    TEST_RUN(test_blocked_submissions);
+    TEST_RUN(test_ble_limited_acceptance);
+    TEST_RUN(test_usb_poll_interval);
+    TEST_RUN(test_usb_fast_host);
+
+    return test_report("test_hid_pacer");
+}
@@ -0,0 +1,193 @@
+// Pacing profiles in pacing.conf: one per BLE host keyed on its identity
+// address, the least recently saved BLE host evicted past the limit, the
+// profile picked by the peer of the connection event, and a high saved drop
+// rate starting the pacer a step slower.
+
+#include "test.h"
+#include "flipper_wedge_hid.h"
+#include "flipper_wedge_hid_pacing.h"
+
+static const uint8_t host_a[6] = {0x66, 0x55, 0x44, 0x33, 0x22, 0x11};
+static const uint8_t host_b[6] = {0x01, 0x02, 0x03, 0x04, 0x05, 0xC6}; // Static random
+static const uint8_t host_rpa[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0x4F}; // Private
+
+static void pacing_file_remove(void) {
+    remove(stub_storage_host_path(FLIPPER_WEDGE_HID_PACING_PATH));
+}
+
+static bool pacing_file_contains(const char* text) {
+    static char content[4096];
+    FILE* file = fopen(stub_storage_host_path(FLIPPER_WEDGE_HID_PACING_PATH), "rb");
+    if(!file) return false;
+    size_t len = fread(content, 1, sizeof(content) - 1, file);
+    fclose(file);
+    content[len] = '\0';
+    return strstr(content, text) != NULL;
+}
+
+static void host_id_of(uint8_t n, char* host_id) {
+    const uint8_t address[6] = {n, 0, 0, 0, 0, 0x10};
+    flipper_wedge_hid_pacing_ble_host_id(address, host_id);
+}
+
+static bool save_profile(const char* host_id, uint32_t delay_us, uint32_t drop_per_mille) {
+    FlipperWedgeHidPacingProfile profile = {
+        .delay_us = delay_us, .drop_per_mille = drop_per_mille, .reports = 100};
+    return flipper_wedge_hid_pacing_save(host_id, &profile);
+}
+
+static bool save_delay(const char* host_id, uint32_t delay_us) {
+    return save_profile(host_id, delay_us, 5);
+}
+
+static uint32_t load_delay(const char* host_id) {
+    FlipperWedgeHidPacingProfile profile;
+    return flipper_wedge_hid_pacing_load(host_id, &profile) ? profile.delay_us : 0;
+}
+
+static void test_ble_host_id(void) {
+    char host_id[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    flipper_wedge_hid_pacing_ble_host_id(host_a, host_id);
+    TEST_ASSERT_STR(host_id, "Ble112233445566");
+
+    TEST_ASSERT(!flipper_wedge_hid_pacing_is_private_address(0x00, host_a));
+    TEST_ASSERT(!flipper_wedge_hid_pacing_is_private_address(0x01, host_b));
+    TEST_ASSERT(flipper_wedge_hid_pacing_is_private_address(0x01, host_rpa));
+    // Public address that happens to have the private bit pattern
+    TEST_ASSERT(!flipper_wedge_hid_pacing_is_private_address(0x00, host_rpa));
+}
+
+static void test_profile_per_host(void) {
+    pacing_file_remove();
+    char usb[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    char a[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    char b[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    flipper_wedge_hid_pacing_usb_host_id(usb);
+    flipper_wedge_hid_pacing_ble_host_id(host_a, a);
+    flipper_wedge_hid_pacing_ble_host_id(host_b, b);
+
+    TEST_ASSERT(save_delay(a, 3000));
+    TEST_ASSERT(save_delay(usb, 500));
+    TEST_ASSERT(save_delay(b, 9000));
+    TEST_ASSERT(save_delay(a, 4000));
+
+    TEST_ASSERT_EQ(load_delay(usb), 500);
+    TEST_ASSERT_EQ(load_delay(a), 4000);
+    TEST_ASSERT_EQ(load_delay(b), 9000);
+}
+
+static void test_least_recent_ble_host_evicted(void) {
+    pacing_file_remove();
+    char usb[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    char host_id[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    flipper_wedge_hid_pacing_usb_host_id(usb);
+    TEST_ASSERT(save_delay(usb, 500));
+
+    const uint8_t hosts = FLIPPER_WEDGE_HID_PACING_BLE_HOSTS_MAX + 2;
+    for(uint8_t n = 0; n < hosts; n++) {
+        host_id_of(n, host_id);
+        TEST_ASSERT(save_delay(host_id, 1000 + n));
+    }
+    for(uint8_t n = 0; n < hosts; n++) {
+        host_id_of(n, host_id);
+        TEST_ASSERT_EQ(load_delay(host_id), n < 2 ? 0 : 1000 + n);
+    }
+    TEST_ASSERT_EQ(load_delay(usb), 500);
+
+    // Saving again makes a host the most recent one
+    host_id_of(2, host_id);
+    TEST_ASSERT(save_delay(host_id, 2002));
+    host_id_of(hosts, host_id);
+    TEST_ASSERT(save_delay(host_id, 1000 + hosts));
+    host_id_of(2, host_id);
+    TEST_ASSERT_EQ(load_delay(host_id), 2002);
+    host_id_of(3, host_id);
+    TEST_ASSERT_EQ(load_delay(host_id), 0);
+    TEST_ASSERT(!pacing_file_contains(host_id));
+}
+
+static void test_old_format_replaced(void) {
+    // Version 1 keyed every bonded central on a hash of the bond key file
+    FILE* file = fopen(stub_storage_host_path(FLIPPER_WEDGE_HID_PACING_PATH), "wb");
+    TEST_ASSERT(file);
+    if(!file) return;
+    fputs("Filetype: FlipperWedge Pacing\nVersion: 1\nBle1A2B3C4D: 3000 0 100\n", file);
+    fclose(file);
+
+    char a[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    flipper_wedge_hid_pacing_ble_host_id(host_a, a);
+    TEST_ASSERT_EQ(load_delay("Ble1A2B3C4D"), 0);
+    TEST_ASSERT(save_delay(a, 6000));
+    TEST_ASSERT_EQ(load_delay(a), 6000);
+    TEST_ASSERT(!pacing_file_contains("Ble1A2B3C4D"));
+}
+
+static void connect(uint8_t address_type, const uint8_t* address) {
+    stub_hid_set_connected(StubHidBle, false);
+    stub_ble_connect_event(address_type, address);
+    stub_hid_set_connected(StubHidBle, true);
+}
+
+static void test_profile_follows_peer(void) {
+    pacing_file_remove();
+    char a[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    char b[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    flipper_wedge_hid_pacing_ble_host_id(host_a, a);
+    flipper_wedge_hid_pacing_ble_host_id(host_b, b);
+    TEST_ASSERT(save_delay(a, 7000));
+    TEST_ASSERT(save_delay(b, 9000));
+
+    stub_hid_reset();
+    FlipperWedgeHid* hid = flipper_wedge_hid_alloc();
+    flipper_wedge_hid_init_ble(hid);
+
+    connect(0x00, host_a);
+    flipper_wedge_hid_restore_pacing(hid, FlipperWedgeHidTransportBle);
+    TEST_ASSERT_EQ(flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportBle), 7000);
+
+    connect(0x01, host_b);
+    flipper_wedge_hid_restore_pacing(hid, FlipperWedgeHidTransportBle);
+    TEST_ASSERT_EQ(flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportBle), 9000);
+
+    // A private address is looked up once the stack can resolve it
+    connect(0x01, host_rpa);
+    flipper_wedge_hid_restore_pacing(hid, FlipperWedgeHidTransportBle);
+    TEST_ASSERT_EQ(flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportBle), 9000);
+    stub_ble_add_bond(host_rpa, host_a);
+    flipper_wedge_hid_restore_pacing(hid, FlipperWedgeHidTransportBle);
+    TEST_ASSERT_EQ(flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportBle), 7000);
+
+    flipper_wedge_hid_deinit_ble(hid);
+    flipper_wedge_hid_free(hid);
+}
+
+static void test_drop_rate_restored(void) {
+    pacing_file_remove();
+    char a[FLIPPER_WEDGE_HID_PACING_HOST_ID_LEN];
+    flipper_wedge_hid_pacing_ble_host_id(host_a, a);
+    // 5% of the reports refused while 7 ms was learned: a step above it
+    TEST_ASSERT(save_profile(a, 7000, 50));
+
+    stub_hid_reset();
+    FlipperWedgeHid* hid = flipper_wedge_hid_alloc();
+    flipper_wedge_hid_init_ble(hid);
+    connect(0x00, host_a);
+    flipper_wedge_hid_restore_pacing(hid, FlipperWedgeHidTransportBle);
+    TEST_ASSERT_EQ(flipper_wedge_hid_get_delay_us(hid, FlipperWedgeHidTransportBle), 7500);
+
+    flipper_wedge_hid_deinit_ble(hid);
+    flipper_wedge_hid_free(hid);
+}
+
+int main(void) {
+    stub_clock_set_virtual(true);
+
+    TEST_RUN(test_ble_host_id);
+    TEST_RUN(test_profile_per_host);
+    TEST_RUN(test_least_recent_ble_host_evicted);
+    TEST_RUN(test_old_format_replaced);
+    TEST_RUN(test_profile_follows_peer);
+    TEST_RUN(test_drop_rate_restored);
+
+    return test_report("test_hid_pacing");
+}
@@ -0,0 +1,390 @@
+// Packed reports decode back to the keystrokes they were packed from:
+// keystreams are typed report by report into the stub sinks, and the
+// reports the host received are turned back into key presses.
+
+#include "test.h"
+#include "flipper_wedge_hid.h"
+#include "flipper_wedge_hid_report.h"
+#include "flipper_wedge_keystream.h"
+
+#define STREAM_MAX 16384
+
+typedef struct {
+    uint16_t keycodes[STREAM_MAX];
+    bool released[STREAM_MAX]; // A release point comes right before the key
+    size_t count;
+} Expected;
+
+// What a host should see: one press per usage, with the modifiers in effect
+static void expected_from_stream(const uint8_t* data, size_t len, Expected* expected) {
+    uint8_t modifiers = 0;
+    bool release = true;
+    expected->count = 0;
+    for(size_t i = 0; i < len; i++) {
+        if(data[i] == FLIPPER_WEDGE_KEYSTREAM_RELEASE) {
+            release = true;
+        } else if(flipper_wedge_keystream_is_modifier(data[i])) {
+            modifiers = flipper_wedge_keystream_get_modifiers(data[i]);
+        } else {
+            expected->keycodes[expected->count] = data[i] | (modifiers << 8);
+            expected->released[expected->count] = release;
+            expected->count++;
+            release = false;
+        }
+    }
+}
+
+static void type_stream(FlipperWedgeHid* hid, FlipperWedgeHidTransport transport, const uint8_t* data, size_t len) {
+    FlipperWedgeHidCursor cursor;
+    flipper_wedge_hid_cursor_init(&cursor, data, len);
+    size_t reports = 0;
+    while(!flipper_wedge_hid_cursor_is_done(&cursor)) {
+        flipper_wedge_hid_type_next_report(hid, transport, &cursor);
+        furi_check(++reports <= len);
+    }
+}
+
+// Decode the sink and compare with the stream, returns the reports used
+static size_t check_round_trip(StubHid sink, const uint8_t* data, size_t len) {
+    static Expected expected;
+    static uint16_t decoded[STREAM_MAX];
+    static bool released[STREAM_MAX];
+
+    expected_from_stream(data, len, &expected);
+    size_t count = stub_hid_decode(sink, decoded, released, STREAM_MAX);
+
+    TEST_ASSERT_EQ(count, expected.count);
+    size_t mismatches = 0;
+    for(size_t i = 0; i < MIN(count, expected.count); i++) {
+        if(decoded[i] != expected.keycodes[i] || (expected.released[i] && !released[i])) {
+            if(mismatches++ < 5) {
+                fprintf(
+                    stderr,
+                    "  key %zu: got %04X%s, expected %04X%s\n",
+                    i,
+                    decoded[i],
+                    released[i] ? " after release" : "",
+                    expected.keycodes[i],
+                    expected.released[i] ? " after release" : "");
+            }
+        }
+    }
+    TEST_ASSERT_EQ(mismatches, 0);
+
+    // Nothing may stay down on the host once the stream is done
+    size_t reports;
+    const StubHidReport* log = stub_hid_get_reports(sink, &reports);
+    TEST_ASSERT(reports > 0);
+    if(reports > 0) {
+        const StubHidReport* last = &log[reports - 1];
+        TEST_ASSERT_EQ(last->modifiers, 0);
+        for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+            TEST_ASSERT_EQ(last->keys[i], 0);
+        }
+    }
+    return reports;
+}
+
+static FlipperWedgeHid* hid_alloc_connected(void) {
+    stub_hid_reset();
+    FlipperWedgeHid* hid = flipper_wedge_hid_alloc();
+    flipper_wedge_hid_init_usb(hid);
+    flipper_wedge_hid_init_ble(hid);
+    stub_hid_set_connected(StubHidBle, true);
+    return hid;
+}
+
+static void hid_free(FlipperWedgeHid* hid) {
+    flipper_wedge_hid_deinit_ble(hid);
+    flipper_wedge_hid_deinit_usb(hid);
+    flipper_wedge_hid_free(hid);
+}
+
+// Random usages, modifier changes, repeats and release points
+static size_t random_stream(uint32_t* seed, uint8_t* data, size_t size) {
+    static const uint16_t modifiers[] = {
+        0,
+        KEY_MOD_LEFT_SHIFT,
+        KEY_MOD_RIGHT_ALT,
+        KEY_MOD_LEFT_CTRL | KEY_MOD_LEFT_SHIFT,
+        KEY_MOD_LEFT_ALT,
+    };
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, size);
+    uint16_t modifier = 0;
+    uint8_t usage = HID_KEYBOARD_A;
+
+    while(stream.len + 3 < size) {
+        uint32_t r = test_random(seed);
+        if(r % 17 == 0) {
+            flipper_wedge_keystream_append_key(&stream, FLIPPER_WEDGE_KEYSTREAM_RELEASE);
+            continue;
+        }
+        if(r % 7 == 0) modifier = modifiers[(r >> 8) % COUNT_OF(modifiers)];
+        // Every fifth key repeats the last one, the host must see it twice
+        if(r % 5 != 0) usage = HID_KEYBOARD_A + (r >> 16) % 50;
+        flipper_wedge_keystream_append_key(&stream, usage | modifier);
+    }
+    return stream.len;
+}
+
+static void test_random_streams_usb(void) {
+    static uint8_t data[STREAM_MAX];
+    uint32_t seed = 0x2545F491;
+    for(int round = 0; round < 50; round++) {
+        FlipperWedgeHid* hid = hid_alloc_connected();
+        size_t len = random_stream(&seed, data, 200 + round * 40);
+        type_stream(hid, FlipperWedgeHidTransportUsb, data, len);
+        check_round_trip(StubHidUsb, data, len);
+        hid_free(hid);
+    }
+}
+
+static void test_random_streams_ble(void) {
+    static uint8_t data[STREAM_MAX];
+    uint32_t seed = 0x9E3779B9;
+    for(int round = 0; round < 20; round++) {
+        FlipperWedgeHid* hid = hid_alloc_connected();
+        size_t len = random_stream(&seed, data, 1000);
+        type_stream(hid, FlipperWedgeHidTransportBle, data, len);
+        check_round_trip(StubHidBle, data, len);
+        hid_free(hid);
+    }
+}
+
+// Every third submission is refused, retries and the cumulative reports
+// must still get every key across
+static bool refuse_every_third(StubHid sink, uint64_t now_us, void* context) {
+    uint32_t* calls = context;
+    return (++*calls % 3) != 0;
+}
+
+static void test_random_streams_lossy_ble(void) {
+    static uint8_t data[STREAM_MAX];
+    uint32_t seed = 0xDEADBEEF;
+    for(int round = 0; round < 10; round++) {
+        FlipperWedgeHid* hid = hid_alloc_connected();
+        uint32_t calls = 0;
+        stub_hid_set_accept(StubHidBle, refuse_every_third, &calls);
+        size_t len = random_stream(&seed, data, 1000);
+        type_stream(hid, FlipperWedgeHidTransportBle, data, len);
+        check_round_trip(StubHidBle, data, len);
+        TEST_ASSERT(stub_hid_get_refused(StubHidBle) > 0);
+        hid_free(hid);
+    }
+}
+
+// Text through a layout, returns the number of reports
+static size_t type_text(FlipperWedgeKeyboardLayout* layout, const char* text) {
+    static uint8_t data[STREAM_MAX];
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, text, strlen(text)), strlen(text));
+    flipper_wedge_keystream_append_key(&stream, HID_KEYBOARD_RETURN);
+
+    type_stream(hid, FlipperWedgeHidTransportUsb, stream.data, stream.len);
+    size_t reports = check_round_trip(StubHidUsb, stream.data, stream.len);
+    hid_free(hid);
+    return reports;
+}
+
+// A key the host should see, and whether everything was up before it
+typedef struct {
+    uint16_t keycode;
+    bool released;
+} HostKey;
+
+// Text through a layout, the host must see exactly keys and nothing held after
+static void check_host_keys(
+    FlipperWedgeKeyboardLayout* layout,
+    const char* text,
+    const HostKey* keys,
+    size_t count) {
+    static uint8_t data[STREAM_MAX];
+    static uint16_t decoded[STREAM_MAX];
+    static bool released[STREAM_MAX];
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, text, strlen(text)), strlen(text));
+    type_stream(hid, FlipperWedgeHidTransportUsb, stream.data, stream.len);
+    check_round_trip(StubHidUsb, stream.data, stream.len);
+
+    TEST_ASSERT_EQ(stub_hid_decode(StubHidUsb, decoded, released, STREAM_MAX), count);
+    for(size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQ(decoded[i], keys[i].keycode);
+        TEST_ASSERT_EQ(released[i], keys[i].released);
+    }
+    hid_free(hid);
+}
+
+static void test_text_default_layout(void) {
+    // Distinct keys share reports, modifier changes and repeats split them
+    size_t reports = type_text(NULL, "abcdef");
+    // One report per press while packing, then the release
+    TEST_ASSERT_EQ(reports, 6 + 1 + 2);
+    type_text(NULL, "Hello, World! aaa bbb 0123456789 ~!@#$%^&*()_+");
+}
+
+static void test_text_dead_keys(void) {
+    // Dead key then Space, keycodes by US legend of the key
+    static const struct {
+        FlipperWedgeLayoutType type;
+        char c;
+        uint16_t dead_key;
+    } dead_keys[] = {
+        {FlipperWedgeLayoutQwertz, '^', 0x35},
+        {FlipperWedgeLayoutQwertz, '`', 0x2E | KEY_MOD_LEFT_SHIFT},
+        {FlipperWedgeLayoutAzerty, '`', 0x24 | KEY_MOD_RIGHT_ALT},
+        {FlipperWedgeLayoutAzerty, '~', 0x1F | KEY_MOD_RIGHT_ALT},
+        {FlipperWedgeLayoutHungarian, '^', 0x20 | KEY_MOD_RIGHT_ALT},
+        {FlipperWedgeLayoutHungarian, '`', 0x24 | KEY_MOD_RIGHT_ALT},
+        {FlipperWedgeLayoutHungarian, '~', 0x1E | KEY_MOD_RIGHT_ALT},
+    };
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    for(size_t i = 0; i < COUNT_OF(dead_keys); i++) {
+        flipper_wedge_keyboard_layout_set_builtin(layout, dead_keys[i].type);
+        uint16_t keys[FLIPPER_WEDGE_LAYOUT_STROKES_MAX];
+        TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_get_keys(layout, dead_keys[i].c, keys), 2);
+        TEST_ASSERT_EQ(keys[0], dead_keys[i].dead_key);
+        TEST_ASSERT_EQ(keys[1], HID_KEYBOARD_SPACEBAR);
+    }
+
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutQwertz);
+    type_text(layout, "a^b`c^^ x^y");
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutAzerty);
+    type_text(layout, "a`b~c~~ x`y");
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutHungarian);
+    type_text(layout, "a^b`c~~ x^y");
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+// Windows Alt codes keep Left Alt down across reports until the release point
+static void test_text_windows_alt_codes(void) {
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeWindows);
+
+    // U+20AC twice: Alt held over KP+ KP2 KP0 a c, Alt up enters it
+    static const HostKey euro_twice[] = {
+        {0x57 | KEY_MOD_LEFT_ALT, true}, // KP+
+        {0x5A | KEY_MOD_LEFT_ALT, false}, // KP2
+        {0x62 | KEY_MOD_LEFT_ALT, false}, // KP0
+        {0x04 | KEY_MOD_LEFT_ALT, false}, // a
+        {0x06 | KEY_MOD_LEFT_ALT, false}, // c
+        {0x57 | KEY_MOD_LEFT_ALT, true},
+        {0x5A | KEY_MOD_LEFT_ALT, false},
+        {0x62 | KEY_MOD_LEFT_ALT, false},
+        {0x04 | KEY_MOD_LEFT_ALT, false},
+        {0x06 | KEY_MOD_LEFT_ALT, false},
+    };
+    check_host_keys(layout, "\xE2\x82\xAC\xE2\x82\xAC", euro_twice, COUNT_OF(euro_twice));
+    const char* text = "Zo\xC3\xAB \xE2\x82\xAC\xE2\x82\xAC \xF0\x9F\x98\x80!";
+    type_text(layout, text);
+
+    // Check Alt was never seen up inside a code
+    static uint8_t data[STREAM_MAX];
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    flipper_wedge_keystream_append(&stream, layout, text, strlen(text));
+    type_stream(hid, FlipperWedgeHidTransportUsb, stream.data, stream.len);
+
+    static uint16_t decoded[STREAM_MAX];
+    static bool released[STREAM_MAX];
+    size_t count = stub_hid_decode(StubHidUsb, decoded, released, STREAM_MAX);
+    size_t alt_keys = 0;
+    for(size_t i = 1; i < count; i++) {
+        bool alt = decoded[i] & KEY_MOD_LEFT_ALT;
+        bool alt_before = decoded[i - 1] & KEY_MOD_LEFT_ALT;
+        // KP+ opens a code, any other Alt key continues the previous one
+        if(alt && alt_before && (decoded[i] & 0xFF) != 0x57) {
+            TEST_ASSERT(!released[i]);
+            alt_keys++;
+        }
+    }
+    TEST_ASSERT(alt_keys > 10);
+
+    hid_free(hid);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+static void test_text_linux_unicode(void) {
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeLinux);
+
+    // U+20AC: Ctrl+Shift+U, the hex digits with Ctrl+Shift up, Space
+    static const HostKey euro[] = {
+        {0x18 | KEY_MOD_LEFT_CTRL | KEY_MOD_LEFT_SHIFT, true}, // U
+        {0x1F, true}, // 2
+        {0x27, false}, // 0
+        {0x04, false}, // a
+        {0x06, false}, // c
+        {HID_KEYBOARD_SPACEBAR, false},
+    };
+    check_host_keys(layout, "\xE2\x82\xAC", euro, COUNT_OF(euro));
+
+    type_text(layout, "na\xC3\xAFve \xE2\x82\xAC 100");
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+// Long accented text through a text session: compiled a few characters at a
+// time, the host must see the same keys as from the stream compiled whole
+static void check_text_session(FlipperWedgeKeyboardLayout* layout, const char* text) {
+    static uint8_t data[FLIPPER_WEDGE_KEYSTREAM_SIZE(1000)];
+    static FlipperWedgeHidText session;
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, text, strlen(text)), strlen(text));
+    flipper_wedge_keystream_append_key(&stream, HID_KEYBOARD_RETURN);
+
+    FlipperWedgeHid* hid = hid_alloc_connected();
+    flipper_wedge_hid_text_init(&session, layout, text, strlen(text), true);
+    TEST_ASSERT_EQ(session.total, 1000 + 1);
+    size_t reports = 0;
+    size_t typed = 0;
+    while(!flipper_wedge_hid_text_is_done(&session) && ++reports <= stream.len) {
+        flipper_wedge_hid_type_next_text_report(hid, FlipperWedgeHidTransportUsb, &session);
+        TEST_ASSERT(session.typed >= typed && session.typed <= session.total);
+        typed = session.typed;
+    }
+    TEST_ASSERT_EQ(session.typed, session.total);
+    TEST_ASSERT_EQ(session.cursor.typed, stream.keys);
+    check_round_trip(StubHidUsb, stream.data, stream.len);
+    hid_free(hid);
+}
+
+static void test_text_session(void) {
+    static const char* const pieces[] = {"a", "Z", "^", " ", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"};
+    static char text[1000 * 4 + 1];
+    uint32_t seed = 0x31415926;
+    size_t len = 0;
+    for(int i = 0; i < 1000; i++) {
+        const char* piece = pieces[test_random(&seed) % COUNT_OF(pieces)];
+        strcpy(text + len, piece);
+        len += strlen(piece);
+    }
+
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutQwertz);
+    for(FlipperWedgeUnicodeMode mode = 0; mode < FlipperWedgeUnicodeCount; mode++) {
+        flipper_wedge_keyboard_layout_set_unicode_mode(layout, mode);
+        check_text_session(layout, text);
+    }
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+int main(void) {
+    stub_clock_set_virtual(true);
+
+    TEST_RUN(test_random_streams_usb);
+    TEST_RUN(test_random_streams_ble);
+    TEST_RUN(test_random_streams_lossy_ble);
+    TEST_RUN(test_text_default_layout);
+    TEST_RUN(test_text_dead_keys);
+    TEST_RUN(test_text_windows_alt_codes);
+    TEST_RUN(test_text_linux_unicode);
+    TEST_RUN(test_text_session);
+
+    return test_report("test_hid_report");
+}
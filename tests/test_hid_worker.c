@@ -0,0 +1,255 @@
+// The typing worker on its own thread against the stub sinks: jobs queued
+// from the test thread, typed on USB, BLE or both, cancelled mid-job.
+// Runs on the real clock, the sinks' timings are real sleeps.
+
+#include "test.h"
+#include "flipper_wedge_hid_worker.h"
+
+#define KEYS_MAX 8192
+
+// Wait for the worker to finish everything queued, false on timeout
+static bool wait_idle(FlipperWedgeHidWorker* worker, uint32_t timeout_ms) {
+    for(uint32_t ms = 0; ms < timeout_ms; ms++) {
+        if(!flipper_wedge_hid_worker_is_busy(worker)) return true;
+        furi_delay_ms(1);
+    }
+    return false;
+}
+
+static size_t decoded_keys(StubHid sink, uint16_t* keycodes) {
+    return stub_hid_decode(sink, keycodes, NULL, KEYS_MAX);
+}
+
+// BLE only types once the worker brought the profile up and saw the connection
+static FlipperWedgeHidWorker* worker_start(FlipperWedgeHidWorkerMode mode) {
+    FlipperWedgeHidWorker* worker = flipper_wedge_hid_worker_alloc();
+    flipper_wedge_hid_worker_start(worker, mode);
+    if(mode == FlipperWedgeHidWorkerModeBle || mode == FlipperWedgeHidWorkerModeUsbBle) {
+        FlipperWedgeHid* hid = flipper_wedge_hid_worker_get_hid(worker);
+        for(uint32_t ms = 0; ms < 2000 && !flipper_wedge_hid_is_bt_connected(hid); ms++) {
+            stub_hid_set_connected(StubHidBle, true);
+            furi_delay_ms(1);
+        }
+    }
+    return worker;
+}
+
+// Keys the firmware default layout types for ASCII text
+static bool check_ascii_keys(StubHid sink, const char* text, bool append_enter) {
+    static uint16_t keycodes[KEYS_MAX];
+    size_t len = strlen(text);
+    size_t count = decoded_keys(sink, keycodes);
+    bool ok = (count == len + (append_enter ? 1 : 0));
+    for(size_t i = 0; ok && i < len; i++) {
+        ok = (keycodes[i] == HID_ASCII_TO_KEY(text[i]));
+    }
+    if(ok && append_enter) ok = (keycodes[len] == HID_KEYBOARD_RETURN);
+    return ok;
+}
+
+// Each mode types on its own sinks and nowhere else
+static void test_types_on_each_transport(void) {
+    static const struct {
+        FlipperWedgeHidWorkerMode mode;
+        bool usb;
+        bool ble;
+    } cases[] = {
+        {FlipperWedgeHidWorkerModeUsb, true, false},
+        {FlipperWedgeHidWorkerModeBle, false, true},
+        {FlipperWedgeHidWorkerModeUsbBle, true, true},
+    };
+    const char* text = "Hello, World! 0123 ~{}";
+    static uint16_t keycodes[KEYS_MAX];
+
+    for(size_t i = 0; i < COUNT_OF(cases); i++) {
+        stub_hid_reset();
+        FlipperWedgeHidWorker* worker = worker_start(cases[i].mode);
+
+        TEST_ASSERT(flipper_wedge_hid_worker_type(worker, NULL, text, true));
+        TEST_ASSERT(wait_idle(worker, 5000));
+        if(cases[i].usb) {
+            TEST_ASSERT(check_ascii_keys(StubHidUsb, text, true));
+        } else {
+            TEST_ASSERT_EQ(decoded_keys(StubHidUsb, keycodes), 0);
+        }
+        if(cases[i].ble) {
+            TEST_ASSERT(check_ascii_keys(StubHidBle, text, true));
+        } else {
+            TEST_ASSERT_EQ(decoded_keys(StubHidBle, keycodes), 0);
+        }
+
+        // Progress of the last job holds, in characters with Enter as one
+        size_t typed, total;
+        flipper_wedge_hid_worker_get_progress(worker, &typed, &total);
+        TEST_ASSERT_EQ(total, strlen(text) + 1);
+        TEST_ASSERT_EQ(typed, total);
+
+        flipper_wedge_hid_worker_free(worker);
+    }
+}
+
+// A BLE central taking a report every few milliseconds doesn't hold back
+// the USB host, each lane is paced by its own transport
+static void test_slow_ble_does_not_hold_back_usb(void) {
+    static char text[201];
+    static uint16_t keycodes[KEYS_MAX];
+    for(size_t i = 0; i < sizeof(text) - 1; i++) {
+        text[i] = (char)('a' + i % 26);
+    }
+    text[sizeof(text) - 1] = '\0';
+
+    stub_hid_reset();
+    FlipperWedgeHidWorker* worker = worker_start(FlipperWedgeHidWorkerModeUsbBle);
+    stub_hid_set_call_us(StubHidBle, 3000);
+
+    TEST_ASSERT(flipper_wedge_hid_worker_type(worker, NULL, text, false));
+    for(uint32_t ms = 0; ms < 5000 && decoded_keys(StubHidUsb, keycodes) < 200; ms++) {
+        furi_delay_ms(1);
+    }
+    TEST_ASSERT(check_ascii_keys(StubHidUsb, text, false));
+    TEST_ASSERT(decoded_keys(StubHidBle, keycodes) < 100);
+    TEST_ASSERT(flipper_wedge_hid_worker_is_busy(worker));
+
+    TEST_ASSERT(wait_idle(worker, 10000));
+    TEST_ASSERT(check_ascii_keys(StubHidBle, text, false));
+
+    flipper_wedge_hid_worker_free(worker);
+}
+
+// A disconnected transport drops the job, the queue doesn't stall on it
+static void test_disconnected_ble_drops_job(void) {
+    static uint16_t keycodes[KEYS_MAX];
+
+    stub_hid_reset();
+    FlipperWedgeHidWorker* worker = worker_start(FlipperWedgeHidWorkerModeBle);
+    stub_hid_set_connected(StubHidBle, false);
+
+    TEST_ASSERT(flipper_wedge_hid_worker_type(worker, NULL, "lost", true));
+    TEST_ASSERT(wait_idle(worker, 2000));
+    TEST_ASSERT_EQ(decoded_keys(StubHidBle, keycodes), 0);
+
+    stub_hid_set_connected(StubHidBle, true);
+    TEST_ASSERT(flipper_wedge_hid_worker_type(worker, NULL, "kept", true));
+    TEST_ASSERT(wait_idle(worker, 2000));
+    TEST_ASSERT(check_ascii_keys(StubHidBle, "kept", true));
+
+    flipper_wedge_hid_worker_free(worker);
+}
+
+// Progress counts characters, not keys: a cancelled job stops on a
+// character boundary and reports the characters whose keys all went out
+static void test_cancel_counts_characters(void) {
+    static char text[500 * 2 + 1];
+    static uint16_t keycodes[KEYS_MAX];
+    for(int i = 0; i < 500; i++) {
+        memcpy(text + 2 * i, "\xC3\xA9", 2); // é, Ctrl+Shift+U e 9 Space
+    }
+    text[sizeof(text) - 1] = '\0';
+
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeLinux);
+    stub_hid_reset();
+    stub_hid_set_poll_interval(StubHidUsb, 1000);
+    FlipperWedgeHidWorker* worker = worker_start(FlipperWedgeHidWorkerModeUsb);
+
+    TEST_ASSERT(flipper_wedge_hid_worker_type(worker, layout, text, false));
+    size_t typed = 0;
+    size_t total = 0;
+    for(uint32_t ms = 0; ms < 5000 && typed < 10; ms++) {
+        furi_delay_ms(1);
+        flipper_wedge_hid_worker_get_progress(worker, &typed, &total);
+    }
+    TEST_ASSERT_EQ(total, 500);
+
+    flipper_wedge_hid_worker_cancel(worker);
+    flipper_wedge_hid_worker_get_progress(worker, &typed, &total);
+    size_t keys = decoded_keys(StubHidUsb, keycodes);
+    TEST_ASSERT(typed > 0 && typed < 500);
+    TEST_ASSERT(keys >= typed * 4 && keys < (typed + 1) * 4);
+
+    // Nothing is held down on the host
+    size_t count;
+    const StubHidReport* reports = stub_hid_get_reports(StubHidUsb, &count);
+    TEST_ASSERT(count > 0);
+    if(count > 0) {
+        const StubHidReport* last = &reports[count - 1];
+        TEST_ASSERT_EQ(last->modifiers, 0);
+        for(uint8_t i = 0; i < STUB_HID_KEYS; i++) {
+            TEST_ASSERT_EQ(last->keys[i], 0);
+        }
+    }
+
+    flipper_wedge_hid_worker_free(worker);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+// A cancel frees the slots of the jobs it drops, a full queue takes the
+// next job right away
+static void test_cancel_frees_queue(void) {
+    static char text[201];
+    static uint16_t keycodes[KEYS_MAX];
+    memset(text, 'a', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    stub_hid_reset();
+    // One report per 2 ms poll keeps the jobs queued while the test runs
+    stub_hid_set_poll_interval(StubHidUsb, 2000);
+    FlipperWedgeHidWorker* worker = flipper_wedge_hid_worker_alloc();
+    flipper_wedge_hid_worker_start(worker, FlipperWedgeHidWorkerModeUsb);
+
+    for(size_t i = 0; i < FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_TYPING; i++) {
+        TEST_ASSERT(flipper_wedge_hid_worker_type(worker, NULL, text, false));
+    }
+    TEST_ASSERT(!flipper_wedge_hid_worker_type(worker, NULL, text, false));
+
+    flipper_wedge_hid_worker_cancel(worker);
+    TEST_ASSERT(!flipper_wedge_hid_worker_is_busy(worker));
+    size_t before = decoded_keys(StubHidUsb, keycodes);
+    TEST_ASSERT(before < 200);
+
+    // Nothing of the cancelled jobs is typed after the cancel returned
+    TEST_ASSERT(flipper_wedge_hid_worker_type(worker, NULL, "xyz", true));
+    TEST_ASSERT(wait_idle(worker, 2000));
+    size_t count = decoded_keys(StubHidUsb, keycodes);
+    TEST_ASSERT_EQ(count, before + 4);
+    if(count == before + 4) {
+        TEST_ASSERT_EQ(keycodes[before], HID_ASCII_TO_KEY('x'));
+        TEST_ASSERT_EQ(keycodes[before + 3], HID_KEYBOARD_RETURN);
+    }
+
+    flipper_wedge_hid_worker_free(worker);
+}
+
+// Bulk messages wait for the host, a cancel must still free their slots
+static void test_cancel_frees_bulk_queue(void) {
+    static const uint8_t uid[] = {0x04, 0xA1, 0xB2, 0xC3};
+    FlipperWedgeBulkField field = {FlipperWedgeBulkFieldNfcUid, uid, sizeof(uid)};
+
+    stub_hid_reset();
+    FlipperWedgeHidWorker* worker = flipper_wedge_hid_worker_alloc();
+    flipper_wedge_hid_worker_start(worker, FlipperWedgeHidWorkerModeUsbBulk);
+
+    for(size_t i = 0; i < FLIPPER_WEDGE_HID_WORKER_QUEUE_SIZE_BULK; i++) {
+        TEST_ASSERT(flipper_wedge_hid_worker_send_bulk(worker, &field, 1));
+    }
+    TEST_ASSERT(!flipper_wedge_hid_worker_send_bulk(worker, &field, 1));
+
+    flipper_wedge_hid_worker_cancel(worker);
+    TEST_ASSERT(!flipper_wedge_hid_worker_is_busy(worker));
+    TEST_ASSERT(flipper_wedge_hid_worker_send_bulk(worker, &field, 1));
+
+    flipper_wedge_hid_worker_free(worker);
+}
+
+int main(void) {
+    stub_clock_set_virtual(false);
+
+    TEST_RUN(test_types_on_each_transport);
+    TEST_RUN(test_slow_ble_does_not_hold_back_usb);
+    TEST_RUN(test_disconnected_ble_drops_job);
+    TEST_RUN(test_cancel_counts_characters);
+    TEST_RUN(test_cancel_frees_queue);
+    TEST_RUN(test_cancel_frees_bulk_queue);
+
+    return test_report("test_hid_worker");
+}
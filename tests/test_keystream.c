@@ -0,0 +1,228 @@
+// Keystream sizing and per-character compile: no character takes more than
+// FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX bytes in any layout and Unicode mode, a
+// character that doesn't fit leaves the stream as it was, a layout's own key
+// wins over the input method, and sequences come from the cache once compiled.
+
+#include "test.h"
+#include "flipper_wedge_keystream.h"
+#include "flipper_wedge_unicode.h"
+
+#define STREAM_MAX 4096
+
+// Characters with a key of their own in some layouts, an input method
+// sequence in others, and the longest sequences there are
+static const char* const unicode_samples[] = {
+    "\xC3\xA9", // é
+    "\xC3\xB6", // ö
+    "\xC5\x91", // ő
+    "\xC3\x9F", // ß
+    "\xC2\xA7", // §
+    "\xE2\x82\xAC", // €
+    "\xE4\xB8\xAD", // 中
+    "\xF0\x9F\x98\x80", // 😀
+    "\xF4\x8F\xBF\xBF", // U+10FFFF
+};
+
+static const FlipperWedgeLayoutType builtin_layouts[] = {
+    FlipperWedgeLayoutDefault,
+    FlipperWedgeLayoutNumPad,
+    FlipperWedgeLayoutAzerty,
+    FlipperWedgeLayoutQwertz,
+    FlipperWedgeLayoutHungarian,
+    FlipperWedgeLayoutDvorak,
+};
+
+// Compile one character after a key that leaves other modifiers down, so
+// the character pays for its own modifier changes
+static size_t char_bytes(FlipperWedgeKeyboardLayout* layout, const char* text, size_t len) {
+    uint8_t data[STREAM_MAX];
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    flipper_wedge_keystream_append_key(&stream, HID_KEYBOARD_A | KEY_MOD_LEFT_CTRL);
+    size_t before = stream.len;
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append_char(&stream, layout, text, len), len);
+    return stream.len - before;
+}
+
+static void test_char_max_covers_every_character(void) {
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    size_t worst = 0;
+
+    for(size_t l = 0; l < COUNT_OF(builtin_layouts); l++) {
+        flipper_wedge_keyboard_layout_set_builtin(layout, builtin_layouts[l]);
+        for(FlipperWedgeUnicodeMode mode = 0; mode < FlipperWedgeUnicodeCount; mode++) {
+            flipper_wedge_keyboard_layout_set_unicode_mode(layout, mode);
+            for(char c = ' '; c <= '~'; c++) {
+                worst = MAX(worst, char_bytes(layout, &c, 1));
+            }
+            for(size_t i = 0; i < COUNT_OF(unicode_samples); i++) {
+                worst = MAX(worst, char_bytes(layout, unicode_samples[i], strlen(unicode_samples[i])));
+            }
+        }
+    }
+
+    TEST_ASSERT(worst <= FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX);
+    // Windows Alt codes of the highest code points are the longest
+    TEST_ASSERT(worst > 2 * FLIPPER_WEDGE_LAYOUT_STROKES_MAX);
+    printf("    worst character: %zu of %d bytes\n", worst, FLIPPER_WEDGE_KEYSTREAM_CHAR_MAX);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+// A buffer of KEYSTREAM_SIZE(n) takes n of the longest characters and Enter
+static void test_size_holds_worst_case_text(void) {
+    static char text[100 * 4 + 1];
+    static uint8_t data[FLIPPER_WEDGE_KEYSTREAM_SIZE(100)];
+    text[0] = '\0';
+    for(int i = 0; i < 100; i++) {
+        // Alternate so the modifier state changes on every key
+        strcat(text, (i % 2) ? "\xF4\x8F\xBF\xBF" : "\xF0\x9F\x98\x80");
+    }
+
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    for(FlipperWedgeUnicodeMode mode = FlipperWedgeUnicodeLinux; mode <= FlipperWedgeUnicodeWindows;
+        mode++) {
+        flipper_wedge_keyboard_layout_set_unicode_mode(layout, mode);
+        FlipperWedgeKeystream stream;
+        flipper_wedge_keystream_init(&stream, data, sizeof(data));
+        TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, text, strlen(text)), strlen(text));
+        TEST_ASSERT(flipper_wedge_keystream_append_key(&stream, HID_KEYBOARD_RETURN));
+    }
+
+    // Dead keys, several strokes each
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutQwertz);
+    memset(text, '^', 100);
+    text[100] = '\0';
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, text, 100), 100);
+    TEST_ASSERT(flipper_wedge_keystream_append_key(&stream, HID_KEYBOARD_RETURN));
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+// Room for part of a character: nothing goes in, the stream is unchanged
+static void test_char_that_does_not_fit_rolls_back(void) {
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeWindows);
+    const char* euro = "\xE2\x82\xAC";
+    size_t need = char_bytes(layout, euro, 3);
+
+    for(size_t room = 0; room < need; room++) {
+        uint8_t data[64];
+        FlipperWedgeKeystream stream;
+        flipper_wedge_keystream_init(&stream, data, 2 + room);
+        flipper_wedge_keystream_append_key(&stream, HID_KEYBOARD_A | KEY_MOD_LEFT_SHIFT);
+        FlipperWedgeKeystream before = stream;
+
+        TEST_ASSERT_EQ(flipper_wedge_keystream_append_char(&stream, layout, euro, 3), 0);
+        TEST_ASSERT_EQ(stream.len, before.len);
+        TEST_ASSERT_EQ(stream.keys, before.keys);
+        TEST_ASSERT_EQ(stream.modifiers, before.modifiers);
+    }
+
+    // Same for a dead key and its Space
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutQwertz);
+    uint8_t data[2];
+    FlipperWedgeKeystream stream;
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, "a^", 2), 1);
+    TEST_ASSERT_EQ(stream.len, 1);
+    TEST_ASSERT_EQ(stream.keys, 1);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+static void test_append_stops_at_character_boundary(void) {
+    uint8_t data[STREAM_MAX];
+    FlipperWedgeKeystream stream;
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeLinux);
+
+    // é cut off by len
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, "ab\xC3\xA9", 3), 2);
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append_char(&stream, layout, "\xC3\xA9", 1), 0);
+
+    // NUL ends the text
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, "ab\0cd", 5), 2);
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append_char(&stream, layout, "", 1), 0);
+
+    // Malformed bytes and characters without keys are consumed, not typed
+    flipper_wedge_keystream_init(&stream, data, sizeof(data));
+    TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, NULL, "a\xFF\xC3\xA9z", 5), 5);
+    TEST_ASSERT_EQ(stream.keys, 2);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+static void test_layout_key_before_input_method(void) {
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    const uint16_t* keys;
+    static const FlipperWedgeUnicodeMode modes[] = {FlipperWedgeUnicodeLinux, FlipperWedgeUnicodeWindows};
+
+    for(size_t i = 0; i < COUNT_OF(modes); i++) {
+        flipper_wedge_keyboard_layout_set_unicode_mode(layout, modes[i]);
+
+        // é has a key on AZERTY (2) and Hungarian (;), keycodes by US legend
+        flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutAzerty);
+        TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0xE9, &keys), 1);
+        TEST_ASSERT_EQ(keys[0], 0x1F);
+        flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutHungarian);
+        TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0xE9, &keys), 1);
+        TEST_ASSERT_EQ(keys[0], 0x33);
+
+        // One key in the stream too
+        uint8_t data[STREAM_MAX];
+        FlipperWedgeKeystream stream;
+        flipper_wedge_keystream_init(&stream, data, sizeof(data));
+        TEST_ASSERT_EQ(flipper_wedge_keystream_append(&stream, layout, "\xC3\xA9", 2), 2);
+        TEST_ASSERT_EQ(stream.keys, 1);
+    }
+
+    // US layout has none: the input method
+    flipper_wedge_keyboard_layout_set_builtin(layout, FlipperWedgeLayoutDefault);
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeLinux);
+    TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0xE9, &keys), 4);
+    TEST_ASSERT_EQ(keys[0], 0x18 | KEY_MOD_LEFT_CTRL | KEY_MOD_LEFT_SHIFT);
+    TEST_ASSERT_EQ(keys[1], 0x08); // e
+    TEST_ASSERT_EQ(keys[2], 0x26); // 9
+    TEST_ASSERT_EQ(keys[3], HID_KEYBOARD_SPACEBAR);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+static void test_sequence_cache(void) {
+    FlipperWedgeKeyboardLayout* layout = flipper_wedge_keyboard_layout_alloc();
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeWindows);
+    const uint16_t* first;
+    const uint16_t* second;
+    TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0x20AC, &first), 6);
+
+    // Marked in place: a second lookup that compiled again would undo it
+    FlipperWedgeUnicodeSequence* slot =
+        &layout->unicode_cache[0x20AC & (FLIPPER_WEDGE_UNICODE_CACHE_SIZE - 1)];
+    TEST_ASSERT(first == slot->keys);
+    slot->keys[0] = 0x1234;
+    TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0x20AC, &second), 6);
+    TEST_ASSERT(second == first);
+    TEST_ASSERT_EQ(second[0], 0x1234);
+
+    // A code point sharing the slot replaces it, a mode change drops it
+    uint32_t same_slot = 0x20AC + FLIPPER_WEDGE_UNICODE_CACHE_SIZE;
+    TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, same_slot, &second), 6);
+    TEST_ASSERT_EQ(slot->codepoint, same_slot);
+    TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0x20AC, &second), 6);
+    slot->keys[0] = 0x1234;
+    flipper_wedge_keyboard_layout_set_unicode_mode(layout, FlipperWedgeUnicodeWindows);
+    TEST_ASSERT_EQ(flipper_wedge_unicode_sequence(layout, 0x20AC, &second), 6);
+    TEST_ASSERT_EQ(second[0], 0x57 | KEY_MOD_LEFT_ALT);
+    flipper_wedge_keyboard_layout_free(layout);
+}
+
+int main(void) {
+    TEST_RUN(test_char_max_covers_every_character);
+    TEST_RUN(test_size_holds_worst_case_text);
+    TEST_RUN(test_char_that_does_not_fit_rolls_back);
+    TEST_RUN(test_append_stops_at_character_boundary);
+    TEST_RUN(test_layout_key_before_input_method);
+    TEST_RUN(test_sequence_cache);
+
+    return test_report("test_keystream");
+}
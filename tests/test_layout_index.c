@@ -0,0 +1,145 @@
+// Layout index: files are listed with their names, an unchanged directory
+// reads no layout file and leaves the index file alone, and added, removed
+// and changed files are picked up, with and without file timestamps.
+
+#include "test.h"
+#include "stub.h"
+#include "flipper_wedge_keyboard_layout_index.h"
+#include <sys/stat.h>
+#include <utime.h>
+
+#define LAYOUT_PATH(file) FLIPPER_WEDGE_LAYOUTS_DIRECTORY "/" file
+
+static Storage* storage;
+
+static void write_layout(const char* path, const char* name) {
+    FILE* file = fopen(stub_storage_host_path(path), "wb");
+    furi_check(file);
+    fprintf(file, "Filetype: Flipper Wedge Keyboard Layout\nVersion: 1\nName: %s\n0: 39 SHIFT\n", name);
+    fclose(file);
+}
+
+// Set a file's mtime, whole seconds as FAT keeps them
+static void set_mtime(const char* path, time_t mtime) {
+    struct utimbuf times = {.actime = mtime, .modtime = mtime};
+    furi_check(utime(stub_storage_host_path(path), &times) == 0);
+}
+
+// Inode of the index file, a rewrite replaces it
+static ino_t index_inode(void) {
+    struct stat st;
+    return stat(stub_storage_host_path(FLIPPER_WEDGE_LAYOUT_INDEX_PATH), &st) == 0 ? st.st_ino : 0;
+}
+
+static const char* name_of(FlipperWedgeKeyboardLayoutIndex* index, const char* path) {
+    size_t position;
+    if(!flipper_wedge_keyboard_layout_index_find(index, path, &position)) return "";
+    const FlipperWedgeKeyboardLayoutIndexEntry* entry = flipper_wedge_keyboard_layout_index_get(index, position);
+    return entry ? entry->name : "";
+}
+
+// Fresh layouts directory with three files
+static void setup(void) {
+    char root[] = "/tmp/flipper_wedge_test_XXXXXX";
+    furi_check(mkdtemp(root));
+    stub_storage_set_root(root);
+    storage_common_mkdir(storage, FLIPPER_WEDGE_LAYOUTS_DIRECTORY);
+    write_layout(LAYOUT_PATH("azerty.txt"), "French");
+    write_layout(LAYOUT_PATH("qwertz.txt"), "German");
+    write_layout(LAYOUT_PATH("dvorak.txt"), "Dvorak");
+    set_mtime(LAYOUT_PATH("azerty.txt"), 1700000000);
+    set_mtime(LAYOUT_PATH("qwertz.txt"), 1700000000);
+    set_mtime(LAYOUT_PATH("dvorak.txt"), 1700000000);
+
+    // Not layouts
+    FILE* file = fopen(stub_storage_host_path(LAYOUT_PATH("readme.md")), "wb");
+    fclose(file);
+    storage_common_mkdir(storage, LAYOUT_PATH("sub.txt"));
+}
+
+// Refresh with nothing changed: only the index is read, once for the keys
+// and a record per file, and it isn't rewritten
+static void check_unchanged(FlipperWedgeKeyboardLayoutIndex* index, size_t count) {
+    ino_t inode = index_inode();
+    struct stat st;
+    furi_check(stat(stub_storage_host_path(FLIPPER_WEDGE_LAYOUT_INDEX_PATH), &st) == 0);
+    uint64_t bytes = stub_storage_bytes_read();
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), count);
+    TEST_ASSERT_EQ(
+        stub_storage_bytes_read() - bytes,
+        (uint64_t)st.st_size + count * sizeof(FlipperWedgeKeyboardLayoutIndexEntry));
+    TEST_ASSERT(index_inode() == inode);
+}
+
+static void run_changes(bool timestamps) {
+    stub_storage_set_timestamp_fails(!timestamps);
+    setup();
+    FlipperWedgeKeyboardLayoutIndex* index = flipper_wedge_keyboard_layout_index_alloc(storage);
+
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), 3);
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("azerty.txt")), "French");
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("qwertz.txt")), "German");
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("dvorak.txt")), "Dvorak");
+    TEST_ASSERT(index_inode() != 0);
+    check_unchanged(index, 3);
+
+    // Renamed layout of another size
+    write_layout(LAYOUT_PATH("qwertz.txt"), "Swiss German");
+    set_mtime(LAYOUT_PATH("qwertz.txt"), 1700000000);
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), 3);
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("qwertz.txt")), "Swiss German");
+    check_unchanged(index, 3);
+
+    // Same size, newer timestamp: only seen with timestamps
+    write_layout(LAYOUT_PATH("dvorak.txt"), "Colemk");
+    set_mtime(LAYOUT_PATH("dvorak.txt"), 1700000100);
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), 3);
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("dvorak.txt")), timestamps ? "Colemk" : "Dvorak");
+    check_unchanged(index, 3);
+
+    // Added and removed
+    write_layout(LAYOUT_PATH("bepo.txt"), "BEPO");
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), 4);
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("bepo.txt")), "BEPO");
+    check_unchanged(index, 4);
+    storage_common_remove(storage, LAYOUT_PATH("azerty.txt"));
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), 3);
+    size_t position;
+    TEST_ASSERT(!flipper_wedge_keyboard_layout_index_find(index, LAYOUT_PATH("azerty.txt"), &position));
+    TEST_ASSERT_STR(name_of(index, LAYOUT_PATH("qwertz.txt")), "Swiss German");
+    check_unchanged(index, 3);
+
+    flipper_wedge_keyboard_layout_index_free(index);
+    stub_storage_set_timestamp_fails(false);
+}
+
+static void test_with_timestamps(void) {
+    run_changes(true);
+}
+
+static void test_without_timestamps(void) {
+    run_changes(false);
+}
+
+static void test_timestamps_going_away(void) {
+    // An index written with timestamps is kept when they stop working
+    setup();
+    FlipperWedgeKeyboardLayoutIndex* index = flipper_wedge_keyboard_layout_index_alloc(storage);
+    TEST_ASSERT_EQ(flipper_wedge_keyboard_layout_index_refresh(index), 3);
+    stub_storage_set_timestamp_fails(true);
+    check_unchanged(index, 3);
+    stub_storage_set_timestamp_fails(false);
+    check_unchanged(index, 3);
+    flipper_wedge_keyboard_layout_index_free(index);
+}
+
+int main(void) {
+    storage = furi_record_open(RECORD_STORAGE);
+
+    TEST_RUN(test_with_timestamps);
+    TEST_RUN(test_without_timestamps);
+    TEST_RUN(test_timestamps_going_away);
+
+    furi_record_close(RECORD_STORAGE);
+    return test_report("test_layout_index");
+}
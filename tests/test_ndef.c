@@ -0,0 +1,589 @@
+// NDEF record iterator and selector: record views, MB/ME, short and long
+// records, ids, chunked records, Type 2/5 TLVs cut off anywhere, records cut
+// off by the end of data, and random and mutated messages.
+
+#include "test.h"
+#include "flipper_wedge_ndef.h"
+
+// Record header flags, as in the NFC Forum NDEF specification
+#define MB 0x80
+#define ME 0x40
+#define CF 0x20
+#define SR 0x10
+#define IL 0x08
+#define LONG 0x100 // Builder only: 4-byte payload length even if it fits one
+
+typedef struct {
+    uint8_t data[4096];
+    size_t len;
+} Message;
+
+static void put(Message* message, const void* bytes, size_t len) {
+    furi_check(message->len + len <= sizeof(message->data));
+    if(len == 0) return;
+    memcpy(&message->data[message->len], bytes, len);
+    message->len += len;
+}
+
+static void put_byte(Message* message, uint8_t byte) {
+    put(message, &byte, 1);
+}
+
+// Record or chunk: flags hold MB/ME/CF and the TNF, SR and IL are worked out
+static void put_record(
+    Message* message,
+    uint16_t flags,
+    const char* type,
+    const char* id,
+    const void* payload,
+    size_t payload_len) {
+    bool short_record = payload_len <= 0xFF && !(flags & LONG);
+    put_byte(message, (flags & 0xFF) | (short_record ? SR : 0) | (id ? IL : 0));
+    put_byte(message, strlen(type));
+    if(short_record) {
+        put_byte(message, payload_len);
+    } else {
+        uint8_t len[4] = {payload_len >> 24, payload_len >> 16, payload_len >> 8, payload_len};
+        put(message, len, sizeof(len));
+    }
+    if(id) put_byte(message, strlen(id));
+    put(message, type, strlen(type));
+    if(id) put(message, id, strlen(id));
+    put(message, payload, payload_len);
+}
+
+// Text record payload: status byte with the language code length, "en", text
+static void put_text(Message* message, uint16_t flags, const char* text) {
+    uint8_t payload[1024];
+    size_t len = strlen(text);
+    furi_check(len + 3 <= sizeof(payload));
+    payload[0] = 0x02;
+    memcpy(&payload[1], "en", 2);
+    memcpy(&payload[3], text, len);
+    put_record(message, flags | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T", NULL, payload, len + 3);
+}
+
+static void put_uri(Message* message, uint16_t flags, uint8_t code, const char* rest) {
+    uint8_t payload[256];
+    size_t len = strlen(rest);
+    payload[0] = code;
+    memcpy(&payload[1], rest, len);
+    put_record(message, flags | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "U", NULL, payload, len + 1);
+}
+
+static size_t select_message(
+    const Message* message,
+    FlipperWedgeNdefSelect select,
+    const char* mime_type,
+    char* output,
+    size_t output_size) {
+    FlipperWedgeNdefIterator it;
+    flipper_wedge_ndef_iter_init(&it, message->data, message->len);
+    return flipper_wedge_ndef_select(&it, select, mime_type, output, output_size);
+}
+
+static void test_record_view(void) {
+    Message message = {0};
+    put_record(&message, MB | ME | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "text/plain", "id1", "abc", 3);
+
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT_EQ(record.tnf, FLIPPER_WEDGE_NDEF_TNF_MEDIA);
+    TEST_ASSERT(record.message_begin);
+    TEST_ASSERT(record.message_end);
+    TEST_ASSERT(!record.chunked);
+    TEST_ASSERT(!record.truncated);
+    TEST_ASSERT_EQ(record.type_len, 10);
+    TEST_ASSERT(memcmp(record.type, "text/plain", 10) == 0);
+    TEST_ASSERT_EQ(record.id_len, 3);
+    TEST_ASSERT(record.id && memcmp(record.id, "id1", 3) == 0);
+    TEST_ASSERT_EQ(record.payload_len, 3);
+    TEST_ASSERT_EQ(record.payload_chunk_len, 3);
+    // A view into the message, nothing copied
+    TEST_ASSERT(record.payload == &message.data[message.len - 3]);
+    TEST_ASSERT(flipper_wedge_ndef_record_is(&record, FLIPPER_WEDGE_NDEF_TNF_MEDIA, "text/plain"));
+    TEST_ASSERT(!flipper_wedge_ndef_record_is(&record, FLIPPER_WEDGE_NDEF_TNF_MEDIA, "text/plai"));
+    TEST_ASSERT(!flipper_wedge_ndef_record_is(&record, FLIPPER_WEDGE_NDEF_TNF_EXTERNAL, "text/plain"));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    // Empty record, no id
+    message.len = 0;
+    put_record(&message, MB | ME | FLIPPER_WEDGE_NDEF_TNF_EMPTY, "", NULL, NULL, 0);
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT_EQ(record.tnf, FLIPPER_WEDGE_NDEF_TNF_EMPTY);
+    TEST_ASSERT(record.id == NULL);
+    TEST_ASSERT_EQ(record.payload_len, 0);
+
+    // No data
+    flipper_wedge_ndef_iter_init(&it, NULL, 10);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+    flipper_wedge_ndef_iter_init(&it, message.data, 0);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+}
+
+static void test_message_begin_end(void) {
+    Message message = {0};
+    put_text(&message, MB, "one");
+    put_uri(&message, 0, 0x04, "example.com");
+    put_text(&message, ME, "three");
+    // Anything after the message end isn't read
+    put_text(&message, MB | ME, "after");
+
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    bool begin[3];
+    bool end[3];
+    size_t count = 0;
+    while(flipper_wedge_ndef_iter_next(&it, &record)) {
+        if(count < 3) {
+            begin[count] = record.message_begin;
+            end[count] = record.message_end;
+        }
+        count++;
+    }
+    TEST_ASSERT_EQ(count, 3);
+    TEST_ASSERT(begin[0] && !begin[1] && !begin[2]);
+    TEST_ASSERT(!end[0] && !end[1] && end[2]);
+
+    // A message without ME ends with the data
+    message.len = 0;
+    put_text(&message, MB, "one");
+    put_text(&message, 0, "two");
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    count = 0;
+    while(flipper_wedge_ndef_iter_next(&it, &record)) count++;
+    TEST_ASSERT_EQ(count, 2);
+}
+
+static void test_long_record(void) {
+    static char text[1001];
+    memset(text, 'x', 1000);
+    text[1000] = '\0';
+    text[0] = 'A';
+    text[999] = 'Z';
+
+    Message message = {0};
+    put_text(&message, MB | ME, text);
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT_EQ(record.payload_len, 1003);
+    TEST_ASSERT(!record.truncated);
+
+    // A short payload in the 4-byte length form is read the same
+    message.len = 0;
+    put_record(
+        &message, MB | ME | LONG | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T", NULL, "\x02" "enhi", 5);
+    char output[16];
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectText, NULL, output, sizeof(output)), 2);
+    TEST_ASSERT_STR(output, "hi");
+
+    // Length past the end of a 4 GB payload doesn't wrap
+    message.len = 0;
+    const uint8_t huge[] = {MB | ME | FLIPPER_WEDGE_NDEF_TNF_MEDIA, 1, 0xFF, 0xFF, 0xFF, 0xFF, 'a', 'b'};
+    put(&message, huge, sizeof(huge));
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(record.truncated);
+    TEST_ASSERT_EQ(record.payload_len, 1);
+}
+
+static void test_chunked_record(void) {
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    Message message = {0};
+
+    // "Hello, chunked world!" in four chunks, the third one empty
+    put_record(&message, MB | CF | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T", "c", "\x02" "enHello, ", 10);
+    put_record(&message, CF | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "", NULL, "chunked ", 8);
+    put_record(&message, CF | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "", NULL, "", 0);
+    put_record(&message, FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "", NULL, "world!", 6);
+    put_uri(&message, ME, 0x04, "example.com");
+
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(record.chunked);
+    TEST_ASSERT(record.message_begin);
+    TEST_ASSERT(!record.message_end);
+    TEST_ASSERT_EQ(record.tnf, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN);
+    TEST_ASSERT_EQ(record.payload_chunk_len, 10);
+    TEST_ASSERT_EQ(record.payload_len, 24);
+
+    // Copies cross chunk boundaries, and an empty chunk, from any offset
+    uint8_t payload[32];
+    TEST_ASSERT_EQ(flipper_wedge_ndef_record_copy(&record, 0, payload, sizeof(payload)), 24);
+    TEST_ASSERT(memcmp(payload, "\x02" "enHello, chunked world!", 24) == 0);
+    memset(payload, 0, sizeof(payload));
+    TEST_ASSERT_EQ(flipper_wedge_ndef_record_copy(&record, 8, payload, 12), 12);
+    TEST_ASSERT(memcmp(payload, ", chunked wo", 12) == 0);
+    TEST_ASSERT_EQ(flipper_wedge_ndef_record_copy(&record, 18, payload, sizeof(payload)), 6);
+    TEST_ASSERT(memcmp(payload, "world!", 6) == 0);
+    TEST_ASSERT_EQ(flipper_wedge_ndef_record_copy(&record, 24, payload, sizeof(payload)), 0);
+    TEST_ASSERT_EQ(flipper_wedge_ndef_record_copy(&record, 0, payload, 0), 0);
+
+    // The record after the chunks
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(flipper_wedge_ndef_record_is(&record, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "U"));
+    TEST_ASSERT(record.message_end);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    char output[64];
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectText, NULL, output, sizeof(output)), 21);
+    TEST_ASSERT_STR(output, "Hello, chunked world!");
+    select_message(&message, FlipperWedgeNdefSelectAll, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "Hello, chunked world!\nhttps://example.com");
+    // Cut off inside the second chunk
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectText, NULL, output, 11), 10);
+    TEST_ASSERT_STR(output, "Hello, chu");
+
+    // First chunk empty: the text status byte comes from the second
+    message.len = 0;
+    put_record(&message, MB | CF | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T", NULL, "", 0);
+    put_record(&message, ME | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "", NULL, "\x02" "enok", 5);
+    select_message(&message, FlipperWedgeNdefSelectText, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "ok");
+}
+
+static void test_malformed_chunks(void) {
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    Message message = {0};
+
+    // Continuation with a TNF other than unchanged
+    put_record(&message, MB | CF | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "a/b", NULL, "12", 2);
+    put_record(&message, ME | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "", NULL, "34", 2);
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    // Continuation with a type
+    message.len = 0;
+    put_record(&message, MB | CF | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "a/b", NULL, "12", 2);
+    put_record(&message, ME | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "x", NULL, "34", 2);
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    // Chunk follows but the data ends
+    message.len = 0;
+    put_record(&message, MB | CF | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "a/b", NULL, "12", 2);
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    // Last chunk cut off: a chunked record is only returned whole
+    message.len = 0;
+    put_record(&message, MB | CF | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "a/b", NULL, "12", 2);
+    put_record(&message, ME | FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "", NULL, "3456", 4);
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len - 2);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    // First chunk cut off
+    flipper_wedge_ndef_iter_init(&it, message.data, 5);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+
+    // A malformed record ends the iteration for good
+    message.len = 0;
+    put_text(&message, MB, "fine");
+    put_byte(&message, 0x01);
+    put_byte(&message, 0x01);
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+}
+
+static void test_truncated_record(void) {
+    Message message = {0};
+    put_text(&message, MB | ME, "Hello, world");
+
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    char output[32];
+
+    // Payload cut off: the part that is there
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len - 7);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(record.truncated);
+    TEST_ASSERT_EQ(record.payload_len, 15 - 7);
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len - 7);
+    flipper_wedge_ndef_select(&it, FlipperWedgeNdefSelectText, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "Hello");
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len - 7);
+    TEST_ASSERT(!flipper_wedge_ndef_select_complete(&it, FlipperWedgeNdefSelectText, NULL, 0));
+    // Already enough for the characters that will be typed
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len - 7);
+    TEST_ASSERT(flipper_wedge_ndef_select_complete(&it, FlipperWedgeNdefSelectText, NULL, 5));
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len - 7);
+    TEST_ASSERT(!flipper_wedge_ndef_select_complete(&it, FlipperWedgeNdefSelectText, NULL, 6));
+
+    // Whole record
+    flipper_wedge_ndef_iter_init(&it, message.data, message.len);
+    TEST_ASSERT(flipper_wedge_ndef_select_complete(&it, FlipperWedgeNdefSelectText, NULL, 0));
+
+    // Cut off in the header or the type: nothing
+    for(size_t len = 1; len <= 3; len++) {
+        flipper_wedge_ndef_iter_init(&it, message.data, len);
+        TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &record));
+    }
+    // Cut off right before the payload
+    flipper_wedge_ndef_iter_init(&it, message.data, 4);
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &record));
+    TEST_ASSERT(record.truncated);
+    TEST_ASSERT_EQ(record.payload_len, 0);
+    flipper_wedge_ndef_iter_init(&it, message.data, 4);
+    TEST_ASSERT_EQ(flipper_wedge_ndef_select(&it, FlipperWedgeNdefSelectText, NULL, output, sizeof(output)), 0);
+}
+
+static void test_tlv(void) {
+    Message record = {0};
+    put_text(&record, MB | ME, "tlv");
+
+    FlipperWedgeNdefIterator it;
+    char output[32];
+    uint8_t memory[512];
+    size_t len = 0;
+
+    // NULL TLVs and a lock control TLV before the message, terminator after
+    memory[len++] = 0x00;
+    memory[len++] = 0x01;
+    memory[len++] = 0x03;
+    memory[len++] = 0xA0;
+    memory[len++] = 0x10;
+    memory[len++] = 0x44;
+    memory[len++] = 0x00;
+    memory[len++] = 0x03;
+    memory[len++] = record.len;
+    memcpy(&memory[len], record.data, record.len);
+    len += record.len;
+    memory[len++] = 0xFE;
+    TEST_ASSERT(flipper_wedge_ndef_iter_init_tlv(&it, memory, len));
+    flipper_wedge_ndef_select(&it, FlipperWedgeNdefSelectText, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "tlv");
+
+    // 3-byte length form
+    Message large = {0};
+    static char text[301];
+    memset(text, 'y', 300);
+    text[300] = '\0';
+    put_text(&large, MB | ME, text);
+    len = 0;
+    memory[len++] = 0x03;
+    memory[len++] = 0xFF;
+    memory[len++] = large.len >> 8;
+    memory[len++] = large.len & 0xFF;
+    memcpy(&memory[len], large.data, large.len);
+    len += large.len;
+    TEST_ASSERT(flipper_wedge_ndef_iter_init_tlv(&it, memory, len));
+    FlipperWedgeNdefRecord view;
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &view));
+    TEST_ASSERT_EQ(view.payload_len, 303);
+    TEST_ASSERT(!view.truncated);
+
+    // Message TLV cut off by the end of the memory read: as far as it goes
+    TEST_ASSERT(flipper_wedge_ndef_iter_init_tlv(&it, memory, 4 + 100));
+    TEST_ASSERT(flipper_wedge_ndef_iter_next(&it, &view));
+    TEST_ASSERT(view.truncated);
+    TEST_ASSERT_EQ(view.payload_len, 100 - 7);
+
+    // Cut off in the length field
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, memory, 1));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, memory, 2));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, memory, 3));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_next(&it, &view));
+    // Cut off right after the length field: empty message
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, memory, 4));
+
+    // Empty message TLV, as on a blank formatted tag
+    const uint8_t blank[] = {0x03, 0x00, 0xFE};
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, blank, sizeof(blank)));
+
+    // Terminator or a cut off lock control TLV before any message
+    const uint8_t terminated[] = {0xFE, 0x03, 0x02, 0xD0, 0x00};
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, terminated, sizeof(terminated)));
+    const uint8_t cut_lock[] = {0x01, 0x08, 0xA0, 0x10};
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, cut_lock, sizeof(cut_lock)));
+
+    // No memory at all
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, NULL, 10));
+    TEST_ASSERT(!flipper_wedge_ndef_iter_init_tlv(&it, memory, 0));
+}
+
+static void test_select(void) {
+    Message message = {0};
+    char output[128];
+
+    put_record(&message, MB | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "Application/JSON", NULL, "{}", 2);
+    put_uri(&message, 0, 0x04, "example.com/a");
+    put_text(&message, 0, "first");
+    put_text(&message, ME, "second");
+
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectText, NULL, output, sizeof(output)), 5);
+    TEST_ASSERT_STR(output, "first");
+    select_message(&message, FlipperWedgeNdefSelectUri, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "https://example.com/a");
+    select_message(&message, FlipperWedgeNdefSelectMime, "application/json", output, sizeof(output));
+    TEST_ASSERT_STR(output, "{}");
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectMime, NULL, output, sizeof(output)), 0);
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectMime, "", output, sizeof(output)), 0);
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectMime, "text/plain", output, sizeof(output)), 0);
+    select_message(&message, FlipperWedgeNdefSelectAll, "application/json", output, sizeof(output));
+    TEST_ASSERT_STR(output, "{}\nhttps://example.com/a\nfirst\nsecond");
+    select_message(&message, FlipperWedgeNdefSelectAll, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "https://example.com/a\nfirst\nsecond");
+
+    // Cut off to the output size, always terminated
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectUri, NULL, output, 9), 8);
+    TEST_ASSERT_STR(output, "https://");
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectUri, NULL, output, 1), 0);
+    TEST_ASSERT_STR(output, "");
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectUri, NULL, NULL, 0), 0);
+
+    // Smart Poster: the URI inside
+    Message poster = {0};
+    put_text(&poster, MB, "Title");
+    put_uri(&poster, ME, 0x02, "flipper.net");
+    message.len = 0;
+    put_record(&message, MB | ME | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "Sp", NULL, poster.data, poster.len);
+    select_message(&message, FlipperWedgeNdefSelectUri, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "https://www.flipper.net");
+    TEST_ASSERT_EQ(select_message(&message, FlipperWedgeNdefSelectText, NULL, output, sizeof(output)), 0);
+
+    // Records too short for their kind are skipped
+    message.len = 0;
+    put_record(&message, MB | FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "T", NULL, "\x05" "en", 3);
+    put_record(&message, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "U", NULL, "", 0);
+    put_text(&message, ME, "valid");
+    select_message(&message, FlipperWedgeNdefSelectAll, NULL, output, sizeof(output));
+    TEST_ASSERT_STR(output, "valid");
+}
+
+static void test_uri_prefix(void) {
+    TEST_ASSERT_STR(flipper_wedge_ndef_uri_prefix(0x00), "");
+    TEST_ASSERT_STR(flipper_wedge_ndef_uri_prefix(0x01), "http://www.");
+    TEST_ASSERT_STR(flipper_wedge_ndef_uri_prefix(0x04), "https://");
+    TEST_ASSERT_STR(flipper_wedge_ndef_uri_prefix(0x23), "urn:nfc:");
+    TEST_ASSERT_STR(flipper_wedge_ndef_uri_prefix(0x24), "");
+    TEST_ASSERT_STR(flipper_wedge_ndef_uri_prefix(0xFF), "");
+}
+
+// Every record view stays inside the data, whatever the bytes
+static void check_iteration(const uint8_t* data, size_t len) {
+    FlipperWedgeNdefIterator it;
+    FlipperWedgeNdefRecord record;
+    flipper_wedge_ndef_iter_init(&it, data, len);
+    size_t records = 0;
+    while(flipper_wedge_ndef_iter_next(&it, &record)) {
+        records++;
+        bool inside = record.payload >= data &&
+                      record.payload + record.payload_chunk_len <= data + len &&
+                      record.type + record.type_len <= data + len &&
+                      record.payload_chunk_len <= record.payload_len &&
+                      (record.chunked || record.payload_chunk_len == record.payload_len);
+        if(!inside) TEST_ASSERT(inside);
+        if(!inside || records > len) break;
+        uint8_t copy[64];
+        flipper_wedge_ndef_record_copy(&record, record.payload_len / 2, copy, sizeof(copy));
+    }
+
+    char output[64];
+    static const char* mime_types[] = {NULL, "a/b"};
+    for(FlipperWedgeNdefSelect select = 0; select < FlipperWedgeNdefSelectCount; select++) {
+        for(size_t m = 0; m < COUNT_OF(mime_types); m++) {
+            flipper_wedge_ndef_iter_init(&it, data, len);
+            size_t out_len =
+                flipper_wedge_ndef_select(&it, select, mime_types[m], output, sizeof(output));
+            if(out_len >= sizeof(output) || output[out_len] != '\0') {
+                TEST_ASSERT(out_len < sizeof(output) && output[out_len] == '\0');
+            }
+            flipper_wedge_ndef_iter_init(&it, data, len);
+            flipper_wedge_ndef_select_complete(&it, select, mime_types[m], 16);
+        }
+    }
+
+    // The same bytes as tag memory
+    if(flipper_wedge_ndef_iter_init_tlv(&it, data, len)) {
+        while(flipper_wedge_ndef_iter_next(&it, &record)) {
+            if(record.payload + record.payload_chunk_len > data + len) {
+                TEST_ASSERT(record.payload + record.payload_chunk_len <= data + len);
+                break;
+            }
+        }
+    }
+}
+
+static void test_fuzz(void) {
+    uint32_t seed = 0xC0FFEE;
+    int before = test_failures;
+
+    // Random bytes, biased towards plausible headers and short lengths
+    uint8_t data[96];
+    for(size_t round = 0; round < 20000 && test_failures == before; round++) {
+        size_t len = test_random(&seed) % sizeof(data);
+        for(size_t i = 0; i < len; i++) {
+            uint32_t r = test_random(&seed);
+            data[i] = (r & 0x300) ? (r & 0x1F) : (r & 0xFF);
+            if(i == 0 && (r & 0x400)) data[i] = 0x03; // TLV
+        }
+        // The iterator and selector may only look at the first len bytes
+        uint8_t* heap = malloc(len ? len : 1);
+        memcpy(heap, data, len);
+        check_iteration(heap, len);
+        free(heap);
+    }
+
+    // Valid messages with bytes flipped, removed or cut off
+    Message base = {0};
+    put_record(&base, MB | CF | FLIPPER_WEDGE_NDEF_TNF_MEDIA, "a/b", "i", "12", 2);
+    put_record(&base, FLIPPER_WEDGE_NDEF_TNF_UNCHANGED, "", NULL, "345", 3);
+    put_uri(&base, 0, 0x04, "example.com");
+    Message poster = {0};
+    put_uri(&poster, MB | ME, 0x01, "x.y");
+    put_record(&base, FLIPPER_WEDGE_NDEF_TNF_WELL_KNOWN, "Sp", NULL, poster.data, poster.len);
+    put_text(&base, ME, "end of message");
+
+    check_iteration(base.data, base.len);
+    for(size_t round = 0; round < 20000 && test_failures == before; round++) {
+        Message mutated = base;
+        size_t edits = 1 + test_random(&seed) % 3;
+        for(size_t e = 0; e < edits; e++) {
+            uint32_t r = test_random(&seed);
+            size_t at = (r >> 8) % mutated.len;
+            switch(r % 3) {
+            case 0:
+                mutated.data[at] ^= 1 << ((r >> 4) % 8);
+                break;
+            case 1:
+                mutated.data[at] = r >> 24;
+                break;
+            default:
+                memmove(&mutated.data[at], &mutated.data[at + 1], mutated.len - at - 1);
+                mutated.len--;
+                break;
+            }
+        }
+        size_t len = test_random(&seed) % (mutated.len + 1);
+        uint8_t* heap = malloc(len ? len : 1);
+        memcpy(heap, mutated.data, len);
+        check_iteration(heap, len);
+        free(heap);
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_record_view);
+    TEST_RUN(test_message_begin_end);
+    TEST_RUN(test_long_record);
+    TEST_RUN(test_chunked_record);
+    TEST_RUN(test_malformed_chunks);
+    TEST_RUN(test_truncated_record);
+    TEST_RUN(test_tlv);
+    TEST_RUN(test_select);
+    TEST_RUN(test_uri_prefix);
+    TEST_RUN(test_fuzz);
+
+    return test_report("test_ndef");
+}
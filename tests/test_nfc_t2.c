@@ -0,0 +1,229 @@
+// Type 2 NDEF reader on simulated NTAG and Ultralight tags: the text typed
+// matches a full dump, only the pages the NDEF TLV covers are read, FAST_READ
+// falls back to READ after a NAK, reads stop once the selected text is
+// there, and bad CCs, TLVs and random tags are handled.
+
+#include "nfc_t2_tag.h"
+
+static uint8_t message[1024];
+static char text[1025];
+static char dump_text[1025];
+
+// Text the reader's message gives
+static size_t read_text(T2Tag* tag, size_t message_size) {
+    t2_tag_reset_counters(tag);
+    size_t len = flipper_wedge_nfc_t2_read_ndef(
+        t2_tag_transceive, t2_tag_reactivate, t2_tag_complete, tag, message, message_size);
+    FlipperWedgeNdefIterator it;
+    flipper_wedge_ndef_iter_init(&it, message, len);
+    return flipper_wedge_ndef_select(&it, FlipperWedgeNdefSelectText, NULL, text, sizeof(text));
+}
+
+// Text a full dump of the data area gives, as the MfUltralight poller read it
+static size_t dump_tag_text(T2Tag* tag) {
+    size_t data_size = MIN(tag->memory[14] * 8, (size_t)(tag->pages - 4) * 4);
+    FlipperWedgeNdefIterator it;
+    flipper_wedge_ndef_iter_init_tlv(&it, t2_tag_data(tag), data_size);
+    return flipper_wedge_ndef_select(&it, FlipperWedgeNdefSelectText, NULL, dump_text, sizeof(dump_text));
+}
+
+static void test_reads_tlv_pages_only(void) {
+    static const struct {
+        const T2TagModel* model;
+        size_t chars;
+        size_t max_chars;
+        size_t exchanges;
+        size_t naks;
+    } cases[] = {
+        {&t2_tag_ntag213, 20, 0, 2, 0},
+        {&t2_tag_ntag213, 120, 0, 2, 0},
+        {&t2_tag_ntag215, 400, 0, 3, 0},
+        {&t2_tag_ntag216, 100, 0, 2, 0},
+        {&t2_tag_ntag216, 500, 0, 4, 0},
+        {&t2_tag_ntag216, 850, 0, 5, 0},
+        {&t2_tag_ntag216, 850, 250, 3, 0},
+        {&t2_tag_ultralight, 30, 0, 4, 1},
+        {&t2_tag_ultralight_c, 120, 0, 10, 1},
+    };
+
+    T2Tag tag;
+    for(size_t i = 0; i < COUNT_OF(cases); i++) {
+        t2_tag_init(&tag, cases[i].model);
+        size_t used = t2_tag_put_text(&tag, 0, cases[i].chars, false);
+        tag.max_chars = cases[i].max_chars;
+
+        size_t len = read_text(&tag, sizeof(message));
+        size_t expected = dump_tag_text(&tag);
+        TEST_ASSERT_EQ(expected, cases[i].chars);
+        if(cases[i].max_chars) {
+            TEST_ASSERT(len >= cases[i].max_chars);
+            expected = cases[i].max_chars;
+        } else {
+            TEST_ASSERT_EQ(len, expected);
+        }
+        TEST_ASSERT(memcmp(text, dump_text, expected) == 0);
+        TEST_ASSERT_EQ(tag.exchanges, cases[i].exchanges);
+        TEST_ASSERT_EQ(tag.naks, cases[i].naks);
+        TEST_ASSERT_EQ(tag.reactivations, cases[i].naks);
+        // Nothing past the TLV's last page but the rest of a 4-page READ
+        if(!cases[i].max_chars) {
+            size_t tlv_last_page = 4 + (used - 2) / 4;
+            TEST_ASSERT(tag.page_last <= tlv_last_page + (tag.fast_read ? 0 : 3));
+        }
+    }
+}
+
+static void test_tlv_placement(void) {
+    T2Tag tag;
+
+    // Lock control TLV in front
+    t2_tag_init(&tag, &t2_tag_ntag216);
+    t2_tag_put_text(&tag, 0, 850, true);
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 850);
+    TEST_ASSERT_EQ(dump_tag_text(&tag), 850);
+    TEST_ASSERT(memcmp(text, dump_text, 850) == 0);
+
+    // NULL TLVs up to byte 40: the header takes more READs to find
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    memset(t2_tag_data(&tag), 0, 40);
+    t2_tag_put_text(&tag, 40, 50, false);
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 50);
+    TEST_ASSERT_EQ(tag.exchanges, 4);
+
+    // Beyond the bytes searched for the header
+    t2_tag_init(&tag, &t2_tag_ntag215);
+    memset(t2_tag_data(&tag), 0, 100);
+    t2_tag_put_text(&tag, 100, 10, false);
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 0);
+}
+
+static void test_fast_read_refused(void) {
+    T2Tag tag;
+    t2_tag_init(&tag, &t2_tag_ultralight_c);
+    t2_tag_put_text(&tag, 0, 120, false);
+
+    // Without a way to reactivate, what the READs before gave
+    t2_tag_reset_counters(&tag);
+    size_t len = flipper_wedge_nfc_t2_read_ndef(
+        t2_tag_transceive, NULL, t2_tag_complete, &tag, message, sizeof(message));
+    TEST_ASSERT_EQ(len, 12 - 2);
+    TEST_ASSERT_EQ(tag.naks, 1);
+
+    // Reactivated once, READ for the rest of the message
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 120);
+    TEST_ASSERT_EQ(tag.naks, 1);
+    TEST_ASSERT_EQ(tag.reactivations, 1);
+}
+
+static void test_message_cut_off(void) {
+    T2Tag tag;
+    t2_tag_init(&tag, &t2_tag_ntag216);
+    t2_tag_put_text(&tag, 0, 850, false);
+    t2_tag_reset_counters(&tag);
+    TEST_ASSERT_EQ(
+        flipper_wedge_nfc_t2_read_ndef(t2_tag_transceive, t2_tag_reactivate, NULL, &tag, message, 100),
+        100);
+    // Long text record: text from byte 10
+    TEST_ASSERT(message[10] == 'a' && message[99] == 'a' + (99 - 10) % 26);
+
+    // TLV longer than the data area in the CC
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    t2_tag_put_text(&tag, 0, 120, false);
+    tag.memory[14] = 64 / 8;
+    TEST_ASSERT_EQ(
+        flipper_wedge_nfc_t2_read_ndef(t2_tag_transceive, t2_tag_reactivate, NULL, &tag, message, sizeof(message)),
+        64 - 2);
+}
+
+static void test_bad_tags(void) {
+    T2Tag tag;
+    uint8_t* data;
+
+    // No NDEF CC, another major version, no read access
+    static const struct {
+        size_t byte;
+        uint8_t value;
+    } bad_cc[] = {{12, 0x00}, {13, 0x20}, {15, 0x80}};
+    for(size_t i = 0; i < COUNT_OF(bad_cc); i++) {
+        t2_tag_init(&tag, &t2_tag_ntag213);
+        t2_tag_put_text(&tag, 0, 20, false);
+        tag.memory[bad_cc[i].byte] = bad_cc[i].value;
+        TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 0);
+        TEST_ASSERT_EQ(tag.exchanges, 1);
+    }
+    // A newer minor version is read
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    t2_tag_put_text(&tag, 0, 20, false);
+    tag.memory[13] = 0x13;
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 20);
+
+    // Blank tag, terminator first, TLV starting past the data area
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 0);
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    data = t2_tag_data(&tag);
+    data[0] = 0xFE;
+    data[1] = 0x03;
+    data[2] = 0x05;
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 0);
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    memset(t2_tag_data(&tag), 0, 6);
+    t2_tag_put_text(&tag, 6, 20, false);
+    tag.memory[14] = 1;
+    TEST_ASSERT_EQ(read_text(&tag, sizeof(message)), 0);
+
+    // Silent tag
+    t2_tag_init(&tag, &t2_tag_ntag213);
+    t2_tag_put_text(&tag, 0, 20, false);
+    tag.halted = true;
+    TEST_ASSERT_EQ(
+        flipper_wedge_nfc_t2_read_ndef(t2_tag_transceive, NULL, NULL, &tag, message, sizeof(message)), 0);
+}
+
+static void test_fuzz(void) {
+    static const T2TagModel* models[] = {
+        &t2_tag_ntag213,
+        &t2_tag_ntag215,
+        &t2_tag_ntag216,
+        &t2_tag_ultralight,
+        &t2_tag_ultralight_c,
+    };
+    uint32_t seed = 0x7A6;
+    T2Tag tag;
+
+    // Random CC size byte and data area start, mostly TLV-ish bytes
+    for(size_t round = 0; round < 20000; round++) {
+        t2_tag_init(&tag, models[test_random(&seed) % COUNT_OF(models)]);
+        tag.pages = 5 + test_random(&seed) % (T2_TAG_PAGES_MAX - 5);
+        tag.memory[14] = test_random(&seed);
+        uint8_t* data = t2_tag_data(&tag);
+        for(size_t i = 0; i < 64 && 16 + i < (size_t)tag.pages * 4; i++) {
+            uint32_t r = test_random(&seed);
+            data[i] = (r & 0x700) ? (r & 0xFF) : 0x03;
+        }
+        tag.max_chars = test_random(&seed) % 300;
+        size_t message_size = test_random(&seed) % (sizeof(message) + 1);
+
+        t2_tag_reset_counters(&tag);
+        uint8_t* heap = malloc(message_size ? message_size : 1);
+        size_t len = flipper_wedge_nfc_t2_read_ndef(
+            t2_tag_transceive, t2_tag_reactivate, t2_tag_complete, &tag, heap, message_size);
+        free(heap);
+        if(len > message_size || tag.exchanges > 20) {
+            TEST_ASSERT(len <= message_size);
+            TEST_ASSERT(tag.exchanges <= 20);
+            break;
+        }
+    }
+}
+
+int main(void) {
+    TEST_RUN(test_reads_tlv_pages_only);
+    TEST_RUN(test_tlv_placement);
+    TEST_RUN(test_fast_read_refused);
+    TEST_RUN(test_message_cut_off);
+    TEST_RUN(test_bad_tags);
+    TEST_RUN(test_fuzz);
+
+    return test_report("test_nfc_t2");
+}
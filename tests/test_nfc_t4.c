@@ -0,0 +1,385 @@
+// Type 4 NDEF read planner against a scripted tag: the APDUs it sends, how
+// many exchanges a read takes for each MLe, early stops, cut off messages,
+// NDEF files smaller than MLe, extended NDEF files, reserved file IDs and
+// tags that fail halfway. Like a real tag, it refuses reads past the file.
+//
+// Exchanges per read, SELECT application, CC and NDEF file and READ CC
+// included. The planner reads NLEN with the first block and sizes every
+// READ BINARY to MLe; the baseline read NLEN on its own, then 128-byte
+// blocks whatever the MLe (more than a 59-byte MLe tag accepts):
+//
+//   MLe  NDEF bytes  planner  baseline
+//    59          50        5         6
+//    59         250        9         7
+//    59         500       13         9
+//    59        1000       21        13
+//   255          50        5         6
+//   255         250        5         7
+//   255         500        6         9
+//   255        1000        8        13
+
+#include "test.h"
+#include "flipper_wedge_nfc_t4.h"
+
+#define TAG_NDEF_FILE_ID 0xE104
+#define TAG_NDEF_FILE_MAX 2048
+
+typedef struct {
+    uint8_t cc[17];
+    uint8_t ndef_file[TAG_NDEF_FILE_MAX];
+    size_t ndef_file_len;
+    uint16_t ndef_file_id;
+    uint16_t mle;
+
+    bool no_application; // Answers SELECT application with 6A82
+    bool short_past_end; // Answers a READ BINARY past the end of the file short, with 9000
+
+    bool application_selected;
+    uint16_t selected_file;
+    size_t exchanges;
+    bool le_over_mle; // A READ BINARY asked for more than MLe
+    size_t fail_at; // Exchange that gets no response, 0 for none
+} ScriptedTag;
+
+static void tag_status(uint8_t* response, size_t* response_len, uint16_t status) {
+    response[(*response_len)++] = status >> 8;
+    response[(*response_len)++] = status & 0xFF;
+}
+
+static bool tag_transceive(
+    const uint8_t* command,
+    size_t command_len,
+    uint8_t* response,
+    size_t response_size,
+    size_t* response_len,
+    void* context) {
+    static const uint8_t aid[] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
+    ScriptedTag* tag = context;
+    tag->exchanges++;
+    *response_len = 0;
+    if(tag->exchanges == tag->fail_at) return false;
+    furi_check(response_size >= FLIPPER_WEDGE_NFC_T4_RESPONSE_MAX);
+    furi_check(command_len <= FLIPPER_WEDGE_NFC_T4_COMMAND_MAX);
+
+    if(command_len == 5 + sizeof(aid) && command[1] == 0xA4 && command[2] == 0x04) {
+        bool match = !tag->no_application && command[4] == sizeof(aid) &&
+                     memcmp(&command[5], aid, sizeof(aid)) == 0;
+        tag->application_selected = match;
+        tag_status(response, response_len, match ? 0x9000 : 0x6A82);
+    } else if(command_len == 7 && command[1] == 0xA4 && command[2] == 0x00 && command[4] == 2) {
+        uint16_t file_id = (command[5] << 8) | command[6];
+        bool found = tag->application_selected &&
+                     (file_id == 0xE103 || file_id == tag->ndef_file_id);
+        if(found) tag->selected_file = file_id;
+        tag_status(response, response_len, found ? 0x9000 : 0x6A82);
+    } else if(command_len == 5 && command[1] == 0xB0) {
+        size_t offset = (command[2] << 8) | command[3];
+        size_t le = command[4] ? command[4] : 256;
+        const uint8_t* file = (tag->selected_file == 0xE103) ? tag->cc : tag->ndef_file;
+        size_t file_len = (tag->selected_file == 0xE103) ? sizeof(tag->cc) : tag->ndef_file_len;
+        if(!tag->selected_file) {
+            tag_status(response, response_len, 0x6986);
+        } else if(le > tag->mle) {
+            tag->le_over_mle = true;
+            tag_status(response, response_len, 0x6700);
+        } else if(offset >= file_len) {
+            tag_status(response, response_len, 0x6B00);
+        } else if(offset + le > file_len && !tag->short_past_end) {
+            // Wrong Le: not that much left in the file
+            tag_status(response, response_len, 0x6700);
+        } else {
+            size_t len = MIN(le, file_len - offset);
+            memcpy(response, &file[offset], len);
+            *response_len = len;
+            tag_status(response, response_len, 0x9000);
+        }
+    } else {
+        tag_status(response, response_len, 0x6D00);
+    }
+    return true;
+}
+
+static uint8_t message_byte(size_t i) {
+    return (uint8_t)(i * 7 + 3);
+}
+
+// Tag with a mapping 2.0 CC and an NDEF message of nlen bytes
+static void tag_init(ScriptedTag* tag, uint16_t mle, size_t nlen) {
+    memset(tag, 0, sizeof(ScriptedTag));
+    furi_check(nlen + 2 <= TAG_NDEF_FILE_MAX);
+    tag->mle = mle;
+    tag->ndef_file_id = TAG_NDEF_FILE_ID;
+    const uint8_t cc[] = {
+        0x00, 0x0F, // CCLEN
+        0x20, // Mapping version 2.0
+        mle >> 8, mle & 0xFF, // MLe
+        0x00, 0xFF, // MLc
+        0x04, 0x06, // NDEF File Control TLV
+        TAG_NDEF_FILE_ID >> 8, TAG_NDEF_FILE_ID & 0xFF,
+        TAG_NDEF_FILE_MAX >> 8, TAG_NDEF_FILE_MAX & 0xFF,
+        0x00, 0x00, // Read and write access
+    };
+    memcpy(tag->cc, cc, sizeof(cc));
+    tag->ndef_file[0] = nlen >> 8;
+    tag->ndef_file[1] = nlen & 0xFF;
+    for(size_t i = 0; i < nlen; i++) {
+        tag->ndef_file[2 + i] = message_byte(i);
+    }
+    tag->ndef_file_len = TAG_NDEF_FILE_MAX;
+}
+
+static bool message_matches(const uint8_t* message, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        if(message[i] != message_byte(i)) return false;
+    }
+    return true;
+}
+
+static uint8_t message[1024];
+
+static size_t read_ndef(ScriptedTag* tag, FlipperWedgeNfcT4Complete complete, size_t message_size) {
+    memset(message, 0, sizeof(message));
+    return flipper_wedge_nfc_t4_read_ndef(tag_transceive, complete, tag, message, message_size);
+}
+
+static void test_exchange_counts(void) {
+    static const struct {
+        uint16_t mle;
+        size_t nlen;
+        size_t exchanges;
+    } cases[] = {
+        {59, 50, 5},
+        {59, 250, 9},
+        {59, 500, 13},
+        {59, 1000, 21},
+        {255, 50, 5},
+        {255, 250, 5},
+        {255, 500, 6},
+        {255, 1000, 8},
+    };
+
+    ScriptedTag tag;
+    for(size_t i = 0; i < COUNT_OF(cases); i++) {
+        tag_init(&tag, cases[i].mle, cases[i].nlen);
+        TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), cases[i].nlen);
+        TEST_ASSERT(message_matches(message, cases[i].nlen));
+        TEST_ASSERT_EQ(tag.exchanges, cases[i].exchanges);
+        TEST_ASSERT(!tag.le_over_mle);
+    }
+
+    // An MLe above what short Le can ask for reads 255 bytes at a time
+    tag_init(&tag, 0x7FFF, 1000);
+    tag.mle = 255;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 1000);
+    TEST_ASSERT_EQ(tag.exchanges, 8);
+    TEST_ASSERT(!tag.le_over_mle);
+}
+
+static size_t complete_after;
+
+static bool complete_at(const uint8_t* data, size_t len, void* context) {
+    UNUSED(data);
+    UNUSED(context);
+    return len >= complete_after;
+}
+
+static void test_complete_stops_reading(void) {
+    ScriptedTag tag;
+    tag_init(&tag, 59, 1000);
+    complete_after = 100;
+    // 57 bytes with NLEN, then 59 more
+    TEST_ASSERT_EQ(read_ndef(&tag, complete_at, sizeof(message)), 116);
+    TEST_ASSERT(message_matches(message, 116));
+    TEST_ASSERT_EQ(tag.exchanges, 6);
+
+    // Satisfied by the first block
+    tag_init(&tag, 255, 1000);
+    complete_after = 1;
+    TEST_ASSERT_EQ(read_ndef(&tag, complete_at, sizeof(message)), 253);
+    TEST_ASSERT_EQ(tag.exchanges, 5);
+}
+
+static void test_message_cut_off(void) {
+    ScriptedTag tag;
+
+    // Longer than the buffer: the buffer's worth
+    tag_init(&tag, 255, 1000);
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, 300), 300);
+    TEST_ASSERT(message_matches(message, 300));
+    TEST_ASSERT_EQ(message[300], 0);
+    TEST_ASSERT_EQ(tag.exchanges, 6);
+
+    // NLEN past the NDEF file size from the CC: the file's worth
+    tag_init(&tag, 255, 1000);
+    tag.cc[11] = 0x01;
+    tag.cc[12] = 0x00;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 0x100 - 2);
+
+    // Tag answering short of the Le: reads go on from where it stopped
+    tag_init(&tag, 255, 100);
+    tag.ndef_file_len = 2 + 50;
+    tag.short_past_end = true;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 50);
+    TEST_ASSERT(message_matches(message, 50));
+}
+
+static void test_small_ndef_file(void) {
+    ScriptedTag tag;
+
+    // A 64-byte file behind an MLe of 0xF6: no read past its end, which the
+    // tag refuses
+    static const size_t nlens[] = {10, 62};
+    for(size_t i = 0; i < COUNT_OF(nlens); i++) {
+        tag_init(&tag, 0xF6, nlens[i]);
+        tag.cc[11] = 0x00;
+        tag.cc[12] = 64;
+        tag.ndef_file_len = 64;
+        TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), nlens[i]);
+        TEST_ASSERT(message_matches(message, nlens[i]));
+        TEST_ASSERT_EQ(tag.exchanges, 5);
+    }
+
+    // NLEN claiming more than the file holds: the file's worth
+    tag_init(&tag, 0xF6, 100);
+    tag.cc[11] = 0x00;
+    tag.cc[12] = 64;
+    tag.ndef_file_len = 64;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 62);
+    TEST_ASSERT(message_matches(message, 62));
+    TEST_ASSERT_EQ(tag.exchanges, 5);
+}
+
+static void test_extended_ndef_file(void) {
+    ScriptedTag tag;
+    tag_init(&tag, 255, 0);
+    const uint8_t cc[] = {
+        0x00, 0x11, 0x30, 0x00, 0xFF, 0x00, 0xFF,
+        0x06, 0x08, // ENDEF File Control TLV, 4-byte file size and NLEN
+        TAG_NDEF_FILE_ID >> 8, TAG_NDEF_FILE_ID & 0xFF,
+        0x00, 0x00, TAG_NDEF_FILE_MAX >> 8, TAG_NDEF_FILE_MAX & 0xFF,
+        0x00, 0x00,
+    };
+    memcpy(tag.cc, cc, sizeof(cc));
+    size_t nlen = 600;
+    const uint8_t nlen_field[] = {0, 0, nlen >> 8, nlen & 0xFF};
+    memcpy(tag.ndef_file, nlen_field, sizeof(nlen_field));
+    for(size_t i = 0; i < nlen; i++) {
+        tag.ndef_file[4 + i] = message_byte(i);
+    }
+
+    FlipperWedgeNfcT4Cc parsed;
+    TEST_ASSERT(flipper_wedge_nfc_t4_parse_cc(cc, sizeof(cc), &parsed));
+    TEST_ASSERT_EQ(parsed.nlen_size, 4);
+    TEST_ASSERT_EQ(parsed.ndef_file_max, TAG_NDEF_FILE_MAX);
+
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), nlen);
+    TEST_ASSERT(message_matches(message, nlen));
+    TEST_ASSERT_EQ(tag.exchanges, 4 + 3);
+}
+
+static void test_parse_cc(void) {
+    ScriptedTag tag;
+    tag_init(&tag, 59, 0);
+    FlipperWedgeNfcT4Cc cc;
+    TEST_ASSERT(flipper_wedge_nfc_t4_parse_cc(tag.cc, 15, &cc));
+    TEST_ASSERT_EQ(cc.mapping_version, 0x20);
+    TEST_ASSERT_EQ(cc.mle, 59);
+    TEST_ASSERT_EQ(cc.ndef_file_id, TAG_NDEF_FILE_ID);
+    TEST_ASSERT_EQ(cc.ndef_file_max, TAG_NDEF_FILE_MAX);
+    TEST_ASSERT_EQ(cc.nlen_size, 2);
+
+    TEST_ASSERT(!flipper_wedge_nfc_t4_parse_cc(tag.cc, 14, &cc));
+
+    uint8_t bad[15];
+    memcpy(bad, tag.cc, sizeof(bad));
+    bad[2] = 0x00;
+    TEST_ASSERT(!flipper_wedge_nfc_t4_parse_cc(bad, sizeof(bad), &cc));
+    bad[2] = 0x40;
+    TEST_ASSERT(!flipper_wedge_nfc_t4_parse_cc(bad, sizeof(bad), &cc));
+    bad[2] = 0x10;
+    TEST_ASSERT(flipper_wedge_nfc_t4_parse_cc(bad, sizeof(bad), &cc));
+
+    // Proprietary File Control TLV, or an NDEF one too short
+    bad[7] = 0x05;
+    TEST_ASSERT(!flipper_wedge_nfc_t4_parse_cc(bad, sizeof(bad), &cc));
+    bad[7] = 0x04;
+    bad[8] = 0x05;
+    TEST_ASSERT(!flipper_wedge_nfc_t4_parse_cc(bad, sizeof(bad), &cc));
+}
+
+static void test_reserved_file_ids(void) {
+    static const uint16_t reserved[] = {0x0000, 0xE102, 0xE103, 0x3F00, 0x3FFF, 0xFFFF};
+    ScriptedTag tag;
+    FlipperWedgeNfcT4Cc cc;
+
+    for(size_t i = 0; i < COUNT_OF(reserved); i++) {
+        tag_init(&tag, 255, 100);
+        tag.cc[9] = reserved[i] >> 8;
+        tag.cc[10] = reserved[i] & 0xFF;
+        tag.ndef_file_id = reserved[i];
+        TEST_ASSERT(!flipper_wedge_nfc_t4_parse_cc(tag.cc, 15, &cc));
+        // Never selected: the CC's own file would be read as the message
+        TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 0);
+        TEST_ASSERT_EQ(tag.exchanges, 3);
+    }
+
+    // Proprietary file IDs around the reserved ones are fine
+    static const uint16_t allowed[] = {0x0001, 0xE101, 0xE104, 0x3F01, 0xFFFE};
+    for(size_t i = 0; i < COUNT_OF(allowed); i++) {
+        tag_init(&tag, 255, 100);
+        tag.cc[9] = allowed[i] >> 8;
+        tag.cc[10] = allowed[i] & 0xFF;
+        tag.ndef_file_id = allowed[i];
+        TEST_ASSERT(flipper_wedge_nfc_t4_parse_cc(tag.cc, 15, &cc));
+        TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 100);
+    }
+}
+
+static void test_tag_failures(void) {
+    ScriptedTag tag;
+
+    // No NDEF application: an error status isn't retried
+    tag_init(&tag, 255, 100);
+    tag.no_application = true;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 0);
+    TEST_ASSERT_EQ(tag.exchanges, 1);
+
+    // NDEF file named in the CC missing
+    tag_init(&tag, 255, 100);
+    tag.cc[9] = 0xE1;
+    tag.cc[10] = 0x05;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 0);
+    TEST_ASSERT_EQ(tag.exchanges, 4);
+
+    // No response to SELECT application: retried
+    tag_init(&tag, 255, 100);
+    tag.fail_at = 1;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 100);
+    TEST_ASSERT_EQ(tag.exchanges, 6);
+
+    // Lost halfway: what was read so far
+    tag_init(&tag, 59, 500);
+    tag.fail_at = 7;
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 57 + 59);
+    TEST_ASSERT(message_matches(message, 57 + 59));
+
+    // Empty message
+    tag_init(&tag, 255, 0);
+    TEST_ASSERT_EQ(read_ndef(&tag, NULL, sizeof(message)), 0);
+    TEST_ASSERT_EQ(tag.exchanges, 5);
+}
+
+int main(void) {
+    stub_clock_set_virtual(true);
+
+    TEST_RUN(test_exchange_counts);
+    TEST_RUN(test_complete_stops_reading);
+    TEST_RUN(test_message_cut_off);
+    TEST_RUN(test_small_ndef_file);
+    TEST_RUN(test_extended_ndef_file);
+    TEST_RUN(test_parse_cc);
+    TEST_RUN(test_reserved_file_ids);
+    TEST_RUN(test_tag_failures);
+
+    return test_report("test_nfc_t4");
+}
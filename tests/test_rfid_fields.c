@@ -0,0 +1,138 @@
+// Facility code and card number decoded from LF RFID protocol data. HID Prox
+// vectors are the 6 data bytes of the firmware's HID Prox protocol: the 44
+// data bits of the frame after 4 zero bits.
+
+#include "test.h"
+#include "flipper_wedge_rfid_fields.h"
+#include <lfrfid/protocols/lfrfid_protocols.h>
+
+typedef struct {
+    const char* name;
+    uint8_t data[6];
+    uint8_t bits;
+    uint32_t facility_code;
+    uint32_t card_number;
+} HidVector;
+
+static const HidVector hid_vectors[] = {
+    // Published Proxmark3 example frame 2006ec0c86
+    {"H10301", {0x00, 0x20, 0x06, 0xEC, 0x0C, 0x86}, 26, 118, 1603},
+    // Encoded from the format definitions, parity checked below
+    {"C1000-35", {0x00, 0x2E, 0x9A, 0x51, 0x54, 0xA4}, 35, 1234, 567890},
+    {"H10304", {0x00, 0x13, 0x03, 0x9A, 0x8C, 0x9D}, 37, 12345, 345678},
+};
+
+static uint8_t get_bit(const uint8_t* data, size_t bit) {
+    return (data[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+// Bit i of the vector's Wiegand card
+static uint8_t card_bit(const HidVector* vector, size_t i) {
+    return get_bit(vector->data, 48 - vector->bits + i);
+}
+
+// Ones among card bits first to last, optionally skipping every third bit
+static uint32_t card_ones(const HidVector* vector, size_t first, size_t last, bool skip_third) {
+    uint32_t ones = 0;
+    for(size_t i = first; i <= last; i++) {
+        if(skip_third && (i - first) % 3 == 2) continue;
+        ones += card_bit(vector, i);
+    }
+    return ones;
+}
+
+// The vectors are real frames: header, sentinel and parity of the format
+static void test_vectors_are_well_formed(void) {
+    const HidVector* h10301 = &hid_vectors[0];
+    TEST_ASSERT_EQ(card_ones(h10301, 0, 12, false) % 2, 0);
+    TEST_ASSERT_EQ(card_ones(h10301, 13, 25, false) % 2, 1);
+
+    // Corporate 1000: even over 2,3,5,6..., odd over 1,2,4,5..., odd over all
+    const HidVector* c1000 = &hid_vectors[1];
+    TEST_ASSERT_EQ((card_bit(c1000, 1) + card_ones(c1000, 2, 33, true)) % 2, 0);
+    TEST_ASSERT_EQ((card_ones(c1000, 1, 32, true) + card_bit(c1000, 34)) % 2, 1);
+    TEST_ASSERT_EQ(card_ones(c1000, 0, 34, false) % 2, 1);
+
+    const HidVector* h10304 = &hid_vectors[2];
+    TEST_ASSERT_EQ(card_ones(h10304, 0, 18, false) % 2, 0);
+    TEST_ASSERT_EQ(card_ones(h10304, 18, 36, false) % 2, 1);
+
+    for(size_t i = 0; i < COUNT_OF(hid_vectors); i++) {
+        const HidVector* vector = &hid_vectors[i];
+        // 4 zero bits before the frame data
+        TEST_ASSERT_EQ(vector->data[0] >> 4, 0);
+        if(vector->bits < 37) {
+            TEST_ASSERT_EQ(get_bit(vector->data, 10), 1);
+            TEST_ASSERT_EQ(get_bit(vector->data, 48 - vector->bits - 1), 1);
+        }
+    }
+}
+
+static void test_hid_prox(void) {
+    for(size_t i = 0; i < COUNT_OF(hid_vectors); i++) {
+        const HidVector* vector = &hid_vectors[i];
+        TEST_ASSERT_EQ(
+            flipper_wedge_rfid_fields_hid_format_bits(vector->data, sizeof(vector->data)), vector->bits);
+
+        FlipperWedgeRfidFields fields;
+        flipper_wedge_rfid_fields_decode(
+            LFRFIDProtocolHidGeneric, vector->data, sizeof(vector->data), &fields);
+        TEST_ASSERT(fields.valid);
+        TEST_ASSERT_EQ(fields.facility_code, vector->facility_code);
+        TEST_ASSERT_EQ(fields.card_number, vector->card_number);
+    }
+}
+
+static void test_hid_prox_other_formats(void) {
+    FlipperWedgeRfidFields fields;
+
+    // Sentinel in the first 6 header bits: 40-bit card, no layout for it
+    const uint8_t long_format[6] = {0x01, 0x80, 0x12, 0x34, 0x56, 0x78};
+    TEST_ASSERT_EQ(flipper_wedge_rfid_fields_hid_format_bits(long_format, 6), 40);
+    flipper_wedge_rfid_fields_decode(LFRFIDProtocolHidGeneric, long_format, 6, &fields);
+    TEST_ASSERT(!fields.valid);
+
+    // 36-bit, sentinel right after the header bit
+    const uint8_t bits36[6] = {0x00, 0x30, 0x12, 0x34, 0x56, 0x78};
+    TEST_ASSERT_EQ(flipper_wedge_rfid_fields_hid_format_bits(bits36, 6), 36);
+
+    // Header bit without a sentinel before the shortest format
+    const uint8_t no_sentinel[6] = {0x00, 0x20, 0x00, 0x00, 0x00, 0x00};
+    TEST_ASSERT_EQ(flipper_wedge_rfid_fields_hid_format_bits(no_sentinel, 6), 0);
+    flipper_wedge_rfid_fields_decode(LFRFIDProtocolHidGeneric, no_sentinel, 6, &fields);
+    TEST_ASSERT(!fields.valid);
+
+    // Short data
+    flipper_wedge_rfid_fields_decode(LFRFIDProtocolHidGeneric, hid_vectors[0].data, 5, &fields);
+    TEST_ASSERT(!fields.valid);
+}
+
+static void test_other_protocols(void) {
+    FlipperWedgeRfidFields fields;
+
+    // EM4100 version 0x12, then 0x34 and 0x5678
+    const uint8_t em4100[5] = {0x00, 0x12, 0x34, 0x56, 0x78};
+    flipper_wedge_rfid_fields_decode(LFRFIDProtocolEM4100, em4100, sizeof(em4100), &fields);
+    TEST_ASSERT(fields.valid);
+    TEST_ASSERT_EQ(fields.facility_code, 0x34);
+    TEST_ASSERT_EQ(fields.card_number, 0x5678);
+
+    const uint8_t h10301[3] = {118, 1603 >> 8, 1603 & 0xFF};
+    flipper_wedge_rfid_fields_decode(LFRFIDProtocolH10301, h10301, sizeof(h10301), &fields);
+    TEST_ASSERT(fields.valid);
+    TEST_ASSERT_EQ(fields.facility_code, 118);
+    TEST_ASSERT_EQ(fields.card_number, 1603);
+
+    const uint8_t fdxb[11] = {0};
+    flipper_wedge_rfid_fields_decode(LFRFIDProtocolFDXB, fdxb, sizeof(fdxb), &fields);
+    TEST_ASSERT(!fields.valid);
+}
+
+int main(void) {
+    TEST_RUN(test_vectors_are_well_formed);
+    TEST_RUN(test_hid_prox);
+    TEST_RUN(test_hid_prox_other_formats);
+    TEST_RUN(test_other_protocols);
+
+    return test_report("test_rfid_fields");
+}
@@ -0,0 +1,224 @@
+// Output templates: syntax errors leave the template empty, UID options in
+// any order, widths, {ndef:N} cutting whole UTF-8 characters, {fc}/{card}
+// with and without decoded fields, escapes, and parts that don't fit.
+
+#include "test.h"
+#include "flipper_wedge_template.h"
+
+static const uint8_t nfc_uid[] = {0x04, 0xA1, 0xB2, 0xC3};
+static const uint8_t rfid_uid[] = {0x00, 0x12, 0x34};
+
+static FlipperWedgeTemplateData scan_data(void) {
+    FlipperWedgeTemplateData data = {
+        .nfc_uid = nfc_uid,
+        .nfc_uid_len = sizeof(nfc_uid),
+        .rfid_uid = rfid_uid,
+        .rfid_uid_len = sizeof(rfid_uid),
+        .delimiter = ":",
+    };
+    return data;
+}
+
+// Compile source and render it into output, "!" if it doesn't compile
+static const char* render(const char* source, const FlipperWedgeTemplateData* data) {
+    static char output[256];
+    FlipperWedgeTemplate tpl;
+    if(!flipper_wedge_template_compile(&tpl, source)) return "!";
+    flipper_wedge_template_render(&tpl, data, output, sizeof(output));
+    return output;
+}
+
+static void test_compile_errors(void) {
+    static const char* bad[] = {
+        "{",
+        "{nfc",
+        "{}",
+        "}",
+        "abc}",
+        "{foo}",
+        "{nfc:bogus}",
+        "{nfc:hex:0}",
+        "{nfc:65}",
+        "{nfc:12x}",
+        "{ndef:0}",
+        "{ndef:65536}",
+        "{ndef:abc}",
+        "{fc:0}",
+        "{card:x}",
+        "{sep:1}",
+        "{tab:rev}",
+        "\\q",
+        "\\",
+        "{nfc:hex:rev:lower:nosep:dec:hex:rev:1}", // Longer than a token
+    };
+
+    FlipperWedgeTemplate tpl;
+    for(size_t i = 0; i < COUNT_OF(bad); i++) {
+        // A good template first, an error must not leave it behind
+        TEST_ASSERT(flipper_wedge_template_compile(&tpl, "{nfc}"));
+        TEST_ASSERT(!flipper_wedge_template_compile(&tpl, bad[i]));
+        TEST_ASSERT(!flipper_wedge_template_is_set(&tpl));
+    }
+
+    // Literal text longer than the program holds
+    char source[FLIPPER_WEDGE_TEMPLATE_PROGRAM_MAX + 1];
+    memset(source, 'x', sizeof(source) - 1);
+    source[sizeof(source) - 1] = '\0';
+    TEST_ASSERT(!flipper_wedge_template_compile(&tpl, source));
+    TEST_ASSERT(!flipper_wedge_template_is_set(&tpl));
+
+    // Empty clears
+    TEST_ASSERT(flipper_wedge_template_compile(&tpl, "{nfc}"));
+    TEST_ASSERT(flipper_wedge_template_compile(&tpl, ""));
+    TEST_ASSERT(!flipper_wedge_template_is_set(&tpl));
+}
+
+static void test_uid_options(void) {
+    FlipperWedgeTemplateData data = scan_data();
+
+    TEST_ASSERT_STR(render("{nfc}", &data), "04:A1:B2:C3");
+    TEST_ASSERT_STR(render("{nfc:hex}", &data), "04:A1:B2:C3");
+    TEST_ASSERT_STR(render("{nfc:hex:rev}", &data), "C3:B2:A1:04");
+    TEST_ASSERT_STR(render("{nfc:rev:hex}", &data), "C3:B2:A1:04");
+    TEST_ASSERT_STR(render("{nfc:lower}", &data), "04:a1:b2:c3");
+    TEST_ASSERT_STR(render("{nfc:nosep}", &data), "04A1B2C3");
+    TEST_ASSERT_STR(render("{nfc:nosep:rev:lower}", &data), "c3b2a104");
+    TEST_ASSERT_STR(render("{nfc:dec}", &data), "77705923");
+    TEST_ASSERT_STR(render("{nfc:dec:rev}", &data), "3283263748");
+    // The last of hex and dec wins
+    TEST_ASSERT_STR(render("{nfc:dec:hex:nosep}", &data), "04A1B2C3");
+    TEST_ASSERT_STR(render("{rfid:dec}", &data), "4660");
+    TEST_ASSERT_STR(render("{rfid:nosep}", &data), "001234");
+
+    // Width pads with leading zeros, never cuts
+    TEST_ASSERT_STR(render("{rfid:dec:8}", &data), "00004660");
+    TEST_ASSERT_STR(render("{rfid:8:dec}", &data), "00004660");
+    TEST_ASSERT_STR(render("{rfid:dec:2}", &data), "4660");
+    TEST_ASSERT_STR(render("{nfc:nosep:10}", &data), "0004A1B2C3");
+    TEST_ASSERT_STR(render("{nfc:dec:64}", &data), "0000000000000000000000000000000000000000000000000000000077705923");
+
+    // Delimiter from the settings, none at all
+    data.delimiter = "-";
+    TEST_ASSERT_STR(render("{nfc}{sep}{rfid}", &data), "04-A1-B2-C3-00-12-34");
+    data.delimiter = NULL;
+    TEST_ASSERT_STR(render("{nfc}{sep}{rfid}", &data), "04A1B2C3001234");
+
+    // Absent UIDs render as nothing, the text around them stays
+    data = scan_data();
+    data.rfid_uid_len = 0;
+    TEST_ASSERT_STR(render("[{rfid}]{nfc:nosep}", &data), "[]04A1B2C3");
+    data.nfc_uid = NULL;
+    TEST_ASSERT_STR(render("[{nfc:8}]", &data), "[]");
+}
+
+static void test_ndef_length(void) {
+    FlipperWedgeTemplateData data = scan_data();
+
+    data.ndef_text = "hello world";
+    TEST_ASSERT_STR(render("{ndef}", &data), "hello world");
+    TEST_ASSERT_STR(render("{ndef:5}", &data), "hello");
+    TEST_ASSERT_STR(render("{ndef:11}", &data), "hello world");
+    TEST_ASSERT_STR(render("{ndef:200}", &data), "hello world");
+
+    // Characters, not bytes: 2, 3 and 4-byte sequences stay whole
+    data.ndef_text = "a\xC3\xA9" "b\xE2\x82\xAC" "c\xF0\x9F\x98\x80" "d";
+    TEST_ASSERT_STR(render("{ndef:1}", &data), "a");
+    TEST_ASSERT_STR(render("{ndef:2}", &data), "a\xC3\xA9");
+    TEST_ASSERT_STR(render("{ndef:3}", &data), "a\xC3\xA9" "b");
+    TEST_ASSERT_STR(render("{ndef:4}", &data), "a\xC3\xA9" "b\xE2\x82\xAC");
+    TEST_ASSERT_STR(render("{ndef:6}", &data), "a\xC3\xA9" "b\xE2\x82\xAC" "c\xF0\x9F\x98\x80");
+    TEST_ASSERT_STR(render("{ndef:7}", &data), data.ndef_text);
+
+    data.ndef_text = "\xF0\x9F\x98\x80\xF0\x9F\x98\x81";
+    TEST_ASSERT_STR(render("<{ndef:1}>", &data), "<\xF0\x9F\x98\x80>");
+
+    data.ndef_text = "";
+    TEST_ASSERT_STR(render("<{ndef:3}>", &data), "<>");
+    data.ndef_text = NULL;
+    TEST_ASSERT_STR(render("<{ndef}>", &data), "<>");
+}
+
+static void test_rfid_fields(void) {
+    FlipperWedgeTemplateData data = scan_data();
+    FlipperWedgeRfidFields fields = {.valid = true, .facility_code = 118, .card_number = 1603};
+
+    // Without decoded fields, or with a protocol that has none
+    TEST_ASSERT_STR(render("{fc}/{card}", &data), "/");
+    data.rfid_fields = &fields;
+    fields.valid = false;
+    TEST_ASSERT_STR(render("{fc}/{card}", &data), "/");
+
+    fields.valid = true;
+    TEST_ASSERT_STR(render("{fc}/{card}", &data), "118/1603");
+    TEST_ASSERT_STR(render("{fc:3},{card:5}", &data), "118,01603");
+    TEST_ASSERT_STR(render("{card:2}", &data), "1603");
+
+    fields.facility_code = 0;
+    fields.card_number = UINT32_MAX;
+    TEST_ASSERT_STR(render("{fc}/{card}", &data), "0/4294967295");
+    TEST_ASSERT_STR(render("{fc:4}", &data), "0000");
+}
+
+static void test_literals(void) {
+    FlipperWedgeTemplateData data = scan_data();
+
+    TEST_ASSERT_STR(render("UID=", &data), "UID=");
+    TEST_ASSERT_STR(render("\\{{rfid:nosep}\\}", &data), "{001234}");
+    TEST_ASSERT_STR(render("a\\\\b\\tc\\nd", &data), "a\\b\tc\nd");
+    TEST_ASSERT_STR(render("{rfid:nosep}{tab}{nfc:nosep}\\n", &data), "001234\t04A1B2C3\n");
+
+    // As much literal text as the program holds
+    char source[FLIPPER_WEDGE_TEMPLATE_PROGRAM_MAX - 1];
+    memset(source, 'x', sizeof(source) - 1);
+    source[sizeof(source) - 1] = '\0';
+    TEST_ASSERT_STR(render(source, &data), source);
+}
+
+static void test_output_size(void) {
+    FlipperWedgeTemplateData data = scan_data();
+    data.ndef_text = "hello";
+    FlipperWedgeTemplate tpl;
+    TEST_ASSERT(flipper_wedge_template_compile(&tpl, "ab{nfc:nosep}{sep}{ndef}"));
+
+    // Parts that don't fit in what is left are skipped whole, later ones
+    // that do are still written
+    static const struct {
+        size_t size;
+        const char* expected;
+    } cases[] = {
+        {1, ""},
+        {2, ":"}, // Literal text is one part
+        {3, "ab"},
+        {9, "ab:hello"},
+        {10, "ab:hello"},
+        {11, "ab04A1B2C3"},
+        {12, "ab04A1B2C3:"},
+        {16, "ab04A1B2C3:"},
+        {17, "ab04A1B2C3:hello"},
+    };
+    char output[32];
+    for(size_t i = 0; i < COUNT_OF(cases); i++) {
+        memset(output, '#', sizeof(output));
+        size_t len = flipper_wedge_template_render(&tpl, &data, output, cases[i].size);
+        TEST_ASSERT_STR(output, cases[i].expected);
+        TEST_ASSERT_EQ(len, strlen(cases[i].expected));
+        TEST_ASSERT(output[cases[i].size] == '#');
+    }
+    TEST_ASSERT_EQ(flipper_wedge_template_render(&tpl, &data, output, 0), 0);
+
+    // Padding that doesn't fit drops the field
+    TEST_ASSERT(flipper_wedge_template_compile(&tpl, "{rfid:dec:8}"));
+    TEST_ASSERT_EQ(flipper_wedge_template_render(&tpl, &data, output, 8), 0);
+    TEST_ASSERT_EQ(flipper_wedge_template_render(&tpl, &data, output, 9), 8);
+}
+
+int main(void) {
+    TEST_RUN(test_compile_errors);
+    TEST_RUN(test_uid_options);
+    TEST_RUN(test_ndef_length);
+    TEST_RUN(test_rfid_fields);
+    TEST_RUN(test_literals);
+    TEST_RUN(test_output_size);
+
+    return test_report("test_template");
+}
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Reference reader for the Flipper Wedge "USB Bulk" output mode.
+
+In USB Bulk mode the Flipper does not type, it enumerates as a keyboard plus
+a vendor-defined HID interface (usage page 0xFF00) with 64-byte reports and
+hands each scan over as a binary message when asked. This script polls that
+interface through Linux hidraw and prints every scan as one JSON object per
+line. Stdlib only.
+
+Protocol (see helpers/flipper_wedge_bulk.h):
+  request  -> 'F' 'W' 'R' version, zero padded to 64 bytes
+  response <- reports: [0] bit7 first | seq, [1] payload len, [2..63] payload
+  message  =  'F' 'W' version type body_len(u16 LE) crc16(u16 LE) + fields
+  field    =  type(u8) len(u16 LE) value
+
+Usage:
+  flipper_wedge_bulk_reader.py [--device /dev/hidrawN] [--interval 0.05]
+"""
+
+import argparse
+import glob
+import json
+import os
+import select
+import struct
+import sys
+import time
+
+VID = 0x0483
+PID = 0x5742
+# Usage Page (Vendor Defined 0xFF00), long item, as the descriptor starts
+USAGE_PAGE_ITEM = bytes([0x06, 0x00, 0xFF])
+
+REPORT_SIZE = 64
+PAYLOAD_SIZE = REPORT_SIZE - 2
+HEADER_SIZE = 8
+VERSION = 1
+
+MESSAGE_EMPTY = 0
+MESSAGE_SCAN = 1
+
+FIELD_NAMES = {
+    1: "text",
+    2: "nfc_uid",
+    3: "rfid_uid",
+    4: "rfid_protocol",
+    5: "ndef_text",
+    6: "timestamp",
+}
+
+
+class ProtocolError(Exception):
+    pass
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def find_device():
+    # The keyboard interface of the same device gets a hidraw node too
+    for uevent in glob.glob("/sys/class/hidraw/hidraw*/device/uevent"):
+        with open(uevent) as f:
+            ids = [line for line in f if line.startswith("HID_ID=")]
+        if not ids:
+            continue
+        _, vid, pid = ids[0].strip().split("=")[1].split(":")
+        if int(vid, 16) != VID or int(pid, 16) != PID:
+            continue
+        descriptor = os.path.join(os.path.dirname(uevent), "report_descriptor")
+        with open(descriptor, "rb") as f:
+            if f.read().startswith(USAGE_PAGE_ITEM):
+                return "/dev/" + uevent.split("/")[4]
+    return None
+
+
+def read_report(fd, timeout):
+    ready, _, _ = select.select([fd], [], [], timeout)
+    if not ready:
+        raise ProtocolError("timeout waiting for report")
+    report = os.read(fd, REPORT_SIZE)
+    if len(report) < 2:
+        raise ProtocolError("short report")
+    return report
+
+
+def request_message(fd, timeout=1.0):
+    # Leading 0 is the report ID hidraw expects for devices without IDs
+    request = bytes([ord("F"), ord("W"), ord("R"), VERSION])
+    os.write(fd, b"\x00" + request.ljust(REPORT_SIZE, b"\x00"))
+
+    message = bytearray()
+    expected = None
+    index = 0
+    while expected is None or len(message) < expected:
+        report = read_report(fd, timeout)
+        first = bool(report[0] & 0x80)
+        seq = report[0] & 0x7F
+        length = report[1]
+        if length > PAYLOAD_SIZE:
+            raise ProtocolError("bad payload length %d" % length)
+        if first != (index == 0) or seq != (index & 0x7F):
+            raise ProtocolError("out of sequence report %d, expected %d" % (seq, index))
+
+        message += report[2 : 2 + length]
+        index += 1
+
+        if expected is None and len(message) >= HEADER_SIZE:
+            if message[0:2] != b"FW" or message[2] != VERSION:
+                raise ProtocolError("bad message header")
+            expected = HEADER_SIZE + struct.unpack_from("<H", message, 4)[0]
+
+    return decode_message(bytes(message[:expected]))
+
+
+def decode_message(message):
+    msg_type = message[3]
+    body_len, crc = struct.unpack_from("<HH", message, 4)
+    body = message[HEADER_SIZE : HEADER_SIZE + body_len]
+    if crc16(body) != crc:
+        raise ProtocolError("CRC mismatch")
+
+    fields = {}
+    pos = 0
+    while pos + 3 <= len(body):
+        field_type = body[pos]
+        (length,) = struct.unpack_from("<H", body, pos + 1)
+        value = body[pos + 3 : pos + 3 + length]
+        pos += 3 + length
+
+        name = FIELD_NAMES.get(field_type, "field_%d" % field_type)
+        if name in ("nfc_uid", "rfid_uid"):
+            fields[name] = value.hex().upper()
+        elif name == "timestamp" and len(value) == 4:
+            fields[name] = struct.unpack("<I", value)[0]
+        else:
+            fields[name] = value.decode("utf-8", errors="replace")
+
+    return msg_type, fields
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--device", help="hidraw device node (default: autodetect)")
+    parser.add_argument(
+        "--interval", type=float, default=0.05, help="poll interval in seconds when idle"
+    )
+    args = parser.parse_args()
+
+    device = args.device or find_device()
+    if not device:
+        print("Flipper in USB Bulk mode not found", file=sys.stderr)
+        return 1
+
+    fd = os.open(device, os.O_RDWR)
+    try:
+        while True:
+            try:
+                msg_type, fields = request_message(fd)
+            except ProtocolError as e:
+                print("Dropped message: %s" % e, file=sys.stderr)
+                # Drain whatever is left of the broken message before asking again
+                while select.select([fd], [], [], 0.1)[0]:
+                    os.read(fd, REPORT_SIZE)
+                continue
+
+            if msg_type == MESSAGE_SCAN:
+                print(json.dumps(fields), flush=True)
+            else:
+                time.sleep(args.interval)
+    except KeyboardInterrupt:
+        return 0
+    finally:
+        os.close(fd)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
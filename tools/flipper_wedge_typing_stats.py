@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Summarize typing throughput from a Flipper Wedge debug log.
+
+The HID worker writes one STATS line per typed job to
+/ext/apps_data/flipper_wedge/debug.log:
+
+  [MM:SS.mmm] FlipperWedgeHidWorker: STATS transport=USB keys=9 chars=9 \
+      reports=10 failed=0 ms=12 keys_per_s=750 reports_per_key=1.11 delay_us=0
+
+Copy the log off the SD card (qFlipper or `storage read`) and run:
+
+  flipper_wedge_typing_stats.py debug.log                 # JSON summary
+  flipper_wedge_typing_stats.py debug.log --raw           # one JSON object per job
+  flipper_wedge_typing_stats.py new.log --baseline old.json --tolerance 10
+
+Jobs are grouped by transport and payload size bucket (matching the usual
+UID / delimited UID / 250 / 500 / 1000-char NDEF cases) so runs with the same
+test tags are comparable. With --baseline the exit code is 1 if any group's
+median keys/s dropped by more than the tolerance, so it can gate a release.
+Stdlib only.
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+
+STATS_RE = re.compile(r"STATS ((?:\w+=\S+ ?)+)")
+
+NUMERIC = ("keys", "chars", "reports", "failed", "ms", "keys_per_s", "delay_us")
+
+# Upper bounds (inclusive) of the payload buckets, in keys
+BUCKETS = ((16, "uid"), (64, "uid_delimited"), (300, "ndef_250"), (600, "ndef_500"), (1201, "ndef_1000"))
+
+
+def parse(path):
+    jobs = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = STATS_RE.search(line)
+            if not match:
+                continue
+            job = dict(pair.split("=", 1) for pair in match.group(1).split())
+            for key in NUMERIC:
+                if key in job:
+                    job[key] = int(job[key])
+            if "reports_per_key" in job:
+                job["reports_per_key"] = float(job["reports_per_key"])
+            jobs.append(job)
+    return jobs
+
+
+def bucket(keys):
+    for limit, name in BUCKETS:
+        if keys <= limit:
+            return name
+    return "large"
+
+
+def summarize(jobs):
+    groups = {}
+    for job in jobs:
+        name = "%s/%s" % (job.get("transport", "?"), bucket(job.get("keys", 0)))
+        groups.setdefault(name, []).append(job)
+
+    summary = {}
+    for name, group in sorted(groups.items()):
+        summary[name] = {
+            "jobs": len(group),
+            "keys_per_s_median": statistics.median(j["keys_per_s"] for j in group),
+            "keys_per_s_min": min(j["keys_per_s"] for j in group),
+            "reports_per_key_median": statistics.median(j["reports_per_key"] for j in group),
+            "ms_median": statistics.median(j["ms"] for j in group),
+            "failed_total": sum(j["failed"] for j in group),
+        }
+    return summary
+
+
+def compare(summary, baseline, tolerance):
+    regressions = []
+    for name, old in baseline.items():
+        new = summary.get(name)
+        if not new or not old["keys_per_s_median"]:
+            continue
+        change = 100.0 * (new["keys_per_s_median"] - old["keys_per_s_median"]) / old["keys_per_s_median"]
+        if change < -tolerance:
+            regressions.append(
+                "%s: %s -> %s keys/s (%.1f%%)"
+                % (name, old["keys_per_s_median"], new["keys_per_s_median"], change)
+            )
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", help="debug.log copied from the SD card")
+    parser.add_argument("--raw", action="store_true", help="print every job instead of a summary")
+    parser.add_argument("--baseline", help="summary JSON from a previous run to compare against")
+    parser.add_argument(
+        "--tolerance", type=float, default=10.0, help="allowed keys/s drop in percent (default 10)"
+    )
+    args = parser.parse_args()
+
+    jobs = parse(args.log)
+    if not jobs:
+        print("No STATS lines found in %s" % args.log, file=sys.stderr)
+        return 1
+
+    if args.raw:
+        for job in jobs:
+            print(json.dumps(job))
+        return 0
+
+    summary = summarize(jobs)
+    print(json.dumps(summary, indent=2))
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = compare(summary, json.load(f), args.tolerance)
+        for regression in regressions:
+            print("REGRESSION " + regression, file=sys.stderr)
+        return 1 if regressions else 0
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())